@@ -12,11 +12,22 @@
 
 #include "Cameras.h" 
 #include "GraphicsUtils.h" // <-- Include for collision functions
+#include "CollisionWorld.h"
+#include "DistanceField.h"
+#include "RigidBodies.h"
+#include "HeightField.h"
+#include "FloorStack.h"
 #include <stdio.h> 
 #include <math.h> 
+#include <algorithm>
 
 // --- Collision Padding ---
-const float CAMERA_COLLISION_PADDING = 0.2f; // How far camera stops from blocked cell edge
+const float CAMERA_COLLISION_PADDING = 0.2f; // Player radius: how far the camera stops from walls and objects
+const float CAMERA_STEP_HEIGHT = 0.4f;       // Highest ledge walked onto without jumping
+
+float Camera::getCollisionRadius() const {
+    return CAMERA_COLLISION_PADDING;
+}
 
 
 Camera::Camera(int windowWidth, int windowHeight) {
@@ -34,6 +45,8 @@ Camera::Camera(int windowWidth, int windowHeight) {
     // Set initial position
     // We set Y to ground level initially
     m_posY = m_groundLevel;
+    m_prevY = m_posY;
+    m_renderAlpha = 1.0f;
     setPosition(0.0f, 5.0f); // UPDATED: Only X and Z
 
     m_yaw = 90.0f; // Look forward (along -Z)
@@ -83,6 +96,11 @@ void Camera::setPosition(float x, float z) {
     m_posZ = z;
     // We do NOT change m_posY here. It stays at current height or ground level.
 
+    // Teleport: nothing to interpolate from
+    m_prevX = m_posX;
+    m_prevY = m_posY;
+    m_prevZ = m_posZ;
+
     // Reset velocity when position is set externally
     m_velX = m_velY = m_velZ = 0.0f;
 }
@@ -130,7 +148,8 @@ void Camera::toggleMode() {
     else {
         printf("Camera: Game Mode ENABLED\n");
         glutSetCursor(GLUT_CURSOR_NONE);
-        m_posY = m_groundLevel;
+        m_posY = m_groundLevel + g_floors.getBaseY(g_floors.getCurrent());
+        m_prevY = m_posY;
         m_isJumping = false;
         m_velY = 0;
         centerMouse();
@@ -144,9 +163,14 @@ void Camera::centerMouse() {
 }
 
 void Camera::applyView() {
+    // Blend the last two simulation steps
+    float x = m_prevX + (m_posX - m_prevX) * m_renderAlpha;
+    float y = m_prevY + (m_posY - m_prevY) * m_renderAlpha;
+    float z = m_prevZ + (m_posZ - m_prevZ) * m_renderAlpha;
+
     gluLookAt(
-        m_posX, m_posY, m_posZ,
-        m_posX + m_forwardX, m_posY + m_forwardY, m_posZ + m_forwardZ,
+        x, y, z,
+        x + m_forwardX, y + m_forwardY, z + m_forwardZ,
         0.0f, 1.0f, 0.0f
     );
 }
@@ -253,6 +277,11 @@ void Camera::jump() {
 void Camera::update(float dt) {
     if (dt > 0.1f) dt = 0.1f;
 
+    // Rendering interpolates from here to the new position
+    m_prevX = m_posX;
+    m_prevY = m_posY;
+    m_prevZ = m_posZ;
+
     // --- 1. CHECK SPRINT KEY ---
     m_inputSprint = false;
 #ifdef _WIN32
@@ -336,8 +365,36 @@ void Camera::update(float dt) {
     float potentialNextZ = m_posZ + m_velZ * dt;
     float potentialNextY = m_posY + m_velY * dt;
 
-    // --- 8. Check Grid Collision ---
-    if (!m_isDeveloperMode) {
+    // --- 8. Check Collision ---
+    // Feet height: m_groundLevel is the eye height above whatever is underfoot.
+    // Object tops are measured from the floor the player is on.
+    float feetY = m_posY - m_groundLevel;
+    int floor = g_floors.getCurrent();
+    float floorY = g_floors.getBaseY(floor);
+    if (!m_isDeveloperMode && g_collisionWorld.isBuilt()) {
+        // Far from everything (distance field lower bound), nothing can be hit this frame.
+        // Otherwise sweep the player's circle against the exact object boxes and slide along them;
+        // boxes low enough to step onto (or already below the feet) are passed over.
+        float stepX = m_velX * dt, stepZ = m_velZ * dt;
+        float reach = CAMERA_COLLISION_PADDING + sqrtf(stepX * stepX + stepZ * stepZ);
+        float newX = m_posX, newZ = m_posZ;
+        if (g_distanceField.minClearance(m_posX, m_posZ) > reach) {
+            newX += stepX;
+            newZ += stepZ;
+        }
+        else if (g_collisionWorld.moveAndSlide(newX, newZ, CAMERA_COLLISION_PADDING, stepX, stepZ, 3, feetY - floorY + CAMERA_STEP_HEIGHT) && dt > 0.0f) {
+            // Keep only the velocity that went along the surface
+            m_velX = (newX - m_posX) / dt;
+            m_velZ = (newZ - m_posZ) / dt;
+        }
+
+        // Crates are pushed by the next physics step; until then the player stays outside them
+        g_rigidBodies.separateCircle(newX, newZ, CAMERA_COLLISION_PADDING);
+        potentialNextX = newX;
+        potentialNextZ = newZ;
+    }
+    else if (!m_isDeveloperMode) {
+        // Grid fallback (no collision world yet)
         // X-Axis Check
         float checkX = m_posX + (m_velX > 0 ? CAMERA_COLLISION_PADDING : -CAMERA_COLLISION_PADDING) + m_velX * dt;
         if (isGridPositionBlocked(checkX, m_posZ)) {
@@ -351,15 +408,31 @@ void Camera::update(float dt) {
             m_velZ = 0;
             potentialNextZ = m_posZ;
         }
+    }
 
-        // Ground Check
-        if (m_isJumping && potentialNextY <= m_groundLevel && m_velY < 0.0f) {
-            potentialNextY = m_groundLevel;
+    float groundY = m_groundLevel + floorY;
+    if (!m_isDeveloperMode) {
+        // Ground Check: the highest surface under the player that can be stood on:
+        // the floor, stairs going up from it, or an object's top (the height field is
+        // 0 everywhere without one)
+        groundY = m_groundLevel + g_floors.groundAt(floor, potentialNextX, potentialNextZ);
+        if (g_heightField.isReady()) {
+            float top = g_heightField.groundUnder(potentialNextX, potentialNextZ, CAMERA_COLLISION_PADDING,
+                feetY - floorY + CAMERA_STEP_HEIGHT);
+            groundY = std::max(groundY, m_groundLevel + floorY + top);
+        }
+        if (m_isJumping && potentialNextY <= groundY && m_velY < 0.0f) {
+            potentialNextY = groundY;
             m_isJumping = false;
             m_velY = 0;
         }
+        else if (!m_isJumping && potentialNextY - groundY > CAMERA_STEP_HEIGHT) {
+            // Walked off an edge: fall
+            m_isJumping = true;
+            m_velY = 0;
+        }
         else if (!m_isJumping) {
-            potentialNextY = m_groundLevel;
+            potentialNextY = groundY;
             m_velY = 0;
         }
     }
@@ -369,8 +442,8 @@ void Camera::update(float dt) {
     m_posY = potentialNextY;
     m_posZ = potentialNextZ;
 
-    if (!m_isDeveloperMode && m_posY < m_groundLevel) {
-        m_posY = m_groundLevel;
+    if (!m_isDeveloperMode && m_posY < groundY) {
+        m_posY = groundY;
         if (m_isJumping) {
             m_isJumping = false;
             m_velY = 0;
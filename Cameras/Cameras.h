@@ -28,6 +28,14 @@ public:
      */
     void applyView();
 
+    /**
+     * @brief Sets how far rendering is between the last two update() steps
+     * (0 = previous step, 1 = latest). applyView() blends the position by it,
+     * so a fixed simulation rate still looks smooth at any frame rate.
+     * Orientation is not blended: mouse look is applied as it happens.
+     */
+    void setRenderAlpha(float alpha) { m_renderAlpha = alpha; }
+
 
     /**
      * @brief Finishes camera setup. Call this in main() AFTER glutCreateWindow().
@@ -68,12 +76,27 @@ public:
     bool isDeveloperMode() const { return m_isDeveloperMode; }
 
     void setPosition(float x, float z);
-    void setGroundLevel(float level) { m_groundLevel = level; m_posY = level; }
+    void setGroundLevel(float level) { m_groundLevel = level; m_posY = level; m_prevY = level; }
 
     float getX() { return m_posX; }
     float getY() { return m_posY; }
     float getZ() { return m_posZ; }
 
+    // Height of the player's feet (eye height minus the ground level)
+    float getFeetY() const { return m_posY - m_groundLevel; }
+
+    // Horizontal velocity of the last update() (pushes crates)
+    float getVelX() const { return m_velX; }
+    float getVelZ() const { return m_velZ; }
+
+    // Radius of the player's circle against walls and objects
+    float getCollisionRadius() const;
+
+    // View direction (unit length)
+    float getForwardX() const { return m_forwardX; }
+    float getForwardY() const { return m_forwardY; }
+    float getForwardZ() const { return m_forwardZ; }
+
 private:
     // --- INTERNAL HELPERS ---
     void jump();
@@ -84,6 +107,8 @@ private:
     // --- CAMERA STATE ---
     bool  m_isDeveloperMode;
     float m_posX, m_posY, m_posZ; // Camera position
+    float m_prevX, m_prevY, m_prevZ; // Position before the last update() (for interpolation)
+    float m_renderAlpha;
     float m_yaw;   // Degrees (rotation left/right)
     float m_pitch; // Degrees (rotation up/down)
 
@@ -1,6 +1,9 @@
 #include "pch.h" // Must be first
 #include "CornerTower.h"
 #include "GraphicsUtils.h" // For collision functions
+#include "GpuMemory.h"
+#include "Footprint.h"
+#include "CollisionWorld.h"
 #include <stdio.h>
 #include <math.h>
 
@@ -16,7 +19,10 @@ CornerTower::CornerTower(float roomHeight, float towerWidth)
 }
 
 CornerTower::~CornerTower() {
-    if (m_displayListID != 0) glDeleteLists(m_displayListID, 1);
+    if (m_displayListID != 0) {
+        glDeleteLists(m_displayListID, 1);
+        g_gpuMemory.untrack(GPU_DISPLAY_LIST, m_displayListID);
+    }
 }
 
 // Add a tower position to the list
@@ -25,35 +31,52 @@ void CornerTower::addTower(float x, float z) {
     t.x = x;
     t.z = z;
     m_towers.push_back(t);
+    printf("Design Tower added at (%.1f, %.1f)\n", x, z);
+}
 
-    // --- COLLISION UPDATE ---
+void CornerTower::clear() {
+    m_towers.clear();
+}
+
+void CornerTower::applyCollision(CollisionGrid& grid) {
+    for (const auto& t : m_towers) {
+        stampCollision(t, grid);
+    }
+}
+
+FootprintBox CornerTower::getBaseFootprint() const {
     // Collision covers the WIDEST part (the bottom-most base layer)
     // 3 layers of overhang means width + (3 * overhang * 2)
     float maxBaseWidth = m_width + (m_rimOverhang * 3.0f * 2.0f);
     float halfW = maxBaseWidth / 2.0f;
 
-    for (float i = x - halfW; i <= x + halfW; i += 0.5f) {
-        for (float j = z - halfW; j <= z + halfW; j += 0.5f) {
-            int gx, gz;
-            if (worldToGrid(i, j, gx, gz)) {
-                addBlockGridBox(gx, gz);
-            }
+    FootprintBox base = { halfW, halfW, 0.0f, 0.0f };
+    return base;
+}
+
+void CornerTower::addColliders() {
+    // The three base layers are steps (each one rim higher and one overhang
+    // narrower), the shaft reaches the ceiling
+    FootprintBox base = getBaseFootprint();
+    FootprintBox shaft = { m_width / 2.0f, m_width / 2.0f, 0.0f, 0.0f };
+    for (const auto& t : m_towers) {
+        FootprintBox layer = base;
+        for (int i = 1; i <= 3; ++i) {
+            g_collisionWorld.addBox(t.x, t.z, 0.0f, layer, COLLIDER_TOWER, m_rimHeight * i);
+            layer.halfWidth -= m_rimOverhang;
+            layer.halfDepth -= m_rimOverhang;
         }
+        g_collisionWorld.addBox(t.x, t.z, 0.0f, shaft, COLLIDER_TOWER);
     }
-    printf("Design Tower added at (%.1f, %.1f)\n", x, z);
 }
 
-void CornerTower::build(GLuint textureID) {
-    m_textureID = textureID;
-
-    if (m_displayListID != 0) glDeleteLists(m_displayListID, 1);
-    m_displayListID = glGenLists(1);
-
-    glNewList(m_displayListID, GL_COMPILE);
+void CornerTower::stampCollision(const TowerPos& t, CollisionGrid& grid) {
+    rasterizeFootprintBox(t.x, t.z, 0.0f, getBaseFootprint(), true, grid);
+}
 
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, m_textureID);
-    glColor3f(1.0f, 1.0f, 1.0f);
+void CornerTower::bakeGeometry(BakedMesh& out) const {
+    out.clear();
+    out.beginBatch(0);
 
     for (const auto& tower : m_towers) {
         float x = tower.x;
@@ -65,26 +88,17 @@ void CornerTower::build(GLuint textureID) {
         // Layer 1 (Bottom - Widest)
         float baseY = m_rimHeight / 2.0f;
         float layer1W = m_width + (m_rimOverhang * 6.0f); // Widest
-        glPushMatrix();
-        glTranslatef(x, baseY, z);
-        drawBox(layer1W, m_rimHeight, layer1W);
-        glPopMatrix();
+        out.addBox(x, baseY, z, layer1W, m_rimHeight, layer1W);
 
         // Layer 2 (Middle Base)
         baseY += m_rimHeight;
         float layer2W = m_width + (m_rimOverhang * 4.0f);
-        glPushMatrix();
-        glTranslatef(x, baseY, z);
-        drawBox(layer2W, m_rimHeight, layer2W);
-        glPopMatrix();
+        out.addBox(x, baseY, z, layer2W, m_rimHeight, layer2W);
 
         // Layer 3 (Top Base)
         baseY += m_rimHeight;
         float layer3W = m_width + (m_rimOverhang * 2.0f);
-        glPushMatrix();
-        glTranslatef(x, baseY, z);
-        drawBox(layer3W, m_rimHeight, layer3W);
-        glPopMatrix();
+        out.addBox(x, baseY, z, layer3W, m_rimHeight, layer3W);
 
         // Total height used by base
         float totalBaseH = m_rimHeight * 3.0f;
@@ -96,24 +110,15 @@ void CornerTower::build(GLuint textureID) {
         float topY = m_height - (m_rimHeight / 2.0f);
 
         // Layer 1 (Top-most - Widest)
-        glPushMatrix();
-        glTranslatef(x, topY, z);
-        drawBox(layer1W, m_rimHeight, layer1W);
-        glPopMatrix();
+        out.addBox(x, topY, z, layer1W, m_rimHeight, layer1W);
 
         // Layer 2
         topY -= m_rimHeight;
-        glPushMatrix();
-        glTranslatef(x, topY, z);
-        drawBox(layer2W, m_rimHeight, layer2W);
-        glPopMatrix();
+        out.addBox(x, topY, z, layer2W, m_rimHeight, layer2W);
 
         // Layer 3
         topY -= m_rimHeight;
-        glPushMatrix();
-        glTranslatef(x, topY, z);
-        drawBox(layer3W, m_rimHeight, layer3W);
-        glPopMatrix();
+        out.addBox(x, topY, z, layer3W, m_rimHeight, layer3W);
 
         float totalTopH = m_rimHeight * 3.0f;
 
@@ -125,43 +130,38 @@ void CornerTower::build(GLuint textureID) {
         float shaftCenterY = totalBaseH + (shaftH / 2.0f);
 
         // A. Inner Core (The main block)
-        glPushMatrix();
-        glTranslatef(x, shaftCenterY, z);
-        drawBox(m_width * 0.9f, shaftH, m_width * 0.9f); // Slightly inset
-        glPopMatrix();
+        out.addBox(x, shaftCenterY, z, m_width * 0.9f, shaftH, m_width * 0.9f); // Slightly inset
 
         // B. Corner Pillars (Vertical Ridges)
         // We draw 4 thin posts at the corners of the shaft to give it a "framed" look
         float postW = m_width * 0.15f; // Thin posts
         float postOffset = (m_width / 2.0f) - (postW / 2.0f); // Push to corners
 
-        // Front-Left Post
-        glPushMatrix();
-        glTranslatef(x - postOffset, shaftCenterY, z + postOffset);
-        drawBox(postW, shaftH, postW);
-        glPopMatrix();
-
-        // Front-Right Post
-        glPushMatrix();
-        glTranslatef(x + postOffset, shaftCenterY, z + postOffset);
-        drawBox(postW, shaftH, postW);
-        glPopMatrix();
-
-        // Back-Left Post
-        glPushMatrix();
-        glTranslatef(x - postOffset, shaftCenterY, z - postOffset);
-        drawBox(postW, shaftH, postW);
-        glPopMatrix();
-
-        // Back-Right Post
-        glPushMatrix();
-        glTranslatef(x + postOffset, shaftCenterY, z - postOffset);
-        drawBox(postW, shaftH, postW);
-        glPopMatrix();
+        out.addBox(x - postOffset, shaftCenterY, z + postOffset, postW, shaftH, postW); // Front-Left Post
+        out.addBox(x + postOffset, shaftCenterY, z + postOffset, postW, shaftH, postW); // Front-Right Post
+        out.addBox(x - postOffset, shaftCenterY, z - postOffset, postW, shaftH, postW); // Back-Left Post
+        out.addBox(x + postOffset, shaftCenterY, z - postOffset, postW, shaftH, postW); // Back-Right Post
+    }
+}
+
+void CornerTower::build(GLuint textureID, const BakedMesh* baked) {
+    m_textureID = textureID;
+
+    // Reuse cached geometry when we have it, otherwise generate it
+    if (baked) m_mesh = *baked;
+    else bakeGeometry(m_mesh);
+
+    if (m_displayListID != 0) {
+        glDeleteLists(m_displayListID, 1);
+        g_gpuMemory.untrack(GPU_DISPLAY_LIST, m_displayListID);
     }
+    m_displayListID = glGenLists(1);
 
-    glDisable(GL_TEXTURE_2D);
+    glNewList(m_displayListID, GL_COMPILE);
+    m_mesh.draw(&m_textureID, 1);
     glEndList();
+
+    g_gpuMemory.trackDisplayList(m_displayListID, "CornerTower", "towers", (int)m_mesh.vertices.size());
 }
 
 void CornerTower::draw() {
@@ -169,25 +169,3 @@ void CornerTower::draw() {
         glCallList(m_displayListID);
     }
 }
-
-// Helper to draw a textured cube centered at (0,0,0)
-void CornerTower::drawBox(float w, float h, float d) {
-    float hw = w / 2.0f;
-    float hh = h / 2.0f;
-    float hd = d / 2.0f;
-
-    glBegin(GL_QUADS);
-    // Front
-    glNormal3f(0, 0, 1); glTexCoord2f(0, 0); glVertex3f(-hw, -hh, hd); glTexCoord2f(1, 0); glVertex3f(hw, -hh, hd); glTexCoord2f(1, 1); glVertex3f(hw, hh, hd); glTexCoord2f(0, 1); glVertex3f(-hw, hh, hd);
-    // Back
-    glNormal3f(0, 0, -1); glTexCoord2f(0, 0); glVertex3f(hw, -hh, -hd); glTexCoord2f(1, 0); glVertex3f(-hw, -hh, -hd); glTexCoord2f(1, 1); glVertex3f(-hw, hh, -hd); glTexCoord2f(0, 1); glVertex3f(hw, hh, -hd);
-    // Left
-    glNormal3f(-1, 0, 0); glTexCoord2f(0, 0); glVertex3f(-hw, -hh, -hd); glTexCoord2f(1, 0); glVertex3f(-hw, -hh, hd); glTexCoord2f(1, 1); glVertex3f(-hw, hh, hd); glTexCoord2f(0, 1); glVertex3f(-hw, hh, -hd);
-    // Right
-    glNormal3f(1, 0, 0); glTexCoord2f(0, 0); glVertex3f(hw, -hh, hd); glTexCoord2f(1, 0); glVertex3f(hw, -hh, -hd); glTexCoord2f(1, 1); glVertex3f(hw, hh, -hd); glTexCoord2f(0, 1); glVertex3f(hw, hh, hd);
-    // Top
-    glNormal3f(0, 1, 0); glTexCoord2f(0, 0); glVertex3f(-hw, hh, hd); glTexCoord2f(1, 0); glVertex3f(hw, hh, hd); glTexCoord2f(1, 1); glVertex3f(hw, hh, -hd); glTexCoord2f(0, 1); glVertex3f(-hw, hh, -hd);
-    // Bottom
-    glNormal3f(0, -1, 0); glTexCoord2f(0, 0); glVertex3f(-hw, -hh, -hd); glTexCoord2f(1, 0); glVertex3f(hw, -hh, -hd); glTexCoord2f(1, 1); glVertex3f(hw, -hh, hd); glTexCoord2f(0, 1); glVertex3f(-hw, -hh, hd);
-    glEnd();
-}
\ No newline at end of file
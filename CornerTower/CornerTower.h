@@ -4,6 +4,10 @@
 #include "pch.h"
 #include <glut.h>
 #include <vector> // Needed for storing multiple towers
+#include "BakedMesh.h"
+#include "Footprint.h"
+
+class CollisionGrid;
 
 // Structure to hold the position of a single tower
 struct TowerPos {
@@ -17,16 +21,36 @@ public:
     CornerTower(float roomHeight, float towerWidth);
     ~CornerTower();
 
+    // Height used by the next build() (the room height changed)
+    void setHeight(float roomHeight) { m_height = roomHeight; }
+
     // Add a new tower at a specific location
     void addTower(float x, float z);
 
-    // Create the display list and collision
+    // Create the display list
     // textureID: The metal texture
-    void build(GLuint textureID);
+    // baked: geometry from the world cache (skips generating it), or nullptr
+    void build(GLuint textureID, const BakedMesh* baked = nullptr);
+
+    // Generates the tower geometry on the CPU (no GL calls)
+    void bakeGeometry(BakedMesh& out) const;
+
+    // Geometry used by the last build() (saved into the world cache)
+    const BakedMesh& getMesh() const { return m_mesh; }
 
     // Draw all towers
     void draw();
 
+    // Removes all towers (their grid cells stay blocked until the grid is rebuilt)
+    void clear();
+
+    // Blocks the cells of every tower in 'grid' (the live grid or a scratch
+    // one; not needed when a compiled level brings its own grid)
+    void applyCollision(CollisionGrid& grid);
+
+    // Adds every tower to g_collisionWorld (base layers as low steps, then the shaft)
+    void addColliders();
+
 private:
     // Shared properties for all towers
     float m_width;
@@ -40,6 +64,11 @@ private:
     // List of positions
     std::vector<TowerPos> m_towers;
 
-    // Internal helper to draw a textured box
-    void drawBox(float width, float height, float depth);
+    BakedMesh m_mesh;
+
+    // Footprint of the widest base layer
+    FootprintBox getBaseFootprint() const;
+
+    // Blocks the grid cells under one tower's base
+    void stampCollision(const TowerPos& t, CollisionGrid& grid);
 };
\ No newline at end of file
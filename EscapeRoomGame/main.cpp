@@ -11,7 +11,10 @@
 // --- Standard libraries ---
 #include <iostream>
 #include <stdio.h> 
+#include <string.h>
 #include <string>  
+#include <vector>
+#include <algorithm>
 
 // --- Your Custom Game Modules ---
 #include "InsideWall.h"    
@@ -23,6 +26,30 @@
 #include "Cameras.h"
 #include "Labels.h"
 #include "TheRoom.h"
+#include "TextureStreamer.h"
+#include "FileWatcher.h"
+#include "LevelLayout.h"
+#include "LevelFile.h"
+#include "GpuMemory.h"
+#include "WorldCache.h"
+#include "Visibility.h"
+#include "CollisionWorld.h"
+#include "DistanceField.h"
+#include "Raycast.h"
+#include "FixedTimestep.h"
+#include "FramePacer.h"
+#include "InteractableIndex.h"
+#include "TriggerVolumes.h"
+#include "Pathfinder.h"
+#include "FlowField.h"
+#include "PathHierarchy.h"
+#include "LevelAnalyzer.h"
+#include "JobSystem.h"
+#include "Crowd.h"
+#include "RigidBodies.h"
+#include "HeightField.h"
+#include "FloorStack.h"
+#include "WorldChunks.h"
 
 
 //--- OpenGL Libraries ---
@@ -38,8 +65,14 @@
 int win_width = 1024;
 int win_height = 720;
 
-// Delta-time calculation
-int g_lastTime = 0;
+// Frame pacing (see FramePacer): rendered frames per second
+const int TARGET_FPS = 60;
+bool g_vsync = true;
+
+// Fixed rate simulation: physics runs in 1/120 s steps, rendering interpolates
+const int SIM_RATE = 120;
+const int SIM_MAX_STEPS = 8; // Per frame; longer stalls are dropped
+FixedTimestep g_simClock(SIM_RATE, SIM_MAX_STEPS);
 
 // Pointers to module objects
 Camera* g_camera = nullptr;
@@ -51,6 +84,19 @@ SecretBook* g_book = nullptr;
 SecretDoor* g_door = nullptr;
 RoomDecorations* g_decor = nullptr; // <-- NEW: Pointer for decorations
 
+// --- Floors ---
+// Every floor of the level has its own modules; the pointers above are
+// the ones of the floor the player is on (see switchFloor)
+struct FloorModules {
+	InsideWall* walls;
+	CornerTower* towers;
+	SecretBook* books;
+	SecretDoor* doors;
+	RoomDecorations* decor;
+	LevelLayout layout;    // This floor's objects, as last applied
+};
+std::vector<FloorModules> g_floorModules;
+
 // Game State
 bool g_flashlightOn = true;
 bool g_showAxes = false;
@@ -61,21 +107,83 @@ bool g_isEnteringPin = false;
 std::string g_currentPin = "";
 int g_interactingDoorIndex = -1;
 
-// HELPER: Map door index to its PIN
-std::string getPinForDoor(int index) {
-	if (index == 0) return "157";
-	if (index == 1) return "1134";
-	if (index == 2) return "1927";
-	if (index == 3) return "188";
-	if (index == 4) return "111";
-	return "000";
-}
+// --- Interaction Focus ---
+// Door and book under the crosshair, found once per simulation tick
+// and read by display() and keyboard() (-1 = none)
+int g_focusDoor = -1;
+int g_focusBook = -1;
+
+// Door and book trigger volumes the player is standing in (look-at rays
+// are only cast while there is at least one)
+int g_doorsInRange = 0;
+int g_booksInRange = 0;
+
+// --- Guide Me ---
+// Draws the way to the next unread note (or locked door) on the floor
+bool g_guideMode = false;
+std::vector<PathPoint> g_guidePath;
+FlowField g_guideField;                // Toward every current objective, repaired as doors change
+std::vector<PathPoint> g_guideGoals;   // Objectives g_guideField was built for
+float g_guideTimer = 0.0f;            // Seconds until the path is recomputed
+const float GUIDE_REFRESH = 0.25f;    // The player moves about a unit in that time
+const float GUIDE_DOOR_DISTANCE = 1.5f; // Stand this far in front of a door
+
+// --- Level Data & Hot Reload ---
+// The text file is the source; the game loads the compiled binary
+// (--level picks another source, compiled next to it as .lvl)
+const char* LEVEL_SOURCE_PATH = "levels/room.txt";
+const char* LEVEL_BINARY_PATH = "levels/room.lvl";
+std::string g_levelBinaryPath;
+const float TOWER_WIDTH = 1.5f;
+LevelLayout g_layout;      // Layout currently applied to the modules
+FileWatcher g_fileWatcher;
+
+// --- World Cache ---
+// Bump WORLD_CACHE_BUILD whenever the code that bakes meshes, stamps the
+// grid or computes visibility changes, so old caches are rebuilt.
+const char* WORLD_CACHE_PATH = "levels/room.cache";
+const uint32_t WORLD_CACHE_BUILD = 6;
+JobHandle g_cacheSave;     // Latest save job; each save waits for the one before
+
+// --- Distance Field ---
+// Clearance is only tracked this far (world units) from walls and objects
+const float DISTANCE_FIELD_RANGE = 4.0f;
+
+// --- Grid Repairs ---
+// Cells doors and crates changed since the derived grids were last
+// repaired; idle() repairs their bounding rect once per frame
+bool g_gridDirty = false;
+int g_dirtyX0 = 0, g_dirtyZ0 = 0, g_dirtyX1 = 0, g_dirtyZ1 = 0;
 
 // --- Function Declarations ---
 void display();
 void reshape(int w, int h);
-void init();
-void setupCollisionGrid();
+void init(const LevelLayout& level, const std::vector<unsigned char>& levelGrid, uint64_t levelKey);
+bool compileLevel(const char* sourcePath, const char* binaryPath);
+bool loadLevel(LevelLayout& outLayout, std::vector<unsigned char>& outGrid, uint64_t& outKey);
+bool configureLevelGrid(const LevelLayout& layout);
+void setupCollisionGrid(CollisionGrid& grid);
+void rebuildCollisionGrid(bool withCrates = true);
+void buildGridData();
+void repairGridData();
+void rebuildCollisionWorld();
+int getLookedAtDoor();
+int getLookedAtBook();
+void updateInteractionFocus();
+void onTriggerEvent(const TriggerEvent& e);
+void updateInteractionPrompt();
+bool findGuidePath();
+void updateGuide(float dt);
+void computeVisibility();
+void writeWorldCache(uint64_t levelKey, const std::vector<unsigned char>& levelGrid);
+void applyLayout(const LevelLayout& layout, bool force, const WorldCacheData* cache = nullptr);
+void resizeFloors(int count, const LevelLayout& level);
+void selectFloor(int floor);
+void switchFloor(int floor);
+void rebuildWorldChunks();
+void watchTextures();
+void setupHotReload();
+void simulationStep(float dt);
 void idle();
 void keyboard(unsigned char key, int x, int y);
 void keyboardUp(unsigned char key, int x, int y);
@@ -95,19 +203,153 @@ int main(int argc, char** argv) {
 	welcomeConsoleMessage();
 	printf("Starting Escape Room Game...\n");
 
+	// Offline level compiler: text source -> binary level, then exit (no window needed)
+	for (int i = 1; i + 2 < argc; ++i) {
+		if (strcmp(argv[i], "--compile-level") == 0) {
+			return compileLevel(argv[i + 1], argv[i + 2]) ? 0 : 1;
+		}
+	}
+
+	// Level to play instead of levels/room.txt
+	for (int i = 1; i + 1 < argc; ++i) {
+		if (strcmp(argv[i], "--level") == 0) {
+			LEVEL_SOURCE_PATH = argv[i + 1];
+			g_levelBinaryPath = LEVEL_SOURCE_PATH;
+			size_t dot = g_levelBinaryPath.find_last_of('.');
+			if (dot != std::string::npos && g_levelBinaryPath.find_first_of("/\\", dot) == std::string::npos) {
+				g_levelBinaryPath.erase(dot);
+			}
+			g_levelBinaryPath += ".lvl";
+			LEVEL_BINARY_PATH = g_levelBinaryPath.c_str();
+			printf("Level: '%s'\n", LEVEL_SOURCE_PATH);
+		}
+	}
+
+	// Pathfinder benchmark: random queries on a large generated grid, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-pathfinder") == 0) {
+			int size = (i + 1 < argc) ? atoi(argv[i + 1]) : 1000;
+			Pathfinder::runBenchmark(size > 0 ? size : 1000);
+			return 0;
+		}
+	}
+
+	// Rigid body benchmark: a room of crates bulldozed by a moving pusher, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-rigid-bodies") == 0) {
+			int count = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+			RigidBodyWorld::runBenchmark(count > 0 ? count : 300);
+			return 0;
+		}
+	}
+
+	// Crowd benchmark: thousands of agents stepped on one thread and on the job system, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-crowd") == 0) {
+			int count = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+			Crowd::runBenchmark(count > 0 ? count : 5000);
+			return 0;
+		}
+	}
+
+	// Level analyzer benchmark: solvability check of a large generated venue, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-level-analyzer") == 0) {
+			int size = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+			runLevelAnalyzerBenchmark(size > 0 ? size : 2000);
+			return 0;
+		}
+	}
+
+	// Path hierarchy benchmark: abstract and refined queries, door updates, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-path-hierarchy") == 0) {
+			int size = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+			PathHierarchy::runBenchmark(size > 0 ? size : 1000);
+			return 0;
+		}
+	}
+
+	// Flow field benchmark: full build vs repairs after doorway changes, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-flow-field") == 0) {
+			int size = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+			FlowField::runBenchmark(size > 0 ? size : 1000);
+			return 0;
+		}
+	}
+
+	// Distance field benchmark: full build vs local update, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-distance-field") == 0) {
+			int size = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+			DistanceField::runBenchmark(size > 0 ? size : 1000);
+			return 0;
+		}
+	}
+
+	// World chunk benchmark: cutting a large generated venue into chunks, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-world-chunks") == 0) {
+			int size = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+			WorldChunks::runBenchmark(size > 0 ? size : 512);
+			return 0;
+		}
+	}
+
+	// Job system benchmark: task graphs and parallel loops, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-job-system") == 0) {
+			int jobs = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+			JobSystem::runBenchmark(jobs > 0 ? jobs : 4096);
+			return 0;
+		}
+	}
+
+	// Frame pacer benchmark: the old polling idle loop vs the pacer, without a window, then exit
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark-frame-pacer") == 0) {
+			double workMs = (i + 1 < argc) ? atof(argv[i + 1]) : 0.0;
+			FramePacer::runBenchmark(workMs > 0.0 ? workMs : 2.0);
+			return 0;
+		}
+	}
+
 	// 1. Initialize GLUT
 	glutInit(&argc, argv);
 	glutInitDisplayMode(GLUT_DOUBLE | GLUT_DEPTH | GLUT_RGBA | GLUT_MULTISAMPLE);
 
+	// Command line options (after glutInit has removed its own)
+	g_framePacer.setTargetFps(TARGET_FPS);
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--texture-budget-mb") == 0 && i + 1 < argc) {
+			int mb = atoi(argv[++i]);
+			if (mb > 0) g_textureStreamer.setBudget((size_t)mb * 1024 * 1024);
+		}
+		if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+			g_framePacer.setTargetFps(atoi(argv[++i]));
+		}
+		if (strcmp(argv[i], "--no-vsync") == 0) {
+			g_vsync = false;
+		}
+	}
+	printf("Texture budget: %.0f MB\n", g_textureStreamer.getBudget() / (1024.0 * 1024.0));
+	printf("Frame rate target: %d fps\n", g_framePacer.getTargetFps());
+
+	// Load the level (compiling it first if the source changed)
+	LevelLayout level;
+	std::vector<unsigned char> levelGrid;
+	uint64_t levelKey = 0;
+	if (!loadLevel(level, levelGrid, levelKey)) {
+		printf("Error: could not load level '%s'.\n", LEVEL_SOURCE_PATH);
+		return 1;
+	}
+
 	// Create Module objects *after* glutInit
 	g_camera = new Camera(win_width, win_height);
 	g_labels = new Labels(win_width, win_height);
-	g_room = new TheRoom(GRID_SIZE, 5.0f, GRID_SIZE);
-	g_insideWalls = new InsideWall(5.0f);
-	g_tower = new CornerTower(5.0f, 1.5f);
-	g_book = new SecretBook();
-	g_door = new SecretDoor();
-	g_decor = new RoomDecorations(); // <-- NEW: Initialize Decorations
+	g_room = new TheRoom(level.roomWidth, level.roomHeight, level.roomDepth);
+	// Walls, towers, books, doors and decorations: one set per floor, created by applyLayout
 
 	// Center the window
 	int screen_width = glutGet(GLUT_SCREEN_WIDTH);
@@ -131,60 +373,870 @@ int main(int argc, char** argv) {
 
 	// Configure the Camera's starting state
 	g_camera->setGroundLevel(2.2f);
-	g_camera->setPosition(-18.0f, -18.0f);
+	g_camera->setPosition(level.spawnX, level.spawnZ);
 
 	// 3. Call one-time setup functions
-	init();
+	init(level, levelGrid, levelKey);
 	g_camera->init();
 
 	// 4. Start the Main Game Loop
-	g_lastTime = glutGet(GLUT_ELAPSED_TIME);
+	g_framePacer.setVSync(g_vsync);
+	g_simClock.reset(glutGet(GLUT_ELAPSED_TIME));
 	glutMainLoop();
 
 	// 5. Clean up memory
 	delete g_camera;
 	delete g_labels;
 	delete g_room;
-	delete g_insideWalls;
-	delete g_tower;
-	delete g_book;
-	delete g_door;
-	delete g_decor; // <-- NEW: Clean up
+	resizeFloors(0, g_layout); // <-- NEW: Clean up every floor
 	g_camera = nullptr;
 	g_labels = nullptr;
 	g_room = nullptr;
-	g_insideWalls = nullptr;
-	g_tower = nullptr;
-	g_book = nullptr;
-	g_door = nullptr;
-	g_decor = nullptr;
+	selectFloor(-1);
+	if (g_cacheSave) g_jobSystem.wait(g_cacheSave);
+	g_jobSystem.stop();
 
 	return 0;
 }
 
+// ================================================================
+// Configure Level Grid Function
+// Sizes the collision grid to cover the level's room at the level's
+// cell size. Returns true (grid cleared) if the grid had to change.
+// ================================================================
+bool configureLevelGrid(const LevelLayout& layout) {
+	int width = layout.getGridWidth();
+	int height = layout.getGridHeight();
+	if (width == g_collisionGrid.getWidth() && height == g_collisionGrid.getHeight() &&
+		layout.gridCellSize == g_collisionGrid.getCellSize() &&
+		layout.getGridOriginX() == g_collisionGrid.getOriginX() &&
+		layout.getGridOriginZ() == g_collisionGrid.getOriginZ()) {
+		return false;
+	}
+
+	if (!g_collisionGrid.configure(width, height, layout.gridCellSize, layout.getGridOriginX(), layout.getGridOriginZ())) {
+		printf("Warning: invalid collision grid %dx%d (cell %.2f), keeping the current grid.\n", width, height, layout.gridCellSize);
+		return false;
+	}
+	printf("Collision grid: %dx%d cells of %.2f units (%.1f KB)\n",
+		width, height, layout.gridCellSize, (double)g_collisionGrid.getWordsPerRow() * height * 8 / 1024.0);
+	return true;
+}
+
 // ================================================================
 // Setup Collision Grid Function
+// Blocks the boundary walls of 'grid' (the live grid or a scratch one).
 // ================================================================
-void setupCollisionGrid() {
+void setupCollisionGrid(CollisionGrid& grid) {
 	printf("Initializing collision grid...\n");
 
 	// Block the Boundary Walls
-	for (int i = 0; i < GRID_SEGMENTS; ++i) {
-		addBlockGridBox(0, i); // Left Wall (X=0)
-		addBlockGridBox(GRID_SEGMENTS - 1, i); // Right Wall (X=Max)
-		if (i > 0 && i < GRID_SEGMENTS - 1) { // Avoid double-blocking corners
-			addBlockGridBox(i, 0); // Back Wall (Z=0)
-			addBlockGridBox(i, GRID_SEGMENTS - 1); // Front Wall (Z=Max)
+	int maxX = grid.getWidth() - 1;
+	int maxZ = grid.getHeight() - 1;
+	grid.fillRect(0, 0, 0, maxZ, true); // Left Wall (X=0)
+	grid.fillRect(maxX, 0, maxX, maxZ, true); // Right Wall (X=Max)
+	grid.fillRect(0, 0, maxX, 0, true); // Back Wall (Z=0)
+	grid.fillRect(0, maxZ, maxX, maxZ, true); // Front Wall (Z=Max)
+	printf("Boundary walls marked as blocked.\n");
+}
+
+// ================================================================
+// Level Compiler
+// Turns the text level into the binary form. The collision grid is
+// produced by the real module code on a local scratch grid (the live
+// grid and its listeners are never touched), so the compiled grid
+// always matches what the game would have built itself.
+// Every compile (so every hot reload) also checks the level can be won.
+// The compiled grid is the ground floor's; the analyzer sees every floor.
+// ================================================================
+bool compileLevel(const char* sourcePath, const char* binaryPath) {
+	LevelLayout layout;
+	if (!loadLevelLayout(sourcePath, layout)) return false;
+
+	// Stairs of this layout (the live floors are left alone)
+	FloorStack floors;
+	floors.configure(layout.getFloorCount(), layout.roomHeight);
+	for (const auto& s : layout.stairs) floors.addStairs(s.floor, s.x0, s.z0, s.x1, s.z1, s.width);
+
+	// Stamp every floor with every door closed (no GL work needed), and copy
+	// it into one grid holding the floors one after the other along Z
+	std::vector<unsigned char> levelGrid;
+	CollisionGrid grid;
+	if (!grid.configure(layout.getGridWidth(), layout.getGridHeight(), layout.gridCellSize, layout.getGridOriginX(), layout.getGridOriginZ())) {
+		printf("Error: invalid collision grid %dx%d (cell %.2f) in '%s'.\n",
+			layout.getGridWidth(), layout.getGridHeight(), layout.gridCellSize, sourcePath);
+		return false;
+	}
+	int gridWidth = grid.getWidth();
+	int gridHeight = grid.getHeight();
+	int floorCount = floors.getFloorCount();
+	CollisionGrid stackedGrid(gridWidth, gridHeight * floorCount, grid.getCellSize(), grid.getOriginX(), grid.getOriginZ());
+	std::vector<std::vector<int>> gates(layout.doors.size());
+	for (int f = 0; f < floorCount; ++f) {
+		grid.fill(false);
+		setupCollisionGrid(grid);
+
+		InsideWall walls(layout.roomHeight);
+		for (const auto& w : layout.walls) {
+			if (w.floor == f) walls.addWall(w.startX, w.startZ, w.endX, w.endZ, w.thickness);
+		}
+		walls.applyCollision(grid);
+
+		CornerTower towers(layout.roomHeight, TOWER_WIDTH);
+		for (const auto& t : layout.towers) {
+			if (t.floor == f) towers.addTower(t.x, t.z);
+		}
+		towers.applyCollision(grid);
+
+		SecretDoor doors; // Leaves the shared indexes again when it goes out of scope
+		std::vector<int> doorIndex; // Layout index of each door added
+		for (size_t i = 0; i < layout.doors.size(); ++i) {
+			const LayoutDoor& d = layout.doors[i];
+			if (d.floor != f) continue;
+			doors.addDoor(d.x, d.z, d.direction, d.pin.c_str());
+			doorIndex.push_back((int)i);
+		}
+		doors.applyCollision(grid);
+
+		RoomDecorations decor;
+		for (const auto& d : layout.decorations) {
+			if (d.floor == f) decor.addDecoration(d.type, d.x, d.z, d.rotation);
+		}
+		decor.applyCollision(grid);
+		floors.applyCollision(f, grid);
+		if (f == 0) grid.saveBits(levelGrid);
+		for (int z = 0; z < gridHeight; ++z) {
+			for (int x = 0; x < gridWidth; ++x) stackedGrid.set(x, f * gridHeight + z, grid.get(x, z));
+		}
+
+		// Open the doors one by one: the cells each one frees are its gate
+		int floorOffset = f * gridHeight * gridWidth;
+		for (size_t k = 0; k < doorIndex.size(); ++k) {
+			const LayoutDoor& door = layout.doors[doorIndex[k]];
+			const float DOOR_REACH = 3.0f; // Doors are 4 units wide
+			int x0, z0, x1, z1;
+			grid.worldToCell(door.x - DOOR_REACH, door.z - DOOR_REACH, x0, z0);
+			grid.worldToCell(door.x + DOOR_REACH, door.z + DOOR_REACH, x1, z1);
+			std::vector<int> blocked;
+			for (int z = z0; z <= z1; ++z) {
+				for (int x = x0; x <= x1; ++x) {
+					if (grid.inBounds(x, z) && grid.get(x, z)) blocked.push_back(z * gridWidth + x);
+				}
+			}
+			doors.stampCollision((int)k, grid, false);
+			for (int c : blocked) {
+				if (!grid.get(c % gridWidth, c / gridWidth)) gates[doorIndex[k]].push_back(floorOffset + c);
+			}
 		}
 	}
-	printf("Boundary walls marked as blocked.\n");
+
+	// Stairs join the cells just off both ends (the analyzer puts each note on its floor)
+	std::vector<std::pair<int, int>> links;
+	for (int i = 0; i < floors.getStairsCount(); ++i) {
+		const FloorStairs& s = floors.getStairs(i);
+		float bottomX, bottomZ, topX, topZ;
+		floors.getLandings(i, grid.getCellSize(), bottomX, bottomZ, topX, topZ);
+		int bx, bz, tx, tz;
+		if (!grid.worldToCell(bottomX, bottomZ, bx, bz) || !grid.worldToCell(topX, topZ, tx, tz)) continue;
+		links.push_back(std::make_pair((s.floor * gridHeight + bz) * gridWidth + bx, ((s.floor + 1) * gridHeight + tz) * gridWidth + tx));
+	}
+
+	LevelReport report;
+	analyzeLevel(stackedGrid, layout, gates, report, &links);
+	printLevelReport(report);
+
+	return writeLevelFile(binaryPath, layout, levelGrid, gridWidth, gridHeight);
+}
+
+// ================================================================
+// Level Loader
+// Recompiles the binary level if the text source is newer, then
+// loads it in one read. outKey identifies the level for the world cache.
+// ================================================================
+bool loadLevel(LevelLayout& outLayout, std::vector<unsigned char>& outGrid, uint64_t& outKey) {
+	long long sourceTime = getFileModifiedTime(LEVEL_SOURCE_PATH);
+	long long binaryTime = getFileModifiedTime(LEVEL_BINARY_PATH);
+	if (sourceTime >= 0 && sourceTime > binaryTime) {
+		printf("Level source changed, compiling '%s'...\n", LEVEL_SOURCE_PATH);
+		compileLevel(LEVEL_SOURCE_PATH, LEVEL_BINARY_PATH);
+	}
+
+	LevelFile file;
+	if (!file.open(LEVEL_BINARY_PATH)) {
+		// Missing or written by an older build: compile once more
+		if (!compileLevel(LEVEL_SOURCE_PATH, LEVEL_BINARY_PATH) || !file.open(LEVEL_BINARY_PATH)) return false;
+	}
+
+	file.toLayout(outLayout);
+	outKey = hashBytes(&WORLD_CACHE_BUILD, sizeof(WORLD_CACHE_BUILD), file.contentHash());
+
+	const LevelFileHeader& h = file.header();
+	outGrid.clear();
+	if (file.grid() && h.gridWidth == outLayout.getGridWidth() && h.gridHeight == outLayout.getGridHeight()) {
+		outGrid.assign(file.grid(), file.grid() + h.gridSize);
+	}
+	printf("Level '%s' loaded (%u bytes).\n", LEVEL_BINARY_PATH, h.fileSize);
+	return true;
+}
+
+// ================================================================
+// Rebuild Collision Grid Function
+// Clears the grid and lets every module of the current floor (and its
+// stairs) block their cells again, then
+// recomputes the distance field and path grids from it (the guide's
+// flow field is rebuilt the next time it is needed).
+// No GL work, but the cost grows with the grid and is mostly the path
+// hierarchy build: about 0.35 ms for the shipped 40x40 room, 27 ms at
+// 250x250 and 450 ms at 1000x1000 (-O2, generated venues), so a
+// layout reload of a large venue stalls for a frame or more.
+// ================================================================
+void rebuildCollisionGrid(bool withCrates) {
+	g_collisionGrid.setNotifyEnabled(false); // Everything is rebuilt below
+	clearCollisionGrid();
+	setupCollisionGrid(g_collisionGrid);
+	if (g_insideWalls) g_insideWalls->applyCollision(g_collisionGrid);
+	if (g_tower) g_tower->applyCollision(g_collisionGrid);
+	if (g_door) g_door->applyCollision(g_collisionGrid);
+	if (g_decor) g_decor->applyCollision(g_collisionGrid);
+	g_floors.applyCollision(g_floors.getCurrent(), g_collisionGrid);
+	if (withCrates) g_rigidBodies.applyCollision(g_collisionGrid);
+	g_collisionGrid.setNotifyEnabled(true);
+	buildGridData();
+	g_guideField.clear();
+}
+
+// ================================================================
+// Build Grid Data Function
+// The distance field, pathfinder and path hierarchy only read the
+// collision grid, so they are built side by side on the job system.
+// ================================================================
+void buildGridData() {
+	std::vector<JobHandle> builds;
+	builds.push_back(g_jobSystem.run("distance field build", [] { g_distanceField.build(g_collisionGrid, DISTANCE_FIELD_RANGE); }));
+	builds.push_back(g_jobSystem.run("pathfinder build", [] { g_pathfinder.build(g_collisionGrid); }));
+	builds.push_back(g_jobSystem.run("path hierarchy build", [] { g_pathHierarchy.build(g_collisionGrid); }));
+	g_jobSystem.wait(builds);
+	g_gridDirty = false; // Nothing left to repair
+}
+
+// ================================================================
+// Collision Grid Changes
+// Doors opening and closing and crates moving report the cells they
+// changed; they are only collected here (a crate reports every cell it
+// crosses) and repaired once per frame by repairGridData().
+// ================================================================
+void onCollisionGridChanged(int x0, int z0, int x1, int z1) {
+	if (!g_gridDirty) {
+		g_dirtyX0 = x0; g_dirtyZ0 = z0; g_dirtyX1 = x1; g_dirtyZ1 = z1;
+		g_gridDirty = true;
+		return;
+	}
+	g_dirtyX0 = std::min(g_dirtyX0, x0);
+	g_dirtyZ0 = std::min(g_dirtyZ0, z0);
+	g_dirtyX1 = std::max(g_dirtyX1, x1);
+	g_dirtyZ1 = std::max(g_dirtyZ1, z1);
+}
+
+// ================================================================
+// Repair Grid Data Function
+// The derived grids repair the cells changed since the last frame side
+// by side on the job system, while the chunk tiles are refreshed here.
+// The guide's flow field is only kept up to date while the guide is on;
+// otherwise it is dropped and rebuilt when the guide is next needed.
+// ================================================================
+void repairGridData() {
+	if (!g_gridDirty) return;
+	g_gridDirty = false;
+	int x0 = g_dirtyX0, z0 = g_dirtyZ0, x1 = g_dirtyX1, z1 = g_dirtyZ1;
+
+	std::vector<JobHandle> repairs;
+	repairs.push_back(g_jobSystem.run("distance field repair", [=] { g_distanceField.update(g_collisionGrid, x0, z0, x1, z1); }));
+	repairs.push_back(g_jobSystem.run("pathfinder repair", [=] { g_pathfinder.update(g_collisionGrid, x0, z0, x1, z1); }));
+	repairs.push_back(g_jobSystem.run("path hierarchy repair", [=] { g_pathHierarchy.update(g_collisionGrid, x0, z0, x1, z1); }));
+	if (g_guideMode) {
+		repairs.push_back(g_jobSystem.run("guide field repair", [=] { g_guideField.update(g_collisionGrid, x0, z0, x1, z1); }));
+	}
+	else {
+		g_guideField.clear();
+	}
+	g_worldChunks.refreshTiles(x0, z0, x1, z1);
+	g_jobSystem.wait(repairs);
+}
+
+// ================================================================
+// Rebuild Collision World Function
+// Collects the exact boxes of every object (plus the four room walls)
+// into the swept collision hierarchy used for movement, and the height
+// field of their tops.
+// ================================================================
+void rebuildCollisionWorld() {
+	g_collisionWorld.clear();
+
+	// Room walls: one unit thick, just outside the room
+	float halfW = g_layout.roomWidth / 2.0f;
+	float halfD = g_layout.roomDepth / 2.0f;
+	FootprintBox sideWall = { 0.5f, halfD + 1.0f, 0.0f, 0.0f };
+	FootprintBox endWall = { halfW + 1.0f, 0.5f, 0.0f, 0.0f };
+	g_collisionWorld.addBox(-halfW - 0.5f, 0.0f, 0.0f, sideWall, COLLIDER_BOUNDARY);
+	g_collisionWorld.addBox(halfW + 0.5f, 0.0f, 0.0f, sideWall, COLLIDER_BOUNDARY);
+	g_collisionWorld.addBox(0.0f, -halfD - 0.5f, 0.0f, endWall, COLLIDER_BOUNDARY);
+	g_collisionWorld.addBox(0.0f, halfD + 0.5f, 0.0f, endWall, COLLIDER_BOUNDARY);
+
+	if (g_insideWalls) g_insideWalls->addColliders();
+	if (g_tower) g_tower->addColliders();
+	if (g_door) g_door->addColliders();
+	if (g_decor) g_decor->addColliders();
+
+	g_collisionWorld.build();
+
+	// Floor heights come from the same boxes (what the player can stand on)
+	g_heightField.build(g_collisionWorld, g_collisionGrid);
+}
+
+// ================================================================
+// Look-At Helpers
+// The door or book under the crosshair (camera ray), within reach
+// and not behind a wall. -1 if there is none. Objects are placed on
+// their floor, so the eye height is taken from the current floor.
+// ================================================================
+int getLookedAtDoor() {
+	if (!g_door || !g_camera) return -1;
+	float eyeY = g_camera->getY() - g_floors.getBaseY(g_floors.getCurrent());
+	return g_door->getLookedAtDoorIndex(g_camera->getX(), eyeY, g_camera->getZ(),
+		g_camera->getForwardX(), g_camera->getForwardY(), g_camera->getForwardZ(), g_layout.roomHeight);
+}
+
+int getLookedAtBook() {
+	if (!g_book || !g_camera) return -1;
+	float eyeY = g_camera->getY() - g_floors.getBaseY(g_floors.getCurrent());
+	return g_book->getLookedAtBookIndex(g_camera->getX(), eyeY, g_camera->getZ(),
+		g_camera->getForwardX(), g_camera->getForwardY(), g_camera->getForwardZ(), g_layout.roomHeight);
+}
+
+void updateInteractionFocus() {
+	g_focusDoor = g_doorsInRange > 0 ? getLookedAtDoor() : -1;
+	g_focusBook = g_booksInRange > 0 ? getLookedAtBook() : -1;
+}
+
+// ================================================================
+// Trigger Events
+// Books and doors add a trigger volume of their interaction range.
+// ================================================================
+void onTriggerEvent(const TriggerEvent& e) {
+	if (e.type == TRIGGER_STAY) return;
+	int change = (e.type == TRIGGER_ENTER) ? 1 : -1;
+
+	if (e.tag == INTERACT_DOOR) {
+		g_doorsInRange += change;
+
+		// Walking away from the door cancels its PIN entry
+		if (e.type == TRIGGER_EXIT && g_isEnteringPin && e.index == g_interactingDoorIndex) {
+			g_isEnteringPin = false;
+			g_currentPin = "";
+			g_interactingDoorIndex = -1;
+			printf("PIN Entry Cancelled.\n");
+		}
+	}
+	else if (e.tag == INTERACT_BOOK) {
+		g_booksInRange += change;
+	}
+}
+
+// ================================================================
+// Interaction Prompt
+// Picks the message or hint for what the player is focusing on and
+// hands it to the labels, once per tick instead of every frame.
+// ================================================================
+void updateInteractionPrompt() {
+	if (!g_labels) return;
+	const char* message = "";
+	const char* hint = "";
+
+	if (g_door && g_isEnteringPin && g_interactingDoorIndex != -1 && !g_door->isDoorOpen(g_interactingDoorIndex)) {
+		// Keep showing the PIN prompt while entering it, wherever the player looks
+		// UPDATED MESSAGE: Two lines for better visibility
+		message = "Enter PIN to Unlock.\n(Press 'Esc' or 'E' to Cancel)";
+	}
+	else if (!g_isEnteringPin) {
+		if (g_book && g_focusBook != -1) {
+			if (g_book->isBookOpen(g_focusBook)) message = g_book->getBookMessage(g_focusBook);
+			else hint = "Press 'E' to Read";
+		}
+		if (g_door && g_focusDoor != -1 && !g_door->isDoorOpen(g_focusDoor)) {
+			hint = "Press 'E' to Unlock";
+		}
+	}
+
+	g_labels->setCenterMessage(message);
+	g_labels->setActionHint(hint);
+}
+
+// ================================================================
+// Guide Me
+// Route to the nearest note not read yet; once every note is read,
+// to the nearest locked door (either side). "Nearest" is by walking
+// distance: the route follows a flow field toward all the objectives,
+// which is only rebuilt when they change and is repaired when doors
+// open or close.
+// ================================================================
+void collectGuideGoals(std::vector<PathPoint>& goals) {
+	goals.clear();
+	for (int i = 0; g_book && i < g_book->getBookCount(); ++i) {
+		if (g_book->isBookRead(i)) continue;
+		PathPoint p = { 0.0f, 0.0f };
+		g_book->getBookPosition(i, p.x, p.z);
+		goals.push_back(p);
+	}
+	if (!goals.empty()) return;
+
+	for (int i = 0; g_door && i < g_door->getDoorCount(); ++i) {
+		if (g_door->isDoorOpen(i)) continue;
+		float x = 0.0f, z = 0.0f;
+		int direction = 1;
+		g_door->getDoorPosition(i, x, z, direction);
+
+		// Doors parallel to X face along Z and the other way around
+		float nx = (direction == 2) ? 1.0f : 0.0f;
+		float nz = (direction == 2) ? 0.0f : 1.0f;
+		for (int side = -1; side <= 1; side += 2) {
+			PathPoint p = { x + nx * side * GUIDE_DOOR_DISTANCE, z + nz * side * GUIDE_DOOR_DISTANCE };
+			goals.push_back(p);
+		}
+	}
+}
+
+bool findGuidePath() {
+	g_guidePath.clear();
+	if (!g_camera || !g_pathfinder.isReady()) return false;
+
+	std::vector<PathPoint> goals;
+	collectGuideGoals(goals);
+	bool changed = !g_guideField.isReady() || goals.size() != g_guideGoals.size();
+	for (size_t i = 0; !changed && i < goals.size(); ++i) {
+		changed = goals[i].x != g_guideGoals[i].x || goals[i].z != g_guideGoals[i].z;
+	}
+	if (changed) {
+		g_guideField.build(g_collisionGrid, goals);
+		g_guideGoals = goals;
+	}
+	return g_guideField.tracePath(g_camera->getX(), g_camera->getZ(), g_guidePath, &g_pathfinder);
+}
+
+void updateGuide(float dt) {
+	if (!g_guideMode) return;
+	g_guideTimer -= dt;
+	if (g_guideTimer > 0.0f) return;
+	g_guideTimer = GUIDE_REFRESH;
+	findGuidePath();
+}
+
+// ================================================================
+// Compute Visibility Function
+// Walls and towers are the only occluders, so they are stamped on a
+// local grid of the same size (the live collision grid is not touched).
+// ================================================================
+void computeVisibility() {
+	CollisionGrid occluderGrid(g_collisionGrid.getWidth(), g_collisionGrid.getHeight(), g_collisionGrid.getCellSize(),
+		g_collisionGrid.getOriginX(), g_collisionGrid.getOriginZ());
+	if (g_insideWalls) g_insideWalls->applyCollision(occluderGrid);
+	if (g_tower) g_tower->applyCollision(occluderGrid);
+
+	std::vector<unsigned char> occluders;
+	occluderGrid.saveBits(occluders);
+	g_visibility.compute(occluders.data(), occluderGrid.getWidth(), occluderGrid.getHeight());
+}
+
+// ================================================================
+// Write World Cache Function
+// Saves what the modules generated for this level so the next launch
+// can load it instead (see init()). The level starts on the ground
+// floor, so that is the floor cached (and the only time to write it).
+// ================================================================
+void writeWorldCache(uint64_t levelKey, const std::vector<unsigned char>& levelGrid) {
+	if (!g_room || !g_insideWalls || !g_tower) return;
+	if (g_floors.getCurrent() != 0) return;
+
+	WorldCacheData cache;
+	cache.grid = levelGrid;
+	if (cache.grid.empty()) saveCollisionGrid(cache.grid);
+	cache.gridWidth = g_collisionGrid.getWidth();
+	cache.gridHeight = g_collisionGrid.getHeight();
+
+	cache.meshes[CACHE_MESH_ROOM] = g_room->getMesh();
+	cache.meshes[CACHE_MESH_WALLS] = g_insideWalls->getMesh();
+	cache.meshes[CACHE_MESH_TOWERS] = g_tower->getMesh();
+
+	cache.visibility = g_visibility.getBits();
+	cache.visBlocksX = g_visibility.getBlocksX();
+	cache.visBlocksZ = g_visibility.getBlocksZ();
+
+	// Writing the file does not hold up the first frame. Saves truncate
+	// the same file, so each one runs after the previous has finished
+	std::shared_ptr<WorldCacheData> data = std::make_shared<WorldCacheData>(std::move(cache));
+	JobFunction save = [data, levelKey] { saveWorldCache(WORLD_CACHE_PATH, levelKey, *data); };
+	g_cacheSave = g_cacheSave ? g_jobSystem.then(g_cacheSave, "world cache save", save) : g_jobSystem.run("world cache save", save);
+}
+
+// ================================================================
+// Rebuild World Chunks Function
+// Hands the current floor's static geometry (room storey, walls and
+// towers) and objects to the chunk streamer, which cuts it into chunks
+// around the camera from then on. Called whenever that geometry or the
+// floor changes.
+// ================================================================
+void rebuildWorldChunks() {
+	if (!g_room || !g_insideWalls || !g_tower) return;
+	int floor = g_floors.getCurrent();
+	std::shared_ptr<ChunkSource> source = std::make_shared<ChunkSource>();
+
+	source->meshes.resize(3);
+	source->meshes[0].label = "room";
+	source->meshes[0].mesh = g_room->getMesh(floor);
+	source->meshes[0].textures.resize(ROOM_TEXTURE_SLOTS);
+	g_room->getTextures(source->meshes[0].textures.data());
+	source->meshes[1].label = "walls";
+	source->meshes[1].mesh = g_insideWalls->getMesh();
+	source->meshes[1].textures.assign(1, g_room->getWallTextureID());
+	source->meshes[2].label = "towers";
+	source->meshes[2].mesh = g_tower->getMesh();
+	source->meshes[2].textures.assign(1, g_room->getWallTextureID());
+
+	const LevelLayout& layout = g_floorModules[floor].layout;
+	for (size_t i = 0; i < layout.books.size(); ++i) {
+		source->objects.push_back({ CHUNK_OBJECT_BOOK, (int)i, layout.books[i].x, layout.books[i].z });
+	}
+	for (size_t i = 0; i < layout.doors.size(); ++i) {
+		source->objects.push_back({ CHUNK_OBJECT_DOOR, (int)i, layout.doors[i].x, layout.doors[i].z });
+	}
+	for (size_t i = 0; i < layout.decorations.size(); ++i) {
+		source->objects.push_back({ CHUNK_OBJECT_DECORATION, (int)i, layout.decorations[i].x, layout.decorations[i].z });
+	}
+
+	g_worldChunks.setSource(source, &g_collisionGrid);
+}
+
+// ================================================================
+// Floor Modules
+// resizeFloors creates (with the level's textures) or deletes the
+// modules of each floor; loadFloorTextures (re)loads one set's textures.
+// selectFloor points the module pointers at one floor's set.
+// setFloorActive switches a floor's triggers and crates.
+// ================================================================
+void loadFloorTextures(FloorModules& m, const LevelLayout& level) {
+	// --- Load Textures (paths come from the level's texture slots) ---
+	m.books->loadTextures(
+		level.getTexture("book.wood"),
+		level.getTexture("book.cover"),
+		level.getTexture("book.pages")
+	);
+	m.doors->loadTextures(
+		level.getTexture("door.frame"),  // Frame
+		level.getTexture("door.panel"),  // Panels
+		level.getTexture("door.detail")  // Details (Metal/Wicker)
+	);
+	m.decor->loadTextures(level.getTexture("decor.wood"), level.getTexture("decor.metal"));
+}
+
+void resizeFloors(int count, const LevelLayout& level) {
+	while ((int)g_floorModules.size() > count) {
+		FloorModules& m = g_floorModules.back();
+		delete m.walls;
+		delete m.towers;
+		delete m.books;
+		delete m.doors;
+		delete m.decor;
+		g_floorModules.pop_back();
+	}
+
+	while ((int)g_floorModules.size() < count) {
+		FloorModules m;
+		m.walls = new InsideWall(level.roomHeight);
+		m.towers = new CornerTower(level.roomHeight, TOWER_WIDTH);
+		m.books = new SecretBook();
+		m.doors = new SecretDoor();
+		m.decor = new RoomDecorations();
+		loadFloorTextures(m, level);
+		g_floorModules.push_back(m);
+	}
+}
+
+void selectFloor(int floor) {
+	FloorModules* m = (floor >= 0 && floor < (int)g_floorModules.size()) ? &g_floorModules[floor] : nullptr;
+	g_insideWalls = m ? m->walls : nullptr;
+	g_tower = m ? m->towers : nullptr;
+	g_book = m ? m->books : nullptr;
+	g_door = m ? m->doors : nullptr;
+	g_decor = m ? m->decor : nullptr;
+}
+
+void setFloorActive(int floor, bool active) {
+	const FloorModules& m = g_floorModules[floor];
+	g_triggers.setOwnerEnabled(m.books, active);
+	g_triggers.setOwnerEnabled(m.doors, active);
+	g_rigidBodies.setOwnerEnabled(m.decor, active);
+}
+
+void populateCrowd(const std::vector<LayoutNpc>& npcs) {
+	g_crowd.clear();
+	for (const auto& n : npcs) {
+		g_crowd.addAgent(n.role, n.x, n.z, n.patrolX, n.patrolZ);
+	}
+}
+
+// ================================================================
+// Switch Floor Function
+// The player took the stairs. Only the floor the player is on is
+// simulated: its triggers and crates are switched on (the others off),
+// and its grid, colliders, height field, visibility and ambient
+// characters are rebuilt. A floor is a 40x40 grid and a few dozen
+// boxes, so this fits between two simulation steps.
+// ================================================================
+void switchFloor(int floor) {
+	if (floor < 0 || floor >= (int)g_floorModules.size()) return;
+	g_floors.setCurrent(floor);
+	selectFloor(floor);
+	for (int f = 0; f < (int)g_floorModules.size(); ++f) setFloorActive(f, f == floor);
+
+	// Interaction state belonged to the floor left behind
+	g_isEnteringPin = false;
+	g_currentPin = "";
+	g_interactingDoorIndex = -1;
+	g_focusDoor = -1;
+	g_focusBook = -1;
+	g_guidePath.clear();
+
+	populateCrowd(g_floorModules[floor].layout.npcs);
+	rebuildCollisionWorld();
+	rebuildCollisionGrid();
+	computeVisibility();
+	rebuildWorldChunks();
+	printf("Floor %d\n", floor);
+}
+
+// ================================================================
+// Apply Floor Layout Function
+// Pushes one floor's part of the layout into that floor's modules
+// (selected by the caller). Sections equal to the ones already applied
+// are skipped unless 'force' is set. 'shellChanged' (new room height or
+// textures) rebuilds every module but leaves the characters alone.
+// Ambient characters only exist on the current floor.
+// ================================================================
+void applyFloorLayout(FloorModules& floor, const LevelLayout& layout, bool force, bool shellChanged, bool current,
+	const WorldCacheData* cache, bool& collisionChanged, bool& occludersChanged) {
+	const LevelLayout& applied = floor.layout;
+	bool rebuild = force || shellChanged;
+
+	// --- Inside Walls ---
+	if (g_insideWalls && g_room && (rebuild || !(layout.walls == applied.walls))) {
+		g_insideWalls->clear();
+		for (const auto& w : layout.walls) {
+			g_insideWalls->addWall(w.startX, w.startZ, w.endX, w.endZ, w.thickness);
+		}
+		g_insideWalls->build(g_room->getWallTextureID(), cache ? &cache->meshes[CACHE_MESH_WALLS] : nullptr);
+		collisionChanged = true;
+		occludersChanged = true;
+	}
+
+	// --- Corner Towers ---
+	if (g_tower && g_room && (rebuild || !(layout.towers == applied.towers))) {
+		g_tower->clear();
+		for (const auto& t : layout.towers) {
+			g_tower->addTower(t.x, t.z);
+		}
+		g_tower->build(g_room->getWallTextureID(), cache ? &cache->meshes[CACHE_MESH_TOWERS] : nullptr);
+		collisionChanged = true;
+		occludersChanged = true;
+	}
+
+	// --- Secret Books ---
+	if (g_book && (rebuild || !(layout.books == applied.books))) {
+		g_book->clear();
+		for (const auto& b : layout.books) {
+			g_book->addBook(b.x, b.z, b.message.c_str());
+		}
+		if (current) g_focusBook = -1;
+	}
+
+	// --- Secret Doors ---
+	if (g_door && (rebuild || !(layout.doors == applied.doors))) {
+		// Doors that were already unlocked stay open if they did not move
+		std::vector<bool> wasOpen(layout.doors.size(), false);
+		for (size_t i = 0; i < layout.doors.size() && i < applied.doors.size(); ++i) {
+			wasOpen[i] = g_door->isDoorOpen((int)i) &&
+				layout.doors[i].x == applied.doors[i].x && layout.doors[i].z == applied.doors[i].z;
+		}
+
+		g_door->clear();
+		for (size_t i = 0; i < layout.doors.size(); ++i) {
+			const LayoutDoor& d = layout.doors[i];
+			g_door->addDoor(d.x, d.z, d.direction, d.pin.c_str());
+			if (wasOpen[i]) g_door->tryUnlock((int)i, d.pin.c_str());
+		}
+		collisionChanged = true;
+
+		// The door being unlocked may no longer exist
+		if (current) {
+			g_isEnteringPin = false;
+			g_currentPin = "";
+			g_interactingDoorIndex = -1;
+			g_focusDoor = -1;
+		}
+	}
+
+	// --- Room Decorations ---
+	if (g_decor && (rebuild || !(layout.decorations == applied.decorations))) {
+		g_decor->clear();
+		for (const auto& d : layout.decorations) {
+			g_decor->addDecoration(d.type, d.x, d.z, d.rotation);
+		}
+		collisionChanged = true;
+	}
+
+	// --- Ambient Characters (back at their posts after a change) ---
+	if (current && (force || !(layout.npcs == applied.npcs))) {
+		populateCrowd(layout.npcs);
+	}
+
+	floor.layout = layout;
+}
+
+// ================================================================
+// Apply Level Layout Function
+// Pushes a layout into the modules of every floor. Sections equal to
+// the layout already applied are skipped unless 'force' is set, so a
+// reload only rebuilds the modules whose objects changed; a new room
+// size or texture slot rebuilds the shell and every floor's modules
+// (open doors stay open), and a new spawn point moves the player there. With a cache
+// the ground floor's room, wall and tower geometry is taken from it
+// instead of being generated. Only the current floor's grid, colliders
+// and visibility are rebuilt (the others are when the player gets there).
+// ================================================================
+void applyLayout(const LevelLayout& layout, bool force, const WorldCacheData* cache) {
+	bool collisionChanged = false;
+	bool occludersChanged = false;
+
+	// --- Floors and Stairs ---
+	int floorCount = layout.getFloorCount();
+	int oldCount = (int)g_floorModules.size();
+	bool floorLost = g_floors.getCurrent() >= floorCount;
+	bool stairsChanged = force || floorCount != oldCount || !(layout.stairs == g_layout.stairs);
+	bool roomResized = !force && (layout.roomWidth != g_layout.roomWidth ||
+		layout.roomHeight != g_layout.roomHeight || layout.roomDepth != g_layout.roomDepth);
+	bool texturesChanged = !force && !(layout.textures == g_layout.textures);
+	bool shellChanged = roomResized || texturesChanged;
+	bool spawnMoved = !force && (layout.spawnX != g_layout.spawnX || layout.spawnZ != g_layout.spawnZ);
+	resizeFloors(floorCount, layout);
+	g_floors.configure(floorCount, layout.roomHeight);
+	for (const auto& s : layout.stairs) {
+		g_floors.addStairs(s.floor, s.x0, s.z0, s.x1, s.z1, s.width);
+	}
+
+	// --- Room Shell (a storey per floor, open where stairs go up) ---
+	if (g_room && shellChanged) {
+		g_room->setSize(layout.roomWidth, layout.roomHeight, layout.roomDepth);
+		g_room->loadTextures(
+			layout.getTexture("room.floor"),
+			layout.getTexture("room.wall"),
+			layout.getTexture("room.ceiling")
+		);
+	}
+	if (g_room && (stairsChanged || shellChanged)) {
+		g_room->setFloors(g_floors);
+		g_room->build(cache ? &cache->meshes[CACHE_MESH_ROOM] : nullptr);
+		collisionChanged = true; // Stairs are stamped in the grid
+	}
+
+	// --- Objects, floor by floor (new floors have nothing to compare with) ---
+	for (int f = 0; f < floorCount; ++f) {
+		bool current = (f == g_floors.getCurrent());
+		bool floorCollision = false, floorOccluders = false;
+		bool newFloor = f >= oldCount; // Created with this layout's height and textures
+		if (shellChanged && !newFloor) {
+			FloorModules& m = g_floorModules[f];
+			m.walls->setHeight(layout.roomHeight);
+			m.towers->setHeight(layout.roomHeight);
+			loadFloorTextures(m, layout);
+		}
+		selectFloor(f);
+		applyFloorLayout(g_floorModules[f], layout.onFloor(f), force || newFloor, shellChanged, current,
+			f == 0 ? cache : nullptr, floorCollision, floorOccluders);
+		if (current) {
+			collisionChanged = collisionChanged || floorCollision;
+			occludersChanged = occludersChanged || floorOccluders;
+		}
+	}
+	selectFloor(g_floors.getCurrent());
+	g_layout = layout;
+
+	// Rebuilt modules added their triggers and crates switched on
+	for (int f = 0; f < floorCount; ++f) setFloorActive(f, f == g_floors.getCurrent());
+
+	// The player's floor is gone (or the spawn point moved): back to the ground floor
+	if (spawnMoved) g_camera->setPosition(layout.spawnX, layout.spawnZ);
+	if ((floorLost || (spawnMoved && g_floors.getCurrent() != 0)) && !force) {
+		switchFloor(0);
+		return;
+	}
+
+	// The box hierarchy is rebuilt from scratch, it only takes microseconds
+	if (collisionChanged) rebuildCollisionWorld();
+
+	// Removed objects leave stale blocked cells behind, so re-stamp everything.
+	// (On the first load the compiled grid is used instead.)
+	if (collisionChanged && !force) rebuildCollisionGrid();
+	if (occludersChanged && !force) computeVisibility();
+	rebuildWorldChunks();
+}
+
+// ================================================================
+// Setup Hot Reload Function
+// Watches the level source and every streamed texture. Callbacks run
+// from idle(), between two frames. A reload costs one read of the level
+// plus work linear in its objects (toLayout, applyLayout's section
+// compares); only the sections that changed are rebuilt.
+// ================================================================
+void watchTextures() {
+	// Texture IDs never change, so only the changed texture is re-uploaded.
+	// Paths already watched are skipped, so this is called again after a
+	// level reload to pick up the textures of new slots.
+	for (int i = 0; i < g_textureStreamer.getTextureCount(); ++i) {
+		g_fileWatcher.watch(g_textureStreamer.getTexture(i)->path.c_str(), [](const char* path) {
+			g_textureStreamer.reload(path);
+		});
+	}
+}
+
+void setupHotReload() {
+	g_fileWatcher.watch(LEVEL_SOURCE_PATH, [](const char* path) {
+		LevelLayout layout;
+		std::vector<unsigned char> grid;
+		uint64_t key = 0;
+		if (compileLevel(path, LEVEL_BINARY_PATH) && loadLevel(layout, grid, key)) {
+			// The compiled grid assumes closed doors, so the live grid is re-stamped instead
+			bool gridChanged = configureLevelGrid(layout);
+			applyLayout(layout, false);
+			if (gridChanged) {
+				rebuildCollisionGrid();
+				computeVisibility();
+				g_heightField.build(g_collisionWorld, g_collisionGrid);
+			}
+			writeWorldCache(key, grid);
+			watchTextures();
+			printf("Hot reload: level '%s' applied.\n", path);
+		}
+		else {
+			printf("Hot reload: keeping the previous level.\n");
+		}
+	});
+
+	watchTextures();
 }
 
 
 // ================================================================
 // Initialize OpenGL Function
 // =================================================================
-void init() {
+void init(const LevelLayout& level, const std::vector<unsigned char>& levelGrid, uint64_t levelKey) {
 	glClearColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark grey background
 	glEnable(GL_DEPTH_TEST);
 
@@ -227,140 +1279,63 @@ void init() {
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS_EXT, -0.5f);
 	glColor3f(1.0f, 1.0f, 1.0f);
 
-	// --- Load Room Textures ---
-	if (g_room) {
-		g_room->loadTextures(
-			"textures/floor.dds",
-			"textures/wall.dds",
-			"textures/ceiling.dds"
-		);
-		g_room->build();
-	}
+	// --- Worker threads: texture decodes, chunk cuts, builds and updates ---
+	g_jobSystem.start();
+	g_crowd.setJobSystem(&g_jobSystem);
+	g_crowd.setPathHierarchy(&g_pathHierarchy);
 
-	// --- Load Secret Book Textures ---
-	if (g_book) {
-		g_book->loadTextures(
-			"textures/wood.dds",
-			"textures/book_cover.dds",
-			"textures/book_pages.dds"
-		);
-	}
+	// --- World Cache (warm start) ---
+	// Holds the grid, baked geometry and visibility for this exact level
+	WorldCacheData cache;
+	bool warm = loadWorldCache(WORLD_CACHE_PATH, levelKey, cache);
 
-	// --- Load Secret Door Textures ---
-	if (g_door) {
-		g_door->loadTextures(
-			"textures/wall.dds", // Frame
-			"textures/wood.dds", // Panels
-			"textures/floor.dds" // Details (Metal/Wicker)
+	// --- Load Textures (paths come from the level's texture slots) ---
+	// The room is built by applyLayout once the floors are known; the
+	// modules of each floor load theirs as they are created
+	if (g_room) {
+		g_room->loadTextures(
+			level.getTexture("room.floor"),
+			level.getTexture("room.wall"),
+			level.getTexture("room.ceiling")
 		);
 	}
 
-	// --- Load Decoration Textures ---
-	if (g_decor) {
-		g_decor->loadTextures("textures/wood.dds", "textures/wall.dds"); // Using existing textures for now
-	}
-
-	// --- Setup Inside Walls (Your Layout) ---
-	if (g_insideWalls && g_room) {
-		g_insideWalls->addWall(-20.0f, -16.0f, 16.0f, -16.0f, 0.5f);
-		g_insideWalls->addWall(-16.0f, 0.0f, 16.0f, 0.0f, 0.5f);
-		g_insideWalls->addWall(-16.0f, 16.0f, 20.0f, 16.0f, 0.5f);
-		g_insideWalls->addWall(-16.0f, 0.0f, -16.0f, 16.0f, 0.5f);
-		g_insideWalls->addWall(0.0f, 0.0f, 0.0f, -12.0f, 0.5f);
-		g_insideWalls->build(g_room->getWallTextureID());
-	}
-
-	// --- Setup Corner Towers (Your Layout) ---
-	if (g_tower && g_room) {
-		g_tower->addTower(16.0f, -16.0f);
-		g_tower->addTower(16.0f, 0.0f);
-		g_tower->addTower(0.0f, -12.0f);
-		g_tower->addTower(-16.0f, 16.0f);
-		g_tower->addTower(-16.0f, 0.0f);
-		g_tower->build(g_room->getWallTextureID());
-	}
+	// --- Setup the Level Layout (floors, walls, towers, books, doors, decorations) ---
+	configureLevelGrid(level);
+	applyLayout(level, true, warm ? &cache : nullptr);
 
-	// --- Setup Secret Books ---
-	if (g_book) {
-		g_book->addBook(-14.0f, -17.0f, "Note #1:\n\nThe first number is the loneliest number.\n");
-		g_book->addBook(-14.8f, -17.0f, "Note #2:\n\nLook at your hand.\nCount the fingers.");
-		g_book->addBook(-15.6f, -17.0f, "Note #3:\n\nDays in a week.\nColors in a rainbow.");
-		g_book->addBook(-2.5f, -17.0f, "oh!! Sometimes \nI forget the pin number,\ntherefore I attach three notes with three hints.");
-		g_book->addBook(1.0f, -12.0f, "As I remember \nI write a pin number's Hint \non my bedroom diary.I");
-		g_book->addBook(6.0f, -15.0f, "There are four inner planets in our solar system: \nMercury, Venus, Earth, and Mars, \noften called terrestrial planets because they are rocky, \ndense, and orbit closest to the Sun, \ninside the asteroid belt. ");
-		g_book->addBook(7.0f, -15.0f, "The first man landed on the Moon in 1969, \nduring the NASA Apollo 11 mission, \nwhen astronaut Neil Armstrong stepped onto the lunar \nsurface on July 20, 1969, \nfollowed by Buzz Aldrin, fulfilling President Kennedy's goal. ");
-		g_book->addBook(19.0f, -3.0f, "I saw You sleep lot of time,\and therefore I set look,\n the look is the 4 digit\n are what is the __ apollo , How many people in rocket . \nand ,how many inner planets in our solar system.");
-		g_book->addBook(6.0f, -2.0f, "The Apollo 11 crew consisted of three astronauts: ");
-		g_book->addBook(6.0f, -3.0f, "The first fully electronic television system was demonstrated \nby Philo Taylor Farnsworth in 1927 ");
-		g_book->addBook(-1.0f, 4.0f, "The tv room pin is which year the fist tv made");
-		g_book->addBook(-14.0f, -2.0f, "The fist tow digit look at the sofa and cout something");
-		g_book->addBook(-2.0f, -2.0f, "The next  digit how may pellows in my bed room");
+	if (warm && loadCollisionGrid(cache.grid.data(), cache.gridWidth, cache.gridHeight) &&
+		g_visibility.load(cache.visibility, cache.visBlocksX, cache.visBlocksZ)) {
+		printf("Warm start: world data loaded from '%s'.\n", WORLD_CACHE_PATH);
 	}
-
-	// --- Setup Secret Door ---
-	if (g_door) {
-		g_door->addDoor(0.0f, -18.0f, 2, "157");
-		g_door->addDoor(18.2f, 0.0f, 1, "1134");
-		g_door->addDoor(0.0f, -14.4f, 2, "1927");
-		g_door->addDoor(-18.5f, 0.0f, 1, "188");
-		g_door->addDoor(-16.0f, 18.25f, 2, "111");
+	else {
+		// --- Collision Grid Setup ---
+		// Use the grid compiled into the level; stamp it only if there is none
+		if (levelGrid.empty() || !loadCollisionGrid(levelGrid.data(), g_collisionGrid.getWidth(), g_collisionGrid.getHeight())) {
+			rebuildCollisionGrid(false);
+		}
+		computeVisibility();
+		writeWorldCache(levelKey, levelGrid);
 	}
 
-	// --- Setup Room Decorations ---
-	if (g_decor) {
-		// Add some chairs and tables
-		g_decor->addDecoration(1, 11.5f, -6.0f, -90.0f); // Chair near book 1
-		g_decor->addDecoration(2, 10.0f, -6.0f, 90.0f);  // Table near book 1
-		g_decor->addDecoration(1, 8.5f, -6.0f, 90.0f); // Chair near book 1
-		g_decor->addDecoration(1, 10.0f, -7.5f, 0.0f); // Chair near book 1
-		g_decor->addDecoration(1, 10.0f, -4.5f, -180.0f); // Chair near book 1
-		g_decor->addDecoration(1, 4.0f, -3.0f, -180.0f); // Chair near book 1
-
-
-		g_decor->addDecoration(2, 2.0f, 2.0f, 135.0f);   // Chair near book 2
-
-		g_decor->addDecoration(4, -11.0f, 4.0f, 90.0f);    
-		g_decor->addDecoration(4, -11.0f, 6.00f, 90.0f);
-		g_decor->addDecoration(4, -11.0f, 10.0f, 90.0f);
-		g_decor->addDecoration(4, -11.0f, 12.0f, 90.0f);
-
-		//crberd
-		g_decor->addDecoration(3, 15.0f, -15.0f, -45.0f); // Chair near book 3
-		g_decor->addDecoration(3, 1.0f, -7.0f, 90.0f); // Chair near book 3
+	// Crates move, so they are stamped on the live grid only (never cached or compiled)
+	g_rigidBodies.applyCollision(g_collisionGrid);
+	buildGridData();
+	g_collisionGrid.addChangeListener(onCollisionGridChanged);
 
-		//rack
-		g_decor->addDecoration(5, 10.0f, -15.0f, 0.0f);   
-		g_decor->addDecoration(5, 19.0f, -10.0f, 90.0f);   
-		g_decor->addDecoration(5, 19.0f, -6.0f, 90.0f);   
+	// --- Stream in the textures needed for the starting view ---
+	g_textureStreamer.update(g_camera->getX(), g_camera->getZ());
+	g_textureStreamer.flush();
 
-		//lamp
-		g_decor->addDecoration(6, 3.0f, -7.0f, 0.0f);   // Table near book 3
-		g_decor->addDecoration(6, 14.0f, -9.0f, 0.0f);   // Table near book 3
-		g_decor->addDecoration(6, -19.0f, -19.0f, 0.0f);   // Table near book 3
-		g_decor->addDecoration(6, -19.0f, -14.0f, 0.0f);   // Table near book 3
-		g_decor->addDecoration(6, -14.0f, 1.0f, 0.0f);   // Table near book 3
-		g_decor->addDecoration(6, -14.0f, 14.0f, 0.0f);   // Table near book 3
+	// --- And the world chunks around it ---
+	g_worldChunks.flush(g_camera->getX(), g_camera->getZ());
 
-		//plant
-		g_decor->addDecoration(10, 2.0f, -2.0f, 90.0f);   // Table near book 3
-		g_decor->addDecoration(10, -5.0f, -3.0f, 75.0f);   // Table near book 3
-		g_decor->addDecoration(10, -11.0f, -3.0f, 45.0f);   // Table near book 3
-		g_decor->addDecoration(10, 15.5f, -17.5f, 45.0f);   // Table near book 3
+	// --- Trigger volumes: interaction ranges and PIN cancelling ---
+	g_triggers.setStayEvents(false); // Nothing listens to them yet
+	g_triggers.subscribe(onTriggerEvent);
 
-		  // Table near book 3
-		g_decor->addDecoration(9, 4.0f, -5.0f, 0.0f);   // Table near book 3
-
-		//tv unit
-		g_decor->addDecoration(8, -8.0f, -3.0f, 180.0f);   // Table near book 3
-
-		//sofa
-		g_decor->addDecoration(7, -8.0f, -10.0f, 0.0f);   // Table near book 3
-
-
-	}
-
-	// --- Collision Grid Setup ---
-	setupCollisionGrid();
+	// --- Watch content files for hot reload ---
+	setupHotReload();
 }
 
 // ================================================================
@@ -439,55 +1414,80 @@ void display() {
 
 	g_camera->applyView();
 
-	// --- Draw Scene ---
-	if (g_showAxes) drawAxes(GRID_HALF_SIZE);
-	if (g_showCoordinates) { drawGrid(GRID_SIZE, GRID_SEGMENTS); drawGridCoordinates(GRID_SIZE, GRID_SEGMENTS); }
+	// --- Floors seen through a stairwell (the current floor's PVS sees the opening) ---
+	// Their objects are not culled: the PVS belongs to the current floor
+	int currentFloor = g_floors.getCurrent();
+	float floorY = g_floors.getBaseY(currentFloor);
+	g_visibility.setViewpoint(g_camera->getX(), g_camera->getZ(), g_camera->getY() - floorY, g_layout.roomHeight);
+	std::vector<int> portalFloors;
+	g_floors.findVisibleFloors(portalFloors);
+	if (!portalFloors.empty()) {
+		g_visibility.setViewpoint(g_camera->getX(), g_camera->getZ(), g_layout.roomHeight + 1.0f, g_layout.roomHeight);
+		for (int f : portalFloors) {
+			const FloorModules& m = g_floorModules[f];
+			glPushMatrix();
+			glTranslatef(0.0f, g_floors.getBaseY(f), 0.0f);
+			if (g_room) g_room->draw(f);
+			m.walls->draw();
+			m.towers->draw();
+			m.decor->draw();
+			m.books->draw();
+			m.doors->draw();
+			glPopMatrix();
+		}
+		g_visibility.setViewpoint(g_camera->getX(), g_camera->getZ(), g_camera->getY() - floorY, g_layout.roomHeight);
+	}
 
-	if (g_room) g_room->draw();
-	if (g_insideWalls) g_insideWalls->draw();
-	if (g_tower) g_tower->draw();
-	if (g_decor) g_decor->draw(); // <-- NEW: Draw Decorations
+	// --- Draw Scene (the current floor, raised to its height) ---
+	glPushMatrix();
+	glTranslatef(0.0f, floorY, 0.0f);
+	if (g_showAxes) drawAxes(g_collisionGrid.getWorldWidth() / 2.0f);
+	if (g_showCoordinates) {
+		drawGrid(g_camera->getX(), g_camera->getZ());
+		drawGridCoordinates(g_camera->getX(), g_camera->getZ());
+	}
 
-	// Draw Secret Books
-	if (g_book) {
-		g_book->draw();
-		if (g_camera && !g_isEnteringPin) {
-			int nearIndex = g_book->getNearestBookIndex(g_camera->getX(), g_camera->getZ());
-			if (nearIndex != -1) {
-				if (g_book->isBookOpen(nearIndex)) {
-					g_labels->drawCenterMessage(g_book->getBookMessage(nearIndex));
-				}
-				else {
-					g_labels->drawActionHint("Press 'E' to Read");
-				}
-			}
-		}
+	// Static geometry from the resident chunks; while a chunk in view is
+	// still loading, from the modules' whole-floor lists instead
+	if (!g_worldChunks.draw()) {
+		if (g_room) g_room->draw(currentFloor);
+		if (g_insideWalls) g_insideWalls->draw();
+		if (g_tower) g_tower->draw();
 	}
+	if (g_decor) g_decor->draw(); // <-- NEW: Draw Decorations
 
-	// Draw Secret Doors
-	if (g_door) {
-		g_door->draw();
-		if (g_camera) {
-			int doorIdx = g_door->getNearestDoorIndex(g_camera->getX(), g_camera->getZ());
-			if (doorIdx != -1 && !g_door->isDoorOpen(doorIdx)) {
-				// --- PIN UI LOGIC ---
-				if (g_isEnteringPin && g_interactingDoorIndex == doorIdx) {
-					// UPDATED MESSAGE: Two lines for better visibility
-					const char* pinMsg = "Enter PIN to Unlock.\n(Press 'Esc' or 'E' to Cancel)";
-					g_labels->drawCenterMessage(pinMsg);
-				}
-				else if (!g_isEnteringPin) {
-					g_labels->drawActionHint("Press 'E' to Unlock");
-				}
-			}
-		}
+	// Ambient characters, placed between the last two simulation steps
+	if (g_crowd.getCount() > 0) {
+		g_crowd.buildVertices(g_simClock.getAlpha(), g_camera->getX(), g_camera->getZ());
+		g_crowd.draw();
 	}
 
+	// Draw Secret Books and Doors (their prompts are set once per tick, see updateInteractionPrompt)
+	if (g_book) g_book->draw();
+	if (g_door) g_door->draw();
+
+	// "Guide me" route from the player's feet
+	if (g_guideMode) drawPath(g_guidePath, g_camera->getX(), g_camera->getZ());
+	glPopMatrix();
+
 	// --- Draw 2D UI (Labels) ---
+	if (g_labels && g_camera && g_camera->isDeveloperMode()) {
+		const double MB = 1024.0 * 1024.0;
+		char stats[320];
+		sprintf_s(stats, sizeof(stats),
+			"GPU Memory : %.2f MB\nTextures   : %d (%.2f MB)\nLists      : %d (%.2f MB)\nBuffers    : %d (%.2f MB)\nChunks     : %d/%d (%.2f MB)",
+			g_gpuMemory.getTotalBytes() / MB,
+			g_gpuMemory.getCount(GPU_TEXTURE), g_gpuMemory.getTotalBytes(GPU_TEXTURE) / MB,
+			g_gpuMemory.getCount(GPU_DISPLAY_LIST), g_gpuMemory.getTotalBytes(GPU_DISPLAY_LIST) / MB,
+			g_gpuMemory.getCount(GPU_BUFFER), g_gpuMemory.getTotalBytes(GPU_BUFFER) / MB,
+			g_worldChunks.getResidentCount(), g_worldChunks.getChunkCount(), g_worldChunks.getResidentBytes() / MB);
+		g_labels->setDeveloperStats(stats);
+	}
 	if (g_labels && g_camera) {
 		g_labels->draw(g_camera->isDeveloperMode(), g_camera->getX(), g_camera->getY(), g_camera->getZ());
 	}
 
+	g_framePacer.endFrameWork(); // A swap blocked on vsync is not frame work
 	glutSwapBuffers();
 }
 
@@ -506,19 +1506,80 @@ void reshape(int w, int h) {
 	g_labels->onWindowResize(w, h);
 }
 
+// ================================================================
+// Simulation Step Function
+// Advances everything that moves by one fixed step.
+// ================================================================
+void simulationStep(float dt) {
+	if (g_camera) g_camera->update(dt);
+
+	// Stairs: past the top, or into a stairwell, the player is on another floor
+	if (g_camera && !g_camera->isDeveloperMode() && g_floors.getFloorCount() > 1) {
+		int floor = g_floors.floorAfterMove(g_floors.getCurrent(), g_camera->getX(), g_camera->getZ(), g_camera->getFeetY());
+		if (floor != g_floors.getCurrent()) switchFloor(floor);
+	}
+
+	// The book and door are a few angle updates each, cheaper than a job, and
+	// an opening door writes the grid, so they step here before the crowd
+	// (which only reads the grid) goes to a worker
+	if (g_book) g_book->update(dt);
+	if (g_door) g_door->update(dt);
+	if (g_camera) g_crowd.setPlayer(g_camera->getX(), g_camera->getZ());
+	JobHandle crowdUpdate = g_jobSystem.run("crowd update", [dt] { g_crowd.update(g_collisionGrid, g_distanceField, g_pathfinder, dt); });
+	g_jobSystem.wait(crowdUpdate);
+
+	// Crates (after the others: they write the grid): the player pushes with the velocity it moved at this step
+	if (g_camera && !g_camera->isDeveloperMode()) {
+		g_rigidBodies.setPusher(g_camera->getX(), g_camera->getZ(), g_camera->getCollisionRadius(), g_camera->getVelX(), g_camera->getVelZ());
+	}
+	g_rigidBodies.step(dt, g_collisionWorld, &g_collisionGrid);
+}
+
 // ================================================================
 // Idle Callback Function (Optimized)
 // ================================================================
 void idle() {
+	// Sleep until the next frame is due (no busy polling of the clock)
+	g_framePacer.waitForNextFrame();
 	int currentTime = glutGet(GLUT_ELAPSED_TIME);
-	float dt = (currentTime - g_lastTime) / 1000.0f;
-	if (dt < 0.016f) return;
-	if (dt > 0.1f) dt = 0.1f;
-	g_lastTime = currentTime;
 
-	if (g_camera) g_camera->update(dt);
-	if (g_book) g_book->update(dt);
-	if (g_door) g_door->update(dt);
+	// Apply hot reloads between frames
+	g_fileWatcher.poll(currentTime);
+
+	// Run as many fixed steps as real time allows, then render in between
+	int steps = g_simClock.advance(currentTime);
+	for (int i = 0; i < steps; ++i) {
+		simulationStep(g_simClock.getStep());
+	}
+
+	// Cells doors and crates changed during those steps
+	repairGridData();
+
+	// Triggers, look-at queries and prompts only depend on the latest tick.
+	// The guide route is traced on a worker meanwhile; trigger events, the
+	// focus and the prompt follow the trigger update on the main thread
+	if (steps > 0 && g_camera) {
+		float camX = g_camera->getX(), camZ = g_camera->getZ();
+		float guideDt = steps * g_simClock.getStep();
+		JobHandle guide = g_jobSystem.run("guide update", [guideDt] { updateGuide(guideDt); });
+		JobHandle triggers = g_jobSystem.run("trigger update", [camX, camZ] { g_triggers.update(camX, camZ); });
+		JobHandle focus = g_jobSystem.then(triggers, "trigger dispatch", [] {
+			g_triggers.dispatch();
+			updateInteractionFocus();
+			updateInteractionPrompt();
+		}, JOB_MAIN_THREAD);
+		g_jobSystem.wait(focus);
+		g_jobSystem.wait(guide);
+	}
+	if (g_camera) g_camera->setRenderAlpha(g_simClock.getAlpha());
+	if (g_decor) g_decor->setRenderAlpha(g_simClock.getAlpha());
+
+	// Stream texture mips and world chunks for the new camera position
+	if (g_camera) g_textureStreamer.update(g_camera->getX(), g_camera->getZ());
+	if (g_camera) g_worldChunks.update(g_camera->getX(), g_camera->getZ());
+
+	// GL work queued by jobs since the last frame
+	g_jobSystem.pumpMainThread();
 
 	glutPostRedisplay();
 }
@@ -546,8 +1607,8 @@ void keyboard(unsigned char key, int x, int y) {
 			// LOGIC: Check if this next digit is correct
 			std::string nextPin = g_currentPin + (char)key;
 
-			// DYNAMICALLY get the correct PIN for this door
-			std::string targetPin = getPinForDoor(g_interactingDoorIndex);
+			// The PIN comes from the level data, via the door itself
+			std::string targetPin = g_door ? g_door->getDoorPin(g_interactingDoorIndex) : "";
 
 			// Check validity
 			bool isValidSoFar = true;
@@ -587,8 +1648,9 @@ void keyboard(unsigned char key, int x, int y) {
 	if (key == 27) { // ESC Key
 		printf("ESC key pressed. Exiting.\n");
 		delete g_camera; delete g_labels; delete g_room;
-		delete g_insideWalls; delete g_tower; delete g_book; delete g_door;
-		delete g_decor; // <-- NEW: Clean up
+		resizeFloors(0, g_layout); // <-- NEW: Clean up every floor
+		if (g_cacheSave) g_jobSystem.wait(g_cacheSave); // Don't drop a queued save
+		g_jobSystem.stop();
 		exit(0);
 	}
 	if (key == '\t') { // Tab Key
@@ -604,9 +1666,10 @@ void keyboard(unsigned char key, int x, int y) {
 
 	// --- INTERACTION KEY ('E') ---
 	if (key == 'e' || key == 'E') {
+		// Only what the camera is looking at (not through walls)
 		// 1. Check Door Interaction FIRST
 		if (g_door && g_camera) {
-			int doorIndex = g_door->getNearestDoorIndex(g_camera->getX(), g_camera->getZ());
+			int doorIndex = g_focusDoor;
 			if (doorIndex != -1 && !g_door->isDoorOpen(doorIndex)) {
 				// Start PIN Entry
 				g_isEnteringPin = true;
@@ -618,13 +1681,21 @@ void keyboard(unsigned char key, int x, int y) {
 
 		// 2. Check Book Interaction
 		if (g_book && g_camera) {
-			int bookIndex = g_book->getNearestBookIndex(g_camera->getX(), g_camera->getZ());
+			int bookIndex = g_focusBook;
 			if (bookIndex != -1) {
 				g_book->toggleBook(bookIndex);
 			}
 		}
 	}
 
+	// Guide Me Toggle ('G')
+	if (key == 'g' || key == 'G') {
+		g_guideMode = !g_guideMode;
+		g_guideTimer = 0.0f; // Find the route on the next tick
+		g_guidePath.clear();
+		printf("Guide Me: %s\n", g_guideMode ? "ON" : "OFF");
+	}
+
 	// Developer Toggles
 	if (key == 't' || key == 'T') {
 		if (g_camera->isDeveloperMode()) g_showAxes = !g_showAxes;
@@ -632,6 +1703,21 @@ void keyboard(unsigned char key, int x, int y) {
 	if (key == 'c' || key == 'C') {
 		if (g_camera->isDeveloperMode()) g_showCoordinates = !g_showCoordinates;
 	}
+	if (key == 'r' || key == 'R') {
+		if (g_camera->isDeveloperMode()) g_textureStreamer.printReport();
+	}
+	if (key == 'm' || key == 'M') {
+		if (g_camera->isDeveloperMode()) g_gpuMemory.printReport();
+	}
+	if (key == 'k' || key == 'K') {
+		if (g_camera->isDeveloperMode()) g_framePacer.printReport();
+	}
+	if (key == 'j' || key == 'J') {
+		if (g_camera->isDeveloperMode()) g_worldChunks.printReport();
+	}
+	if (key == 'l' || key == 'L') {
+		if (g_camera->isDeveloperMode()) g_jobSystem.printReport();
+	}
 
 	g_camera->onKeyDown(key);
 }
@@ -0,0 +1,73 @@
+// BakedMesh.cpp : CPU-side static geometry for display lists and the world cache.
+//
+#include "pch.h" // Must be first
+#include "BakedMesh.h"
+
+void BakedMesh::beginBatch(int textureSlot) {
+    BakedBatch b;
+    b.textureSlot = textureSlot;
+    b.first = (int)vertices.size();
+    b.count = 0;
+    batches.push_back(b);
+}
+
+void BakedMesh::addVertex(float x, float y, float z, float nx, float ny, float nz, float u, float v) {
+    if (batches.empty()) beginBatch(0);
+    BakedVertex vert = { u, v, nx, ny, nz, x, y, z };
+    vertices.push_back(vert);
+    batches.back().count++;
+}
+
+void BakedMesh::addBox(float cx, float cy, float cz, float w, float h, float d, bool withBottom) {
+    float x0 = cx - w / 2.0f, x1 = cx + w / 2.0f;
+    float y0 = cy - h / 2.0f, y1 = cy + h / 2.0f;
+    float z0 = cz - d / 2.0f, z1 = cz + d / 2.0f;
+
+    // Front
+    addVertex(x0, y0, z1, 0, 0, 1, 0, 0); addVertex(x1, y0, z1, 0, 0, 1, 1, 0);
+    addVertex(x1, y1, z1, 0, 0, 1, 1, 1); addVertex(x0, y1, z1, 0, 0, 1, 0, 1);
+    // Back
+    addVertex(x1, y0, z0, 0, 0, -1, 0, 0); addVertex(x0, y0, z0, 0, 0, -1, 1, 0);
+    addVertex(x0, y1, z0, 0, 0, -1, 1, 1); addVertex(x1, y1, z0, 0, 0, -1, 0, 1);
+    // Left
+    addVertex(x0, y0, z0, -1, 0, 0, 0, 0); addVertex(x0, y0, z1, -1, 0, 0, 1, 0);
+    addVertex(x0, y1, z1, -1, 0, 0, 1, 1); addVertex(x0, y1, z0, -1, 0, 0, 0, 1);
+    // Right
+    addVertex(x1, y0, z1, 1, 0, 0, 0, 0); addVertex(x1, y0, z0, 1, 0, 0, 1, 0);
+    addVertex(x1, y1, z0, 1, 0, 0, 1, 1); addVertex(x1, y1, z1, 1, 0, 0, 0, 1);
+    // Top
+    addVertex(x0, y1, z1, 0, 1, 0, 0, 0); addVertex(x1, y1, z1, 0, 1, 0, 1, 0);
+    addVertex(x1, y1, z0, 0, 1, 0, 1, 1); addVertex(x0, y1, z0, 0, 1, 0, 0, 1);
+    // Bottom
+    if (withBottom) {
+        addVertex(x0, y0, z0, 0, -1, 0, 0, 0); addVertex(x1, y0, z0, 0, -1, 0, 1, 0);
+        addVertex(x1, y0, z1, 0, -1, 0, 1, 1); addVertex(x0, y0, z1, 0, -1, 0, 0, 1);
+    }
+}
+
+void BakedMesh::draw(const GLuint* textures, int textureCount) const {
+    if (vertices.empty()) return;
+
+    // Client array state is not recorded into display lists, only the draw calls are
+    glInterleavedArrays(GL_T2F_N3F_V3F, 0, vertices.data());
+
+    for (const auto& b : batches) {
+        GLuint tex = (b.textureSlot >= 0 && b.textureSlot < textureCount) ? textures[b.textureSlot] : 0;
+        if (tex != 0) {
+            glEnable(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glColor3f(1.0f, 1.0f, 1.0f);
+        }
+        else {
+            glDisable(GL_TEXTURE_2D);
+            glColor3f(1.0f, 0.0f, 1.0f); // Missing texture: Pink
+        }
+        glDrawArrays(GL_QUADS, b.first, b.count);
+    }
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisable(GL_TEXTURE_2D);
+    glColor3f(1.0f, 1.0f, 1.0f);
+}
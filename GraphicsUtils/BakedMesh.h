@@ -0,0 +1,57 @@
+#pragma once
+#include <glut.h>
+#include <vector>
+
+// ================================================================
+// BakedMesh
+//
+// Static geometry produced once on the CPU (all transforms applied) and
+// kept as a plain vertex array, so it can be written to the world cache
+// and compiled into a display list without re-running the module's
+// procedural drawing code.
+//
+// Vertices use the GL_T2F_N3F_V3F interleaved layout and are drawn as
+// GL_QUADS. Each batch uses one of the owning module's texture slots;
+// slots are used instead of GL IDs because IDs change between runs.
+// ================================================================
+
+struct BakedVertex {
+    float u, v;
+    float nx, ny, nz;
+    float x, y, z;
+};
+
+struct BakedBatch {
+    int textureSlot;
+    int first;   // First vertex
+    int count;   // Vertex count (multiple of 4)
+};
+
+class BakedMesh {
+public:
+    std::vector<BakedVertex> vertices;
+    std::vector<BakedBatch> batches;
+
+    void clear() { vertices.clear(); batches.clear(); }
+
+    /**
+     * @brief Starts a new batch drawn with the given texture slot.
+     */
+    void beginBatch(int textureSlot);
+
+    void addVertex(float x, float y, float z, float nx, float ny, float nz, float u, float v);
+
+    /**
+     * @brief Adds an axis-aligned box centered at (cx, cy, cz), with the unit
+     * texture coordinates the modules use for every face.
+     * @param withBottom False to leave out the bottom face (never seen for floor standing boxes).
+     */
+    void addBox(float cx, float cy, float cz, float w, float h, float d, bool withBottom = true);
+
+    /**
+     * @brief Records the mesh into the currently open display list (or draws it).
+     * @param textures GL texture ID for each slot (0 = untextured).
+     * @param textureCount Number of entries in textures.
+     */
+    void draw(const GLuint* textures, int textureCount) const;
+};
@@ -0,0 +1,236 @@
+// CollisionGrid.cpp : Flat bitset collision grid with word-level operations.
+//
+#include "pch.h" // Must be first
+#include "CollisionGrid.h"
+#include <string.h>
+#include <algorithm>
+#include <random>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Default 40 x 40 room of 1 unit cells, centered on the origin.
+// Levels configure their own grid when they load.
+CollisionGrid g_collisionGrid(40, 40, 1.0f, -20.0f, -20.0f);
+
+// ================================================================
+// Bit helpers
+// ================================================================
+
+static inline int popCount64(uint64_t v) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+static inline int lowestBit64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (int)index;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+// Bits lo..hi (inclusive) of a word set
+static inline uint64_t bitRange(int lo, int hi) {
+    uint64_t upper = (hi >= 63) ? ~0ULL : ((1ULL << (hi + 1)) - 1);
+    return upper & (~0ULL << lo);
+}
+
+// ================================================================
+// CollisionGrid
+// ================================================================
+
+CollisionGrid::CollisionGrid(int width, int height, float cellSize, float originX, float originZ)
+    : m_width(0), m_height(0), m_wordsPerRow(0),
+    m_cellSize(1.0f), m_invCellSize(1.0f), m_originX(0.0f), m_originZ(0.0f),
+    m_nextListener(1), m_notify(true)
+{
+    if (!configure(width, height, cellSize, originX, originZ)) resize(0, 0);
+}
+
+bool CollisionGrid::configure(int width, int height, float cellSize, float originX, float originZ) {
+    // Cell indices are ints and x / 64 words per row must fit too
+    if (width < 0 || height < 0 || !(cellSize > 0.0f) || width > (1 << 28) || height > (1 << 28)) return false;
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0f / cellSize;
+    m_originX = originX;
+    m_originZ = originZ;
+    resize(width, height);
+    return true;
+}
+
+void CollisionGrid::resize(int width, int height) {
+    m_width = width > 0 ? width : 0;
+    m_height = height > 0 ? height : 0;
+    m_wordsPerRow = (m_width + 63) / 64;
+    m_words.assign((size_t)m_wordsPerRow * m_height, 0);
+}
+
+void CollisionGrid::fill(bool blocked) {
+    if (!blocked) {
+        std::fill(m_words.begin(), m_words.end(), 0);
+        return;
+    }
+    fillRect(0, 0, m_width - 1, m_height - 1, true); // Keeps the padding bits clear
+}
+
+bool CollisionGrid::clip(int& x0, int& z0, int& x1, int& z1) const {
+    if (x0 > x1) std::swap(x0, x1);
+    if (z0 > z1) std::swap(z0, z1);
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, m_width - 1);
+    z1 = std::min(z1, m_height - 1);
+    return x0 <= x1 && z0 <= z1;
+}
+
+template <typename Fn>
+void CollisionGrid::forEachWord(int x0, int x1, Fn fn) const {
+    int w0 = x0 >> 6, w1 = x1 >> 6;
+    if (w0 == w1) {
+        fn(w0, bitRange(x0 & 63, x1 & 63));
+        return;
+    }
+    fn(w0, bitRange(x0 & 63, 63));
+    for (int w = w0 + 1; w < w1; ++w) fn(w, ~0ULL);
+    fn(w1, bitRange(0, x1 & 63));
+}
+
+void CollisionGrid::fillRect(int x0, int z0, int x1, int z1, bool blocked) {
+    if (!clip(x0, z0, x1, z1)) return;
+    for (int z = z0; z <= z1; ++z) {
+        uint64_t* r = &m_words[(size_t)z * m_wordsPerRow];
+        if (blocked) forEachWord(x0, x1, [r](int w, uint64_t mask) { r[w] |= mask; });
+        else forEachWord(x0, x1, [r](int w, uint64_t mask) { r[w] &= ~mask; });
+    }
+}
+
+bool CollisionGrid::anyInRect(int x0, int z0, int x1, int z1) const {
+    int cx0 = x0, cz0 = z0, cx1 = x1, cz1 = z1;
+    if (!clip(cx0, cz0, cx1, cz1)) return true;
+    // Any part of the rectangle outside the grid is blocked
+    if (cx0 != std::min(x0, x1) || cz0 != std::min(z0, z1) ||
+        cx1 != std::max(x0, x1) || cz1 != std::max(z0, z1)) return true;
+
+    for (int z = cz0; z <= cz1; ++z) {
+        const uint64_t* r = row(z);
+        uint64_t any = 0;
+        forEachWord(cx0, cx1, [r, &any](int w, uint64_t mask) { any |= r[w] & mask; });
+        if (any) return true;
+    }
+    return false;
+}
+
+int CollisionGrid::countInRect(int x0, int z0, int x1, int z1) const {
+    if (!clip(x0, z0, x1, z1)) return 0;
+    int count = 0;
+    for (int z = z0; z <= z1; ++z) {
+        const uint64_t* r = row(z);
+        forEachWord(x0, x1, [r, &count](int w, uint64_t mask) { count += popCount64(r[w] & mask); });
+    }
+    return count;
+}
+
+int CollisionGrid::findInRow(int z, int x0, int x1, bool blocked) const {
+    if (z < 0 || z >= m_height) return -1;
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, m_width - 1);
+    if (x0 > x1) return -1;
+
+    const uint64_t* r = row(z);
+    int w0 = x0 >> 6, w1 = x1 >> 6;
+    for (int w = w0; w <= w1; ++w) {
+        uint64_t mask = bitRange(w == w0 ? (x0 & 63) : 0, w == w1 ? (x1 & 63) : 63);
+        uint64_t bits = (blocked ? r[w] : ~r[w]) & mask;
+        if (bits) return (w << 6) + lowestBit64(bits);
+    }
+    return -1;
+}
+
+void CollisionGrid::saveBits(std::vector<unsigned char>& outBits) const {
+    size_t rowBytes = (size_t)(m_width + 7) / 8;
+    outBits.assign(rowBytes * m_height, 0);
+    for (int z = 0; z < m_height; ++z) {
+        // Words are little-endian, so the first rowBytes bytes are the row
+        memcpy(&outBits[z * rowBytes], row(z), rowBytes);
+    }
+}
+
+bool CollisionGrid::loadBits(const unsigned char* bits, int width, int height) {
+    if (!bits || width != m_width || height != m_height) return false;
+    size_t rowBytes = (size_t)(width + 7) / 8;
+    for (int z = 0; z < height; ++z) {
+        uint64_t* r = &m_words[(size_t)z * m_wordsPerRow];
+        std::fill(r, r + m_wordsPerRow, 0);
+        memcpy(r, &bits[z * rowBytes], rowBytes);
+        // Drop any bits past the last column
+        if (m_width & 63) r[m_wordsPerRow - 1] &= bitRange(0, (m_width & 63) - 1);
+    }
+    return true;
+}
+
+// ================================================================
+// Change events
+// ================================================================
+
+int CollisionGrid::addChangeListener(GridChangeListener listener) {
+    int id = m_nextListener++;
+    m_listeners.push_back(std::make_pair(id, listener));
+    return id;
+}
+
+void CollisionGrid::removeChangeListener(int id) {
+    for (size_t i = 0; i < m_listeners.size(); ++i) {
+        if (m_listeners[i].first == id) {
+            m_listeners.erase(m_listeners.begin() + i);
+            return;
+        }
+    }
+}
+
+void CollisionGrid::notifyChanged(int x0, int z0, int x1, int z1) const {
+    if (!m_notify || m_listeners.empty()) return;
+    if (!clip(x0, z0, x1, z1)) return;
+    for (size_t i = 0; i < m_listeners.size(); ++i) {
+        m_listeners[i].second(x0, z0, x1, z1);
+    }
+}
+
+void CollisionGrid::notifyChangedArea(float minX, float minZ, float maxX, float maxZ) const {
+    int x0, z0, x1, z1;
+    worldToCell(minX, minZ, x0, z0);
+    worldToCell(maxX, maxZ, x1, z1);
+    notifyChanged(x0, z0, x1, z1);
+}
+
+// ================================================================
+// Benchmark venue
+// ================================================================
+
+void makeBenchmarkVenue(CollisionGrid& grid, int size, bool openDoorways, std::vector<int>* doorways) {
+    grid.configure(size, size, 1.0f, -size / 2.0f, -size / 2.0f);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> pos(0, size - 1), extent(0, 5);
+    for (int i = 0; i < size * size / 400; ++i) {
+        int x = pos(rng), z = pos(rng);
+        grid.fillRect(x, z, x + extent(rng), z + extent(rng), true);
+    }
+    for (int wall = 25; wall < size; wall += 50) {
+        grid.fillRect(0, wall, size - 1, wall, true);
+        grid.fillRect(wall, 0, wall, size - 1, true);
+        for (int gap = 10; openDoorways && gap < size; gap += 50) {
+            grid.fillRect(gap, wall, gap + 2, wall, false);
+            grid.fillRect(wall, gap, wall, gap + 2, false);
+            if (doorways) {
+                int a[] = { gap, wall, gap + 2, wall, wall, gap, wall, gap + 2 };
+                doorways->insert(doorways->end(), a, a + 8);
+            }
+        }
+    }
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <functional>
+#include <utility>
+#include <math.h>
+
+// ================================================================
+// CollisionGrid
+//
+// Flat bitset of blocked cells: one bit per cell, one allocation for the
+// whole grid. Every row starts on a 64-bit word (padding bits stay 0), so
+// a row is a plain array of words:
+//  - rectangles are filled/cleared a word at a time (masks at both ends)
+//  - row scans OR / popcount whole words, which compilers vectorize
+//  - saving to the packed byte format used by level files and the world
+//    cache is a copy per row (little-endian words, lowest bit first)
+//
+// The grid also knows where it lies in the world (origin = min corner
+// of cell (0, 0), square cells of any size), so levels pick their own
+// size and resolution at runtime. At 1 bit per cell a 10000 x 10000 grid
+// is 12.5 MB.
+//
+// Code that edits cells while the game runs (doors opening and closing)
+// reports the edited rectangle with notifyChanged(); listeners (distance
+// field, pathfinder, flow fields) then repair only those cells instead of
+// rebuilding from the whole grid.
+//
+// The GraphicsUtils grid functions (worldToGrid, addBlockGridBox,
+// isGridPositionBlocked, drawGrid, ...) all go through g_collisionGrid.
+// ================================================================
+
+// Inclusive cell rectangle [x0..x1] x [z0..z1] that changed
+typedef std::function<void(int x0, int z0, int x1, int z1)> GridChangeListener;
+
+class CollisionGrid {
+public:
+    CollisionGrid(int width = 0, int height = 0, float cellSize = 1.0f, float originX = 0.0f, float originZ = 0.0f);
+
+    /**
+     * @brief Sets size and world placement. All cells become walkable.
+     * @param cellSize Side of a cell in world units (> 0).
+     * @param originX, originZ World position of the min corner of cell (0, 0).
+     * @return False (grid untouched) for an invalid size.
+     */
+    bool configure(int width, int height, float cellSize, float originX, float originZ);
+
+    /**
+     * @brief Resizes the grid, keeping cell size and origin. All cells become walkable.
+     */
+    void resize(int width, int height);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getWordsPerRow() const { return m_wordsPerRow; }
+    float getCellSize() const { return m_cellSize; }
+    float getOriginX() const { return m_originX; }
+    float getOriginZ() const { return m_originZ; }
+    float getWorldWidth() const { return m_width * m_cellSize; }
+    float getWorldDepth() const { return m_height * m_cellSize; }
+
+    /**
+     * @brief Cell containing a world position (may be outside the grid).
+     * @return True if the cell is inside the grid.
+     */
+    bool worldToCell(float worldX, float worldZ, int& x, int& z) const {
+        x = (int)floorf((worldX - m_originX) * m_invCellSize);
+        z = (int)floorf((worldZ - m_originZ) * m_invCellSize);
+        return inBounds(x, z);
+    }
+
+    /**
+     * @brief World position of a cell's center.
+     */
+    void cellCenter(int x, int z, float& worldX, float& worldZ) const {
+        worldX = m_originX + (x + 0.5f) * m_cellSize;
+        worldZ = m_originZ + (z + 0.5f) * m_cellSize;
+    }
+
+    bool isWorldBlocked(float worldX, float worldZ) const {
+        int x, z;
+        worldToCell(worldX, worldZ, x, z);
+        return get(x, z);
+    }
+
+    bool inBounds(int x, int z) const { return x >= 0 && z >= 0 && x < m_width && z < m_height; }
+
+    /**
+     * @brief True if the cell is blocked. Cells outside the grid count as blocked.
+     */
+    bool get(int x, int z) const {
+        if (!inBounds(x, z)) return true;
+        return (row(z)[x >> 6] >> (x & 63)) & 1;
+    }
+
+    void set(int x, int z, bool blocked) {
+        if (!inBounds(x, z)) return;
+        uint64_t bit = 1ULL << (x & 63);
+        if (blocked) m_words[(size_t)z * m_wordsPerRow + (x >> 6)] |= bit;
+        else m_words[(size_t)z * m_wordsPerRow + (x >> 6)] &= ~bit;
+    }
+
+    /**
+     * @brief Sets every cell to the same state.
+     */
+    void fill(bool blocked);
+
+    /**
+     * @brief Sets every cell in the inclusive rectangle [x0..x1] x [z0..z1].
+     * The rectangle is clipped to the grid.
+     */
+    void fillRect(int x0, int z0, int x1, int z1, bool blocked);
+
+    /**
+     * @brief True if any cell in the inclusive rectangle is blocked
+     * (cells outside the grid count as blocked).
+     */
+    bool anyInRect(int x0, int z0, int x1, int z1) const;
+
+    /**
+     * @brief Number of blocked cells in the inclusive rectangle (clipped to the grid).
+     */
+    int countInRect(int x0, int z0, int x1, int z1) const;
+
+    /**
+     * @brief First blocked (or walkable) cell in row z between x0 and x1, or -1.
+     */
+    int findInRow(int z, int x0, int x1, bool blocked) const;
+
+    const uint64_t* row(int z) const { return &m_words[(size_t)z * m_wordsPerRow]; }
+
+    /**
+     * @brief Packs the grid into bytes (rows padded to whole bytes, lowest bit first).
+     */
+    void saveBits(std::vector<unsigned char>& outBits) const;
+
+    /**
+     * @brief Loads bytes written by saveBits.
+     * @return False (grid untouched) if the size does not match.
+     */
+    bool loadBits(const unsigned char* bits, int width, int height);
+
+    /**
+     * @brief Registers a listener for notifyChanged().
+     * @return Id for removeChangeListener().
+     */
+    int addChangeListener(GridChangeListener listener);
+    void removeChangeListener(int id);
+
+    /**
+     * @brief Tells the listeners that cells [x0..x1] x [z0..z1] changed
+     * (clipped to the grid). Call after the edit is complete.
+     */
+    void notifyChanged(int x0, int z0, int x1, int z1) const;
+
+    /**
+     * @brief notifyChanged() for the cells under a world-space rectangle.
+     */
+    void notifyChangedArea(float minX, float minZ, float maxX, float maxZ) const;
+
+    /**
+     * @brief Mutes notifyChanged() while a whole grid is stamped (the
+     * listeners rebuild from scratch afterwards instead).
+     */
+    void setNotifyEnabled(bool enabled) { m_notify = enabled; }
+    bool isNotifyEnabled() const { return m_notify; }
+
+private:
+    // Calls fn(wordIndex, mask) for the words of one row covering [x0..x1]
+    template <typename Fn>
+    void forEachWord(int x0, int x1, Fn fn) const;
+
+    bool clip(int& x0, int& z0, int& x1, int& z1) const;
+
+    std::vector<uint64_t> m_words;
+    int m_width, m_height;
+    int m_wordsPerRow;
+    float m_cellSize, m_invCellSize;
+    float m_originX, m_originZ;
+
+    std::vector<std::pair<int, GridChangeListener>> m_listeners;
+    int m_nextListener;
+    bool m_notify;
+};
+
+extern CollisionGrid g_collisionGrid;
+
+/**
+ * @brief Builds the venue the navigation benchmarks share: size x size
+ * cells of 1 unit centered on the origin, furniture on about 3% of the
+ * floor and walls every 50 cells that cut it into 50 x 50 rooms. Always the
+ * same venue for a given size.
+ * @param openDoorways Leave a 3-cell doorway in every wall of every room
+ * (otherwise the walls are closed and the caller places doors).
+ * @param doorways If given, receives x0, z0, x1, z1 of every doorway left open.
+ */
+void makeBenchmarkVenue(CollisionGrid& grid, int size, bool openDoorways = true, std::vector<int>* doorways = nullptr);
@@ -0,0 +1,314 @@
+// CollisionWorld.cpp : Swept circle collision against a static box hierarchy.
+//
+#include "pch.h" // Must be first
+#include "CollisionWorld.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+CollisionWorld g_collisionWorld;
+
+// Boxes per leaf. Small leaves keep the narrow phase short, the tree is tiny anyway.
+static const int LEAF_SIZE = 4;
+
+// Distance kept from a surface after a hit, so the next sweep does not start touching it
+static const float CONTACT_SKIN = 0.001f;
+
+// ================================================================
+// Building
+// ================================================================
+
+CollisionWorld::CollisionWorld() {
+}
+
+void CollisionWorld::clear() {
+    m_boxes.clear();
+    m_order.clear();
+    m_nodes.clear();
+}
+
+int CollisionWorld::addBox(float x, float z, float rotationDeg, const FootprintBox& box, int kind, float top) {
+    // Same rotation as glRotatef(rotationDeg, 0, 1, 0): local +X -> (cos, -sin), local +Z -> (sin, cos)
+    float rad = rotationDeg * (float)M_PI / 180.0f;
+    float c = cosf(rad), s = sinf(rad);
+
+    Box b;
+    b.cx = x + box.offsetX * c + box.offsetZ * s;
+    b.cz = z - box.offsetX * s + box.offsetZ * c;
+    b.ux = c;
+    b.uz = -s;
+    b.hx = box.halfWidth;
+    b.hz = box.halfDepth;
+    b.top = top;
+
+    // World bounds of the rotated box
+    float ex = fabsf(c) * b.hx + fabsf(s) * b.hz;
+    float ez = fabsf(s) * b.hx + fabsf(c) * b.hz;
+    b.minX = b.cx - ex; b.maxX = b.cx + ex;
+    b.minZ = b.cz - ez; b.maxZ = b.cz + ez;
+    b.kind = kind;
+    b.enabled = true;
+
+    m_boxes.push_back(b);
+    m_nodes.clear(); // Needs a build()
+    return (int)m_boxes.size() - 1;
+}
+
+int CollisionWorld::addSegment(float startX, float startZ, float endX, float endZ, float thickness, int kind) {
+    float dx = endX - startX, dz = endZ - startZ;
+    float len = sqrtf(dx * dx + dz * dz);
+
+    FootprintBox box = { len / 2.0f + thickness / 2.0f, thickness / 2.0f, 0.0f, 0.0f };
+    float rotationDeg = (len > 0.0f) ? atan2f(-dz, dx) * 180.0f / (float)M_PI : 0.0f;
+    return addBox((startX + endX) / 2.0f, (startZ + endZ) / 2.0f, rotationDeg, box, kind);
+}
+
+void CollisionWorld::setEnabled(int box, bool enabled) {
+    if (box >= 0 && box < (int)m_boxes.size()) m_boxes[box].enabled = enabled;
+}
+
+void CollisionWorld::buildNode(int index, int first, int count) {
+    float minX = 1e30f, minZ = 1e30f, maxX = -1e30f, maxZ = -1e30f;
+    float cMinX = 1e30f, cMinZ = 1e30f, cMaxX = -1e30f, cMaxZ = -1e30f;
+    for (int i = first; i < first + count; ++i) {
+        const Box& b = m_boxes[m_order[i]];
+        minX = fminf(minX, b.minX); maxX = fmaxf(maxX, b.maxX);
+        minZ = fminf(minZ, b.minZ); maxZ = fmaxf(maxZ, b.maxZ);
+        cMinX = fminf(cMinX, b.cx); cMaxX = fmaxf(cMaxX, b.cx);
+        cMinZ = fminf(cMinZ, b.cz); cMaxZ = fmaxf(cMaxZ, b.cz);
+    }
+
+    Node node;
+    node.minX = minX; node.minZ = minZ;
+    node.maxX = maxX; node.maxZ = maxZ;
+
+    if (count <= LEAF_SIZE) {
+        node.first = first;
+        node.count = count;
+        m_nodes[index] = node;
+        return;
+    }
+
+    // Median split along the axis where the centers spread the most
+    bool splitX = (cMaxX - cMinX) >= (cMaxZ - cMinZ);
+    int half = count / 2;
+    std::nth_element(m_order.begin() + first, m_order.begin() + first + half, m_order.begin() + first + count,
+        [this, splitX](int a, int b) {
+            return splitX ? m_boxes[a].cx < m_boxes[b].cx : m_boxes[a].cz < m_boxes[b].cz;
+        });
+
+    // Children are stored next to each other: left, then right
+    int left = (int)m_nodes.size();
+    m_nodes.push_back(Node());
+    m_nodes.push_back(Node());
+    node.first = left;
+    node.count = 0;
+    m_nodes[index] = node;
+
+    buildNode(left, first, half);
+    buildNode(left + 1, first + half, count - half);
+}
+
+void CollisionWorld::build() {
+    m_nodes.clear();
+    m_order.resize(m_boxes.size());
+    for (size_t i = 0; i < m_order.size(); ++i) m_order[i] = (int)i;
+    if (m_boxes.empty()) return;
+
+    m_nodes.reserve(m_boxes.size() * 2);
+    m_nodes.push_back(Node());
+    buildNode(0, 0, (int)m_boxes.size());
+
+    printf("CollisionWorld: %d boxes, %d nodes\n", (int)m_boxes.size(), (int)m_nodes.size());
+}
+
+// ================================================================
+// Queries
+// ================================================================
+
+template <typename Fn>
+void CollisionWorld::query(float minX, float minZ, float maxX, float maxZ, Fn fn) const {
+    if (m_nodes.empty()) return;
+
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& n = m_nodes[stack[--top]];
+        if (n.maxX < minX || n.minX > maxX || n.maxZ < minZ || n.minZ > maxZ) continue;
+
+        if (n.count > 0) {
+            for (int i = n.first; i < n.first + n.count; ++i) {
+                int box = m_order[i];
+                const Box& b = m_boxes[box];
+                if (!b.enabled) continue;
+                if (b.maxX < minX || b.minX > maxX || b.maxZ < minZ || b.minZ > maxZ) continue;
+                fn(box, b);
+            }
+        }
+        else if (top + 2 <= 64) {
+            stack[top++] = n.first + 1;
+            stack[top++] = n.first;
+        }
+    }
+}
+
+// Ray p + t * d against a circle at the origin. Only entering hits count.
+static bool rayCircle(float px, float pz, float dx, float dz, float r, float& t) {
+    float a = dx * dx + dz * dz;
+    float b = px * dx + pz * dz;
+    if (a <= 0.0f || b >= 0.0f) return false; // Not moving towards it
+    float c = px * px + pz * pz - r * r;
+    float disc = b * b - a * c;
+    if (disc < 0.0f) return false;
+    t = (-b - sqrtf(disc)) / a;
+    return true;
+}
+
+bool CollisionWorld::sweepBox(const Box& b, float x, float z, float r, float dx, float dz,
+    float& toi, float& nx, float& nz) const {
+    // Into the box's frame: axes u = (ux, uz) and v = (-uz, ux)
+    float rx = x - b.cx, rz = z - b.cz;
+    float px = rx * b.ux + rz * b.uz;
+    float pz = -rx * b.uz + rz * b.ux;
+    float vx = dx * b.ux + dz * b.uz;
+    float vz = -dx * b.uz + dz * b.ux;
+
+    float lx = 0.0f, lz = 0.0f; // Normal in the box frame
+    float best = 2.0f;
+
+    // Already touching: closest point on the box to the center
+    float qx = fmaxf(-b.hx, fminf(px, b.hx));
+    float qz = fmaxf(-b.hz, fminf(pz, b.hz));
+    float ox = px - qx, oz = pz - qz;
+    float dist2 = ox * ox + oz * oz;
+    if (dist2 <= r * r) {
+        if (dist2 > 1e-12f) {
+            float dist = sqrtf(dist2);
+            lx = ox / dist; lz = oz / dist;
+        }
+        else {
+            // Center inside the box: push out through the nearest face
+            float gapX = b.hx - fabsf(px), gapZ = b.hz - fabsf(pz);
+            if (gapX < gapZ) lx = px >= 0.0f ? 1.0f : -1.0f;
+            else lz = pz >= 0.0f ? 1.0f : -1.0f;
+        }
+        if (vx * lx + vz * lz >= 0.0f) return false; // Moving out or along it
+        best = 0.0f;
+    }
+    else {
+        // Faces pushed out by r (the flat sides of the rounded box)
+        float t;
+        if (vx != 0.0f) {
+            float face = vx < 0.0f ? b.hx + r : -b.hx - r;
+            t = (face - px) / vx;
+            if (t >= 0.0f && t < best && fabsf(pz + vz * t) <= b.hz) { best = t; lx = vx < 0.0f ? 1.0f : -1.0f; lz = 0.0f; }
+        }
+        if (vz != 0.0f) {
+            float face = vz < 0.0f ? b.hz + r : -b.hz - r;
+            t = (face - pz) / vz;
+            if (t >= 0.0f && t < best && fabsf(px + vx * t) <= b.hx) { best = t; lx = 0.0f; lz = vz < 0.0f ? 1.0f : -1.0f; }
+        }
+
+        // Corners (the round parts)
+        const float cornerX[4] = { -b.hx, b.hx, b.hx, -b.hx };
+        const float cornerZ[4] = { -b.hz, -b.hz, b.hz, b.hz };
+        for (int i = 0; i < 4; ++i) {
+            float cx = px - cornerX[i], cz = pz - cornerZ[i];
+            if (rayCircle(cx, cz, vx, vz, r, t) && t >= 0.0f && t < best) {
+                best = t;
+                lx = (cx + vx * t) / r;
+                lz = (cz + vz * t) / r;
+            }
+        }
+        if (best > 1.0f) return false;
+    }
+
+    toi = best;
+    nx = lx * b.ux - lz * b.uz;
+    nz = lx * b.uz + lz * b.ux;
+    return true;
+}
+
+bool CollisionWorld::sweepCircle(float x, float z, float radius, float dx, float dz, SweepHit& out, float stepY) const {
+    out.hit = false;
+    out.toi = 1.0f;
+    out.normalX = out.normalZ = 0.0f;
+    out.slideX = out.slideZ = 0.0f;
+    out.box = -1;
+    out.kind = -1;
+
+    float minX = fminf(x, x + dx) - radius, maxX = fmaxf(x, x + dx) + radius;
+    float minZ = fminf(z, z + dz) - radius, maxZ = fmaxf(z, z + dz) + radius;
+
+    query(minX, minZ, maxX, maxZ, [&](int index, const Box& b) {
+        if (b.top <= stepY) return;
+        float toi, nx, nz;
+        if (!sweepBox(b, x, z, radius, dx, dz, toi, nx, nz)) return;
+        if (out.hit && toi >= out.toi) return;
+        out.hit = true;
+        out.toi = toi;
+        out.normalX = nx;
+        out.normalZ = nz;
+        out.box = index;
+        out.kind = b.kind;
+    });
+
+    if (out.hit) {
+        // What is left of the motion, minus the part going into the surface
+        float restX = dx * (1.0f - out.toi), restZ = dz * (1.0f - out.toi);
+        float into = restX * out.normalX + restZ * out.normalZ;
+        out.slideX = restX - out.normalX * into;
+        out.slideZ = restZ - out.normalZ * into;
+    }
+    return out.hit;
+}
+
+bool CollisionWorld::overlapsCircle(float x, float z, float radius) const {
+    bool overlap = false;
+    query(x - radius, z - radius, x + radius, z + radius, [&](int, const Box& b) {
+        if (overlap) return;
+        float rx = x - b.cx, rz = z - b.cz;
+        float px = fabsf(rx * b.ux + rz * b.uz) - b.hx;
+        float pz = fabsf(-rx * b.uz + rz * b.ux) - b.hz;
+        px = fmaxf(px, 0.0f);
+        pz = fmaxf(pz, 0.0f);
+        if (px * px + pz * pz < radius * radius) overlap = true;
+    });
+    return overlap;
+}
+
+void CollisionWorld::findBoxes(float minX, float minZ, float maxX, float maxZ, std::vector<ColliderShape>& out) const {
+    query(minX, minZ, maxX, maxZ, [&](int, const Box& b) {
+        ColliderShape s = { b.cx, b.cz, b.ux, b.uz, b.hx, b.hz, b.top, b.kind };
+        out.push_back(s);
+    });
+}
+
+bool CollisionWorld::moveAndSlide(float& x, float& z, float radius, float dx, float dz, int maxIterations, float stepY) const {
+    bool hitAny = false;
+    for (int i = 0; i < maxIterations; ++i) {
+        if (dx == 0.0f && dz == 0.0f) break;
+
+        SweepHit hit;
+        if (!sweepCircle(x, z, radius, dx, dz, hit, stepY)) {
+            x += dx;
+            z += dz;
+            return hitAny;
+        }
+        hitAny = true;
+
+        // Stop just short of the surface, then continue along it
+        float len = sqrtf(dx * dx + dz * dz);
+        float t = fmaxf(0.0f, hit.toi - CONTACT_SKIN / len);
+        x += dx * t;
+        z += dz * t;
+        dx = hit.slideX;
+        dz = hit.slideZ;
+    }
+    return hitAny;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <vector>
+#include "Footprint.h"
+
+// ================================================================
+// CollisionWorld
+//
+// Exact 2D collision on the floor plane for round movers (the player,
+// NPCs). Every solid object is an oriented box (walls, towers, door posts
+// and doorways, furniture) and all boxes sit in a static bounding volume
+// hierarchy built once per layout.
+//
+// sweepCircle() moves a circle along a straight path and returns the time
+// of impact, the contact normal and the slide vector (the rest of the
+// motion along the surface), so fast movers cannot tunnel through thin
+// walls and slide smoothly along them instead of snagging on cell corners.
+//
+// Boxes can be switched off without rebuilding (doors that open).
+//
+// Each box also has a top height. Movers whose feet are high enough pass
+// over low boxes (stepY), which is how the player climbs onto furniture;
+// walls and doors reach the ceiling (COLLIDER_FULL_HEIGHT).
+// ================================================================
+
+// Top of a collider nothing can get over
+const float COLLIDER_FULL_HEIGHT = 1e30f;
+
+
+// What a collider belongs to (SweepHit::kind)
+enum ColliderKind {
+    COLLIDER_BOUNDARY = 0,
+    COLLIDER_WALL,
+    COLLIDER_TOWER,
+    COLLIDER_DOOR,
+    COLLIDER_DECOR
+};
+
+// A collider's oriented box, for code that does its own contact tests
+struct ColliderShape {
+    float cx, cz;          // Center
+    float ux, uz;          // Local X axis (local Z is (-uz, ux))
+    float hx, hz;          // Half extents
+    float top;             // Height of the top surface
+    int kind;
+};
+
+struct SweepHit {
+    bool hit;
+    float toi;               // Fraction of the motion before contact (0..1)
+    float normalX, normalZ;  // Contact normal, pointing away from the box
+    float slideX, slideZ;    // Remaining motion projected onto the contact surface
+    int box;                 // Collider index, -1 if nothing was hit
+    int kind;                // ColliderKind of the collider hit
+};
+
+class CollisionWorld {
+public:
+    CollisionWorld();
+
+    /**
+     * @brief Removes every collider.
+     */
+    void clear();
+
+    /**
+     * @brief Adds an oriented box (rotation like glRotatef about Y).
+     * @param top Height of its top surface.
+     * @return Collider index, valid until the next clear().
+     */
+    int addBox(float x, float z, float rotationDeg, const FootprintBox& box, int kind, float top = COLLIDER_FULL_HEIGHT);
+
+    /**
+     * @brief Adds a thick segment (ends extended by half the thickness).
+     */
+    int addSegment(float startX, float startZ, float endX, float endZ, float thickness, int kind);
+
+    /**
+     * @brief Builds the hierarchy. Call after adding colliders, before queries.
+     */
+    void build();
+
+    /**
+     * @brief Turns a collider on or off (e.g. a door opening) without a rebuild.
+     */
+    void setEnabled(int box, bool enabled);
+
+    int getBoxCount() const { return (int)m_boxes.size(); }
+    bool isBuilt() const { return !m_nodes.empty(); }
+
+    /**
+     * @brief Sweeps a circle from (x, z) by (dx, dz) and reports the first contact.
+     * A circle that already overlaps a box only hits it while moving further in.
+     * @param stepY Boxes whose top is at or below this height are passed over.
+     */
+    bool sweepCircle(float x, float z, float radius, float dx, float dz, SweepHit& out,
+        float stepY = -COLLIDER_FULL_HEIGHT) const;
+
+    /**
+     * @brief True if a circle at (x, z) overlaps any enabled collider.
+     */
+    bool overlapsCircle(float x, float z, float radius) const;
+
+    /**
+     * @brief Moves a circle by (dx, dz), sliding along whatever it hits.
+     * @param maxIterations Number of surfaces the motion may slide along.
+     * @return True if anything was hit (x, z hold the final position).
+     */
+    bool moveAndSlide(float& x, float& z, float radius, float dx, float dz, int maxIterations = 3,
+        float stepY = -COLLIDER_FULL_HEIGHT) const;
+
+    /**
+     * @brief Appends every enabled collider whose bounds overlap a world rectangle.
+     */
+    void findBoxes(float minX, float minZ, float maxX, float maxZ, std::vector<ColliderShape>& out) const;
+
+private:
+    struct Box {
+        float cx, cz;          // Center
+        float ux, uz;          // Local X axis (local Z is (-uz, ux))
+        float hx, hz;          // Half extents
+        float top;
+        float minX, minZ, maxX, maxZ; // World bounds
+        int kind;
+        bool enabled;
+    };
+
+    struct Node {
+        float minX, minZ, maxX, maxZ;
+        int first;             // Leaf: first index into m_order. Inner: left child
+        int count;             // Leaf: number of boxes. Inner: 0 (right child = left + 1)
+    };
+
+    void buildNode(int index, int first, int count);
+    bool sweepBox(const Box& b, float x, float z, float r, float dx, float dz, float& toi, float& nx, float& nz) const;
+
+    template <typename Fn>
+    void query(float minX, float minZ, float maxX, float maxZ, Fn fn) const;
+
+    std::vector<Box> m_boxes;
+    std::vector<int> m_order;   // Box indices grouped by leaf
+    std::vector<Node> m_nodes;
+};
+
+extern CollisionWorld g_collisionWorld;
@@ -0,0 +1,519 @@
+// Crowd.cpp : Ambient characters stored as arrays, stepped in parallel chunks.
+//
+#include "pch.h" // Must be first
+#include "Crowd.h"
+#include "JobSystem.h"
+#include "PathHierarchy.h"
+#include "Visibility.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+Crowd g_crowd;
+
+namespace {
+
+const float AGENT_RADIUS = 0.3f;
+const float NEIGHBOUR_RADIUS = 1.0f;      // Agents closer than this push apart (also the bucket size)
+const float PLAYER_RADIUS = 1.5f;
+const float WALL_DISTANCE = 0.8f;         // Clearance below which agents turn away from walls
+const float WAYPOINT_RADIUS = 0.4f;
+const float MAX_ACCEL = 6.0f;
+const float WANDER_RADIUS = 12.0f;
+const float DRAW_DISTANCE = 40.0f;
+const int STEP_GRAIN = 256;               // Agents per job chunk
+
+// Body size: the camera's eye is 2.2 units above the floor
+const float BODY_WIDTH = 0.6f, BODY_HEIGHT = 1.6f, BODY_DEPTH = 0.35f;
+const float HEAD_SIZE = 0.4f;
+
+const unsigned char ROLE_COLORS[NPC_ROLE_COUNT][3] = {
+    { 40, 50, 110 },    // Guard: dark blue uniform
+    { 150, 90, 60 },    // Visitor (varied per agent below)
+};
+
+inline float randomRange(std::mt19937& rng, float lo, float hi) {
+    return std::uniform_real_distribution<float>(lo, hi)(rng);
+}
+
+} // namespace
+
+// ================================================================
+// Agents
+// ================================================================
+
+Crowd::Crowd()
+    : m_bucketMask(0), m_playerX(0.0f), m_playerZ(0.0f), m_jobs(nullptr), m_hierarchy(nullptr),
+    m_planBudget(8), m_planCursor(0), m_lastPlanned(0), m_rng(4321)
+{
+}
+
+int Crowd::addAgent(int role, float x, float z, float patrolX, float patrolZ) {
+    if (role < 0 || role >= NPC_ROLE_COUNT) role = NPC_VISITOR;
+    m_posX.push_back(x);        m_posZ.push_back(z);
+    m_prevX.push_back(x);       m_prevZ.push_back(z);
+    m_velX.push_back(0.0f);     m_velZ.push_back(0.0f);
+    m_newVelX.push_back(0.0f);  m_newVelZ.push_back(0.0f);
+    m_dirX.push_back(0.0f);     m_dirZ.push_back(1.0f);
+    m_goalX.push_back(x);       m_goalZ.push_back(z);
+    m_maxSpeed.push_back(role == NPC_GUARD ? 1.6f : randomRange(m_rng, 0.9f, 1.3f));
+    m_waitTime.push_back(randomRange(m_rng, 0.0f, 2.0f));
+    m_stuckTime.push_back(0.0f);
+    m_needsPath.push_back(1);
+    m_role.push_back((unsigned char)role);
+
+    m_homeX.push_back(x);       m_homeZ.push_back(z);
+    m_patrolX.push_back(patrolX);
+    m_patrolZ.push_back(patrolZ);
+    m_patrolLeg.push_back(0);
+    m_paths.push_back(std::vector<PathPoint>());
+    m_pathNext.push_back(0);
+    m_agentBucket.push_back(0);
+    return (int)m_posX.size() - 1;
+}
+
+void Crowd::clear() {
+    m_posX.clear();     m_posZ.clear();
+    m_prevX.clear();    m_prevZ.clear();
+    m_velX.clear();     m_velZ.clear();
+    m_newVelX.clear();  m_newVelZ.clear();
+    m_dirX.clear();     m_dirZ.clear();
+    m_goalX.clear();    m_goalZ.clear();
+    m_maxSpeed.clear();
+    m_waitTime.clear();
+    m_stuckTime.clear();
+    m_needsPath.clear();
+    m_role.clear();
+    m_homeX.clear();    m_homeZ.clear();
+    m_patrolX.clear();  m_patrolZ.clear();
+    m_patrolLeg.clear();
+    m_paths.clear();
+    m_pathNext.clear();
+    m_agentBucket.clear();
+    m_bucketAgents.clear();
+    m_visible.clear();
+    m_vertices.clear();
+    m_planCursor = 0;
+}
+
+// ================================================================
+// Step
+// ================================================================
+
+void Crowd::update(const CollisionGrid& grid, const DistanceField& field, Pathfinder& planner, float dt) {
+    int n = getCount();
+    m_lastPlanned = 0;
+    if (n == 0) return;
+
+    m_prevX = m_posX;
+    m_prevZ = m_posZ;
+
+    buildBuckets();
+    if (planner.isReady()) plan(grid, planner);
+
+    JobSystem* jobs = m_jobs;
+    JobRange steerRange = [&](int begin, int end) { steer(begin, end, field, dt); };
+    JobRange moveRange = [&](int begin, int end) { move(begin, end, grid, field, dt); };
+    if (jobs) {
+        jobs->parallelFor(n, STEP_GRAIN, steerRange, "crowd steer");
+        jobs->parallelFor(n, STEP_GRAIN, moveRange, "crowd move");
+    }
+    else {
+        steerRange(0, n);
+        moveRange(0, n);
+    }
+}
+
+int Crowd::bucketOf(int cx, int cz) const {
+    unsigned int h = (unsigned int)cx * 73856093u ^ (unsigned int)cz * 19349663u;
+    return (int)(h & (unsigned int)m_bucketMask);
+}
+
+// Counting sort of the agents by bucket: a count pass, a prefix sum and a scatter
+void Crowd::buildBuckets() {
+    int n = getCount();
+    int buckets = 1;
+    while (buckets < n * 2) buckets <<= 1;
+    m_bucketMask = buckets - 1;
+
+    m_bucketStart.assign(buckets + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        int cx = (int)floorf(m_posX[i] * (1.0f / NEIGHBOUR_RADIUS));
+        int cz = (int)floorf(m_posZ[i] * (1.0f / NEIGHBOUR_RADIUS));
+        m_agentBucket[i] = bucketOf(cx, cz);
+        m_bucketStart[m_agentBucket[i] + 1]++;
+    }
+    for (int b = 0; b < buckets; ++b) m_bucketStart[b + 1] += m_bucketStart[b];
+
+    m_bucketAgents.resize(n);
+    m_bucketFill.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (int i = 0; i < n; ++i) m_bucketAgents[m_bucketFill[m_agentBucket[i]]++] = i;
+}
+
+bool Crowd::pickDestination(const CollisionGrid& grid, int i, float& outX, float& outZ) {
+    if (m_role[i] == NPC_GUARD) {
+        m_patrolLeg[i] ^= 1;
+        outX = m_patrolLeg[i] ? m_patrolX[i] : m_homeX[i];
+        outZ = m_patrolLeg[i] ? m_patrolZ[i] : m_homeZ[i];
+        return true;
+    }
+    // A few tries at a walkable spot around the agent
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        float x = m_posX[i] + randomRange(m_rng, -WANDER_RADIUS, WANDER_RADIUS);
+        float z = m_posZ[i] + randomRange(m_rng, -WANDER_RADIUS, WANDER_RADIUS);
+        int cx, cz;
+        if (grid.worldToCell(x, z, cx, cz) && !grid.get(cx, cz)) {
+            grid.cellCenter(cx, cz, outX, outZ);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Serial: the Pathfinder and the hierarchy keep their search state between calls
+void Crowd::plan(const CollisionGrid& grid, Pathfinder& planner) {
+    int n = getCount();
+    for (int k = 0; k < n && m_lastPlanned < m_planBudget; ++k) {
+        int i = m_planCursor;
+        m_planCursor = (m_planCursor + 1) % n;
+        if (!m_needsPath[i] || m_waitTime[i] > 0.0f) continue;
+
+        float gx, gz;
+        std::vector<PathPoint>& path = m_paths[i];
+        bool found = pickDestination(grid, i, gx, gz);
+        if (found) {
+            // Long routes, or short ones a bounded flat search gives up on, go
+            // over the doorways of the hierarchy (see PathHierarchy::findRoute)
+            found = m_hierarchy ? m_hierarchy->findRoute(m_posX[i], m_posZ[i], gx, gz, path, planner)
+                : planner.findPath(m_posX[i], m_posZ[i], gx, gz, path);
+            found = found && path.size() >= 2;
+        }
+        m_lastPlanned++;
+
+        if (!found) {
+            path.clear();
+            m_waitTime[i] = randomRange(m_rng, 1.0f, 3.0f); // Try somewhere else later
+            continue;
+        }
+        m_pathNext[i] = 1;
+        m_goalX[i] = path[1].x;
+        m_goalZ[i] = path[1].z;
+        m_needsPath[i] = 0;
+        m_stuckTime[i] = 0.0f;
+    }
+}
+
+// Parallel: writes only agent i's entries, reads the positions of others
+void Crowd::steer(int begin, int end, const DistanceField& field, float dt) {
+    const float neighbourSq = NEIGHBOUR_RADIUS * NEIGHBOUR_RADIUS;
+    for (int i = begin; i < end; ++i) {
+        float px = m_posX[i], pz = m_posZ[i];
+        float wantX = 0.0f, wantZ = 0.0f;
+
+        if (m_waitTime[i] > 0.0f) {
+            m_waitTime[i] -= dt;
+        }
+        else if (!m_needsPath[i]) {
+            // Path following: advance past reached waypoints, slow down for the last one
+            std::vector<PathPoint>& path = m_paths[i];
+            float dx = m_goalX[i] - px, dz = m_goalZ[i] - pz;
+            float dist = sqrtf(dx * dx + dz * dz);
+            bool last = m_pathNext[i] + 1 >= (int)path.size();
+            if (dist < WAYPOINT_RADIUS) {
+                if (last) {
+                    m_needsPath[i] = 1;
+                    m_waitTime[i] = m_role[i] == NPC_GUARD ? 1.5f : 1.0f + (float)(i % 5);
+                }
+                else {
+                    int next = ++m_pathNext[i];
+                    m_goalX[i] = path[next].x;
+                    m_goalZ[i] = path[next].z;
+                    dx = m_goalX[i] - px; dz = m_goalZ[i] - pz;
+                    dist = sqrtf(dx * dx + dz * dz);
+                }
+            }
+            if (!m_needsPath[i] && dist > 1e-4f) {
+                float speed = m_maxSpeed[i];
+                if (last && dist < 1.0f) speed *= dist;
+                wantX = dx / dist * speed;
+                wantZ = dz / dist * speed;
+            }
+        }
+
+        // Separation from the agents in the 3 x 3 surrounding buckets
+        float pushX = 0.0f, pushZ = 0.0f;
+        int cx = (int)floorf(px * (1.0f / NEIGHBOUR_RADIUS));
+        int cz = (int)floorf(pz * (1.0f / NEIGHBOUR_RADIUS));
+        for (int bz = cz - 1; bz <= cz + 1; ++bz) {
+            for (int bx = cx - 1; bx <= cx + 1; ++bx) {
+                int b = bucketOf(bx, bz);
+                for (int k = m_bucketStart[b]; k < m_bucketStart[b + 1]; ++k) {
+                    int j = m_bucketAgents[k];
+                    if (j == i) continue;
+                    float ox = px - m_posX[j], oz = pz - m_posZ[j];
+                    float d2 = ox * ox + oz * oz;
+                    if (d2 >= neighbourSq) continue; // Also drops hash collisions
+                    if (d2 < 1e-8f) { ox = (float)((i & 1) * 2 - 1) * 0.01f; oz = 0.0f; d2 = 1e-4f; }
+                    float d = sqrtf(d2);
+                    float strength = (NEIGHBOUR_RADIUS - d) / NEIGHBOUR_RADIUS;
+                    pushX += ox / d * strength;
+                    pushZ += oz / d * strength;
+                }
+            }
+        }
+        float ox = px - m_playerX, oz = pz - m_playerZ;
+        float d2 = ox * ox + oz * oz;
+        if (d2 < PLAYER_RADIUS * PLAYER_RADIUS && d2 > 1e-8f) {
+            float d = sqrtf(d2);
+            float strength = 2.0f * (PLAYER_RADIUS - d) / PLAYER_RADIUS;
+            pushX += ox / d * strength;
+            pushZ += oz / d * strength;
+        }
+        wantX += pushX * 2.0f;
+        wantZ += pushZ * 2.0f;
+
+        // Turn away from walls before touching them
+        if (field.isReady()) {
+            float clear = field.clearance(px, pz);
+            if (clear < WALL_DISTANCE) {
+                float gx, gz;
+                field.gradient(px, pz, gx, gz);
+                float strength = (WALL_DISTANCE - clear) / WALL_DISTANCE * 2.0f;
+                wantX += gx * strength;
+                wantZ += gz * strength;
+            }
+        }
+
+        // Limited acceleration toward the wanted velocity
+        float ax = (wantX - m_velX[i]) / dt, az = (wantZ - m_velZ[i]) / dt;
+        float a2 = ax * ax + az * az;
+        if (a2 > MAX_ACCEL * MAX_ACCEL) {
+            float s = MAX_ACCEL / sqrtf(a2);
+            ax *= s; az *= s;
+        }
+        float vx = m_velX[i] + ax * dt, vz = m_velZ[i] + az * dt;
+        float v2 = vx * vx + vz * vz, top = m_maxSpeed[i] * 1.5f;
+        if (v2 > top * top) {
+            float s = top / sqrtf(v2);
+            vx *= s; vz *= s;
+        }
+        m_newVelX[i] = vx;
+        m_newVelZ[i] = vz;
+    }
+}
+
+bool Crowd::blockedAt(const CollisionGrid& grid, const DistanceField& field, float x, float z) const {
+    // Far from everything the distance field answers without touching the grid
+    if (field.isReady() && field.minClearance(x, z) > AGENT_RADIUS) return false;
+    int x0, z0, x1, z1;
+    grid.worldToCell(x - AGENT_RADIUS, z - AGENT_RADIUS, x0, z0);
+    grid.worldToCell(x + AGENT_RADIUS, z + AGENT_RADIUS, x1, z1);
+    return grid.anyInRect(x0, z0, x1, z1);
+}
+
+// Parallel: writes only agent i's entries
+void Crowd::move(int begin, int end, const CollisionGrid& grid, const DistanceField& field, float dt) {
+    for (int i = begin; i < end; ++i) {
+        float vx = m_newVelX[i], vz = m_newVelZ[i];
+        float x = m_posX[i], z = m_posZ[i];
+
+        // One axis at a time, so a blocked axis still lets the agent slide along the other
+        float nx = x + vx * dt;
+        if (!blockedAt(grid, field, nx, z)) x = nx;
+        else vx = 0.0f;
+        float nz = z + vz * dt;
+        if (!blockedAt(grid, field, x, nz)) z = nz;
+        else vz = 0.0f;
+
+        float moved = fabsf(x - m_posX[i]) + fabsf(z - m_posZ[i]);
+        m_posX[i] = x;
+        m_posZ[i] = z;
+        m_velX[i] = vx;
+        m_velZ[i] = vz;
+
+        // Turn smoothly toward the direction of motion
+        float speed = sqrtf(vx * vx + vz * vz);
+        if (speed > 0.05f) {
+            float t = std::min(1.0f, dt * 8.0f);
+            float fx = m_dirX[i] + (vx / speed - m_dirX[i]) * t;
+            float fz = m_dirZ[i] + (vz / speed - m_dirZ[i]) * t;
+            float len = sqrtf(fx * fx + fz * fz);
+            if (len > 1e-4f) { m_dirX[i] = fx / len; m_dirZ[i] = fz / len; }
+        }
+
+        // Walking but going nowhere (blocked by a door that closed, a crowd): pick again
+        if (!m_needsPath[i] && m_waitTime[i] <= 0.0f) {
+            m_stuckTime[i] = moved < m_maxSpeed[i] * dt * 0.1f ? m_stuckTime[i] + dt : 0.0f;
+            if (m_stuckTime[i] > 2.0f) {
+                m_needsPath[i] = 1;
+                m_stuckTime[i] = 0.0f;
+            }
+        }
+    }
+}
+
+// ================================================================
+// Rendering
+// ================================================================
+
+void Crowd::buildBodyMesh() {
+    m_body.clear();
+    m_bodyPart.clear();
+    m_body.beginBatch(-1);
+    m_body.addBox(0.0f, BODY_HEIGHT / 2.0f, 0.0f, BODY_WIDTH, BODY_HEIGHT, BODY_DEPTH, false);
+    m_bodyPart.resize(m_body.vertices.size(), 0);
+    m_body.addBox(0.0f, BODY_HEIGHT + HEAD_SIZE / 2.0f + 0.05f, 0.0f, HEAD_SIZE, HEAD_SIZE, HEAD_SIZE, false);
+    // Nose, so the way an agent faces shows from a distance
+    m_body.addBox(0.0f, BODY_HEIGHT + HEAD_SIZE / 2.0f + 0.05f, HEAD_SIZE / 2.0f + 0.05f, 0.1f, 0.1f, 0.1f, false);
+    m_bodyPart.resize(m_body.vertices.size(), 1);
+}
+
+int Crowd::buildVertices(float alpha, float camX, float camZ) {
+    if (m_body.vertices.empty()) buildBodyMesh();
+    int n = getCount();
+
+    // Which agents to draw (serial: the list is compacted in order)
+    m_visible.clear();
+    const float drawSq = DRAW_DISTANCE * DRAW_DISTANCE;
+    for (int i = 0; i < n; ++i) {
+        float dx = m_posX[i] - camX, dz = m_posZ[i] - camZ;
+        if (dx * dx + dz * dz > drawSq) continue;
+        if (g_visibility.isReady() && !g_visibility.isVisible(m_posX[i], m_posZ[i], 1.0f)) continue;
+        m_visible.push_back(i);
+    }
+
+    // Expand one body per visible agent, each into its own slice of the array
+    const int per = (int)m_body.vertices.size();
+    int count = (int)m_visible.size();
+    m_vertices.resize((size_t)count * per);
+    JobRange expand = [&](int begin, int end) {
+        for (int k = begin; k < end; ++k) {
+            int i = m_visible[k];
+            float x = m_prevX[i] + (m_posX[i] - m_prevX[i]) * alpha;
+            float z = m_prevZ[i] + (m_posZ[i] - m_prevZ[i]) * alpha;
+            float c = m_dirZ[i], s = m_dirX[i]; // Rotates local +Z onto the facing
+
+            unsigned char clothes[3] = { ROLE_COLORS[m_role[i]][0], ROLE_COLORS[m_role[i]][1], ROLE_COLORS[m_role[i]][2] };
+            if (m_role[i] == NPC_VISITOR) {
+                unsigned int h = (unsigned int)i * 2654435761u;
+                clothes[0] = (unsigned char)(80 + (h >> 8) % 160);
+                clothes[1] = (unsigned char)(80 + (h >> 16) % 160);
+                clothes[2] = (unsigned char)(80 + (h >> 24) % 160);
+            }
+
+            Vertex* out = &m_vertices[(size_t)k * per];
+            for (int v = 0; v < per; ++v) {
+                const BakedVertex& b = m_body.vertices[v];
+                Vertex& o = out[v];
+                if (m_bodyPart[v]) { o.r = 225; o.g = 180; o.b = 150; }
+                else { o.r = clothes[0]; o.g = clothes[1]; o.b = clothes[2]; }
+                o.a = 255;
+                o.nx = b.nx * c + b.nz * s;
+                o.ny = b.ny;
+                o.nz = -b.nx * s + b.nz * c;
+                o.x = x + b.x * c + b.z * s;
+                o.y = b.y;
+                o.z = z - b.x * s + b.z * c;
+            }
+        }
+    };
+    if (m_jobs) m_jobs->parallelFor(count, 64, expand, "crowd vertices");
+    else expand(0, count);
+    return count;
+}
+
+void Crowd::draw() const {
+    if (m_vertices.empty()) return;
+
+    glDisable(GL_TEXTURE_2D);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &m_vertices[0].r);
+    glNormalPointer(GL_FLOAT, sizeof(Vertex), &m_vertices[0].nx);
+    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &m_vertices[0].x);
+
+    glDrawArrays(GL_QUADS, 0, (GLsizei)m_vertices.size());
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glColor3f(1.0f, 1.0f, 1.0f); // Reset color
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+void Crowd::runBenchmark(int count) {
+    typedef std::chrono::steady_clock Clock;
+    if (count < 1) count = 1;
+
+    // The shared benchmark venue: 50 x 50 rooms joined by doorways, some furniture.
+    // Sized for about 50 agents per room.
+    int size = 100;
+    while ((size / 50) * (size / 50) * 50 < count) size += 50;
+    CollisionGrid grid;
+    makeBenchmarkVenue(grid, size);
+    std::uniform_int_distribution<int> pos(0, size - 1);
+    DistanceField field;
+    field.build(grid, 4.0f);
+    Pathfinder planner;
+    planner.build(grid);
+
+    // Same crowd twice: on one thread and on the JobSystem
+    Crowd crowds[2];
+    for (int c = 0; c < 2; ++c) {
+        std::mt19937 spawn(99);
+        for (int i = 0; i < count; ++i) {
+            int x, z;
+            do { x = pos(spawn); z = pos(spawn); } while (grid.get(x, z));
+            float wx, wz, px, pz;
+            grid.cellCenter(x, z, wx, wz);
+            grid.cellCenter(std::min(size - 1, x + 8), z, px, pz);
+            crowds[c].addAgent(i % 10 == 0 ? NPC_GUARD : NPC_VISITOR, wx, wz, px, pz);
+        }
+        crowds[c].setPlanBudget(64);
+        crowds[c].setPlayer(1e6f, 1e6f);
+    }
+    JobSystem jobs;
+    jobs.start();
+    crowds[1].setJobSystem(&jobs);
+
+    const float dt = 1.0f / 120.0f;
+    const int steps = 600;
+    double stepMs[2] = { 0.0, 0.0 }, worstMs[2] = { 0.0, 0.0 };
+    int planned = 0;
+    for (int c = 0; c < 2; ++c) {
+        for (int s = 0; s < steps; ++s) {
+            Clock::time_point t0 = Clock::now();
+            crowds[c].update(grid, field, planner, dt);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            stepMs[c] += ms;
+            worstMs[c] = std::max(worstMs[c], ms);
+            if (c == 0) planned += crowds[c].getLastPlanned();
+        }
+    }
+
+    // Agents only write their own entries, so both runs must agree exactly
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        if (crowds[0].m_posX[i] != crowds[1].m_posX[i] || crowds[0].m_posZ[i] != crowds[1].m_posZ[i]) mismatches++;
+    }
+
+    // Vertex expansion of the agents within draw distance of the venue center
+    Clock::time_point t0 = Clock::now();
+    int drawn = 0;
+    const int frames = 60;
+    for (int f = 0; f < frames; ++f) drawn = crowds[1].buildVertices(0.5f, 0.0f, 0.0f);
+    double expandMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / frames;
+
+    printf("Crowd benchmark (%d agents, %dx%d venue, %d steps at 120 Hz):\n", count, size, size, steps);
+    printf("  1 thread : %.3f ms per step (worst %.3f ms)\n", stepMs[0] / steps, worstMs[0]);
+    printf("  %d threads: %.3f ms per step (worst %.3f ms), %.1fx\n", jobs.getWorkerCount() + 1,
+        stepMs[1] / steps, worstMs[1], stepMs[0] / std::max(stepMs[1], 1e-6));
+    printf("  %d paths planned, %d agents differ between runs\n", planned, mismatches);
+    printf("  Vertex expansion: %d agents in view, %.3f ms per frame\n", drawn, expandMs);
+    jobs.stop();
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <glut.h>
+#include <vector>
+#include <random>
+#include "CollisionGrid.h"
+#include "DistanceField.h"
+#include "Pathfinder.h"
+#include "BakedMesh.h"
+
+class JobSystem;
+class PathHierarchy;
+
+// ================================================================
+// Crowd
+//
+// Ambient characters walking around the level: guards patrol between two
+// points, visitors wander from spot to spot and pause for a while.
+//
+// Agents are stored as a structure of arrays (one array per field), so
+// the per-step loops stream through exactly the data they use. A step:
+//  - bucket the agents into a hashed grid (counting sort, one pass)
+//  - plan paths with the Pathfinder for agents that need one, a few per
+//    step so a whole crowd asking at once never stalls a frame; routes
+//    across a large venue (hundreds of cells) go through the PathHierarchy
+//  - steer (in parallel chunks on the JobSystem): seek the next waypoint,
+//    keep apart from neighbours in the surrounding buckets and from the
+//    player, and turn away from walls using the distance field
+//  - move (in parallel): each axis separately against the collision
+//    grid, so agents slide along walls and never walk through them
+// Every agent only writes its own entries, so the parallel passes need
+// no locks and give the same result as a single thread.
+//
+// Drawing expands one small body mesh per visible agent into a single
+// vertex array (the fixed function version of instancing) and draws all
+// of them with one call.
+// ================================================================
+
+enum NpcRole {
+    NPC_GUARD = 0,    // Patrols back and forth between its post and a second point
+    NPC_VISITOR = 1,  // Wanders to random spots nearby
+    NPC_ROLE_COUNT
+};
+
+class Crowd {
+public:
+    Crowd();
+
+    /**
+     * @brief Adds an agent standing at (x, z).
+     * @param patrolX, patrolZ Second end of a guard's patrol (ignored for visitors).
+     * @return Agent index.
+     */
+    int addAgent(int role, float x, float z, float patrolX = 0.0f, float patrolZ = 0.0f);
+    void clear();
+
+    int getCount() const { return (int)m_posX.size(); }
+    float getX(int i) const { return m_posX[i]; }
+    float getZ(int i) const { return m_posZ[i]; }
+
+    /**
+     * @brief Where the player is (agents keep out of their way).
+     */
+    void setPlayer(float x, float z) { m_playerX = x; m_playerZ = z; }
+
+    /**
+     * @brief Jobs used for the parallel passes (nullptr = single thread).
+     */
+    void setJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+
+    /**
+     * @brief Hierarchy that plans long routes through PathHierarchy::findRoute
+     * (nullptr = the Pathfinder plans every route). Kept up to date by the caller.
+     */
+    void setPathHierarchy(PathHierarchy* hierarchy) { m_hierarchy = hierarchy; }
+
+    /**
+     * @brief Paths planned per step at most.
+     */
+    void setPlanBudget(int paths) { m_planBudget = paths; }
+
+    /**
+     * @brief Advances every agent by one step.
+     * @param field Distance field of the grid, used for wall avoidance (may be empty).
+     */
+    void update(const CollisionGrid& grid, const DistanceField& field, Pathfinder& planner, float dt);
+
+    /**
+     * @brief Fills the vertex array with every agent visible from the camera,
+     * placed between the last two steps by 'alpha'.
+     * @return Number of agents written.
+     */
+    int buildVertices(float alpha, float camX, float camZ);
+
+    /**
+     * @brief Draws the agents. Call buildVertices() first.
+     */
+    void draw() const;
+
+    // Stats of the last update()
+    int getLastPlanned() const { return m_lastPlanned; }
+
+    /**
+     * @brief Times steps of 'count' agents on a generated venue, single
+     * threaded and on the JobSystem, printed to the console.
+     */
+    static void runBenchmark(int count);
+
+    // Vertex of the expanded body meshes
+    struct Vertex {
+        unsigned char r, g, b, a;
+        float nx, ny, nz;
+        float x, y, z;
+    };
+
+private:
+    void buildBuckets();
+    void plan(const CollisionGrid& grid, Pathfinder& planner);
+    bool pickDestination(const CollisionGrid& grid, int i, float& outX, float& outZ);
+    void steer(int begin, int end, const DistanceField& field, float dt);
+    void move(int begin, int end, const CollisionGrid& grid, const DistanceField& field, float dt);
+    bool blockedAt(const CollisionGrid& grid, const DistanceField& field, float x, float z) const;
+    int bucketOf(int cellX, int cellZ) const;  // Hashed bucket of a NEIGHBOUR_RADIUS sized cell
+    void buildBodyMesh();
+
+    // Hot, touched every step
+    std::vector<float> m_posX, m_posZ;
+    std::vector<float> m_prevX, m_prevZ;      // Position at the previous step (render interpolation)
+    std::vector<float> m_velX, m_velZ;
+    std::vector<float> m_newVelX, m_newVelZ;  // Written by steer(), applied by move()
+    std::vector<float> m_dirX, m_dirZ;        // Facing (unit length)
+    std::vector<float> m_goalX, m_goalZ;      // Current waypoint
+    std::vector<float> m_maxSpeed;
+    std::vector<float> m_waitTime;            // Seconds left to stand still
+    std::vector<float> m_stuckTime;           // Seconds spent not making progress
+    std::vector<unsigned char> m_needsPath;
+    std::vector<unsigned char> m_role;
+
+    // Cold, touched when an agent plans or reaches a waypoint
+    std::vector<float> m_homeX, m_homeZ;
+    std::vector<float> m_patrolX, m_patrolZ;
+    std::vector<unsigned char> m_patrolLeg;   // Guards: 1 = heading for the patrol point
+    std::vector<std::vector<PathPoint>> m_paths;
+    std::vector<int> m_pathNext;              // Index of the waypoint being walked to
+
+    // Neighbour buckets: agents sorted by hashed cell
+    std::vector<int> m_bucketStart;           // Size = bucket count + 1
+    std::vector<int> m_bucketAgents;
+    std::vector<int> m_agentBucket;
+    std::vector<int> m_bucketFill;            // Scatter cursors
+    int m_bucketMask;
+
+    float m_playerX, m_playerZ;
+    JobSystem* m_jobs;
+    PathHierarchy* m_hierarchy;
+    int m_planBudget;
+    int m_planCursor;                         // Where the next plan() scan starts (round robin)
+    int m_lastPlanned;
+    std::mt19937 m_rng;
+
+    // Rendering
+    BakedMesh m_body;
+    std::vector<unsigned char> m_bodyPart;    // Per body vertex: 0 = clothes, 1 = skin
+    std::vector<int> m_visible;
+    std::vector<Vertex> m_vertices;
+};
+
+extern Crowd g_crowd;
@@ -0,0 +1,239 @@
+// DistanceField.cpp : Capped Euclidean distance transform of the collision grid.
+//
+#include "pch.h" // Must be first
+#include "DistanceField.h"
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+
+DistanceField g_distanceField;
+
+// Squared distances past the cap (in cells) are treated as "no obstacle"
+static const float FAR_AWAY = 1e20f;
+
+DistanceField::DistanceField()
+    : m_width(0), m_height(0), m_cellSize(1.0f), m_originX(0.0f), m_originZ(0.0f),
+      m_maxDistance(0.0f), m_reachCells(0)
+{
+}
+
+void DistanceField::clear() {
+    m_dist.clear();
+    m_width = m_height = 0;
+}
+
+void DistanceField::build(const CollisionGrid& grid, float maxDistance) {
+    m_width = grid.getWidth();
+    m_height = grid.getHeight();
+    m_cellSize = grid.getCellSize();
+    m_originX = grid.getOriginX();
+    m_originZ = grid.getOriginZ();
+    m_maxDistance = maxDistance;
+    m_reachCells = (int)ceilf(maxDistance / m_cellSize);
+    m_dist.assign((size_t)m_width * m_height, 0.0f);
+
+    compute(grid, 0, 0, m_width - 1, m_height - 1);
+}
+
+void DistanceField::update(const CollisionGrid& grid, int x0, int z0, int x1, int z1) {
+    if (!isReady() || grid.getWidth() != m_width || grid.getHeight() != m_height) return;
+
+    // Cells further than the cap from the change cannot see it
+    x0 = x0 - m_reachCells; z0 = z0 - m_reachCells;
+    x1 = x1 + m_reachCells; z1 = z1 + m_reachCells;
+    if (x0 < 0) x0 = 0;
+    if (z0 < 0) z0 = 0;
+    if (x1 > m_width - 1) x1 = m_width - 1;
+    if (z1 > m_height - 1) z1 = m_height - 1;
+    if (x0 > x1 || z0 > z1) return;
+
+    compute(grid, x0, z0, x1, z1);
+}
+
+void DistanceField::updateArea(const CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ) {
+    int x0, z0, x1, z1;
+    grid.worldToCell(minX, minZ, x0, z0);
+    grid.worldToCell(maxX, maxZ, x1, z1);
+    update(grid, x0, z0, x1, z1);
+}
+
+void DistanceField::compute(const CollisionGrid& grid, int x0, int z0, int x1, int z1) {
+    // Window of cells that can be within the cap of the output region
+    const int R = m_reachCells;
+    const int wx0 = x0 - R < 0 ? 0 : x0 - R;
+    const int wx1 = x1 + R > m_width - 1 ? m_width - 1 : x1 + R;
+    const int wz0 = z0 - R < 0 ? 0 : z0 - R;
+    const int wz1 = z1 + R > m_height - 1 ? m_height - 1 : z1 + R;
+    const int W = wx1 - wx0 + 1;
+    const int rows = z1 - z0 + 1;
+
+    // --- Pass 1: distance to the nearest blocked cell in the same column ---
+    // Down then up, one grid row at a time (row-major reads)
+    m_column.assign((size_t)W * rows, FAR_AWAY);
+    m_sites.assign(W, R + 1);
+    int* run = m_sites.data();
+    for (int z = wz0; z <= z1; ++z) {
+        for (int i = 0; i < W; ++i) {
+            run[i] = grid.get(wx0 + i, z) ? 0 : (run[i] > R ? R + 1 : run[i] + 1);
+        }
+        if (z >= z0) {
+            float* out = &m_column[(size_t)(z - z0) * W];
+            for (int i = 0; i < W; ++i) {
+                if (run[i] <= R) out[i] = (float)(run[i] * run[i]);
+            }
+        }
+    }
+    for (int i = 0; i < W; ++i) run[i] = R + 1;
+    for (int z = wz1; z >= z0; --z) {
+        for (int i = 0; i < W; ++i) {
+            run[i] = grid.get(wx0 + i, z) ? 0 : (run[i] > R ? R + 1 : run[i] + 1);
+        }
+        float* out = &m_column[(size_t)(z - z0) * W];
+        for (int i = 0; i < W; ++i) {
+            if (run[i] <= R) {
+                float d2 = (float)(run[i] * run[i]);
+                if (d2 < out[i]) out[i] = d2;
+            }
+        }
+    }
+
+    // --- Pass 2: lower envelope of the parabolas along each row ---
+    m_envelope.resize((size_t)W + 1);
+    m_sites.resize(W);
+    int* v = m_sites.data();        // Parabola sites
+    float* b = m_envelope.data();   // Boundary where parabola k starts
+    const float maxD2 = (float)R * R;
+
+    for (int z = z0; z <= z1; ++z) {
+        const float* f = &m_column[(size_t)(z - z0) * W];
+        float* out = &m_dist[(size_t)z * m_width];
+
+        // Only cells with an obstacle in their column (within the cap) are sites
+        int k = -1;
+        for (int q = 0; q < W; ++q) {
+            if (f[q] >= FAR_AWAY) continue;
+            if (k < 0) {
+                k = 0; v[0] = q; b[0] = -FAR_AWAY; b[1] = FAR_AWAY;
+                continue;
+            }
+            // b[0] is -infinity, so this always stops at k >= 0
+            float s;
+            for (;;) {
+                s = ((f[q] + (float)q * q) - (f[v[k]] + (float)v[k] * v[k])) / (2.0f * (q - v[k]));
+                if (s > b[k]) break;
+                --k;
+            }
+            ++k; v[k] = q; b[k] = s; b[k + 1] = FAR_AWAY;
+        }
+
+        if (k < 0) {
+            for (int x = x0; x <= x1; ++x) out[x] = m_maxDistance;
+            continue;
+        }
+
+        k = 0;
+        for (int x = x0; x <= x1; ++x) {
+            int q = x - wx0;
+            while (b[k + 1] < (float)q) ++k;
+            float dq = (float)(q - v[k]);
+            float d2 = dq * dq + f[v[k]];
+            out[x] = (d2 > maxD2) ? m_maxDistance : fminf(sqrtf(d2) * m_cellSize, m_maxDistance);
+        }
+    }
+}
+
+// ================================================================
+// Queries
+// ================================================================
+
+float DistanceField::clearance(float worldX, float worldZ) const {
+    if (!isReady()) return 0.0f;
+
+    // Bilinear between the four nearest cell centers
+    float u = (worldX - m_originX) / m_cellSize - 0.5f;
+    float w = (worldZ - m_originZ) / m_cellSize - 0.5f;
+    int x = (int)floorf(u), z = (int)floorf(w);
+    float fx = u - x, fz = w - z;
+
+    float top = getCell(x, z) + (getCell(x + 1, z) - getCell(x, z)) * fx;
+    float bottom = getCell(x, z + 1) + (getCell(x + 1, z + 1) - getCell(x, z + 1)) * fx;
+    float d = top + (bottom - top) * fz;
+
+    // Center-to-center distance: the blocked cell's edge is half a cell closer
+    d -= m_cellSize * 0.5f;
+    return d > 0.0f ? d : 0.0f;
+}
+
+void DistanceField::gradient(float worldX, float worldZ, float& outX, float& outZ) const {
+    float h = m_cellSize * 0.5f;
+    float gx = clearance(worldX + h, worldZ) - clearance(worldX - h, worldZ);
+    float gz = clearance(worldX, worldZ + h) - clearance(worldX, worldZ - h);
+    float len = sqrtf(gx * gx + gz * gz);
+    if (len < 1e-6f) {
+        outX = outZ = 0.0f;
+        return;
+    }
+    outX = gx / len;
+    outZ = gz / len;
+}
+
+float DistanceField::minClearance(float worldX, float worldZ) const {
+    if (!isReady()) return 0.0f;
+    int x = (int)floorf((worldX - m_originX) / m_cellSize);
+    int z = (int)floorf((worldZ - m_originZ) / m_cellSize);
+
+    // The point and the obstacle can each be half a cell diagonal from their centers
+    float d = getCell(x, z) - m_cellSize * 1.41422f;
+    return d > 0.0f ? d : 0.0f;
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+void DistanceField::runBenchmark(int size) {
+    typedef std::chrono::steady_clock Clock;
+    const float maxDistance = 8.0f;
+
+    // Random furniture-sized boxes on about 10% of the floor
+    CollisionGrid grid(size, size, 1.0f, -size / 2.0f, -size / 2.0f);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> pos(0, size - 1), extent(0, 5);
+    for (int i = 0; i < size * size / 100; ++i) {
+        int x = pos(rng), z = pos(rng);
+        grid.fillRect(x, z, x + extent(rng), z + extent(rng), true);
+    }
+
+    // A door-sized doorway in the middle (4 x 1 cells)
+    int doorX = size / 2 - 2, doorZ = size / 2;
+    grid.fillRect(doorX, doorZ, doorX + 3, doorZ, true);
+
+    DistanceField field;
+    const int builds = 5;
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < builds; ++i) field.build(grid, maxDistance);
+    double fullMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / builds;
+
+    // Open and close the door repeatedly, updating locally
+    const int updates = 1000;
+    t0 = Clock::now();
+    for (int i = 0; i < updates; ++i) {
+        grid.fillRect(doorX, doorZ, doorX + 3, doorZ, (i & 1) != 0);
+        field.update(grid, doorX, doorZ, doorX + 3, doorZ);
+    }
+    double localUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / updates;
+
+    // The local result must equal a full recompute
+    DistanceField reference;
+    reference.build(grid, maxDistance);
+    float maxError = 0.0f;
+    for (size_t i = 0; i < field.m_dist.size(); ++i) {
+        maxError = fmaxf(maxError, fabsf(field.m_dist[i] - reference.m_dist[i]));
+    }
+
+    printf("DistanceField benchmark (%dx%d, cap %.0f cells):\n", size, size, maxDistance);
+    printf("  full build:   %.2f ms\n", fullMs);
+    printf("  local update: %.2f us (door 4x1)\n", localUs);
+    printf("  local vs full max difference: %g\n", maxError);
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include "CollisionGrid.h"
+
+// ================================================================
+// DistanceField
+//
+// Distance from every grid cell to the nearest blocked cell, computed
+// with an exact Euclidean distance transform (two passes of the linear
+// time lower envelope of parabolas, Felzenszwalb & Huttenlocher).
+//
+// Distances are capped at a maximum (a few units is all movement and AI
+// need). Because of the cap, changing a few cells (a door opening) only
+// affects cells within that distance, so update() recomputes just that
+// window instead of the whole grid.
+//
+// Queries are O(1): a smooth (bilinear) clearance with its gradient for
+// steering, and a conservative lower bound for skipping exact collision
+// checks far away from everything.
+// ================================================================
+
+class DistanceField {
+public:
+    DistanceField();
+
+    /**
+     * @brief Computes the whole field from a collision grid.
+     * @param maxDistance Distances are capped here (world units).
+     */
+    void build(const CollisionGrid& grid, float maxDistance);
+
+    /**
+     * @brief Recomputes the field around cells [x0..x1] x [z0..z1] after they changed.
+     * Does nothing if the grid no longer matches the field (build() again).
+     */
+    void update(const CollisionGrid& grid, int x0, int z0, int x1, int z1);
+
+    /**
+     * @brief update() for the cells under a world-space rectangle.
+     */
+    void updateArea(const CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ);
+
+    void clear();
+
+    bool isReady() const { return !m_dist.empty(); }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    float getMaxDistance() const { return m_maxDistance; }
+
+    /**
+     * @brief Distance (world units) from a cell's center to the nearest blocked
+     * cell's center, capped at getMaxDistance(). 0 for blocked or outside cells.
+     */
+    float getCell(int x, int z) const {
+        if (x < 0 || z < 0 || x >= m_width || z >= m_height) return 0.0f;
+        return m_dist[(size_t)z * m_width + x];
+    }
+
+    /**
+     * @brief Approximate free space around a world position (bilinear, smooth).
+     */
+    float clearance(float worldX, float worldZ) const;
+
+    /**
+     * @brief Direction of increasing clearance (unit length, or 0 in flat areas).
+     */
+    void gradient(float worldX, float worldZ, float& outX, float& outZ) const;
+
+    /**
+     * @brief Lower bound of the distance from a world position to any blocked
+     * cell. Never overestimates, so a circle of this radius is always free.
+     */
+    float minClearance(float worldX, float worldZ) const;
+
+    /**
+     * @brief Times a full build against local updates on a size x size grid
+     * and checks that both give the same field. Prints the results.
+     */
+    static void runBenchmark(int size);
+
+private:
+    // Recomputes cells [x0..x1] x [z0..z1], reading blocked cells up to the cap around them
+    void compute(const CollisionGrid& grid, int x0, int z0, int x1, int z1);
+
+    std::vector<float> m_dist;
+    int m_width, m_height;
+    float m_cellSize, m_originX, m_originZ;
+    float m_maxDistance;
+    int m_reachCells;               // Cap in cells (rounded up)
+
+    // Scratch buffers, kept between updates
+    std::vector<float> m_column;    // Squared vertical distances of the window
+    std::vector<float> m_envelope;  // 1D transform: f, parabola sites and boundaries
+    std::vector<int> m_sites;
+};
+
+extern DistanceField g_distanceField;
@@ -0,0 +1,178 @@
+// FileWatcher.cpp : Change notifications for hot reloading content files.
+//
+#include "pch.h" // Must be first
+#include "FileWatcher.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+// ================================================================
+// Helpers
+// ================================================================
+
+static void splitPath(const std::string& path, std::string& dir, std::string& name) {
+    size_t slash = path.find_last_of("/\\");
+    if (slash == std::string::npos) {
+        dir = ".";
+        name = path;
+    }
+    else {
+        dir = path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+}
+
+long long getFileModifiedTime(const char* path) {
+#ifdef _WIN32
+    struct _stat st;
+    if (_stat(path, &st) != 0) return -1;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0) return -1;
+#endif
+    return (long long)st.st_mtime;
+}
+
+static long long modifiedTime(const std::string& path) {
+    return getFileModifiedTime(path.c_str());
+}
+
+// ================================================================
+// FileWatcher
+// ================================================================
+
+FileWatcher::FileWatcher()
+    : m_inotifyFd(-1), m_settleMs(150), m_pollIntervalMs(500), m_lastPollMs(0)
+{
+#ifdef __linux__
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0) {
+        printf("FileWatcher: inotify unavailable (%s), polling timestamps instead.\n", strerror(errno));
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (m_inotifyFd >= 0) close(m_inotifyFd);
+#endif
+}
+
+bool FileWatcher::isWatching(const char* path) const {
+    for (const auto& f : m_files) {
+        if (f.path == path) return true;
+    }
+    return false;
+}
+
+bool FileWatcher::watch(const char* path, FileChangedCallback onChanged) {
+    if (!path || isWatching(path)) return false;
+
+    WatchedFile file;
+    file.path = path;
+    splitPath(file.path, file.dir, file.name);
+    file.onChanged = onChanged;
+    file.lastModified = modifiedTime(file.path);
+    file.changedAtMs = -1;
+
+    // One watch per directory, shared by every file inside it
+    bool haveDir = false;
+    for (const auto& d : m_dirs) {
+        if (d.dir == file.dir) { haveDir = true; break; }
+    }
+
+    if (!haveDir) {
+        WatchedDir dir;
+        dir.dir = file.dir;
+        dir.handle = -1;
+#ifdef __linux__
+        if (m_inotifyFd >= 0) {
+            // CLOSE_WRITE: saved in place. MOVED_TO: saved via temp file + rename.
+            dir.handle = inotify_add_watch(m_inotifyFd, dir.dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (dir.handle < 0) {
+                printf("FileWatcher: cannot watch '%s' (%s)\n", dir.dir.c_str(), strerror(errno));
+                return false;
+            }
+        }
+#endif
+        m_dirs.push_back(dir);
+    }
+
+    m_files.push_back(file);
+    printf("FileWatcher: watching '%s'\n", path);
+    return true;
+}
+
+void FileWatcher::markChanged(const std::string& dir, const char* name, int nowMs) {
+    for (auto& f : m_files) {
+        if (f.dir == dir && f.name == name) {
+            f.changedAtMs = nowMs; // Restart the settle timer on every write
+        }
+    }
+}
+
+void FileWatcher::readEvents(int nowMs) {
+#ifdef __linux__
+    // Aligned for struct inotify_event
+    alignas(struct inotify_event) char buffer[4096];
+
+    for (;;) {
+        ssize_t len = read(m_inotifyFd, buffer, sizeof(buffer));
+        if (len <= 0) break; // EAGAIN: no more events this frame
+
+        for (char* p = buffer; p < buffer + len; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            if (ev->len > 0) {
+                for (const auto& d : m_dirs) {
+                    if (d.handle == ev->wd) {
+                        markChanged(d.dir, ev->name, nowMs);
+                        break;
+                    }
+                }
+            }
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+#else
+    (void)nowMs;
+#endif
+}
+
+void FileWatcher::pollTimestamps(int nowMs) {
+    if (nowMs - m_lastPollMs < m_pollIntervalMs) return;
+    m_lastPollMs = nowMs;
+
+    for (auto& f : m_files) {
+        long long t = modifiedTime(f.path);
+        if (t != f.lastModified) {
+            f.lastModified = t;
+            if (t >= 0) f.changedAtMs = nowMs;
+        }
+    }
+}
+
+void FileWatcher::poll(int nowMs) {
+    if (m_files.empty()) return;
+
+    if (m_inotifyFd >= 0) readEvents(nowMs);
+    else pollTimestamps(nowMs);
+
+    // By index, with copies: a callback may watch more files (m_files grows)
+    for (size_t i = 0; i < m_files.size(); ++i) {
+        WatchedFile& f = m_files[i];
+        if (f.changedAtMs < 0 || nowMs - f.changedAtMs < m_settleMs) continue;
+        f.changedAtMs = -1;
+
+        printf("FileWatcher: '%s' changed\n", f.path.c_str());
+        FileChangedCallback onChanged = f.onChanged;
+        std::string path = f.path;
+        if (onChanged) onChanged(path.c_str());
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+
+// ================================================================
+// FileWatcher
+//
+// Reports files that changed on disk so content can be hot reloaded
+// without restarting the game.
+//  - Linux: inotify on the parent directory of every watched file, so
+//    editors that save by writing a temp file and renaming it are caught.
+//  - Other platforms: modification times are polled a few times a second.
+//
+// Nothing happens on a background thread. poll() is called once per frame
+// from idle() and runs the callbacks there, between two frames. A change
+// is only reported after the file has been quiet for a short settle time,
+// so a half-written file is never loaded.
+// ================================================================
+
+typedef std::function<void(const char* path)> FileChangedCallback;
+
+/**
+ * @brief Last modification time of a file (seconds), or -1 if it does not exist.
+ */
+long long getFileModifiedTime(const char* path);
+
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    /**
+     * @brief Starts watching a file. Paths are used exactly as given
+     * (relative paths resolve against the working directory).
+     * @return False if the file's directory could not be watched.
+     */
+    bool watch(const char* path, FileChangedCallback onChanged);
+
+    /**
+     * @brief True if the path is already being watched.
+     */
+    bool isWatching(const char* path) const;
+
+    /**
+     * @brief Collects change events and runs the callback of every file
+     * whose settle time has passed (callbacks may watch() more files).
+     * Call once per frame.
+     * @param nowMs Current time in milliseconds (glutGet(GLUT_ELAPSED_TIME)).
+     */
+    void poll(int nowMs);
+
+    /**
+     * @brief Time a file must stay unchanged before it is reported.
+     */
+    void setSettleTime(int ms) { m_settleMs = ms; }
+
+private:
+    struct WatchedFile {
+        std::string path;
+        std::string dir;       // Directory part ("." if none)
+        std::string name;      // File name part
+        FileChangedCallback onChanged;
+        long long lastModified; // Polling fallback only
+        int changedAtMs;        // -1 = no pending change
+    };
+
+    struct WatchedDir {
+        std::string dir;
+        int handle;             // inotify watch descriptor (-1 when polling)
+    };
+
+    void markChanged(const std::string& dir, const char* name, int nowMs);
+    void readEvents(int nowMs);
+    void pollTimestamps(int nowMs);
+
+    std::vector<WatchedFile> m_files;
+    std::vector<WatchedDir> m_dirs;
+
+    int m_inotifyFd;           // -1 when polling timestamps instead
+    int m_settleMs;
+    int m_pollIntervalMs;
+    int m_lastPollMs;
+};
@@ -0,0 +1,38 @@
+// FixedTimestep.cpp : Fixed rate simulation clock with render interpolation.
+//
+#include "pch.h" // Must be first
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(int rate, int maxSteps)
+    : m_rate(rate > 0 ? rate : 60), m_maxSteps(maxSteps > 0 ? maxSteps : 1),
+      m_accumulator(0.0), m_lastMs(0), m_started(false), m_stepCount(0), m_dropped(0.0)
+{
+    m_step = 1.0f / m_rate;
+}
+
+void FixedTimestep::reset(int nowMs) {
+    m_lastMs = nowMs;
+    m_accumulator = 0.0;
+    m_started = true;
+}
+
+int FixedTimestep::advance(int nowMs) {
+    if (!m_started) reset(nowMs);
+
+    int elapsedMs = nowMs - m_lastMs;
+    m_lastMs = nowMs;
+    if (elapsedMs > 0) m_accumulator += elapsedMs / 1000.0;
+
+    int steps = (int)(m_accumulator / m_step);
+    if (steps > m_maxSteps) {
+        // Too far behind: run what fits and drop the remaining whole steps
+        double dropped = (double)(steps - m_maxSteps) * m_step;
+        m_dropped += dropped;
+        m_accumulator -= dropped;
+        steps = m_maxSteps;
+    }
+
+    m_accumulator -= (double)steps * m_step;
+    m_stepCount += steps;
+    return steps;
+}
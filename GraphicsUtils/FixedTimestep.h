@@ -0,0 +1,61 @@
+#pragma once
+
+// ================================================================
+// FixedTimestep
+//
+// Runs the simulation at a fixed rate (e.g. 120 Hz) however fast or slow
+// frames are. Real time is added to an accumulator every frame and spent
+// in whole steps of 1 / rate seconds, so physics gives the same result on
+// every machine and replays stay deterministic.
+//
+// The time left over (less than one step) becomes the interpolation
+// factor: rendering blends the previous and current simulation state by
+// getAlpha() so motion stays smooth at any display rate.
+//
+// After a long stall (loading, a breakpoint) at most maxSteps steps are
+// run in one frame and the rest of the time is dropped, instead of
+// spiralling into ever longer catch-up frames.
+// ================================================================
+
+class FixedTimestep {
+public:
+    /**
+     * @param rate Simulation steps per second.
+     * @param maxSteps Most steps run in one frame.
+     */
+    FixedTimestep(int rate, int maxSteps);
+
+    /**
+     * @brief Adds the real time passed since the last call.
+     * @param nowMs Current time in milliseconds (glutGet(GLUT_ELAPSED_TIME)).
+     * @return Number of steps to run now (0..maxSteps).
+     */
+    int advance(int nowMs);
+
+    /**
+     * @brief Forgets accumulated time (call after loading, before the first frame).
+     */
+    void reset(int nowMs);
+
+    float getStep() const { return m_step; }
+    int getRate() const { return m_rate; }
+
+    /**
+     * @brief Fraction of a step between the last simulated state and now (0..1).
+     */
+    float getAlpha() const { return (float)(m_accumulator / m_step); }
+
+    // Total steps run and time dropped after stalls (for stats)
+    long long getStepCount() const { return m_stepCount; }
+    double getDroppedSeconds() const { return m_dropped; }
+
+private:
+    int m_rate;
+    int m_maxSteps;
+    float m_step;
+    double m_accumulator;
+    int m_lastMs;
+    bool m_started;
+    long long m_stepCount;
+    double m_dropped;
+};
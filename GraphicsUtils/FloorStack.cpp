@@ -0,0 +1,126 @@
+// FloorStack.cpp : Stacked floors of a level and the stairs between them.
+//
+#include "pch.h" // Must be first
+#include "FloorStack.h"
+#include "Visibility.h"
+#include <math.h>
+#include <algorithm>
+
+FloorStack g_floors;
+
+// Feet this far below the next floor still climb onto it at the top of stairs
+const float CLIMB_TOLERANCE = 0.5f;
+
+FloorStack::FloorStack()
+    : m_floorCount(1), m_storeyHeight(5.0f), m_current(0)
+{
+}
+
+void FloorStack::configure(int floorCount, float storeyHeight) {
+    m_floorCount = std::max(1, floorCount);
+    m_storeyHeight = storeyHeight;
+    m_stairs.clear();
+    if (m_current >= m_floorCount) m_current = 0;
+}
+
+void FloorStack::addStairs(int floor, float x0, float z0, float x1, float z1, float width) {
+    FloorStairs s;
+    s.floor = floor;
+    s.x0 = x0; s.z0 = z0;
+    s.x1 = x1; s.z1 = z1;
+    s.halfWidth = width / 2.0f;
+
+    // Along X the width is across Z and the other way around
+    bool alongX = (z0 == z1);
+    s.minX = alongX ? std::min(x0, x1) : x0 - s.halfWidth;
+    s.maxX = alongX ? std::max(x0, x1) : x0 + s.halfWidth;
+    s.minZ = alongX ? z0 - s.halfWidth : std::min(z0, z1);
+    s.maxZ = alongX ? z0 + s.halfWidth : std::max(z0, z1);
+    m_stairs.push_back(s);
+}
+
+void FloorStack::setCurrent(int floor) {
+    if (floor >= 0 && floor < m_floorCount) m_current = floor;
+}
+
+bool FloorStack::alongStairs(const FloorStairs& s, float x, float z, float& t) const {
+    float dx = s.x1 - s.x0, dz = s.z1 - s.z0;
+    float length2 = dx * dx + dz * dz;
+    if (length2 <= 0.0f) return false;
+    float rx = x - s.x0, rz = z - s.z0;
+    float side = (rx * -dz + rz * dx) / sqrtf(length2);
+    if (fabsf(side) > s.halfWidth) return false;
+    t = (rx * dx + rz * dz) / length2;
+    return true;
+}
+
+// ================================================================
+// Walking
+// ================================================================
+
+float FloorStack::groundAt(int floor, float x, float z) const {
+    float ground = getBaseY(floor);
+    for (const FloorStairs& s : m_stairs) {
+        float t;
+        if (s.floor != floor || !alongStairs(s, x, z, t) || t < 0.0f || t > 1.0f) continue;
+        ground = std::max(ground, getBaseY(floor) + t * m_storeyHeight);
+    }
+    return ground;
+}
+
+int FloorStack::floorAfterMove(int floor, float x, float z, float feetY) const {
+    for (const FloorStairs& s : m_stairs) {
+        float t;
+        if (!alongStairs(s, x, z, t)) continue;
+        if (s.floor == floor && floor + 1 < m_floorCount && t > 1.0f && feetY >= getBaseY(floor + 1) - CLIMB_TOLERANCE) {
+            return floor + 1;
+        }
+        if (s.floor + 1 == floor && t >= 0.0f && t <= 1.0f) {
+            return floor - 1;
+        }
+    }
+    return floor;
+}
+
+// ================================================================
+// Grid and portals
+// ================================================================
+
+void FloorStack::applyCollision(int floor, CollisionGrid& grid) const {
+    const float INSET = 0.001f; // A footprint ending on a cell edge does not take the next cell
+    for (const FloorStairs& s : m_stairs) {
+        if (s.floor != floor && s.floor + 1 != floor) continue;
+        int x0, z0, x1, z1;
+        grid.worldToCell(s.minX, s.minZ, x0, z0);
+        grid.worldToCell(s.maxX - INSET, s.maxZ - INSET, x1, z1);
+        grid.fillRect(x0, z0, x1, z1, true);
+    }
+}
+
+void FloorStack::getLandings(int stairs, float distance, float& bottomX, float& bottomZ, float& topX, float& topZ) const {
+    const FloorStairs& s = m_stairs[stairs];
+    float dx = s.x1 - s.x0, dz = s.z1 - s.z0;
+    float length = sqrtf(dx * dx + dz * dz);
+    dx /= length;
+    dz /= length;
+    bottomX = s.x0 - dx * distance;
+    bottomZ = s.z0 - dz * distance;
+    topX = s.x1 + dx * distance;
+    topZ = s.z1 + dz * distance;
+}
+
+void FloorStack::findVisibleFloors(std::vector<int>& out) const {
+    out.clear();
+    for (const FloorStairs& s : m_stairs) {
+        int other;
+        if (s.floor == m_current) other = m_current + 1;
+        else if (s.floor + 1 == m_current) other = m_current - 1;
+        else continue;
+        if (std::find(out.begin(), out.end(), other) != out.end()) continue;
+
+        // The stairwell is the portal: seen from this floor, the other one shows through it
+        float cx = (s.minX + s.maxX) / 2.0f, cz = (s.minZ + s.maxZ) / 2.0f;
+        float radius = sqrtf((s.maxX - s.minX) * (s.maxX - s.minX) + (s.maxZ - s.minZ) * (s.maxZ - s.minZ)) / 2.0f;
+        if (g_visibility.isVisible(cx, cz, radius)) out.push_back(other);
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include "CollisionGrid.h"
+
+// ================================================================
+// FloorStack
+//
+// Floors of a level, stacked one storey (the room height) above the
+// other and joined by stairs. Each floor has its own objects, collision
+// grid and visibility; only the floor the player is on is simulated. To
+// rendering the floors are separate cells whose only openings (portals)
+// are the stairwells, so a neighbouring floor is drawn only while one of
+// them can be seen.
+//
+// Stairs are ramps along X or Z from one floor to the next:
+//  - on the floor below, the ramp raises the ground and is blocked in
+//    the grid (characters walk around it)
+//  - on the floor above, its footprint is an opening in the floor,
+//    blocked in the grid too
+// Climbing past the top edge puts the player on the floor above; stepping
+// into the opening from above puts them back on the floor below, at the
+// height of the ramp there (or falling onto it).
+// ================================================================
+
+struct FloorStairs {
+    int floor;                      // Floor at the bottom
+    float x0, z0, x1, z1;           // Middle of the bottom step and of the top edge
+    float halfWidth;
+    float minX, minZ, maxX, maxZ;   // Footprint
+};
+
+class FloorStack {
+public:
+    FloorStack();
+
+    /**
+     * @brief Sets the number of floors and their height and removes the
+     * stairs. The current floor is kept if it still exists, else it is 0.
+     */
+    void configure(int floorCount, float storeyHeight);
+
+    /**
+     * @brief Adds stairs from (x0, z0) on 'floor' up to (x1, z1) on the floor above.
+     */
+    void addStairs(int floor, float x0, float z0, float x1, float z1, float width);
+
+    int getFloorCount() const { return m_floorCount; }
+    float getStoreyHeight() const { return m_storeyHeight; }
+    float getBaseY(int floor) const { return floor * m_storeyHeight; }
+
+    int getCurrent() const { return m_current; }
+    void setCurrent(int floor);
+
+    int getStairsCount() const { return (int)m_stairs.size(); }
+    const FloorStairs& getStairs(int index) const { return m_stairs[index]; }
+
+    /**
+     * @brief Height of the walking surface at (x, z) on a floor: the floor
+     * itself, or the ramp of stairs going up from it.
+     */
+    float groundAt(int floor, float x, float z) const;
+
+    /**
+     * @brief Floor of someone at (x, z) with their feet at feetY, who was
+     * on 'floor': the one above once past the top of stairs, the one below
+     * inside a stairwell, else the same.
+     */
+    int floorAfterMove(int floor, float x, float z, float feetY) const;
+
+    /**
+     * @brief Blocks the ramps and stairwell openings of a floor in a grid
+     * covering that floor.
+     */
+    void applyCollision(int floor, CollisionGrid& grid) const;
+
+    /**
+     * @brief Points on the floor just off both ends of stairs, 'distance'
+     * beyond the bottom step (floor below) and the top edge (floor above).
+     */
+    void getLandings(int stairs, float distance, float& bottomX, float& bottomZ, float& topX, float& topZ) const;
+
+    /**
+     * @brief Floors next to the current one whose stairwell can be seen
+     * from the viewpoint set on g_visibility this frame.
+     */
+    void findVisibleFloors(std::vector<int>& out) const;
+
+private:
+    // Position along the stairs (0 = bottom, 1 = top) if (x, z) is within their width
+    bool alongStairs(const FloorStairs& s, float x, float z, float& t) const;
+
+    int m_floorCount;
+    float m_storeyHeight;
+    int m_current;
+    std::vector<FloorStairs> m_stairs;
+};
+
+extern FloorStack g_floors;
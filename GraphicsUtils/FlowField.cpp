@@ -0,0 +1,354 @@
+// FlowField.cpp : Multi-goal distance field over the collision grid with local repair.
+//
+#include "pch.h" // Must be first
+#include "FlowField.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+static const float FLOW_UNREACHED = 1e30f;
+
+// The 8 steps, straight ones first
+static const int STEP_X[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int STEP_Z[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+static const float STEP_COST[8] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f };
+
+static bool flowNodeGreater(const FlowField::FlowNode& a, const FlowField::FlowNode& b) {
+    return a.d > b.d;
+}
+
+FlowField::FlowField()
+    : m_grid(nullptr), m_width(0), m_height(0), m_visited(0)
+{
+}
+
+void FlowField::clear() {
+    m_grid = nullptr;
+    m_width = m_height = 0;
+    m_dist.clear();
+    m_next.clear();
+    m_goal.clear();
+    m_goalCells.clear();
+    m_open.clear();
+    m_visited = 0;
+}
+
+bool FlowField::canStep(int x, int z, int dx, int dz) const {
+    if (!walkable(x + dx, z + dz)) return false;
+    if (dx != 0 && dz != 0) return walkable(x + dx, z) && walkable(x, z + dz);
+    return true;
+}
+
+bool FlowField::nearestWalkable(int& x, int& z, int maxRadius, bool reachedOnly) const {
+    auto usable = [&](int cx, int cz) {
+        if (!walkable(cx, cz)) return false;
+        return !reachedOnly || m_dist[(size_t)cz * m_width + cx] < FLOW_UNREACHED;
+    };
+    if (usable(x, z)) return true;
+    for (int r = 1; r <= maxRadius; ++r) {
+        int bestX = 0, bestZ = 0, bestD = -1;
+        for (int dz = -r; dz <= r; ++dz) {
+            for (int dx = -r; dx <= r; ++dx) {
+                if (abs(dx) != r && abs(dz) != r) continue; // Ring only
+                if (!usable(x + dx, z + dz)) continue;
+                int d = dx * dx + dz * dz;
+                if (bestD < 0 || d < bestD) { bestD = d; bestX = x + dx; bestZ = z + dz; }
+            }
+        }
+        if (bestD >= 0) {
+            x = bestX;
+            z = bestZ;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ================================================================
+// Dijkstra
+// ================================================================
+
+void FlowField::push(int cell) {
+    FlowNode n = { m_dist[cell], cell };
+    m_open.push_back(n);
+    std::push_heap(m_open.begin(), m_open.end(), flowNodeGreater);
+}
+
+void FlowField::propagate() {
+    int w = m_width;
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), flowNodeGreater);
+        FlowNode n = m_open.back();
+        m_open.pop_back();
+        if (n.d > m_dist[n.cell]) continue; // Stale entry
+        m_visited++;
+
+        int x = n.cell % w, z = n.cell / w;
+        for (int i = 0; i < 8; ++i) {
+            if (!canStep(x, z, STEP_X[i], STEP_Z[i])) continue;
+            int c = n.cell + STEP_Z[i] * w + STEP_X[i];
+            float d = n.d + STEP_COST[i];
+            if (d < m_dist[c]) {
+                m_dist[c] = d;
+                m_next[c] = n.cell;
+                push(c);
+            }
+        }
+    }
+}
+
+void FlowField::build(const CollisionGrid& grid, const std::vector<PathPoint>& goals) {
+    m_grid = &grid;
+    m_width = grid.getWidth();
+    m_height = grid.getHeight();
+    size_t count = (size_t)m_width * m_height;
+    m_dist.assign(count, FLOW_UNREACHED);
+    m_next.assign(count, -1);
+    m_goal.assign(count, 0);
+    m_goalCells.clear();
+    m_open.clear();
+    m_visited = 0;
+
+    for (const auto& g : goals) {
+        int x, z;
+        grid.worldToCell(g.x, g.z, x, z);
+        if (!nearestWalkable(x, z, 3, false)) continue;
+        int c = z * m_width + x;
+        if (m_goal[c]) continue;
+        m_goal[c] = 1;
+        m_goalCells.push_back(c);
+        m_dist[c] = 0.0f;
+        push(c);
+    }
+    propagate();
+}
+
+// ================================================================
+// Repair
+// ================================================================
+
+void FlowField::invalidate(int cell) {
+    // The cell and every cell whose route to a goal runs through it
+    int w = m_width;
+    m_stack.clear();
+    m_stack.push_back(cell);
+    while (!m_stack.empty()) {
+        int c = m_stack.back();
+        m_stack.pop_back();
+        m_dist[c] = FLOW_UNREACHED;
+        m_next[c] = -1;
+        m_invalid.push_back(c);
+
+        int x = c % w, z = c / w;
+        for (int i = 0; i < 8; ++i) {
+            int nx = x + STEP_X[i], nz = z + STEP_Z[i];
+            if (!m_grid->inBounds(nx, nz)) continue;
+            int n = nz * w + nx;
+            if (m_next[n] == c) m_stack.push_back(n);
+        }
+    }
+}
+
+void FlowField::settleFromNeighbours(int cell) {
+    int w = m_width;
+    int x = cell % w, z = cell / w;
+    if (!walkable(x, z)) return;
+    if (m_goal[cell]) {
+        m_dist[cell] = 0.0f;
+        m_next[cell] = -1;
+        return;
+    }
+    for (int i = 0; i < 8; ++i) {
+        if (!canStep(x, z, STEP_X[i], STEP_Z[i])) continue;
+        int n = cell + STEP_Z[i] * w + STEP_X[i];
+        float d = m_dist[n] + STEP_COST[i];
+        if (d < m_dist[cell]) {
+            m_dist[cell] = d;
+            m_next[cell] = n;
+        }
+    }
+}
+
+void FlowField::update(const CollisionGrid& grid, int x0, int z0, int x1, int z1) {
+    if (m_grid != &grid || grid.getWidth() != m_width || grid.getHeight() != m_height) return;
+
+    // One cell more on each side: those are the diagonals a changed cell may cut
+    if (x0 > x1) std::swap(x0, x1);
+    if (z0 > z1) std::swap(z0, z1);
+    x0 = std::max(x0 - 1, 0);
+    z0 = std::max(z0 - 1, 0);
+    x1 = std::min(x1 + 1, m_width - 1);
+    z1 = std::min(z1 + 1, m_height - 1);
+    if (x0 > x1 || z0 > z1) return;
+
+    int w = m_width;
+    m_open.clear();
+    m_invalid.clear();
+    m_visited = 0;
+
+    // 1. Drop the routes that are no longer possible
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            int c = z * w + x;
+            if (m_dist[c] >= FLOW_UNREACHED) continue;
+            bool broken;
+            if (!walkable(x, z)) broken = true;
+            else if (m_next[c] < 0) broken = false;
+            else broken = !canStep(x, z, m_next[c] % w - x, m_next[c] / w - z);
+            if (broken) invalidate(c);
+        }
+    }
+
+    // 2. Those cells and the changed ones take what their neighbours offer
+    for (int c : m_invalid) {
+        settleFromNeighbours(c);
+        if (m_dist[c] < FLOW_UNREACHED) push(c);
+    }
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            int c = z * w + x;
+            settleFromNeighbours(c);
+            if (m_dist[c] < FLOW_UNREACHED) push(c);
+        }
+    }
+
+    // 3. Spread the changes
+    propagate();
+    m_visited += (int)m_invalid.size();
+}
+
+// ================================================================
+// Queries
+// ================================================================
+
+float FlowField::getCellDistance(int x, int z) const {
+    if (!m_grid || !m_grid->inBounds(x, z)) return -1.0f;
+    float d = m_dist[(size_t)z * m_width + x];
+    return d < FLOW_UNREACHED ? d : -1.0f;
+}
+
+float FlowField::getDistance(float worldX, float worldZ) const {
+    if (!m_grid) return -1.0f;
+    int x, z;
+    m_grid->worldToCell(worldX, worldZ, x, z);
+    if (!nearestWalkable(x, z, 3, true)) return -1.0f;
+    return getCellDistance(x, z) * m_grid->getCellSize();
+}
+
+bool FlowField::getDirection(float worldX, float worldZ, float& dirX, float& dirZ) const {
+    if (!m_grid) return false;
+    int x, z;
+    m_grid->worldToCell(worldX, worldZ, x, z);
+    if (!nearestWalkable(x, z, 3, true)) return false;
+    int next = m_next[(size_t)z * m_width + x];
+    if (next < 0) return false;
+
+    float tx, tz;
+    m_grid->cellCenter(next % m_width, next / m_width, tx, tz);
+    float dx = tx - worldX, dz = tz - worldZ;
+    float len = sqrtf(dx * dx + dz * dz);
+    if (len < 1e-6f) return false;
+    dirX = dx / len;
+    dirZ = dz / len;
+    return true;
+}
+
+bool FlowField::tracePath(float startX, float startZ, std::vector<PathPoint>& outPath, const Pathfinder* pull) const {
+    outPath.clear();
+    if (!m_grid) return false;
+
+    int sx, sz;
+    m_grid->worldToCell(startX, startZ, sx, sz);
+    bool startMoved = !walkable(sx, sz);
+    if (!nearestWalkable(sx, sz, 3, true)) return false;
+
+    std::vector<int> cells, pulled;
+    int c = sz * m_width + sx;
+    cells.push_back(c);
+    while (m_next[c] >= 0 && cells.size() <= m_dist.size()) {
+        c = m_next[c];
+        cells.push_back(c);
+    }
+    if (pull && pull->isReady()) pull->smooth(cells, pulled);
+    else pulled.swap(cells);
+
+    PathPoint p;
+    if (startMoved) m_grid->cellCenter(sx, sz, p.x, p.z);
+    else { p.x = startX; p.z = startZ; }
+    outPath.push_back(p);
+
+    for (size_t i = 1; i < pulled.size(); ++i) {
+        m_grid->cellCenter(pulled[i] % m_width, pulled[i] / m_width, p.x, p.z);
+        outPath.push_back(p);
+    }
+    return true;
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+void FlowField::runBenchmark(int size) {
+    typedef std::chrono::steady_clock Clock;
+    if (size < 100) size = 100;
+
+    // The shared benchmark venue: 50 x 50 rooms joined by doorways, some furniture
+    CollisionGrid grid;
+    std::vector<int> doorways; // x0, z0, x1, z1
+    makeBenchmarkVenue(grid, size, true, &doorways);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> pos(0, size - 1);
+
+    // Objectives in four rooms
+    std::vector<PathPoint> goals;
+    for (int i = 0; i < 4; ++i) {
+        PathPoint p = { (float)(pos(rng) - size / 2), (float)(pos(rng) - size / 2) };
+        goals.push_back(p);
+    }
+
+    FlowField field, reference;
+    Clock::time_point t0 = Clock::now();
+    field.build(grid, goals);
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    int buildVisited = field.getLastVisited();
+
+    // Close and reopen random doorways, repairing after each change
+    const int toggles = 100, checked = 10;
+    std::uniform_int_distribution<int> pick(0, (int)doorways.size() / 4 - 1);
+    double totalUs = 0.0, worstUs = 0.0;
+    long long visited = 0;
+    int mismatches = 0;
+    for (int i = 0; i < toggles; ++i) {
+        const int* d = &doorways[pick(rng) * 4];
+        bool close = !grid.get(d[0], d[1]);
+        grid.fillRect(d[0], d[1], d[2], d[3], close);
+
+        t0 = Clock::now();
+        field.update(grid, d[0], d[1], d[2], d[3]);
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        totalUs += us;
+        worstUs = std::max(worstUs, us);
+        visited += field.getLastVisited();
+
+        if (i < checked) {
+            reference.build(grid, goals);
+            for (int z = 0; z < size; ++z) {
+                for (int x = 0; x < size; ++x) {
+                    if (fabsf(field.getCellDistance(x, z) - reference.getCellDistance(x, z)) > 0.01f) {
+                        mismatches++;
+                        z = size;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("FlowField benchmark (%dx%d, %d goals, %d doorway toggles):\n", size, size, (int)goals.size(), toggles);
+    printf("  full build:       %.2f ms (%d cells)\n", buildMs, buildVisited);
+    printf("  repair average:   %.1f us (worst %.1f us)\n", totalUs / toggles, worstUs);
+    printf("  cells repaired:   %.0f per change\n", (double)visited / toggles);
+    printf("  repair vs build:  %d of %d differ\n", mismatches, checked);
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <vector>
+#include "CollisionGrid.h"
+#include "Pathfinder.h"
+
+// ================================================================
+// FlowField
+//
+// Distance from every cell of the collision grid to the nearest of a set
+// of goals (objectives, exits), with the next cell to step to: one
+// Dijkstra from all goals at once, same moves and costs as the Pathfinder
+// (8-connected, straight 1, diagonal sqrt 2, no corner cutting). Anything
+// standing anywhere on the grid can follow it to the closest goal without
+// a search of its own.
+//
+// When cells change (a door opens or closes) update() repairs the field
+// around them instead of running the whole Dijkstra again:
+//  - cells whose route to a goal crossed a cell that is now blocked (or
+//    a diagonal that is now cut) lose their distance, together with every
+//    cell whose route went through them
+//  - those cells and the changed cells take the best distance offered by
+//    their neighbours, and the usual Dijkstra relaxation spreads any
+//    improvement (a shorter way through an opened door) from there
+// Only cells whose distance actually changes are visited, so a door far
+// from the routes of the grid costs next to nothing even on a big map.
+// ================================================================
+
+class FlowField {
+public:
+    FlowField();
+
+    /**
+     * @brief Computes the field toward world-space goals on a grid.
+     * A goal inside a blocked cell moves to the nearest walkable cell (a few
+     * cells at most); goals that cannot be placed are skipped.
+     * The grid must stay alive while the field is used.
+     */
+    void build(const CollisionGrid& grid, const std::vector<PathPoint>& goals);
+
+    /**
+     * @brief Repairs the field after cells [x0..x1] x [z0..z1] changed.
+     * Does nothing if the grid is not the one that was built or changed size.
+     */
+    void update(const CollisionGrid& grid, int x0, int z0, int x1, int z1);
+
+    void clear();
+
+    bool isReady() const { return m_grid != nullptr; }
+
+    /**
+     * @brief Path distance (world units) from a world position to the
+     * nearest goal, or -1 if no goal can be reached from there.
+     */
+    float getDistance(float worldX, float worldZ) const;
+
+    // Grid version: distance in cells (diagonal = sqrt 2), or -1 if unreachable
+    float getCellDistance(int x, int z) const;
+
+    /**
+     * @brief Unit direction (on XZ) from a world position toward the next
+     * cell on the way to the nearest goal.
+     * @return False if there is no way to a goal (or the position is on one).
+     */
+    bool getDirection(float worldX, float worldZ, float& dirX, float& dirZ) const;
+
+    /**
+     * @brief Follows the field from a world position to the nearest goal.
+     * @param outPath Waypoints from the start to the goal cell's center, both included.
+     * @param pull Pathfinder used to pull the path tight (optional).
+     * @return False if no goal can be reached.
+     */
+    bool tracePath(float startX, float startZ, std::vector<PathPoint>& outPath, const Pathfinder* pull = nullptr) const;
+
+    // Cells visited by the last build() or update() (for stats)
+    int getLastVisited() const { return m_visited; }
+
+    /**
+     * @brief Times a full build and door repairs on a generated size x size
+     * grid and checks repairs against full builds, printed to the console.
+     */
+    static void runBenchmark(int size);
+
+    // Open list entry: distance so far and cell index
+    struct FlowNode {
+        float d;
+        int cell;
+    };
+
+private:
+    bool walkable(int x, int z) const { return !m_grid->get(x, z); }
+    // True if a step from (x, z) by (dx, dz) is allowed (both ends free, no corner cut)
+    bool canStep(int x, int z, int dx, int dz) const;
+    bool nearestWalkable(int& x, int& z, int maxRadius, bool reachedOnly) const;
+
+    // Distance a cell can get from its neighbours (m_dist / m_next are set if better)
+    void settleFromNeighbours(int cell);
+    void invalidate(int cell);
+    void push(int cell);
+    void propagate();
+
+    const CollisionGrid* m_grid;
+    int m_width, m_height;
+
+    std::vector<float> m_dist;          // Cells to the nearest goal (FLOW_UNREACHED if none)
+    std::vector<int> m_next;            // Neighbour one step closer, -1 on goals and unreached cells
+    std::vector<unsigned char> m_goal;  // 1 on goal cells
+    std::vector<int> m_goalCells;
+
+    std::vector<FlowNode> m_open;
+    std::vector<int> m_stack;
+    std::vector<int> m_invalid;
+    int m_visited;
+};
@@ -0,0 +1,123 @@
+// Footprint.cpp : Conservative rasterization of object footprints into the collision grid.
+//
+#include "pch.h" // Must be first
+#include "Footprint.h"
+#include "CollisionGrid.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+void footprintCorners(float x, float z, float rotationDeg, const FootprintBox& box, float outXZ[8]) {
+    // Same rotation as glRotatef(rotationDeg, 0, 1, 0): local +X -> (cos, -sin)
+    float rad = rotationDeg * (float)M_PI / 180.0f;
+    float c = cosf(rad), s = sinf(rad);
+
+    const float local[4][2] = {
+        { box.offsetX - box.halfWidth, box.offsetZ - box.halfDepth },
+        { box.offsetX - box.halfWidth, box.offsetZ + box.halfDepth },
+        { box.offsetX + box.halfWidth, box.offsetZ + box.halfDepth },
+        { box.offsetX + box.halfWidth, box.offsetZ - box.halfDepth },
+    };
+    for (int i = 0; i < 4; ++i) {
+        outXZ[i * 2 + 0] = x + local[i][0] * c + local[i][1] * s;
+        outXZ[i * 2 + 1] = z - local[i][0] * s + local[i][1] * c;
+    }
+}
+
+// First and last cell index covered by [lo, hi] along one axis.
+// A range that only touches a cell border does not cover the next cell.
+static void cellRange(float lo, float hi, float origin, float invCell, int& first, int& last) {
+    float a = (lo - origin) * invCell;
+    float b = (hi - origin) * invCell;
+    first = (int)floorf(a);
+    last = (int)ceilf(b) - 1;
+    if (last < first) last = first; // Zero-width range still covers its cell
+}
+
+int rasterizeFootprint(const float* xz, int count, bool blocked, CollisionGrid& grid) {
+    if (!xz || count < 3) return 0;
+
+    const float cell = grid.getCellSize();
+    const float invCell = 1.0f / cell;
+    const float originX = grid.getOriginX();
+    const float originZ = grid.getOriginZ();
+
+    float minZ = xz[1], maxZ = xz[1];
+    for (int i = 1; i < count; ++i) {
+        minZ = fminf(minZ, xz[i * 2 + 1]);
+        maxZ = fmaxf(maxZ, xz[i * 2 + 1]);
+    }
+
+    int row0, row1;
+    cellRange(minZ, maxZ, originZ, invCell, row0, row1);
+    if (row0 < 0) row0 = 0;
+    if (row1 > grid.getHeight() - 1) row1 = grid.getHeight() - 1;
+
+    int covered = 0;
+    for (int row = row0; row <= row1; ++row) {
+        // Z slab of this row, clipped to the polygon
+        float slabLo = fmaxf(originZ + row * cell, minZ);
+        float slabHi = fminf(originZ + (row + 1) * cell, maxZ);
+
+        // X extent of the polygon inside the slab: vertices in the slab
+        // plus the points where edges cross the slab's two borders
+        float lo = 1e30f, hi = -1e30f;
+        for (int i = 0; i < count; ++i) {
+            float ax = xz[i * 2], az = xz[i * 2 + 1];
+            int j = (i + 1) % count;
+            float bx = xz[j * 2], bz = xz[j * 2 + 1];
+
+            if (az >= slabLo && az <= slabHi) { lo = fminf(lo, ax); hi = fmaxf(hi, ax); }
+
+            float edgeLo = fminf(az, bz), edgeHi = fmaxf(az, bz);
+            if (edgeHi <= edgeLo) continue; // Horizontal edge: its ends are vertices
+            const float borders[2] = { slabLo, slabHi };
+            for (float zb : borders) {
+                if (zb < edgeLo || zb > edgeHi) continue;
+                float t = (zb - az) / (bz - az);
+                float xb = ax + (bx - ax) * t;
+                lo = fminf(lo, xb);
+                hi = fmaxf(hi, xb);
+            }
+        }
+        if (lo > hi) continue;
+
+        int col0, col1;
+        cellRange(lo, hi, originX, invCell, col0, col1);
+        if (col0 < 0) col0 = 0;
+        if (col1 > grid.getWidth() - 1) col1 = grid.getWidth() - 1;
+        if (col0 > col1) continue;
+
+        grid.fillRect(col0, row, col1, row, blocked);
+        covered += col1 - col0 + 1;
+    }
+    return covered;
+}
+
+int rasterizeFootprintBox(float x, float z, float rotationDeg, const FootprintBox& box, bool blocked, CollisionGrid& grid) {
+    float corners[8];
+    footprintCorners(x, z, rotationDeg, box, corners);
+    return rasterizeFootprint(corners, 4, blocked, grid);
+}
+
+int rasterizeFootprintSegment(float startX, float startZ, float endX, float endZ, float thickness, bool blocked, CollisionGrid& grid) {
+    float dx = endX - startX, dz = endZ - startZ;
+    float length = sqrtf(dx * dx + dz * dz);
+    float halfThick = thickness / 2.0f;
+
+    // Direction along the segment (any direction for a point) and its normal
+    float ux = 1.0f, uz = 0.0f;
+    if (length > 0.0f) { ux = dx / length; uz = dz / length; }
+    float nx = -uz * halfThick, nz = ux * halfThick;
+    float ex = ux * halfThick, ez = uz * halfThick;
+
+    const float corners[8] = {
+        startX - ex + nx, startZ - ez + nz,
+        endX + ex + nx,   endZ + ez + nz,
+        endX + ex - nx,   endZ + ez - nz,
+        startX - ex - nx, startZ - ez - nz,
+    };
+    return rasterizeFootprint(corners, 4, blocked, grid);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+class CollisionGrid;
+
+// ================================================================
+// Footprint
+//
+// Stamps the exact floor footprint of an object into a collision grid
+// (the live one or a scratch grid, e.g. the level compiler's).
+// A footprint is a convex polygon in world space (usually an oriented box:
+// position, size, rotation). Every cell whose interior overlaps the
+// polygon is marked, and no other cell, so walls, towers, doors and
+// decorations block what they really cover at any rotation.
+//
+// The polygon is walked one grid row at a time: its X extent inside the
+// row's Z slab gives one run of cells, set with a word-level fill. Cost
+// is O(rows * vertices + covered cells).
+// ================================================================
+
+/**
+ * @brief Local footprint of an object before rotation (X = width, Z = depth).
+ */
+struct FootprintBox {
+    float halfWidth, halfDepth;
+    float offsetX, offsetZ;   // Center relative to the object's origin
+};
+
+/**
+ * @brief World corners of a footprint placed at (x, z) and rotated like
+ * glRotatef(rotationDeg, 0, 1, 0).
+ * @param outXZ Receives 4 corners as x0, z0, x1, z1, ... (counter-clockwise).
+ */
+void footprintCorners(float x, float z, float rotationDeg, const FootprintBox& box, float outXZ[8]);
+
+/**
+ * @brief Marks (or clears) the cells covered by a convex polygon.
+ * @param xz Vertices as x0, z0, x1, z1, ... in order (either winding).
+ * @param count Number of vertices (3 or more).
+ * @param blocked True to block the cells, false to make them walkable.
+ * @param grid Grid to stamp (no listeners are notified).
+ * @return Number of cells covered (inside the grid).
+ */
+int rasterizeFootprint(const float* xz, int count, bool blocked, CollisionGrid& grid);
+
+/**
+ * @brief rasterizeFootprint for a box placed at (x, z) with a rotation in degrees.
+ */
+int rasterizeFootprintBox(float x, float z, float rotationDeg, const FootprintBox& box, bool blocked, CollisionGrid& grid);
+
+/**
+ * @brief Marks the cells covered by a thick line segment (square ends that
+ * extend thickness / 2 past both end points).
+ */
+int rasterizeFootprintSegment(float startX, float startZ, float endX, float endZ, float thickness, bool blocked, CollisionGrid& grid);
@@ -0,0 +1,289 @@
+// FramePacer.cpp : Sleeping frame scheduler with vsync and overrun handling.
+//
+#include "pch.h" // Must be first
+#include "FramePacer.h"
+#include <stdio.h>
+#include <math.h>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib") // timeBeginPeriod
+#endif
+
+#ifdef __linux__
+#include <time.h>
+#include <GL/glx.h>
+#endif
+
+FramePacer g_framePacer(60);
+
+// The OS sleep may overshoot by about this much; the rest is waited out with yields
+#ifdef _WIN32
+static const double SLEEP_MARGIN_MS = 1.5;
+#else
+static const double SLEEP_MARGIN_MS = 1.0;
+#endif
+
+// Adaptation window and thresholds
+static const int ADAPT_FRAMES = 60;
+static const double OVERRUN_RATIO_TO_HALVE = 0.5;   // Half of the frames late: halve the rate
+static const double WORK_RATIO_TO_RESTORE = 0.6;    // Work under 60% of a full-rate frame: restore
+
+// ================================================================
+// Platform helpers
+// ================================================================
+
+static double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) * 1e-7; // 100 ns units
+#elif defined(__linux__)
+    struct timespec ts;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) return 0.0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    return 0.0;
+#endif
+}
+
+// ================================================================
+// FramePacer
+// ================================================================
+
+FramePacer::FramePacer(int targetFps)
+    : m_targetFps(targetFps > 0 ? targetFps : 60), m_halfRate(false), m_started(false), m_timerPeriodSet(false),
+      m_workEnded(false), m_recentFrames(0), m_recentOverruns(0), m_recentWorkMs(0.0), m_overrunsTotal(0),
+      m_intervalCount(0), m_intervalNext(0), m_reportCpu(0.0)
+{
+    for (int i = 0; i < STAT_FRAMES; ++i) m_intervals[i] = 0.0;
+}
+
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+    if (m_timerPeriodSet) timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::setTargetFps(int fps) {
+    if (fps <= 0) return;
+    m_targetFps = fps;
+    m_halfRate = false;
+    m_started = false; // Restart the cadence
+}
+
+int FramePacer::getEffectiveFps() const {
+    return m_halfRate ? (m_targetFps + 1) / 2 : m_targetFps;
+}
+
+bool FramePacer::setVSync(bool enabled) {
+    int interval = enabled ? 1 : 0;
+#ifdef _WIN32
+    typedef BOOL(WINAPI* SwapIntervalProc)(int);
+    SwapIntervalProc swapInterval = (SwapIntervalProc)wglGetProcAddress("wglSwapIntervalEXT");
+    if (swapInterval && swapInterval(interval)) {
+        printf("FramePacer: vsync %s\n", enabled ? "on" : "off");
+        return true;
+    }
+#elif defined(__linux__)
+    typedef int (*SwapIntervalProc)(unsigned int);
+    SwapIntervalProc swapInterval = (SwapIntervalProc)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalMESA");
+    if (!swapInterval) swapInterval = (SwapIntervalProc)glXGetProcAddressARB((const GLubyte*)"glXSwapIntervalSGI");
+    if (swapInterval && swapInterval((unsigned int)interval) == 0) {
+        printf("FramePacer: vsync %s\n", enabled ? "on" : "off");
+        return true;
+    }
+#else
+    (void)interval;
+#endif
+    printf("FramePacer: vsync control not available, pacing with timers only.\n");
+    return false;
+}
+
+void FramePacer::sleepUntil(Clock::time_point deadline) {
+    for (;;) {
+        double remainingMs = std::chrono::duration<double, std::milli>(deadline - Clock::now()).count();
+        if (remainingMs <= 0.0) return;
+
+        if (remainingMs > SLEEP_MARGIN_MS) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(remainingMs - SLEEP_MARGIN_MS));
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void FramePacer::adapt(double workMs) {
+    const double fullPeriodMs = 1000.0 / m_targetFps;
+    const double periodMs = 1000.0 / getEffectiveFps();
+
+    m_recentFrames++;
+    m_recentWorkMs += workMs;
+    if (workMs > periodMs) m_recentOverruns++;
+
+    if (m_recentFrames < ADAPT_FRAMES) return;
+
+    double averageWorkMs = m_recentWorkMs / m_recentFrames;
+    if (!m_halfRate && m_recentOverruns > m_recentFrames * OVERRUN_RATIO_TO_HALVE) {
+        m_halfRate = true;
+        printf("FramePacer: frames overrunning (%.1f ms avg), dropping to %d fps\n", averageWorkMs, getEffectiveFps());
+    }
+    else if (m_halfRate && averageWorkMs < fullPeriodMs * WORK_RATIO_TO_RESTORE) {
+        m_halfRate = false;
+        printf("FramePacer: back to %d fps\n", m_targetFps);
+    }
+
+    m_recentFrames = 0;
+    m_recentOverruns = 0;
+    m_recentWorkMs = 0.0;
+}
+
+void FramePacer::waitForNextFrame() {
+    Clock::time_point now = Clock::now();
+
+    if (!m_started) {
+#ifdef _WIN32
+        // 1 ms sleep resolution instead of 15.6 ms (once: setTargetFps() restarts the cadence)
+        if (!m_timerPeriodSet) m_timerPeriodSet = (timeBeginPeriod(1) == TIMERR_NOERROR);
+#endif
+        m_started = true;
+        m_workEnded = false;
+        m_nextFrame = now;
+        m_lastFrame = now;
+        m_frameStart = now;
+        m_reportWall = now;
+        m_reportCpu = processCpuSeconds();
+        return;
+    }
+
+    // Time spent on the previous frame (update + render, up to the swap)
+    Clock::time_point workEnd = m_workEnded ? m_workEnd : now;
+    adapt(std::chrono::duration<double, std::milli>(workEnd - m_frameStart).count());
+
+    Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / getEffectiveFps()));
+    m_nextFrame += period;
+
+    if (now > m_nextFrame) {
+        // Late: start a new cadence from now rather than rushing to catch up
+        m_overrunsTotal++;
+        m_nextFrame = now;
+    }
+    else {
+        sleepUntil(m_nextFrame);
+    }
+
+    now = Clock::now();
+    recordInterval(now);
+    m_frameStart = now;
+    m_workEnded = false;
+}
+
+void FramePacer::recordInterval(Clock::time_point now) {
+    m_intervals[m_intervalNext] = std::chrono::duration<double, std::milli>(now - m_lastFrame).count();
+    m_intervalNext = (m_intervalNext + 1) % STAT_FRAMES;
+    if (m_intervalCount < STAT_FRAMES) m_intervalCount++;
+    m_lastFrame = now;
+}
+
+void FramePacer::endFrameWork() {
+    m_workEnd = Clock::now();
+    m_workEnded = true;
+}
+
+// ================================================================
+// Stats
+// ================================================================
+
+double FramePacer::getAverageFrameMs() const {
+    if (m_intervalCount == 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < m_intervalCount; ++i) sum += m_intervals[i];
+    return sum / m_intervalCount;
+}
+
+double FramePacer::getJitterMs() const {
+    if (m_intervalCount < 2) return 0.0;
+    double mean = getAverageFrameMs();
+    double sum = 0.0;
+    for (int i = 0; i < m_intervalCount; ++i) {
+        double d = m_intervals[i] - mean;
+        sum += d * d;
+    }
+    return sqrt(sum / (m_intervalCount - 1));
+}
+
+double FramePacer::getCpuUsage() const {
+    double wall = std::chrono::duration<double>(Clock::now() - m_reportWall).count();
+    if (wall <= 0.0) return 0.0;
+    return (processCpuSeconds() - m_reportCpu) / wall;
+}
+
+void FramePacer::printReport() {
+    double averageMs = getAverageFrameMs();
+    printf("\n--- Frame Pacing Report ---\n");
+    printf("  Target      : %d fps (running at %d)\n", m_targetFps, getEffectiveFps());
+    printf("  Frame time  : %.2f ms avg (%.1f fps)\n", averageMs, averageMs > 0.0 ? 1000.0 / averageMs : 0.0);
+    printf("  Jitter      : %.3f ms (std dev, last %d frames)\n", getJitterMs(), m_intervalCount);
+    printf("  Overruns    : %d\n", m_overrunsTotal);
+    printf("  CPU usage   : %.1f%% of one core since last report\n", getCpuUsage() * 100.0);
+    printf("---------------------------\n");
+
+    m_reportWall = Clock::now();
+    m_reportCpu = processCpuSeconds();
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+// Stands in for a frame's update and render
+static void spinFor(double ms) {
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(ms));
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+void FramePacer::runBenchmark(double workMs) {
+    const double runSeconds = 3.0;
+    printf("FramePacer benchmark (60 fps, %.1f ms of work per frame, %.0f s per loop):\n", workMs, runSeconds);
+
+    // Before: idle() returned until 16 whole milliseconds (GLUT_ELAPSED_TIME)
+    // had passed, and GLUT called it again straight away
+    FramePacer polled(60);
+    Clock::time_point start = Clock::now();
+    polled.m_started = true;
+    polled.m_lastFrame = start;
+    polled.m_reportWall = start;
+    polled.m_reportCpu = processCpuSeconds();
+    int lastMs = 0;
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - start).count();
+        if (elapsed >= runSeconds) break;
+        int currentMs = (int)(elapsed * 1000.0);
+        if (currentMs - lastMs < 16) continue;
+        lastMs = currentMs;
+        polled.recordInterval(now);
+        spinFor(workMs);
+    }
+    printf("Polling idle loop:");
+    polled.printReport();
+
+    // After: the pacer sleeps between frames
+    FramePacer paced(60);
+    start = Clock::now();
+    while (std::chrono::duration<double>(Clock::now() - start).count() < runSeconds) {
+        paced.waitForNextFrame();
+        spinFor(workMs);
+        paced.endFrameWork();
+    }
+    printf("FramePacer:");
+    paced.printReport();
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <chrono>
+
+// ================================================================
+// FramePacer
+//
+// Paces the main loop to a target frame rate without spinning. idle()
+// calls waitForNextFrame(), which sleeps until the next frame is due
+// (coarse OS sleep, then a short yield loop for the last fraction of a
+// millisecond), so the CPU is idle between frames instead of polling the
+// clock at 100%.
+//
+// Frames are scheduled on a fixed cadence. A frame that overruns its
+// deadline does not cause a burst of catch-up frames: the cadence is
+// restarted from now. If most recent frames overrun, the pacer drops to
+// half the target rate (steady 30 beats a stuttering 45-60) and returns
+// to the full rate once frames fit comfortably again.
+//
+// Vsync is requested from the driver when available; with vsync on,
+// SwapBuffers also blocks, and the pacer only avoids busy idling. The
+// blocked swap is not work: display() calls endFrameWork() just before
+// swapping, so waiting for vsync never counts as an overrun.
+// ================================================================
+
+class FramePacer {
+public:
+    explicit FramePacer(int targetFps);
+    ~FramePacer();
+
+    void setTargetFps(int fps);
+    int getTargetFps() const { return m_targetFps; }
+
+    /**
+     * @brief Current rate after adaptation (target, or half of it while overrunning).
+     */
+    int getEffectiveFps() const;
+
+    /**
+     * @brief Turns driver vsync on or off for the current GL context.
+     * @return False if the driver offers no swap interval control.
+     */
+    bool setVSync(bool enabled);
+
+    /**
+     * @brief Sleeps until the next frame is due. Call once per frame, before updating.
+     */
+    void waitForNextFrame();
+
+    /**
+     * @brief Marks the end of the frame's work. Call just before glutSwapBuffers().
+     */
+    void endFrameWork();
+
+    // --- Stats (over the last STAT_FRAMES frames) ---
+    double getAverageFrameMs() const;
+    double getJitterMs() const;         // Standard deviation of the frame interval
+    double getCpuUsage() const;         // Process CPU time / wall time since the last report (0..1+)
+    int getOverruns() const { return m_overrunsTotal; }
+
+    /**
+     * @brief Prints the stats and starts a new CPU measurement window.
+     */
+    void printReport();
+
+    static const int STAT_FRAMES = 120;
+
+    /**
+     * @brief Runs the old polling idle loop and then the pacer for a few seconds
+     * each, with workMs of simulated work per frame, and prints both reports.
+     * Needs no window: the vsync swap is left out.
+     */
+    static void runBenchmark(double workMs);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void sleepUntil(Clock::time_point deadline);
+    void adapt(double workMs);
+    void recordInterval(Clock::time_point now);
+
+    int m_targetFps;
+    bool m_halfRate;
+    bool m_started;
+    bool m_timerPeriodSet;           // timeBeginPeriod(1) is in effect (Windows)
+    Clock::time_point m_nextFrame;
+    Clock::time_point m_lastFrame;
+    Clock::time_point m_frameStart;  // When the current frame's work began
+    Clock::time_point m_workEnd;     // When it ended (before the swap)
+    bool m_workEnded;                // endFrameWork() was called this frame
+
+    // Adaptation: overruns and slack over recent frames
+    int m_recentFrames;
+    int m_recentOverruns;
+    double m_recentWorkMs;
+    int m_overrunsTotal;
+
+    // Frame interval history (ring buffer)
+    double m_intervals[STAT_FRAMES];
+    int m_intervalCount;
+    int m_intervalNext;
+
+    // CPU usage window
+    Clock::time_point m_reportWall;
+    double m_reportCpu;
+};
+
+extern FramePacer g_framePacer;
@@ -0,0 +1,164 @@
+// GpuMemory.cpp : Video memory accounting per module.
+//
+#include "pch.h" // Must be first
+#include "GpuMemory.h"
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+
+// --- S3TC formats (not in the Windows GL 1.1 headers) ---
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+GpuMemoryTracker g_gpuMemory;
+
+static const char* s_typeNames[GPU_RESOURCE_TYPE_COUNT] = { "Texture", "List", "Buffer" };
+
+static double toKB(size_t bytes) { return bytes / 1024.0; }
+
+GpuMemoryTracker::GpuMemoryTracker() {
+}
+
+size_t GpuMemoryTracker::textureBytes(GLenum internalFormat, int width, int height, int levels) {
+    size_t total = 0;
+    for (int level = 0; level < levels; ++level) {
+        int w = width >> level; if (w < 1) w = 1;
+        int h = height >> level; if (h < 1) h = 1;
+
+        switch (internalFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+            total += (size_t)((w + 3) / 4) * ((h + 3) / 4) * 8;
+            break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            total += (size_t)((w + 3) / 4) * ((h + 3) / 4) * 16;
+            break;
+        case GL_LUMINANCE:
+        case GL_ALPHA:
+        case 1:
+            total += (size_t)w * h;
+            break;
+        default:
+            // RGBA8, and RGB8 which drivers pad to 4 bytes per texel
+            total += (size_t)w * h * 4;
+            break;
+        }
+    }
+    return total;
+}
+
+void GpuMemoryTracker::record(const GpuAllocation& a) {
+    m_allocations[Key((int)a.type, a.id)] = a;
+}
+
+void GpuMemoryTracker::trackTexture(GLuint id, const char* owner, const char* label,
+    GLenum internalFormat, int width, int height, int levels) {
+    GpuAllocation a;
+    a.type = GPU_TEXTURE;
+    a.id = id;
+    a.owner = owner ? owner : "?";
+    a.label = label ? label : "";
+    a.format = internalFormat;
+    a.width = width;
+    a.height = height;
+    a.levels = levels;
+    a.bytes = textureBytes(internalFormat, width, height, levels);
+    record(a);
+}
+
+void GpuMemoryTracker::trackDisplayList(GLuint id, const char* owner, const char* label, int vertexCount) {
+    GpuAllocation a;
+    a.type = GPU_DISPLAY_LIST;
+    a.id = id;
+    a.owner = owner ? owner : "?";
+    a.label = label ? label : "";
+    a.format = 0;
+    a.width = a.height = a.levels = 0;
+    a.bytes = (size_t)vertexCount * DISPLAY_LIST_BYTES_PER_VERTEX;
+    record(a);
+}
+
+void GpuMemoryTracker::trackBuffer(GLuint id, const char* owner, const char* label, size_t bytes) {
+    GpuAllocation a;
+    a.type = GPU_BUFFER;
+    a.id = id;
+    a.owner = owner ? owner : "?";
+    a.label = label ? label : "";
+    a.format = 0;
+    a.width = a.height = a.levels = 0;
+    a.bytes = bytes;
+    record(a);
+}
+
+void GpuMemoryTracker::untrack(GpuResourceType type, GLuint id) {
+    m_allocations.erase(Key((int)type, id));
+}
+
+size_t GpuMemoryTracker::getTotalBytes() const {
+    size_t total = 0;
+    for (const auto& it : m_allocations) total += it.second.bytes;
+    return total;
+}
+
+size_t GpuMemoryTracker::getTotalBytes(GpuResourceType type) const {
+    size_t total = 0;
+    for (const auto& it : m_allocations) {
+        if (it.second.type == type) total += it.second.bytes;
+    }
+    return total;
+}
+
+int GpuMemoryTracker::getCount(GpuResourceType type) const {
+    int count = 0;
+    for (const auto& it : m_allocations) {
+        if (it.second.type == type) ++count;
+    }
+    return count;
+}
+
+void GpuMemoryTracker::printReport() const {
+    // Group by owner, largest first within each owner
+    std::vector<const GpuAllocation*> sorted;
+    for (const auto& it : m_allocations) sorted.push_back(&it.second);
+    std::sort(sorted.begin(), sorted.end(), [](const GpuAllocation* a, const GpuAllocation* b) {
+        if (a->owner != b->owner) return a->owner < b->owner;
+        return a->bytes > b->bytes;
+    });
+
+    printf("\n--- GPU Memory Report ---\n");
+    printf("  Type     ID     Size          Levels        KB  Label\n");
+
+    size_t ownerTotal = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const GpuAllocation& a = *sorted[i];
+        if (i == 0 || a.owner != sorted[i - 1]->owner) {
+            printf("[%s]\n", a.owner.c_str());
+            ownerTotal = 0;
+        }
+
+        if (a.type == GPU_TEXTURE) {
+            printf("  %-7s %4u   %5dx%-5d   %2d     %9.1f  %s\n",
+                s_typeNames[a.type], a.id, a.width, a.height, a.levels, toKB(a.bytes), a.label.c_str());
+        }
+        else {
+            printf("  %-7s %4u   %-11s   %2s     %9.1f  %s\n",
+                s_typeNames[a.type], a.id, "-", "-", toKB(a.bytes), a.label.c_str());
+        }
+        ownerTotal += a.bytes;
+
+        if (i + 1 == sorted.size() || sorted[i + 1]->owner != a.owner) {
+            printf("  %-40s %9.1f KB\n", "owner total", toKB(ownerTotal));
+        }
+    }
+
+    printf("Textures: %d (%.1f KB)  Display lists: %d (%.1f KB)  Buffers: %d (%.1f KB)\n",
+        getCount(GPU_TEXTURE), toKB(getTotalBytes(GPU_TEXTURE)),
+        getCount(GPU_DISPLAY_LIST), toKB(getTotalBytes(GPU_DISPLAY_LIST)),
+        getCount(GPU_BUFFER), toKB(getTotalBytes(GPU_BUFFER)));
+    printf("Total: %.2f MB\n\n", getTotalBytes() / (1024.0 * 1024.0));
+}
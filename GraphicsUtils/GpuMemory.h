@@ -0,0 +1,100 @@
+#pragma once
+#include <glut.h>
+#include <stddef.h>
+#include <string>
+#include <map>
+#include <utility>
+
+// ================================================================
+// GpuMemory
+//
+// Book-keeping of video memory used by the game. Every module reports
+// the textures, display lists and buffers it creates, together with its
+// own name as the owner. Sizes are computed from what was uploaded:
+//  - Textures: internal format x dimensions x resident mip levels.
+//  - Display lists: vertex count x bytes per compiled vertex (position,
+//    normal, texcoord). Drivers don't expose the real size, so this is
+//    an estimate of the geometry the list holds.
+//  - Buffers: the byte size passed to the upload.
+//
+// Only the GL thread touches the tracker.
+// ================================================================
+
+enum GpuResourceType {
+    GPU_TEXTURE = 0,
+    GPU_DISPLAY_LIST,
+    GPU_BUFFER,
+    GPU_RESOURCE_TYPE_COUNT
+};
+
+/**
+ * @brief One tracked GL object.
+ */
+struct GpuAllocation {
+    GpuResourceType type;
+    GLuint id;
+    std::string owner;     // Module name, e.g. "TheRoom"
+    std::string label;     // File name or short description
+    size_t bytes;
+
+    // Textures only
+    GLenum format;
+    int width, height;     // Size of the finest resident level
+    int levels;
+};
+
+class GpuMemoryTracker {
+public:
+    // Position (3 floats) + normal (3 floats) + texcoord (2 floats)
+    static const size_t DISPLAY_LIST_BYTES_PER_VERTEX = 32;
+
+    GpuMemoryTracker();
+
+    /**
+     * @brief Records (or updates) a texture.
+     * @param internalFormat GL internal format it was uploaded with.
+     * @param width, height Size of the finest resident level.
+     * @param levels Number of mip levels resident, starting at that size.
+     */
+    void trackTexture(GLuint id, const char* owner, const char* label,
+        GLenum internalFormat, int width, int height, int levels);
+
+    /**
+     * @brief Records (or updates) a display list from the vertices compiled into it.
+     */
+    void trackDisplayList(GLuint id, const char* owner, const char* label, int vertexCount);
+
+    /**
+     * @brief Records (or updates) a buffer object.
+     */
+    void trackBuffer(GLuint id, const char* owner, const char* label, size_t bytes);
+
+    /**
+     * @brief Forgets an object. Call next to glDelete*.
+     */
+    void untrack(GpuResourceType type, GLuint id);
+
+    size_t getTotalBytes() const;
+    size_t getTotalBytes(GpuResourceType type) const;
+    int getCount(GpuResourceType type) const;
+
+    /**
+     * @brief Prints every allocation grouped by owner, with totals.
+     */
+    void printReport() const;
+
+    /**
+     * @brief Bytes used by a mip chain of the given format.
+     * Block compressed formats are rounded up to whole 4x4 blocks.
+     */
+    static size_t textureBytes(GLenum internalFormat, int width, int height, int levels);
+
+private:
+    typedef std::pair<int, GLuint> Key;
+    std::map<Key, GpuAllocation> m_allocations;
+
+    void record(const GpuAllocation& a);
+};
+
+// Shared tracker every module reports into
+extern GpuMemoryTracker g_gpuMemory;
@@ -4,18 +4,10 @@
 #include "GraphicsUtils.h" // Include your own header
 #include <stdio.h> // For sprintf_s
 #include <math.h>  // For floor, sqrt
-#include <vector>  // For the collision grid
-
-// --- Grid Constants Definitions ---
-// These provide the concrete values for the 'extern' declarations in the header
-const float GRID_SIZE = 40.0f;
-const int   GRID_SEGMENTS = 40;
-const float GRID_CELL_SIZE = GRID_SIZE / GRID_SEGMENTS;
-const float GRID_HALF_SIZE = GRID_SIZE / 2.0f;
+#include <vector>
 
 // --- Collision Grid Data ---
-// Using vector for easier initialization. True means blocked.
-std::vector<std::vector<bool>> g_collisionGrid(GRID_SEGMENTS, std::vector<bool>(GRID_SEGMENTS, false));
+// g_collisionGrid (a flat bitset, true means blocked) lives in CollisionGrid.cpp
 
 // --- Function Definitions ---
 
@@ -46,27 +38,74 @@ void drawAxes(float length) {
     glColor3f(1.0f, 1.0f, 1.0f); // Reset color
 }
 
+void drawPath(const std::vector<PathPoint>& path, float fromX, float fromZ, float height) {
+    if (path.size() < 2) return;
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glLineWidth(3.0f);
+    glColor3f(0.2f, 1.0f, 0.6f);
+
+    glBegin(GL_LINE_STRIP);
+    glVertex3f(fromX, height, fromZ);
+    for (size_t i = 1; i < path.size(); ++i) {
+        glVertex3f(path[i].x, height, path[i].z);
+    }
+    glEnd();
+
+    // Post at the destination, visible over furniture
+    const PathPoint& end = path.back();
+    glBegin(GL_LINES);
+    glVertex3f(end.x, 0.0f, end.z);
+    glVertex3f(end.x, 2.0f, end.z);
+    glEnd();
+
+    glLineWidth(1.0f);
+    glEnable(GL_LIGHTING);
+    glColor3f(1.0f, 1.0f, 1.0f); // Reset color
+}
+
+// Cell range within 'radius' cells of a world point, clipped to the grid
+static void gridWindow(float centerX, float centerZ, int radius, int& x0, int& z0, int& x1, int& z1) {
+    int cx, cz;
+    g_collisionGrid.worldToCell(centerX, centerZ, cx, cz);
+    x0 = cx - radius; z0 = cz - radius;
+    x1 = cx + radius; z1 = cz + radius;
+    if (x0 < 0) x0 = 0;
+    if (z0 < 0) z0 = 0;
+    if (x1 > g_collisionGrid.getWidth() - 1) x1 = g_collisionGrid.getWidth() - 1;
+    if (z1 > g_collisionGrid.getHeight() - 1) z1 = g_collisionGrid.getHeight() - 1;
+}
+
 /**
- * @brief Draws a grid of lines on the XZ plane.
+ * @brief Draws the collision grid's cell lines on the XZ plane.
  */
-void drawGrid(float size, int numSegments) {
+void drawGrid(float centerX, float centerZ, int maxCells) {
+    int x0, z0, x1, z1;
+    gridWindow(centerX, centerZ, maxCells, x0, z0, x1, z1);
+    if (x0 > x1 || z0 > z1) return;
+
     glDisable(GL_LIGHTING);
     glColor3f(0.4f, 0.4f, 0.4f); // Medium grey
 
-    float halfSize = size / 2.0f;
-    float segmentSize = size / numSegments;
+    const float cell = g_collisionGrid.getCellSize();
+    const float minX = g_collisionGrid.getOriginX() + x0 * cell;
+    const float maxX = g_collisionGrid.getOriginX() + (x1 + 1) * cell;
+    const float minZ = g_collisionGrid.getOriginZ() + z0 * cell;
+    const float maxZ = g_collisionGrid.getOriginZ() + (z1 + 1) * cell;
 
     glBegin(GL_LINES);
-    for (int i = 0; i <= numSegments; ++i) {
-        float pos = -halfSize + (i * segmentSize);
-
-        // Lines parallel to Z-axis
-        glVertex3f(pos, 0.0f, -halfSize);
-        glVertex3f(pos, 0.0f, halfSize);
-
-        // Lines parallel to X-axis
-        glVertex3f(-halfSize, 0.0f, pos);
-        glVertex3f(halfSize, 0.0f, pos);
+    // Lines parallel to Z-axis
+    for (int i = x0; i <= x1 + 1; ++i) {
+        float pos = g_collisionGrid.getOriginX() + i * cell;
+        glVertex3f(pos, 0.0f, minZ);
+        glVertex3f(pos, 0.0f, maxZ);
+    }
+    // Lines parallel to X-axis
+    for (int i = z0; i <= z1 + 1; ++i) {
+        float pos = g_collisionGrid.getOriginZ() + i * cell;
+        glVertex3f(minX, 0.0f, pos);
+        glVertex3f(maxX, 0.0f, pos);
     }
     glEnd();
     glEnable(GL_LIGHTING);
@@ -74,34 +113,34 @@ void drawGrid(float size, int numSegments) {
 }
 
 /**
- * @brief Draws (X, Z) coordinate labels in the center of each grid square.
+ * @brief Draws (X, Z) coordinate labels in the center of the grid cells near a point.
  */
-void drawGridCoordinates(float size, int numSegments) {
+void drawGridCoordinates(float centerX, float centerZ, int radiusCells) {
+    int x0, z0, x1, z1;
+    gridWindow(centerX, centerZ, radiusCells, x0, z0, x1, z1);
+
     glDisable(GL_LIGHTING);
     glColor3f(1.0f, 1.0f, 0.5f); // Yellow text
 
-    float halfSize = size / 2.0f;
-    float segmentSize = size / numSegments;
+    const float cell = g_collisionGrid.getCellSize();
     float textYOffset = 0.02f; // Slightly above the grid lines
 
     void* font = GLUT_BITMAP_HELVETICA_10; // Small font
-    char textBuffer[16];
-
-    for (int i = 0; i < numSegments; ++i) { // Z loop (rows)
-        for (int j = 0; j < numSegments; ++j) { // X loop (columns)
+    char textBuffer[32];
 
-            float cellX_BL = -halfSize + (j * segmentSize);
-            float cellZ_BL = -halfSize + (i * segmentSize);
-            float centerX = cellX_BL + (segmentSize / 2.0f);
-            float centerZ = cellZ_BL + (segmentSize / 2.0f);
+    for (int i = z0; i <= z1; ++i) { // Z loop (rows)
+        for (int j = x0; j <= x1; ++j) { // X loop (columns)
+            float cellCenterX, cellCenterZ;
+            g_collisionGrid.cellCenter(j, i, cellCenterX, cellCenterZ);
 
-            int gridCoordX = (int)floor(centerX / segmentSize);
-            int gridCoordZ = (int)floor(centerZ / segmentSize);
+            // Labels show world coordinates in cell units
+            int gridCoordX = (int)floor(cellCenterX / cell);
+            int gridCoordZ = (int)floor(cellCenterZ / cell);
 
             // Use safer sprintf_s
             sprintf_s(textBuffer, sizeof(textBuffer), "(%d,%d)", gridCoordX, gridCoordZ);
 
-            glRasterPos3f(centerX, textYOffset, centerZ);
+            glRasterPos3f(cellCenterX, textYOffset, cellCenterZ);
 
             char* c = textBuffer;
             while (*c) {
@@ -119,35 +158,44 @@ void drawGridCoordinates(float size, int numSegments) {
  * @brief Converts world X, Z coordinates to grid indices.
  */
 bool worldToGrid(float worldX, float worldZ, int& gridX, int& gridZ) {
-    float shiftedX = worldX + GRID_HALF_SIZE;
-    float shiftedZ = worldZ + GRID_HALF_SIZE;
-
-    gridX = static_cast<int>(floor(shiftedX / GRID_CELL_SIZE));
-    gridZ = static_cast<int>(floor(shiftedZ / GRID_CELL_SIZE));
-
-    // Check bounds
-    return (gridX >= 0 && gridX < GRID_SEGMENTS && gridZ >= 0 && gridZ < GRID_SEGMENTS);
+    // True if the cell is inside the grid
+    return g_collisionGrid.worldToCell(worldX, worldZ, gridX, gridZ);
 }
 
 /**
  * @brief Checks if a target world position (X, Z) corresponds to a blocked grid cell.
  */
 bool isGridPositionBlocked(float worldX, float worldZ) {
-    int gridX, gridZ;
-    if (worldToGrid(worldX, worldZ, gridX, gridZ)) {
-        // Access using [row][column] which corresponds to [Z][X]
-        return g_collisionGrid[gridZ][gridX];
+    return g_collisionGrid.isWorldBlocked(worldX, worldZ); // Outside the defined grid is considered blocked
+}
+
+/**
+ * @brief Checks many world positions at once.
+ */
+void areGridPositionsBlocked(const float* worldX, const float* worldZ, int count, bool* outBlocked) {
+    const CollisionGrid& grid = g_collisionGrid;
+    for (int i = 0; i < count; ++i) {
+        outBlocked[i] = grid.isWorldBlocked(worldX[i], worldZ[i]);
     }
-    return true; // Outside the defined grid is considered blocked
+}
+
+/**
+ * @brief Checks if any cell touched by a world rectangle is blocked.
+ */
+bool isGridAreaBlocked(float minX, float minZ, float maxX, float maxZ) {
+    int x0, z0, x1, z1;
+    worldToGrid(minX, minZ, x0, z0);
+    worldToGrid(maxX, maxZ, x1, z1);
+    return g_collisionGrid.anyInRect(x0, z0, x1, z1);
 }
 
 /**
  * @brief Marks a grid cell as blocked using integer grid coordinates.
  */
 void addBlockGridBox(int gridX, int gridZ) {
-    // Check if the grid coordinates are valid before accessing the vector
-    if (gridZ >= 0 && gridZ < g_collisionGrid.size() && gridX >= 0 && gridX < g_collisionGrid[0].size()) {
-        g_collisionGrid[gridZ][gridX] = true; // Mark as blocked
+    // Check if the grid coordinates are valid before accessing the grid
+    if (g_collisionGrid.inBounds(gridX, gridZ)) {
+        g_collisionGrid.set(gridX, gridZ, true); // Mark as blocked
     }
     else {
         printf("Warning: Attempted to block invalid grid cell (%d, %d)\n", gridX, gridZ);
@@ -158,15 +206,53 @@ void addBlockGridBox(int gridX, int gridZ) {
  * @brief Marks a grid cell as unblocked (walkable) using integer grid coordinates.
  */
 void removeBlockGridBox(int gridX, int gridZ) {
-    // Check if the grid coordinates are valid before accessing the vector
-    if (gridZ >= 0 && gridZ < g_collisionGrid.size() && gridX >= 0 && gridX < g_collisionGrid[0].size()) {
-        g_collisionGrid[gridZ][gridX] = false; // Mark as unblocked (walkable)
+    // Check if the grid coordinates are valid before accessing the grid
+    if (g_collisionGrid.inBounds(gridX, gridZ)) {
+        g_collisionGrid.set(gridX, gridZ, false); // Mark as unblocked (walkable)
     }
     else {
         printf("Warning: Attempted to unblock invalid grid cell (%d, %d)\n", gridX, gridZ);
     }
 }
 
+/**
+ * @brief Marks every grid cell as walkable.
+ */
+void clearCollisionGrid() {
+    g_collisionGrid.fill(false);
+}
+
+/**
+ * @brief Marks a rectangle of grid cells as blocked (inclusive, clipped to the grid).
+ */
+void addBlockGridRect(int gridX0, int gridZ0, int gridX1, int gridZ1) {
+    g_collisionGrid.fillRect(gridX0, gridZ0, gridX1, gridZ1, true);
+}
+
+/**
+ * @brief Marks every grid cell touched by a world rectangle as blocked.
+ */
+void blockGridArea(float minX, float minZ, float maxX, float maxZ) {
+    int x0, z0, x1, z1;
+    worldToGrid(minX, minZ, x0, z0);
+    worldToGrid(maxX, maxZ, x1, z1);
+    g_collisionGrid.fillRect(x0, z0, x1, z1, true);
+}
+
+/**
+ * @brief Packs the collision grid into bits.
+ */
+void saveCollisionGrid(std::vector<unsigned char>& outBits) {
+    g_collisionGrid.saveBits(outBits);
+}
+
+/**
+ * @brief Replaces the collision grid with packed bits.
+ */
+bool loadCollisionGrid(const unsigned char* bits, int width, int height) {
+    return g_collisionGrid.loadBits(bits, width, height);
+}
+
 
 void drawTexturedCube(float size, GLuint textureID) {
     if (textureID == 0) {
@@ -1,13 +1,14 @@
 #pragma once
 #include "pch.h" // Gets <glut.h>
 #include <glut.h>
+#include <vector>
+#include "CollisionGrid.h"
+#include "Pathfinder.h"
 
-// --- Grid Constants ---
-// Use 'extern' for global constants defined elsewhere (in GraphicsUtils.cpp)
-extern const float GRID_SIZE;
-extern const int   GRID_SEGMENTS;
-extern const float GRID_CELL_SIZE;
-extern const float GRID_HALF_SIZE;
+// --- Grid ---
+// The collision grid's size, origin and cell size are set at runtime
+// (g_collisionGrid.configure, usually from the level); every function
+// below works on that grid.
 
 // --- Function Declarations ---
 
@@ -18,18 +19,24 @@ extern const float GRID_HALF_SIZE;
 void drawAxes(float length);
 
 /**
- * @brief Draws a grid of lines on the XZ plane, centered at the origin.
- * @param size The total width and depth of the grid (e.g., 20.0f).
- * @param numSegments The number of squares in each direction (e.g., 20).
+ * @brief Draws the collision grid's cell lines on the XZ plane.
+ * Large grids only draw the lines within maxCells of (centerX, centerZ).
  */
-void drawGrid(float size, int numSegments);
+void drawGrid(float centerX, float centerZ, int maxCells = 100);
 
 /**
- * @brief Draws (X, Z) coordinate labels in the center of each grid square.
- * @param size The total width and depth of the grid (must match drawGrid).
- * @param numSegments The number of squares (must match drawGrid).
+ * @brief Draws (X, Z) coordinate labels in the center of the grid cells
+ * within radiusCells of (centerX, centerZ).
  */
-void drawGridCoordinates(float size, int numSegments);
+void drawGridCoordinates(float centerX, float centerZ, int radiusCells = 20);
+
+/**
+ * @brief Draws a path as a glowing line just above the floor, with a
+ * post marking its end.
+ * @param fromX, fromZ Where the line starts (e.g. the player), instead of the path's first point.
+ * @param height Height of the line above the floor.
+ */
+void drawPath(const std::vector<PathPoint>& path, float fromX, float fromZ, float height = 0.05f);
 
 /**
  * @brief Converts world X, Z coordinates to grid indices.
@@ -49,6 +56,21 @@ bool worldToGrid(float worldX, float worldZ, int& gridX, int& gridZ);
  */
 bool isGridPositionBlocked(float worldX, float worldZ);
 
+/**
+ * @brief Batched isGridPositionBlocked for many points (e.g. agents).
+ * @param worldX Array of count X coordinates.
+ * @param worldZ Array of count Z coordinates.
+ * @param count Number of points.
+ * @param outBlocked Output: one result per point (outside the grid = blocked).
+ */
+void areGridPositionsBlocked(const float* worldX, const float* worldZ, int count, bool* outBlocked);
+
+/**
+ * @brief Checks if any grid cell touched by a world rectangle is blocked.
+ * @return True if a touched cell is blocked or the rectangle leaves the grid.
+ */
+bool isGridAreaBlocked(float minX, float minZ, float maxX, float maxZ);
+
 /**
  * @brief Marks a grid cell as blocked using integer grid coordinates.
  * @param gridX The X index of the cell (column).
@@ -56,6 +78,18 @@ bool isGridPositionBlocked(float worldX, float worldZ);
  */
 void addBlockGridBox(int gridX, int gridZ);
 
+/**
+ * @brief Marks a rectangle of grid cells as blocked, a word at a time.
+ * Corners are inclusive; the rectangle is clipped to the grid.
+ */
+void addBlockGridRect(int gridX0, int gridZ0, int gridX1, int gridZ1);
+
+/**
+ * @brief Marks every grid cell touched by a world rectangle as blocked.
+ * @param minX, minZ, maxX, maxZ World bounds of the rectangle (clipped to the grid).
+ */
+void blockGridArea(float minX, float minZ, float maxX, float maxZ);
+
 /**
  * @brief Marks a grid cell as unblocked (walkable) using integer grid coordinates.
  * @param gridX The X index of the cell (column).
@@ -63,6 +97,28 @@ void addBlockGridBox(int gridX, int gridZ);
  */
 void removeBlockGridBox(int gridX, int gridZ);
 
+/**
+ * @brief Marks every grid cell as walkable. Used before the modules re-apply
+ * their collision after a layout reload.
+ */
+void clearCollisionGrid();
+
+/**
+ * @brief Packs the collision grid into bits (row by row, 1 bit per cell,
+ * lowest bit first, each row padded to whole bytes).
+ * @param outBits Receives (width + 7) / 8 * height bytes.
+ */
+void saveCollisionGrid(std::vector<unsigned char>& outBits);
+
+/**
+ * @brief Replaces the collision grid with bits written by saveCollisionGrid.
+ * @param bits The packed grid.
+ * @param width Number of columns stored in bits.
+ * @param height Number of rows stored in bits.
+ * @return False (grid untouched) if the size does not match the current grid.
+ */
+bool loadCollisionGrid(const unsigned char* bits, int width, int height);
+
 
 //test
 void drawTexturedCube(float size, GLuint textureID);
\ No newline at end of file
@@ -0,0 +1,80 @@
+// HeightField.cpp : Floor heights sampled from the collider boxes.
+//
+#include "pch.h" // Must be first
+#include "HeightField.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+HeightField g_heightField;
+
+HeightField::HeightField()
+    : m_width(0), m_height(0), m_spacing(1.0f), m_invSpacing(1.0f), m_originX(0.0f), m_originZ(0.0f)
+{
+}
+
+void HeightField::clear() {
+    m_heights.clear();
+    m_width = m_height = 0;
+}
+
+void HeightField::build(const CollisionWorld& world, const CollisionGrid& grid, int samplesPerCell) {
+    if (samplesPerCell < 1) samplesPerCell = 1;
+    m_width = grid.getWidth() * samplesPerCell;
+    m_height = grid.getHeight() * samplesPerCell;
+    m_spacing = grid.getCellSize() / samplesPerCell;
+    m_invSpacing = 1.0f / m_spacing;
+    m_originX = grid.getOriginX();
+    m_originZ = grid.getOriginZ();
+    m_heights.assign((size_t)m_width * m_height, 0.0f);
+
+    std::vector<ColliderShape> boxes;
+    world.findBoxes(m_originX, m_originZ, m_originX + m_width * m_spacing, m_originZ + m_height * m_spacing, boxes);
+    int raised = 0;
+    for (const ColliderShape& b : boxes) {
+        if (b.top >= COLLIDER_FULL_HEIGHT) continue;
+        raiseBox(b);
+        raised++;
+    }
+    printf("HeightField: %dx%d samples, %d boxes\n", m_width, m_height, raised);
+}
+
+void HeightField::raiseBox(const ColliderShape& b) {
+    // Samples whose center lies inside the oriented box
+    float ex = fabsf(b.ux) * b.hx + fabsf(b.uz) * b.hz;
+    float ez = fabsf(b.uz) * b.hx + fabsf(b.ux) * b.hz;
+    int x0 = std::max(0, (int)floorf((b.cx - ex - m_originX) * m_invSpacing));
+    int x1 = std::min(m_width - 1, (int)floorf((b.cx + ex - m_originX) * m_invSpacing));
+    int z0 = std::max(0, (int)floorf((b.cz - ez - m_originZ) * m_invSpacing));
+    int z1 = std::min(m_height - 1, (int)floorf((b.cz + ez - m_originZ) * m_invSpacing));
+    for (int z = z0; z <= z1; ++z) {
+        float rz = m_originZ + (z + 0.5f) * m_spacing - b.cz;
+        for (int x = x0; x <= x1; ++x) {
+            float rx = m_originX + (x + 0.5f) * m_spacing - b.cx;
+            if (fabsf(rx * b.ux + rz * b.uz) > b.hx) continue;
+            if (fabsf(-rx * b.uz + rz * b.ux) > b.hz) continue;
+            float& h = m_heights[(size_t)z * m_width + x];
+            h = std::max(h, b.top);
+        }
+    }
+}
+
+float HeightField::groundUnder(float x, float z, float radius, float maxY) const {
+    float ground = 0.0f;
+    int x0 = std::max(0, (int)floorf((x - radius - m_originX) * m_invSpacing));
+    int x1 = std::min(m_width - 1, (int)floorf((x + radius - m_originX) * m_invSpacing));
+    int z0 = std::max(0, (int)floorf((z - radius - m_originZ) * m_invSpacing));
+    int z1 = std::min(m_height - 1, (int)floorf((z + radius - m_originZ) * m_invSpacing));
+    float r2 = radius * radius;
+    for (int sz = z0; sz <= z1; ++sz) {
+        // Nearest point of the sample to the circle's center
+        float cz = std::max(m_originZ + sz * m_spacing, std::min(z, m_originZ + (sz + 1) * m_spacing));
+        for (int sx = x0; sx <= x1; ++sx) {
+            float cx = std::max(m_originX + sx * m_spacing, std::min(x, m_originX + (sx + 1) * m_spacing));
+            if ((cx - x) * (cx - x) + (cz - z) * (cz - z) > r2) continue;
+            float h = m_heights[(size_t)sz * m_width + sx];
+            if (h <= maxY) ground = std::max(ground, h);
+        }
+    }
+    return ground;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <math.h>
+#include <vector>
+#include "CollisionGrid.h"
+#include "CollisionWorld.h"
+
+// ================================================================
+// HeightField
+//
+// Height of whatever stands on the floor, sampled a few times per grid
+// cell (2.5D: one height per sample, 0 = bare floor). It is built from
+// the colliders of the CollisionWorld, so furniture and tower bases need
+// no extra data: every box with a finite top raises the samples inside
+// it to that top. Walls and doors reach the ceiling and are left out
+// (nothing stands on them).
+//
+// Queries are O(1): the height under a point, or the highest surface
+// under a small circle that is still low enough to step onto (used by the
+// camera for its ground height and step-up limit).
+// ================================================================
+
+class HeightField {
+public:
+    HeightField();
+
+    /**
+     * @brief Samples the colliders over the area of a grid.
+     * @param samplesPerCell Samples along each side of a grid cell.
+     */
+    void build(const CollisionWorld& world, const CollisionGrid& grid, int samplesPerCell = 4);
+
+    void clear();
+
+    bool isReady() const { return !m_heights.empty(); }
+
+    /**
+     * @brief Height at a world position (0 outside the field).
+     */
+    float heightAt(float x, float z) const {
+        int sx = (int)floorf((x - m_originX) * m_invSpacing);
+        int sz = (int)floorf((z - m_originZ) * m_invSpacing);
+        if (sx < 0 || sz < 0 || sx >= m_width || sz >= m_height) return 0.0f;
+        return m_heights[(size_t)sz * m_width + sx];
+    }
+
+    /**
+     * @brief Highest surface under a circle that is no higher than maxY
+     * (higher ones are obstacles beside the circle, not ground). 0 if none.
+     * The circle should be small: every sample around it is visited.
+     */
+    float groundUnder(float x, float z, float radius, float maxY) const;
+
+private:
+    void raiseBox(const ColliderShape& box);
+
+    int m_width, m_height;      // Samples
+    float m_spacing, m_invSpacing;
+    float m_originX, m_originZ;
+    std::vector<float> m_heights;
+};
+
+extern HeightField g_heightField;
@@ -0,0 +1,76 @@
+// InteractableIndex.cpp : Spatial hash of interactable objects.
+//
+#include "pch.h" // Must be first
+#include "InteractableIndex.h"
+#include <math.h>
+
+InteractableIndex g_interactables;
+
+InteractableIndex::InteractableIndex(float cellSize)
+    : m_cellSize(cellSize > 0.0f ? cellSize : 4.0f), m_queryStamp(0)
+{
+}
+
+int InteractableIndex::cellOf(float v) const {
+    return (int)floorf(v / m_cellSize);
+}
+
+void InteractableIndex::insert(int item) {
+    const Interactable& obj = m_items[item];
+    int cx0 = cellOf(obj.x - obj.radius), cx1 = cellOf(obj.x + obj.radius);
+    int cz0 = cellOf(obj.z - obj.radius), cz1 = cellOf(obj.z + obj.radius);
+    for (int cz = cz0; cz <= cz1; ++cz) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            m_buckets[key(cx, cz)].push_back(item);
+        }
+    }
+}
+
+void InteractableIndex::rebuild() {
+    m_buckets.clear();
+    for (int i = 0; i < (int)m_items.size(); ++i) insert(i);
+}
+
+void InteractableIndex::add(float x, float z, float radius, int kind, int index, const void* owner) {
+    Interactable obj = { x, z, radius, kind, index, owner };
+    m_items.push_back(obj);
+    m_seen.push_back(0);
+    insert((int)m_items.size() - 1);
+}
+
+void InteractableIndex::removeOwner(const void* owner) {
+    size_t kept = 0;
+    for (size_t i = 0; i < m_items.size(); ++i) {
+        if (m_items[i].owner != owner) m_items[kept++] = m_items[i];
+    }
+    if (kept == m_items.size()) return;
+
+    m_items.resize(kept);
+    m_seen.assign(kept, 0);
+    m_queryStamp = 0;
+    rebuild(); // Item numbers changed
+}
+
+void InteractableIndex::clear() {
+    m_items.clear();
+    m_buckets.clear();
+    m_seen.clear();
+    m_queryStamp = 0;
+}
+
+int InteractableIndex::findNearest(float x, float z, float range, const void* owner) const {
+    int nearest = -1;
+    float best = range * range;
+
+    // Center distance, like the modules' interaction range (no radius added)
+    forEachNear(x, z, range, [&](const Interactable& obj) {
+        if (obj.owner != owner) return;
+        float dx = obj.x - x, dz = obj.z - z;
+        float d2 = dx * dx + dz * dz;
+        if (d2 < best || (d2 == best && nearest != -1 && obj.index < nearest)) {
+            best = d2;
+            nearest = obj.index;
+        }
+    });
+    return nearest;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+
+// ================================================================
+// InteractableIndex
+//
+// Spatial hash of everything the player can interact with (books, doors,
+// and whatever comes next). Objects are bucketed by the square cells
+// their bounding circle overlaps, so "what is near the player" only looks
+// at a few buckets however many objects the level holds.
+//
+// Modules register their objects with an owner pointer and their own
+// object index, and remove them all at once before re-adding (same
+// pattern as TextureStreamer anchors).
+// ================================================================
+
+enum InteractableKind {
+    INTERACT_BOOK = 0,
+    INTERACT_DOOR
+};
+
+struct Interactable {
+    float x, z;
+    float radius;          // Bounding circle of the object on the floor
+    int kind;              // InteractableKind
+    int index;             // Object index inside its module
+    const void* owner;     // Module that added it
+};
+
+class InteractableIndex {
+public:
+    /**
+     * @param cellSize Bucket size in world units (a few times a typical reach).
+     */
+    explicit InteractableIndex(float cellSize = 4.0f);
+
+    void add(float x, float z, float radius, int kind, int index, const void* owner);
+
+    /**
+     * @brief Removes every object added by a module.
+     */
+    void removeOwner(const void* owner);
+
+    void clear();
+
+    int getCount() const { return (int)m_items.size(); }
+
+    /**
+     * @brief Calls fn(const Interactable&) once for every object whose bounding
+     * circle comes within 'range' of (x, z). Order is unspecified.
+     */
+    template <typename Fn>
+    void forEachNear(float x, float z, float range, Fn fn) const;
+
+    /**
+     * @brief Object of one owner whose center is nearest to (x, z) and closer than range.
+     * @return The object's module index, or -1.
+     */
+    int findNearest(float x, float z, float range, const void* owner) const;
+
+private:
+    long long key(int cx, int cz) const { return ((long long)cx << 32) ^ (unsigned int)cz; }
+    int cellOf(float v) const;
+    void insert(int item);
+    void rebuild();
+
+    float m_cellSize;
+    std::vector<Interactable> m_items;
+    std::unordered_map<long long, std::vector<int>> m_buckets;
+
+    // Large objects sit in several buckets; stamps skip repeats within one query
+    mutable std::vector<unsigned int> m_seen;
+    mutable unsigned int m_queryStamp;
+};
+
+extern InteractableIndex g_interactables;
+
+template <typename Fn>
+void InteractableIndex::forEachNear(float x, float z, float range, Fn fn) const {
+    if (m_items.empty()) return;
+
+    if (++m_queryStamp == 0) {
+        // Stamp wrapped around: forget old marks
+        for (auto& s : m_seen) s = 0;
+        m_queryStamp = 1;
+    }
+
+    int cx0 = cellOf(x - range), cx1 = cellOf(x + range);
+    int cz0 = cellOf(z - range), cz1 = cellOf(z + range);
+    for (int cz = cz0; cz <= cz1; ++cz) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            auto it = m_buckets.find(key(cx, cz));
+            if (it == m_buckets.end()) continue;
+
+            for (int item : it->second) {
+                if (m_seen[item] == m_queryStamp) continue;
+                m_seen[item] = m_queryStamp;
+
+                const Interactable& obj = m_items[item];
+                float dx = obj.x - x, dz = obj.z - z;
+                float reach = range + obj.radius;
+                if (dx * dx + dz * dz <= reach * reach) fn(obj);
+            }
+        }
+    }
+}
@@ -0,0 +1,402 @@
+// JobSystem.cpp : Work-stealing worker threads, task graphs and parallel loops.
+//
+#include "pch.h" // Must be first
+#include "JobSystem.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+JobSystem g_jobSystem;
+
+typedef std::chrono::steady_clock Clock;
+
+// Pool the current thread works for (null on the main thread and threads
+// no pool owns) and its queue there
+static thread_local const JobSystem* t_pool = nullptr;
+static thread_local int t_queue = 0;
+
+// Queue the current thread pushes to: its own on a worker of 'pool', else 0
+static int ownQueue(const JobSystem* pool) {
+    return (t_pool == pool) ? t_queue : 0;
+}
+
+struct Job {
+    JobFunction fn;
+    const char* name;
+    JobAffinity affinity;
+    std::atomic<int> pending;       // Unfinished prerequisites, +1 until submitted
+    std::atomic<bool> done;
+
+    std::mutex mutex;               // Guards the two below against finishing
+    bool finished;
+    std::vector<JobHandle> continuations;
+};
+
+JobSystem::JobSystem()
+    : m_mainThread(std::this_thread::get_id()), m_running(false), m_queued(0), m_mainQueued(0), m_waiters(0)
+{
+    m_queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+}
+
+JobSystem::~JobSystem() {
+    stop();
+}
+
+void JobSystem::start(int workers) {
+    if (m_running) return;
+    if (workers < 0) {
+        int cores = (int)std::thread::hardware_concurrency();
+        workers = cores > 1 ? cores - 1 : 0;
+    }
+    m_mainThread = std::this_thread::get_id();
+    m_running = true;
+    for (int i = 0; i < workers; ++i) {
+        m_queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (int i = 0; i < workers; ++i) {
+        m_threads.push_back(std::thread(&JobSystem::workerLoop, this, i + 1));
+    }
+    printf("JobSystem: %d worker threads\n", workers);
+}
+
+void JobSystem::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_threads) {
+        if (t.joinable()) t.join();
+    }
+    m_threads.clear();
+    m_queues.resize(1);
+    m_queues[0]->jobs.clear();
+    m_mainJobs.jobs.clear();
+    m_queued = 0;
+    m_mainQueued = 0;
+}
+
+// ================================================================
+// Task graphs
+// ================================================================
+
+JobHandle JobSystem::createJob(const char* name, const JobFunction& fn, JobAffinity affinity) {
+    JobHandle job = std::make_shared<Job>();
+    job->fn = fn;
+    job->name = name;
+    job->affinity = affinity;
+    job->pending = 1;
+    job->done = false;
+    job->finished = false;
+    return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& prerequisite) {
+    std::lock_guard<std::mutex> lock(prerequisite->mutex);
+    if (prerequisite->finished) return;
+    job->pending++;
+    prerequisite->continuations.push_back(job);
+}
+
+void JobSystem::submit(const JobHandle& job) {
+    if (job->pending.fetch_sub(1) == 1) enqueue(job);
+}
+
+JobHandle JobSystem::run(const char* name, const JobFunction& fn, JobAffinity affinity) {
+    JobHandle job = createJob(name, fn, affinity);
+    submit(job);
+    return job;
+}
+
+JobHandle JobSystem::then(const JobHandle& job, const char* name, const JobFunction& fn, JobAffinity affinity) {
+    JobHandle next = createJob(name, fn, affinity);
+    addDependency(next, job);
+    submit(next);
+    return next;
+}
+
+bool JobSystem::isDone(const JobHandle& job) const {
+    return job->done.load();
+}
+
+void JobSystem::enqueue(const JobHandle& job) {
+    if (job->affinity == JOB_MAIN_THREAD) {
+        {
+            std::lock_guard<std::mutex> lock(m_mainJobs.mutex);
+            m_mainJobs.jobs.push_back(job);
+        }
+        m_mainQueued++;
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_finished.notify_all(); // The main thread may be waiting for it
+        return;
+    }
+
+    // Nobody else would run it
+    if (m_threads.empty()) {
+        execute(job);
+        return;
+    }
+
+    WorkQueue& q = *m_queues[ownQueue(this)];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.jobs.push_back(job);
+    }
+    m_queued++;
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_wake.notify_one();
+}
+
+void JobSystem::execute(const JobHandle& job) {
+    if (job->name) {
+        Clock::time_point t0 = Clock::now();
+        job->fn();
+        record(job->name, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+    else {
+        job->fn();
+    }
+    job->fn = nullptr; // Let go of the captures now
+
+    std::vector<JobHandle> next;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished = true;
+        next.swap(job->continuations);
+    }
+    job->done.store(true);
+    for (const JobHandle& n : next) {
+        if (n->pending.fetch_sub(1) == 1) enqueue(n);
+    }
+
+    if (m_waiters.load() > 0) {
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_finished.notify_all();
+    }
+}
+
+bool JobSystem::runOne(bool mainThread) {
+    JobHandle job;
+
+    // GL work first: it is in order and the frame waits for it
+    if (mainThread && m_mainQueued.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_mainJobs.mutex);
+        if (!m_mainJobs.jobs.empty()) {
+            job = m_mainJobs.jobs.front();
+            m_mainJobs.jobs.pop_front();
+            m_mainQueued--;
+        }
+    }
+    if (job) {
+        execute(job);
+        return true;
+    }
+
+    // Own queue newest first, then steal the oldest job of another queue
+    int count = (int)m_queues.size();
+    int own = ownQueue(this);
+    for (int i = 0; i < count && !job; ++i) {
+        WorkQueue& q = *m_queues[(own + i) % count];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.jobs.empty()) continue;
+        if (i == 0) {
+            job = q.jobs.back();
+            q.jobs.pop_back();
+        }
+        else {
+            job = q.jobs.front();
+            q.jobs.pop_front();
+        }
+    }
+    if (!job) return false;
+    m_queued--;
+    execute(job);
+    return true;
+}
+
+void JobSystem::wait(const JobHandle& job) {
+    bool mainThread = isMainThread();
+    while (!job->done.load()) {
+        if (runOne(mainThread)) continue;
+
+        // Nothing to help with: sleep until a job finishes or work arrives
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_waiters++;
+        m_finished.wait_for(lock, std::chrono::milliseconds(1), [&] {
+            return job->done.load() || m_queued.load() > 0 || (mainThread && m_mainQueued.load() > 0);
+        });
+        m_waiters--;
+    }
+}
+
+void JobSystem::wait(const std::vector<JobHandle>& jobs) {
+    for (const JobHandle& job : jobs) wait(job);
+}
+
+void JobSystem::pumpMainThread() {
+    if (!isMainThread()) return;
+
+    // Only what is queued now; jobs queued by these run next frame
+    int count = m_mainQueued.load();
+    for (int i = 0; i < count; ++i) {
+        JobHandle job;
+        {
+            std::lock_guard<std::mutex> lock(m_mainJobs.mutex);
+            if (m_mainJobs.jobs.empty()) break;
+            job = m_mainJobs.jobs.front();
+            m_mainJobs.jobs.pop_front();
+            m_mainQueued--;
+        }
+        execute(job);
+    }
+}
+
+void JobSystem::workerLoop(int queue) {
+    t_pool = this;
+    t_queue = queue;
+    while (true) {
+        if (runOne(false)) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] { return !m_running || m_queued.load() > 0; });
+        if (!m_running) return;
+    }
+}
+
+// ================================================================
+// Data-parallel loops
+// ================================================================
+
+void JobSystem::parallelFor(int count, int grain, const JobRange& fn, const char* name) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+    Clock::time_point t0 = Clock::now();
+
+    int chunks = (count + grain - 1) / grain;
+    int helpers = std::min(chunks, (int)m_threads.size() + 1) - 1;
+    if (helpers <= 0) {
+        // Not worth waking anyone
+        fn(0, count);
+    }
+    else {
+        // Helpers and the caller claim chunks until none are left; a helper
+        // that starts late finds the counter past the end and returns
+        std::atomic<int> next(0);
+        JobFunction claim = [&]() {
+            for (int chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1)) {
+                int begin = chunk * grain;
+                fn(begin, std::min(begin + grain, count));
+            }
+        };
+        std::vector<JobHandle> jobs;
+        for (int i = 0; i < helpers; ++i) jobs.push_back(run(nullptr, claim));
+        claim();
+        wait(jobs);
+    }
+
+    if (name) record(name, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+}
+
+// ================================================================
+// Profiling
+// ================================================================
+
+void JobSystem::record(const char* name, double ms) {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    auto it = m_stats.find(name);
+    if (it == m_stats.end()) {
+        JobStats s = { name, 0, 0.0, 0.0, 0.0 };
+        it = m_stats.insert(std::make_pair(std::string(name), s)).first;
+    }
+    JobStats& s = it->second;
+    s.count++;
+    s.totalMs += ms;
+    s.worstMs = std::max(s.worstMs, ms);
+    s.lastMs = ms;
+}
+
+void JobSystem::getStats(std::vector<JobStats>& out) const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    out.clear();
+    for (const auto& entry : m_stats) out.push_back(entry.second);
+}
+
+void JobSystem::resetStats() {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_stats.clear();
+}
+
+void JobSystem::printReport() const {
+    std::vector<JobStats> stats;
+    getStats(stats);
+    std::sort(stats.begin(), stats.end(), [](const JobStats& a, const JobStats& b) { return a.totalMs > b.totalMs; });
+
+    printf("\n--- Job Timing Report (%d workers) ---\n", getWorkerCount());
+    printf("  Runs     Total ms   Avg ms   Worst ms   Last ms  Job\n");
+    for (const auto& s : stats) {
+        printf("  %6d  %9.2f  %7.3f  %9.3f  %8.3f  %s\n",
+            s.count, s.totalMs, s.totalMs / std::max(1, s.count), s.worstMs, s.lastMs, s.name.c_str());
+    }
+    printf("\n");
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+// A few microseconds of arithmetic standing in for real work
+static float busyWork(int seed, int iterations) {
+    float x = (float)seed;
+    for (int i = 0; i < iterations; ++i) x = sqrtf(x * x + 1.0f) * 0.999f;
+    return x;
+}
+
+void JobSystem::runBenchmark(int jobs) {
+    if (jobs < 1) jobs = 1;
+    const int WORK = 2000;
+
+    JobSystem pools[2];
+    pools[1].start();
+    double ms[2][3] = {};
+
+    for (int p = 0; p < 2; ++p) {
+        JobSystem& pool = pools[p];
+        std::vector<float> results(jobs, 0.0f);
+
+        // 1. Fan out / fan in: independent jobs feeding one continuation
+        Clock::time_point t0 = Clock::now();
+        JobHandle join = pool.createJob("join", [] {});
+        for (int i = 0; i < jobs; ++i) {
+            JobHandle leaf = pool.createJob("leaf", [&results, i] { results[i] = busyWork(i, WORK); });
+            pool.addDependency(join, leaf);
+            pool.submit(leaf);
+        }
+        pool.submit(join);
+        pool.wait(join);
+        ms[p][0] = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        // 2. Chain: every job waits for the previous one (pure scheduling overhead)
+        t0 = Clock::now();
+        JobHandle last = pool.run("chain", [] {});
+        for (int i = 1; i < jobs; ++i) last = pool.then(last, "chain", [] {});
+        pool.wait(last);
+        ms[p][1] = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        // 3. Parallel loop over the same work
+        t0 = Clock::now();
+        pool.parallelFor(jobs, 16, [&results](int begin, int end) {
+            for (int i = begin; i < end; ++i) results[i] = busyWork(i, WORK);
+        }, "loop");
+        ms[p][2] = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    printf("JobSystem benchmark (%d jobs of %d iterations):\n", jobs, WORK);
+    const char* names[3] = { "fan out/in   ", "chain        ", "parallelFor  " };
+    for (int t = 0; t < 3; ++t) {
+        printf("  %s: 1 thread %8.3f ms, %d threads %8.3f ms (%.1fx)\n", names[t], ms[0][t],
+            pools[1].getWorkerCount() + 1, ms[1][t], ms[0][t] / std::max(ms[1][t], 1e-6));
+    }
+    printf("  chain overhead: %.2f us per job\n", ms[1][1] * 1000.0 / jobs);
+    pools[1].printReport();
+}
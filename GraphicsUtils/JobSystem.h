@@ -0,0 +1,180 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+// ================================================================
+// JobSystem
+//
+// Work-stealing pool of worker threads shared by every subsystem.
+//  - Jobs: a function with a name. Each thread pushes the jobs it makes
+//    ready onto its own queue and takes them back newest first (hot in
+//    cache); a thread with nothing to do steals the oldest job of
+//    another queue, so one busy thread never leaves the others idle.
+//  - Task graphs: a job can wait for other jobs (addDependency) and is
+//    queued once the last of them has finished; then() chains a
+//    continuation onto a job.
+//  - parallelFor() cuts a range into chunks that the calling thread and
+//    the workers claim from a shared counter.
+//  - Main thread jobs: GL work must run on the GLUT thread, so jobs with
+//    JOB_MAIN_THREAD affinity go to a separate queue that only the main
+//    thread runs, from pumpMainThread() (idle()) or while it waits.
+//
+// wait() never just blocks: the waiting thread runs queued jobs until the
+// one it waits for is done, so jobs may wait on (or parallelFor inside)
+// other jobs. Without workers (or before start()) jobs for any thread run
+// on the spot when they become ready.
+//
+// Every named job is timed; printReport() lists count, total and worst
+// time per name for profiling.
+// ================================================================
+
+// Runs items [begin, end) of a parallelFor() range
+typedef std::function<void(int begin, int end)> JobRange;
+typedef std::function<void()> JobFunction;
+
+enum JobAffinity {
+    JOB_ANY_THREAD = 0,
+    JOB_MAIN_THREAD      // GL work: only the GLUT thread runs it
+};
+
+struct Job;
+typedef std::shared_ptr<Job> JobHandle;
+
+/**
+ * @brief Timing of every run of the jobs with one name.
+ */
+struct JobStats {
+    std::string name;
+    int count;
+    double totalMs;
+    double worstMs;
+    double lastMs;
+};
+
+class JobSystem {
+public:
+    JobSystem();
+    ~JobSystem();
+
+    /**
+     * @brief Starts the workers. Call from the main (GLUT) thread.
+     * @param workers Threads besides the caller; -1 = one per remaining hardware core.
+     */
+    void start(int workers = -1);
+
+    /**
+     * @brief Stops the workers. Jobs still queued are dropped.
+     */
+    void stop();
+
+    int getWorkerCount() const { return (int)m_threads.size(); }
+    bool isMainThread() const { return std::this_thread::get_id() == m_mainThread; }
+
+    // --- Task graphs ---
+
+    /**
+     * @brief Makes a job that runs once submitted and once every job added
+     * with addDependency() has finished.
+     * @param name Timing key (a string literal); nullptr = not timed.
+     */
+    JobHandle createJob(const char* name, const JobFunction& fn, JobAffinity affinity = JOB_ANY_THREAD);
+
+    /**
+     * @brief Makes 'job' wait for 'prerequisite'. Call before submit(job).
+     */
+    void addDependency(const JobHandle& job, const JobHandle& prerequisite);
+
+    void submit(const JobHandle& job);
+
+    /**
+     * @brief createJob() + submit().
+     */
+    JobHandle run(const char* name, const JobFunction& fn, JobAffinity affinity = JOB_ANY_THREAD);
+
+    /**
+     * @brief Continuation: a job that runs after 'job' has finished.
+     */
+    JobHandle then(const JobHandle& job, const char* name, const JobFunction& fn, JobAffinity affinity = JOB_ANY_THREAD);
+
+    /**
+     * @brief Queues GL work for the main thread, from any thread.
+     */
+    JobHandle runOnMainThread(const char* name, const JobFunction& fn) { return run(name, fn, JOB_MAIN_THREAD); }
+
+    bool isDone(const JobHandle& job) const;
+
+    /**
+     * @brief Runs queued jobs until 'job' has finished.
+     */
+    void wait(const JobHandle& job);
+    void wait(const std::vector<JobHandle>& jobs);
+
+    /**
+     * @brief Runs the main thread jobs queued so far. Call once per frame from idle().
+     */
+    void pumpMainThread();
+
+    // --- Data-parallel loops ---
+
+    /**
+     * @brief Runs fn over [0, count) in chunks of 'grain' items, in parallel,
+     * and returns once every chunk has run. Chunks may run in any order and
+     * on any thread. The whole loop is timed under 'name'.
+     */
+    void parallelFor(int count, int grain, const JobRange& fn, const char* name = nullptr);
+
+    // --- Profiling ---
+
+    void getStats(std::vector<JobStats>& out) const;
+    void resetStats();
+
+    /**
+     * @brief Prints the timing of every named job to the console.
+     */
+    void printReport() const;
+
+    /**
+     * @brief Times task graphs of many small jobs and parallel loops on
+     * one thread and on the workers, printed to the console.
+     */
+    static void runBenchmark(int jobs);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    void enqueue(const JobHandle& job);
+    void execute(const JobHandle& job);
+    bool runOne(bool mainThread);          // Runs one queued job, false if none was found
+    void workerLoop(int queue);
+    void record(const char* name, double ms);
+
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;  // [0] main thread (and foreign threads), then one per worker
+    WorkQueue m_mainJobs;
+    std::thread::id m_mainThread;
+    bool m_running;
+
+    // Sleeping workers and waiters
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;        // Work for the workers
+    std::condition_variable m_finished;    // A job finished or main thread work arrived
+    std::atomic<int> m_queued;             // Jobs in m_queues
+    std::atomic<int> m_mainQueued;         // Jobs in m_mainJobs
+    std::atomic<int> m_waiters;            // Threads sleeping in wait()
+
+    mutable std::mutex m_statsMutex;
+    std::map<std::string, JobStats> m_stats;
+};
+
+extern JobSystem g_jobSystem;
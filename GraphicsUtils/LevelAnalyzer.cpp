@@ -0,0 +1,504 @@
+// LevelAnalyzer.cpp : Offline reachability and solvability check of a level layout.
+//
+#include "pch.h" // Must be first
+#include "LevelAnalyzer.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline int lowestBit64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (int)index;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+inline int popCount64(uint64_t v) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+// ================================================================
+// Bitmaps
+// ================================================================
+
+// Cell bits in rows of 64-bit words, laid out like the CollisionGrid
+struct Bitmap {
+    int width, height, words;
+    std::vector<uint64_t> bits;
+
+    void init(int w, int h) {
+        width = w;
+        height = h;
+        words = (w + 63) / 64;
+        bits.assign((size_t)words * h, 0);
+    }
+    uint64_t* row(int z) { return &bits[(size_t)z * words]; }
+    const uint64_t* row(int z) const { return &bits[(size_t)z * words]; }
+    bool get(int x, int z) const {
+        if (x < 0 || z < 0 || x >= width || z >= height) return false;
+        return (row(z)[x >> 6] >> (x & 63)) & 1;
+    }
+    void set(int x, int z, bool on) {
+        uint64_t bit = 1ULL << (x & 63);
+        if (on) row(z)[x >> 6] |= bit;
+        else row(z)[x >> 6] &= ~bit;
+    }
+};
+
+// Spreads seeds toward higher bits along the runs of free bits (Kogge-Stone fill)
+inline uint64_t fillUp(uint64_t seeds, uint64_t free) {
+    seeds &= free;
+    seeds |= free & (seeds << 1);  free &= free << 1;
+    seeds |= free & (seeds << 2);  free &= free << 2;
+    seeds |= free & (seeds << 4);  free &= free << 4;
+    seeds |= free & (seeds << 8);  free &= free << 8;
+    seeds |= free & (seeds << 16); free &= free << 16;
+    seeds |= free & (seeds << 32);
+    return seeds;
+}
+
+inline uint64_t fillDown(uint64_t seeds, uint64_t free) {
+    seeds &= free;
+    seeds |= free & (seeds >> 1);  free &= free >> 1;
+    seeds |= free & (seeds >> 2);  free &= free >> 2;
+    seeds |= free & (seeds >> 4);  free &= free >> 4;
+    seeds |= free & (seeds >> 8);  free &= free >> 8;
+    seeds |= free & (seeds >> 16); free &= free >> 16;
+    seeds |= free & (seeds >> 32);
+    return seeds;
+}
+
+// 4-connected flood fill over bitmaps, one row at a time. A row is refilled
+// from itself and its two neighbours; if it grew, its neighbours are queued.
+class Flood {
+public:
+    void init(int height) {
+        m_queued.assign(height, 0);
+        m_rows.clear();
+        m_touched.clear();
+    }
+
+    void queueRow(int z) {
+        if (m_queued[z]) return;
+        m_queued[z] = 1;
+        m_rows.push_back(z);
+    }
+
+    void seed(Bitmap& reach, const Bitmap& free, int x, int z) {
+        if (!free.get(x, z)) return;
+        reach.set(x, z, true);
+        queueRow(z);
+        if (z > 0) queueRow(z - 1); // The seed row itself may not grow
+        if (z + 1 < reach.height) queueRow(z + 1);
+    }
+
+    void run(Bitmap& reach, const Bitmap& free) {
+        int words = reach.words;
+        m_row.resize(words);
+        while (!m_rows.empty()) {
+            int z = m_rows.back();
+            m_rows.pop_back();
+            m_queued[z] = 0;
+
+            uint64_t* r = reach.row(z);
+            const uint64_t* f = free.row(z);
+            const uint64_t* above = z > 0 ? reach.row(z - 1) : nullptr;
+            const uint64_t* below = z + 1 < reach.height ? reach.row(z + 1) : nullptr;
+
+            // Seeds from the rows around, then along the free runs both ways
+            uint64_t carry = 0;
+            for (int w = 0; w < words; ++w) {
+                uint64_t s = r[w] | (above ? above[w] : 0) | (below ? below[w] : 0) | carry;
+                m_row[w] = fillUp(s, f[w]);
+                carry = m_row[w] >> 63;
+            }
+            carry = 0;
+            bool grew = false;
+            for (int w = words - 1; w >= 0; --w) {
+                uint64_t x = fillDown(m_row[w] | (carry << 63), f[w]);
+                carry = x & 1;
+                if (x != r[w]) {
+                    r[w] = x;
+                    grew = true;
+                }
+            }
+            if (!grew) continue;
+
+            m_touched.push_back(z);
+            if (z > 0) queueRow(z - 1);
+            if (z + 1 < reach.height) queueRow(z + 1);
+        }
+    }
+
+    // Rows that changed since the last clearTouched()
+    const std::vector<int>& touched() const { return m_touched; }
+    void clearTouched() { m_touched.clear(); }
+
+private:
+    std::vector<unsigned char> m_queued;
+    std::vector<int> m_rows;
+    std::vector<int> m_touched;
+    std::vector<uint64_t> m_row;
+};
+
+// Cell reached, or (for cells that are blocked) one of the cells around it
+bool reachedNear(const Bitmap& reach, int x, int z) {
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (reach.get(x + dx, z + dz)) return true;
+        }
+    }
+    return false;
+}
+
+// " on floor n" in reports of levels with several floors
+std::string floorName(int floor, int floorCount) {
+    if (floorCount < 2) return "";
+    char s[32];
+    sprintf_s(s, sizeof(s), " on floor %d", floor);
+    return s;
+}
+
+// A door can be used once someone stands next to one of its doorway cells
+bool gateTouched(const Bitmap& area, const std::vector<int>& gate, int width) {
+    for (int c : gate) {
+        int x = c % width, z = c / width;
+        if (area.get(x - 1, z) || area.get(x + 1, z) || area.get(x, z - 1) || area.get(x, z + 1)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// ================================================================
+// Analysis
+// ================================================================
+
+bool analyzeLevel(const CollisionGrid& grid, const LevelLayout& layout,
+    const std::vector<std::vector<int>>& doorGates, LevelReport& report,
+    const std::vector<std::pair<int, int>>* links) {
+    report = LevelReport();
+    report.solvable = false;
+    report.reachableCells = report.unreachableCells = 0;
+    report.unreachablePockets = 0;
+    char line[256];
+
+    int w = grid.getWidth(), h = grid.getHeight();
+    if (w <= 0 || h <= 0) {
+        report.problems.push_back("The level has no collision grid.");
+        return false;
+    }
+    int doorCount = (int)doorGates.size();
+    int floorCount = std::max(1, layout.getFloorCount());
+    int floorRows = h / floorCount; // Floors are stacked along Z
+
+    // Free cells with every door closed
+    Bitmap free;
+    free.init(w, h);
+    for (int z = 0; z < h; ++z) {
+        const uint64_t* g = grid.row(z);
+        uint64_t* f = free.row(z);
+        for (int i = 0; i < free.words; ++i) f[i] = ~g[i];
+        if (w & 63) f[free.words - 1] &= (1ULL << (w & 63)) - 1; // Padding stays blocked
+    }
+    Bitmap closedFree = free;
+
+    // Notes each door needs
+    std::vector<std::vector<int>> clues(doorCount);
+    std::vector<int> bookX(layout.books.size()), bookZ(layout.books.size());
+    for (size_t b = 0; b < layout.books.size(); ++b) {
+        grid.worldToCell(layout.books[b].x, layout.books[b].z, bookX[b], bookZ[b]);
+        bookZ[b] += layout.books[b].floor * floorRows;
+        int door = layout.books[b].clueFor;
+        if (door < 0) continue;
+        if (door < doorCount) {
+            clues[door].push_back((int)b);
+        }
+        else {
+            sprintf_s(line, sizeof(line), "Note %d is a clue for door %d, which does not exist.", (int)b, door);
+            report.problems.push_back(line);
+        }
+    }
+
+    // --- Play the level: fill, open what can be opened, fill again ---
+    Bitmap reach;
+    reach.init(w, h);
+    Flood flood;
+    flood.init(h);
+
+    int sx, sz;
+    grid.worldToCell(layout.spawnX, layout.spawnZ, sx, sz);
+    if (!free.get(sx, sz)) {
+        report.problems.push_back("The spawn point is inside a blocked cell.");
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dx = -1; dx <= 1; ++dx) flood.seed(reach, free, sx + dx, sz + dz);
+        }
+    }
+    else {
+        flood.seed(reach, free, sx, sz);
+    }
+    flood.run(reach, free);
+
+    std::vector<unsigned char> opened(doorCount, 0);
+    for (bool progress = true; progress; ) {
+        progress = false;
+
+        // Stairs: reaching one end reaches the other
+        for (size_t i = 0; links && i < links->size(); ++i) {
+            int a = (*links)[i].first, b = (*links)[i].second;
+            bool reachedA = reach.get(a % w, a / w), reachedB = reach.get(b % w, b / w);
+            int c = reachedA ? b : a;
+            if (reachedA == reachedB || !free.get(c % w, c / w)) continue;
+            flood.seed(reach, free, c % w, c / w);
+            progress = true;
+        }
+
+        for (int d = 0; d < doorCount; ++d) {
+            if (opened[d] || !gateTouched(reach, doorGates[d], w)) continue;
+            bool cluesFound = true;
+            for (int b : clues[d]) cluesFound = cluesFound && reachedNear(reach, bookX[b], bookZ[b]);
+            if (!cluesFound) continue;
+
+            opened[d] = 1;
+            report.openOrder.push_back(d);
+            for (int c : doorGates[d]) {
+                free.set(c % w, c / w, true);
+                flood.queueRow(c / w);
+            }
+            progress = true;
+        }
+        flood.run(reach, free);
+    }
+
+    // --- Doors left closed and why ---
+    for (int d = 0; d < doorCount; ++d) {
+        if (opened[d]) continue;
+        report.lockedDoors.push_back(d);
+        float dx = d < (int)layout.doors.size() ? layout.doors[d].x : 0.0f;
+        float dz = d < (int)layout.doors.size() ? layout.doors[d].z : 0.0f;
+        std::string where = floorName(d < (int)layout.doors.size() ? layout.doors[d].floor : 0, floorCount);
+        if (!gateTouched(reach, doorGates[d], w)) {
+            sprintf_s(line, sizeof(line), "Door %d (%.1f, %.1f)%s can never be reached.", d, dx, dz, where.c_str());
+            report.problems.push_back(line);
+            continue;
+        }
+
+        // Would the clue turn up if this door were open?
+        if (clues[d].empty()) continue;
+        Bitmap behind = reach, behindFree = free;
+        Flood extra;
+        extra.init(h);
+        for (int c : doorGates[d]) {
+            behindFree.set(c % w, c / w, true);
+            extra.queueRow(c / w);
+        }
+        extra.run(behind, behindFree);
+        for (int b : clues[d]) {
+            if (reachedNear(reach, bookX[b], bookZ[b])) continue;
+            if (reachedNear(behind, bookX[b], bookZ[b])) {
+                sprintf_s(line, sizeof(line), "Door %d (%.1f, %.1f)%s is locked for good: its clue, note %d, is behind it.", d, dx, dz, where.c_str(), b);
+            }
+            else {
+                sprintf_s(line, sizeof(line), "Door %d (%.1f, %.1f)%s is locked for good: its clue, note %d, can never be reached.", d, dx, dz, where.c_str(), b);
+            }
+            report.problems.push_back(line);
+        }
+    }
+
+    for (size_t b = 0; b < layout.books.size(); ++b) {
+        if (reachedNear(reach, bookX[b], bookZ[b])) continue;
+        report.missedBooks.push_back((int)b);
+        sprintf_s(line, sizeof(line), "Note %d (%.1f, %.1f)%s can never be reached.", (int)b,
+            layout.books[b].x, layout.books[b].z, floorName(layout.books[b].floor, floorCount).c_str());
+        report.problems.push_back(line);
+    }
+
+    // --- Floor no one can walk to (with every door open) ---
+    Bitmap rest = closedFree;
+    for (const auto& gate : doorGates) {
+        for (int c : gate) rest.set(c % w, c / w, true);
+    }
+    for (int z = 0; z < h; ++z) {
+        uint64_t* r = rest.row(z);
+        const uint64_t* a = reach.row(z);
+        for (int i = 0; i < rest.words; ++i) {
+            report.reachableCells += popCount64(a[i]);
+            r[i] &= ~a[i];
+            report.unreachableCells += popCount64(r[i]);
+        }
+    }
+
+    Bitmap pocket;
+    pocket.init(w, h);
+    long long largest = 0;
+    int largestX = 0, largestZ = 0;
+    flood.init(h);
+    for (int z = 0; z < h; ++z) {
+        for (int i = 0; i < rest.words; ++i) {
+            while (rest.row(z)[i]) {
+                // One pocket: fill it, measure it and take it out of the rest
+                int x = (i << 6) + lowestBit64(rest.row(z)[i]);
+                flood.clearTouched();
+                flood.seed(pocket, rest, x, z);
+                flood.run(pocket, rest);
+                long long size = 0;
+                std::vector<int> rows = flood.touched();
+                rows.push_back(z);
+                std::sort(rows.begin(), rows.end());
+                rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+                for (int pz : rows) {
+                    uint64_t* p = pocket.row(pz);
+                    uint64_t* r = rest.row(pz);
+                    for (int k = 0; k < rest.words; ++k) {
+                        size += popCount64(p[k]);
+                        r[k] &= ~p[k];
+                        p[k] = 0;
+                    }
+                }
+                report.unreachablePockets++;
+                if (size > largest) { largest = size; largestX = x; largestZ = z; }
+            }
+        }
+    }
+    if (report.unreachableCells > 0) {
+        float px, pz;
+        grid.cellCenter(largestX, largestZ % floorRows, px, pz);
+        sprintf_s(line, sizeof(line), "%lld walkable cells in %d pockets can never be reached (largest: %lld cells at %.1f, %.1f%s).",
+            report.unreachableCells, report.unreachablePockets, largest, px, pz, floorName(largestZ / floorRows, floorCount).c_str());
+        report.problems.push_back(line);
+    }
+
+    // --- Rooms that lead nowhere: areas between doors (across stairs) with no notes and a single door ---
+    Bitmap rooms = reach;
+    for (int z = 0; z < h; ++z) {
+        uint64_t* r = rooms.row(z);
+        const uint64_t* c = closedFree.row(z);
+        for (int i = 0; i < rooms.words; ++i) r[i] &= c[i];
+    }
+    Bitmap room;
+    room.init(w, h);
+    for (int z = 0; z < h; ++z) {
+        for (int i = 0; i < rooms.words; ++i) {
+            while (rooms.row(z)[i]) {
+                int x = (i << 6) + lowestBit64(rooms.row(z)[i]);
+                flood.clearTouched();
+                flood.seed(room, rooms, x, z);
+                flood.run(room, rooms);
+
+                // A room goes on up (or down) its stairs
+                std::vector<int> rows;
+                rows.push_back(z);
+                for (bool grew = true; grew; ) {
+                    grew = false;
+                    for (size_t l = 0; links && l < links->size(); ++l) {
+                        int a = (*links)[l].first, b = (*links)[l].second;
+                        bool inA = room.get(a % w, a / w), inB = room.get(b % w, b / w);
+                        int c = inA ? b : a;
+                        if (inA == inB || !rooms.get(c % w, c / w)) continue;
+                        flood.seed(room, rooms, c % w, c / w);
+                        rows.push_back(c / w);
+                        grew = true;
+                    }
+                    flood.run(room, rooms);
+                }
+
+                bool hasSpawn = reachedNear(room, sx, sz);
+                bool hasBook = false;
+                for (size_t b = 0; b < layout.books.size() && !hasBook; ++b) hasBook = reachedNear(room, bookX[b], bookZ[b]);
+                int doors = 0, lastDoor = -1;
+                for (int d = 0; d < doorCount; ++d) {
+                    if (opened[d] && gateTouched(room, doorGates[d], w)) { doors++; lastDoor = d; }
+                }
+                if (!hasSpawn && !hasBook && doors == 1) {
+                    report.deadEndDoors.push_back(lastDoor);
+                    sprintf_s(line, sizeof(line), "Door %d leads to a room with no notes and no other door (fine for the exit).", lastDoor);
+                    report.problems.push_back(line);
+                }
+
+                rows.insert(rows.end(), flood.touched().begin(), flood.touched().end());
+                std::sort(rows.begin(), rows.end());
+                rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+                for (int rz : rows) {
+                    uint64_t* p = room.row(rz);
+                    uint64_t* r = rooms.row(rz);
+                    for (int k = 0; k < rooms.words; ++k) {
+                        r[k] &= ~p[k];
+                        p[k] = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    report.solvable = report.lockedDoors.empty() && report.missedBooks.empty();
+    return report.solvable;
+}
+
+void printLevelReport(const LevelReport& report) {
+    printf("LevelAnalyzer: %s (%lld reachable cells, doors open in order:",
+        report.solvable ? "solvable" : "NOT solvable", report.reachableCells);
+    for (int d : report.openOrder) printf(" %d", d);
+    printf(")\n");
+    for (const auto& p : report.problems) printf("  - %s\n", p.c_str());
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+void runLevelAnalyzerBenchmark(int size) {
+    typedef std::chrono::steady_clock Clock;
+    if (size < 100) size = 100;
+
+    // A venue of 50 x 50 rooms with furniture; every doorway is a door whose
+    // clue lies in the room it is reached from
+    CollisionGrid grid;
+    makeBenchmarkVenue(grid, size, false);
+    LevelLayout layout;
+    layout.spawnX = -size / 2.0f + 12.5f;
+    layout.spawnZ = -size / 2.0f + 12.5f;
+    grid.fillRect(10, 10, 14, 14, false); // Keep the spawn point clear
+
+    std::vector<std::vector<int>> gates;
+    for (int wall = 25; wall < size; wall += 50) {
+        for (int gap = 10; gap + 2 < size; gap += 50) {
+            for (int across = 0; across < 2; ++across) {
+                std::vector<int> gate;
+                for (int i = gap; i <= gap + 2; ++i) gate.push_back(across ? i * size + wall : wall * size + i);
+                gates.push_back(gate);
+
+                LayoutDoor door = { 0.0f, 0.0f, 1, "0", 0 };
+                layout.doors.push_back(door);
+                // Clue on the near side of the doorway
+                float gx = across ? wall - 2.0f : gap + 1.0f, gz = across ? gap + 1.0f : wall - 2.0f;
+                LayoutBook book = { gx - size / 2.0f + 0.5f, gz - size / 2.0f + 0.5f, "", (int)gates.size() - 1, 0 };
+                layout.books.push_back(book);
+                grid.fillRect((int)gx, (int)gz, (int)gx, (int)gz, false);
+            }
+        }
+    }
+
+    LevelReport report;
+    Clock::time_point t0 = Clock::now();
+    analyzeLevel(grid, layout, gates, report);
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    printf("LevelAnalyzer benchmark (%dx%d, %d doors, %d notes): %.1f ms\n",
+        size, size, (int)gates.size(), (int)layout.books.size(), ms);
+    printf("  %s, %d doors opened, %d locked, %d notes missed, %lld unreachable cells in %d pockets, %d dead ends\n",
+        report.solvable ? "solvable" : "not solvable", (int)report.openOrder.size(), (int)report.lockedDoors.size(),
+        (int)report.missedBooks.size(), report.unreachableCells, report.unreachablePockets, (int)report.deadEndDoors.size());
+}
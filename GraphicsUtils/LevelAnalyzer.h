@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+#include "CollisionGrid.h"
+#include "LevelLayout.h"
+
+// ================================================================
+// LevelAnalyzer
+//
+// Offline check that a layout can be won. It works on the compiled
+// collision grid (every door closed) and plays the level the way a
+// player must:
+//  - flood fill from the spawn point
+//  - a door can be opened once the player can stand next to it and
+//    every note marked as its clue ("book x z "..." door") was reached
+//  - opening it frees its doorway cells and the fill carries on
+// until no door can be opened any more. Doors left closed, notes never
+// reached (and notes only found behind the door they unlock), floor no
+// one can walk to and rooms that lead nowhere are reported.
+//
+// A level with several floors is checked on one grid holding the floors
+// one after the other along Z (layout.getFloorCount() equal parts, each
+// object on its floor's part); the two ends of each stairs are a link,
+// and reaching one end reaches the other.
+//
+// The fill works on the grid's bitset rows: a row is filled along its
+// free runs 64 cells at a time (shift-and-mask doubling), and only rows
+// next to a changed row are revisited, so grids of millions of cells
+// take well under a second.
+// ================================================================
+
+struct LevelReport {
+    bool solvable;                  // Every door opens and every note is reached
+    std::vector<int> openOrder;     // Doors in an order they can be opened
+    std::vector<int> lockedDoors;   // Doors that can never be opened
+    std::vector<int> missedBooks;   // Notes that can never be reached
+    std::vector<int> deadEndDoors;  // Doors into a room with no notes and no other door
+    long long reachableCells;
+    long long unreachableCells;     // Walkable cells no one can get to
+    int unreachablePockets;         // Separate areas they form
+    std::vector<std::string> problems;  // One line per problem, for the console
+};
+
+/**
+ * @brief Checks that a level can be finished.
+ * @param grid Collision grid of the level with every door closed.
+ * @param doorGates Cells (z * width + x) each door frees when it opens, in layout order.
+ * @param links Pairs of cells joined although they are not neighbours
+ * (stairs between floors), or nullptr.
+ * @return report.solvable.
+ */
+bool analyzeLevel(const CollisionGrid& grid, const LevelLayout& layout,
+    const std::vector<std::vector<int>>& doorGates, LevelReport& report,
+    const std::vector<std::pair<int, int>>* links = nullptr);
+
+/**
+ * @brief Prints a report to the console.
+ */
+void printLevelReport(const LevelReport& report);
+
+/**
+ * @brief Times the analyzer on a generated size x size venue, printed to the console.
+ */
+void runLevelAnalyzerBenchmark(int size);
@@ -0,0 +1,320 @@
+// LevelFile.cpp : Compiled binary level format (writer and loader).
+//
+#include "pch.h" // Must be first
+#include "LevelFile.h"
+#include "WorldCache.h"
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <map>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ================================================================
+// Writer
+// ================================================================
+
+namespace {
+
+// Builds the string table, sharing repeated strings (e.g. texture paths)
+struct StringTable {
+    std::string data;
+    std::map<std::string, uint32_t> offsets;
+
+    uint32_t add(const std::string& s) {
+        auto it = offsets.find(s);
+        if (it != offsets.end()) return it->second;
+        uint32_t offset = (uint32_t)data.size();
+        data += s;
+        data += '\0';
+        offsets[s] = offset;
+        return offset;
+    }
+};
+
+template <typename T>
+uint32_t appendArray(std::vector<unsigned char>& blob, const std::vector<T>& items) {
+    uint32_t offset = (uint32_t)blob.size();
+    if (!items.empty()) {
+        const unsigned char* p = (const unsigned char*)items.data();
+        blob.insert(blob.end(), p, p + items.size() * sizeof(T));
+    }
+    return offset;
+}
+
+void alignTo4(std::vector<unsigned char>& blob) {
+    while (blob.size() % 4) blob.push_back(0);
+}
+
+} // namespace
+
+bool writeLevelFile(const char* path, const LevelLayout& layout,
+    const std::vector<unsigned char>& gridBits, int gridWidth, int gridHeight) {
+    StringTable strings;
+
+    std::vector<LevelFileTexture> textures;
+    for (const auto& t : layout.textures) {
+        LevelFileTexture ft = { strings.add(t.slot), strings.add(t.path) };
+        textures.push_back(ft);
+    }
+
+    std::vector<LevelFileWall> walls;
+    for (const auto& w : layout.walls) {
+        LevelFileWall fw = { w.startX, w.startZ, w.endX, w.endZ, w.thickness, w.floor };
+        walls.push_back(fw);
+    }
+
+    std::vector<LevelFileTower> towers;
+    for (const auto& t : layout.towers) {
+        LevelFileTower ft = { t.x, t.z, t.floor };
+        towers.push_back(ft);
+    }
+
+    std::vector<LevelFileBook> books;
+    for (const auto& b : layout.books) {
+        LevelFileBook fb = { b.x, b.z, strings.add(b.message), b.clueFor, b.floor };
+        books.push_back(fb);
+    }
+
+    std::vector<LevelFileDoor> doors;
+    for (const auto& d : layout.doors) {
+        LevelFileDoor fd = { d.x, d.z, d.direction, strings.add(d.pin), d.floor };
+        doors.push_back(fd);
+    }
+
+    std::vector<LevelFileDecor> decorations;
+    for (const auto& d : layout.decorations) {
+        LevelFileDecor fd = { d.type, d.x, d.z, d.rotation, d.floor };
+        decorations.push_back(fd);
+    }
+
+    std::vector<LevelFileNpc> npcs;
+    for (const auto& n : layout.npcs) {
+        LevelFileNpc fn = { n.role, n.x, n.z, n.patrolX, n.patrolZ, n.floor };
+        npcs.push_back(fn);
+    }
+
+    std::vector<LevelFileStairs> stairs;
+    for (const auto& s : layout.stairs) {
+        LevelFileStairs fs = { s.x0, s.z0, s.x1, s.z1, s.width, s.floor };
+        stairs.push_back(fs);
+    }
+
+    // --- Lay out the blob ---
+    LevelFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, LEVEL_FILE_MAGIC, 4);
+    h.version = LEVEL_FILE_VERSION;
+    h.roomWidth = layout.roomWidth;
+    h.roomHeight = layout.roomHeight;
+    h.roomDepth = layout.roomDepth;
+    h.spawnX = layout.spawnX;
+    h.spawnZ = layout.spawnZ;
+    h.gridCellSize = layout.gridCellSize;
+    h.gridOriginX = layout.getGridOriginX();
+    h.gridOriginZ = layout.getGridOriginZ();
+
+    std::vector<unsigned char> blob(sizeof(LevelFileHeader), 0);
+    h.textureCount = (uint32_t)textures.size();  h.textureOffset = appendArray(blob, textures);
+    h.wallCount = (uint32_t)walls.size();        h.wallOffset = appendArray(blob, walls);
+    h.towerCount = (uint32_t)towers.size();      h.towerOffset = appendArray(blob, towers);
+    h.bookCount = (uint32_t)books.size();        h.bookOffset = appendArray(blob, books);
+    h.doorCount = (uint32_t)doors.size();        h.doorOffset = appendArray(blob, doors);
+    h.decorCount = (uint32_t)decorations.size(); h.decorOffset = appendArray(blob, decorations);
+    h.npcCount = (uint32_t)npcs.size();          h.npcOffset = appendArray(blob, npcs);
+    h.stairsCount = (uint32_t)stairs.size();     h.stairsOffset = appendArray(blob, stairs);
+
+    h.stringsOffset = (uint32_t)blob.size();
+    h.stringsSize = (uint32_t)strings.data.size();
+    blob.insert(blob.end(), strings.data.begin(), strings.data.end());
+    alignTo4(blob);
+
+    h.gridWidth = gridBits.empty() ? 0 : gridWidth;
+    h.gridHeight = gridBits.empty() ? 0 : gridHeight;
+    h.gridOffset = (uint32_t)blob.size();
+    h.gridSize = (uint32_t)gridBits.size();
+    blob.insert(blob.end(), gridBits.begin(), gridBits.end());
+
+    h.fileSize = (uint32_t)blob.size();
+    memcpy(blob.data(), &h, sizeof(h));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        printf("LevelFile: cannot write '%s'\n", path);
+        return false;
+    }
+    file.write((const char*)blob.data(), (std::streamsize)blob.size());
+    if (!file) {
+        printf("LevelFile: write to '%s' failed\n", path);
+        return false;
+    }
+
+    printf("LevelFile: compiled '%s' (%u bytes, %u strings bytes, %dx%d grid)\n",
+        path, h.fileSize, h.stringsSize, h.gridWidth, h.gridHeight);
+    return true;
+}
+
+// ================================================================
+// Loader
+// ================================================================
+
+LevelFile::LevelFile()
+    : m_data(nullptr), m_size(0), m_mapped(false)
+{
+}
+
+LevelFile::~LevelFile() {
+    close();
+}
+
+void LevelFile::close() {
+#ifdef __linux__
+    if (m_mapped && m_data) munmap((void*)m_data, m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+}
+
+bool LevelFile::open(const char* path) {
+    close();
+
+#ifdef __linux__
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            m_data = p;
+            m_size = (size_t)st.st_size;
+            m_mapped = true;
+        }
+    }
+    ::close(fd);
+#else
+    // One read of the whole file
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::streamoff size = file.tellg();
+    if (size > 0) {
+        m_buffer.resize((size_t)size);
+        file.seekg(0);
+        if (file.read((char*)m_buffer.data(), size)) {
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+        }
+    }
+#endif
+
+    if (!m_data) return false;
+
+    if (!validate(m_size)) {
+        printf("LevelFile: '%s' is invalid or from another version, ignoring it.\n", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool LevelFile::validate(size_t size) const {
+    if (size < sizeof(LevelFileHeader)) return false;
+    const LevelFileHeader& h = header();
+    if (memcmp(h.magic, LEVEL_FILE_MAGIC, 4) != 0) return false;
+    if (h.version != LEVEL_FILE_VERSION || h.fileSize != size) return false;
+
+    // Every section must lie inside the file
+    struct Section { uint64_t offset, bytes; };
+    const Section sections[] = {
+        { h.textureOffset, (uint64_t)h.textureCount * sizeof(LevelFileTexture) },
+        { h.wallOffset,    (uint64_t)h.wallCount * sizeof(LevelFileWall) },
+        { h.towerOffset,   (uint64_t)h.towerCount * sizeof(LevelFileTower) },
+        { h.bookOffset,    (uint64_t)h.bookCount * sizeof(LevelFileBook) },
+        { h.doorOffset,    (uint64_t)h.doorCount * sizeof(LevelFileDoor) },
+        { h.decorOffset,   (uint64_t)h.decorCount * sizeof(LevelFileDecor) },
+        { h.npcOffset,     (uint64_t)h.npcCount * sizeof(LevelFileNpc) },
+        { h.stairsOffset,  (uint64_t)h.stairsCount * sizeof(LevelFileStairs) },
+        { h.stringsOffset, h.stringsSize },
+        { h.gridOffset,    h.gridSize },
+    };
+    for (const auto& s : sections) {
+        if (s.offset + s.bytes > size) return false;
+    }
+    if (!(h.gridCellSize > 0.0f) || h.gridWidth < 0 || h.gridHeight < 0) return false;
+    if (h.gridSize && (uint64_t)((h.gridWidth + 7) / 8) * h.gridHeight != h.gridSize) return false;
+
+    // Strings must be NUL terminated inside the table
+    if (h.stringsSize == 0 || string(h.stringsSize - 1)[0] != '\0') return false;
+    for (uint32_t i = 0; i < h.textureCount; ++i) {
+        if (textures()[i].slot >= h.stringsSize || textures()[i].path >= h.stringsSize) return false;
+    }
+    for (uint32_t i = 0; i < h.bookCount; ++i) {
+        if (books()[i].message >= h.stringsSize) return false;
+    }
+    for (uint32_t i = 0; i < h.doorCount; ++i) {
+        if (doors()[i].pin >= h.stringsSize) return false;
+    }
+    return true;
+}
+
+void LevelFile::toLayout(LevelLayout& out) const {
+    const LevelFileHeader& h = header();
+    LevelLayout layout;
+    layout.roomWidth = h.roomWidth;
+    layout.roomHeight = h.roomHeight;
+    layout.roomDepth = h.roomDepth;
+    layout.spawnX = h.spawnX;
+    layout.spawnZ = h.spawnZ;
+    layout.gridCellSize = h.gridCellSize;
+
+    for (uint32_t i = 0; i < h.textureCount; ++i) {
+        LayoutTexture t = { string(textures()[i].slot), string(textures()[i].path) };
+        layout.textures.push_back(t);
+    }
+    for (uint32_t i = 0; i < h.wallCount; ++i) {
+        const LevelFileWall& w = walls()[i];
+        LayoutWall lw = { w.startX, w.startZ, w.endX, w.endZ, w.thickness, w.floor };
+        layout.walls.push_back(lw);
+    }
+    for (uint32_t i = 0; i < h.towerCount; ++i) {
+        LayoutTower t = { towers()[i].x, towers()[i].z, towers()[i].floor };
+        layout.towers.push_back(t);
+    }
+    for (uint32_t i = 0; i < h.bookCount; ++i) {
+        LayoutBook b = { books()[i].x, books()[i].z, string(books()[i].message), books()[i].clueFor, books()[i].floor };
+        layout.books.push_back(b);
+    }
+    for (uint32_t i = 0; i < h.doorCount; ++i) {
+        const LevelFileDoor& d = doors()[i];
+        LayoutDoor ld = { d.x, d.z, d.direction, string(d.pin), d.floor };
+        layout.doors.push_back(ld);
+    }
+    for (uint32_t i = 0; i < h.decorCount; ++i) {
+        const LevelFileDecor& d = decorations()[i];
+        LayoutDecor ld = { d.type, d.x, d.z, d.rotation, d.floor };
+        layout.decorations.push_back(ld);
+    }
+    for (uint32_t i = 0; i < h.npcCount; ++i) {
+        const LevelFileNpc& n = npcs()[i];
+        LayoutNpc ln = { n.role, n.x, n.z, n.patrolX, n.patrolZ, n.floor };
+        layout.npcs.push_back(ln);
+    }
+    for (uint32_t i = 0; i < h.stairsCount; ++i) {
+        const LevelFileStairs& s = stairs()[i];
+        LayoutStairs ls = { s.x0, s.z0, s.x1, s.z1, s.width, s.floor };
+        layout.stairs.push_back(ls);
+    }
+    out = layout;
+}
+
+uint64_t LevelFile::contentHash() const {
+    return hashBytes(m_data, m_size);
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "LevelLayout.h"
+
+// ================================================================
+// LevelFile
+//
+// Compiled binary form of a level. The whole file is one blob laid out
+// exactly as it is used, so loading is a single read (or an mmap on
+// Linux) plus a header check, whatever the number of objects:
+//
+//   LevelFileHeader
+//   LevelFileTexture[textureCount]
+//   LevelFileWall[wallCount]
+//   LevelFileTower[towerCount]
+//   LevelFileBook[bookCount]
+//   LevelFileDoor[doorCount]
+//   LevelFileDecor[decorCount]
+//   LevelFileNpc[npcCount]
+//   LevelFileStairs[stairsCount]
+//   string table       (NUL terminated messages, PINs, paths)
+//   collision grid     (1 bit per cell, rows padded to whole bytes)
+//
+// Strings are stored as byte offsets into the string table. All values
+// are little-endian, like every platform the game ships on.
+// The collision grid is the grid right after the level is set up (all
+// doors closed), produced by the same module code the game runs. It is
+// the ground floor's; other floors are stamped when the player gets there.
+// ================================================================
+
+static const char     LEVEL_FILE_MAGIC[4] = { 'E', 'R', 'L', 'V' };
+static const uint32_t LEVEL_FILE_VERSION = 7; // 7: floors and stairs
+
+struct LevelFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t fileSize;
+
+    float roomWidth, roomHeight, roomDepth;
+    float spawnX, spawnZ;
+
+    uint32_t textureCount, textureOffset;
+    uint32_t wallCount, wallOffset;
+    uint32_t towerCount, towerOffset;
+    uint32_t bookCount, bookOffset;
+    uint32_t doorCount, doorOffset;
+    uint32_t decorCount, decorOffset;
+    uint32_t npcCount, npcOffset;
+    uint32_t stairsCount, stairsOffset;
+
+    uint32_t stringsOffset, stringsSize;
+
+    int32_t gridWidth, gridHeight;   // 0 if the level has no precomputed grid
+    uint32_t gridOffset, gridSize;
+    float gridCellSize;
+    float gridOriginX, gridOriginZ;
+};
+
+struct LevelFileTexture { uint32_t slot, path; };
+struct LevelFileWall    { float startX, startZ, endX, endZ, thickness; int32_t floor; };
+struct LevelFileTower   { float x, z; int32_t floor; };
+struct LevelFileBook    { float x, z; uint32_t message; int32_t clueFor, floor; };
+struct LevelFileDoor    { float x, z; int32_t direction; uint32_t pin; int32_t floor; };
+struct LevelFileDecor   { int32_t type; float x, z, rotation; int32_t floor; };
+struct LevelFileNpc     { int32_t role; float x, z, patrolX, patrolZ; int32_t floor; };
+struct LevelFileStairs  { float x0, z0, x1, z1, width; int32_t floor; };
+
+/**
+ * @brief Writes a compiled level.
+ * @param gridBits Packed collision grid (see saveCollisionGrid), may be empty.
+ * @return False if the file could not be written.
+ */
+bool writeLevelFile(const char* path, const LevelLayout& layout,
+    const std::vector<unsigned char>& gridBits, int gridWidth, int gridHeight);
+
+/**
+ * @brief Read-only view of a compiled level file.
+ */
+class LevelFile {
+public:
+    LevelFile();
+    ~LevelFile();
+
+    /**
+     * @brief Maps (or reads) the file and validates its header and offsets.
+     * @return False if the file is missing, from another version, or truncated.
+     */
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    const LevelFileHeader& header() const { return *(const LevelFileHeader*)m_data; }
+    const LevelFileTexture* textures() const { return at<LevelFileTexture>(header().textureOffset); }
+    const LevelFileWall* walls() const { return at<LevelFileWall>(header().wallOffset); }
+    const LevelFileTower* towers() const { return at<LevelFileTower>(header().towerOffset); }
+    const LevelFileBook* books() const { return at<LevelFileBook>(header().bookOffset); }
+    const LevelFileDoor* doors() const { return at<LevelFileDoor>(header().doorOffset); }
+    const LevelFileDecor* decorations() const { return at<LevelFileDecor>(header().decorOffset); }
+    const LevelFileNpc* npcs() const { return at<LevelFileNpc>(header().npcOffset); }
+    const LevelFileStairs* stairs() const { return at<LevelFileStairs>(header().stairsOffset); }
+    const char* string(uint32_t offset) const { return (const char*)m_data + header().stringsOffset + offset; }
+
+    /**
+     * @brief Precomputed collision grid bits, or nullptr if the level has none.
+     */
+    const unsigned char* grid() const {
+        return header().gridSize ? at<unsigned char>(header().gridOffset) : nullptr;
+    }
+
+    /**
+     * @brief Copies the level into the editable LevelLayout form.
+     */
+    void toLayout(LevelLayout& out) const;
+
+    /**
+     * @brief Hash of the whole file (used to key the world cache).
+     */
+    uint64_t contentHash() const;
+
+private:
+    template <typename T>
+    const T* at(uint32_t offset) const { return (const T*)((const char*)m_data + offset); }
+
+    bool validate(size_t size) const;
+
+    const void* m_data;
+    size_t m_size;
+    bool m_mapped;                      // mmap'd (else m_buffer owns the data)
+    std::vector<unsigned char> m_buffer;
+};
@@ -0,0 +1,206 @@
+// LevelLayout.cpp : Text layout file parser.
+//
+#include "pch.h" // Must be first
+#include "LevelLayout.h"
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include <math.h>
+#include <algorithm>
+
+// Sanity limit for 'floor' lines (each floor gets its own set of modules)
+static const int MAX_FLOORS = 16;
+
+// Reads a "quoted string" with \n, \" and \\ escapes.
+static bool readQuoted(std::istream& in, std::string& out) {
+    char c;
+    if (!(in >> c) || c != '"') return false; // >> skips leading whitespace
+
+    out.clear();
+    while (in.get(c)) {
+        if (c == '"') return true;
+        if (c == '\\' && in.get(c)) {
+            if (c == 'n') out += '\n';
+            else out += c; // \" and \\ (anything else is kept literally)
+        }
+        else {
+            out += c;
+        }
+    }
+    return false; // Missing closing quote
+}
+
+// Removes a '#' comment that is not inside a quoted string
+static void stripComment(std::string& line) {
+    bool inQuotes = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (line[i] == '"' && (i == 0 || line[i - 1] != '\\')) inQuotes = !inQuotes;
+        if (line[i] == '#' && !inQuotes) { line.erase(i); return; }
+    }
+}
+
+const char* LevelLayout::getTexture(const char* slot) const {
+    for (const auto& t : textures) {
+        if (t.slot == slot) return t.path.c_str();
+    }
+    return nullptr;
+}
+
+int LevelLayout::getGridWidth() const {
+    return (int)ceilf(roomWidth / gridCellSize - 0.001f);
+}
+
+int LevelLayout::getGridHeight() const {
+    return (int)ceilf(roomDepth / gridCellSize - 0.001f);
+}
+
+int LevelLayout::getFloorCount() const {
+    int top = 0;
+    for (const auto& w : walls) top = std::max(top, w.floor);
+    for (const auto& t : towers) top = std::max(top, t.floor);
+    for (const auto& b : books) top = std::max(top, b.floor);
+    for (const auto& d : doors) top = std::max(top, d.floor);
+    for (const auto& d : decorations) top = std::max(top, d.floor);
+    for (const auto& n : npcs) top = std::max(top, n.floor);
+    for (const auto& s : stairs) top = std::max(top, s.floor + 1);
+    return top + 1;
+}
+
+// Copies the items of a section that are on one floor
+template <typename T>
+static void copyFloor(const std::vector<T>& from, int floor, std::vector<T>& to) {
+    to.clear();
+    for (const T& item : from) {
+        if (item.floor == floor) to.push_back(item);
+    }
+}
+
+LevelLayout LevelLayout::onFloor(int floor) const {
+    LevelLayout out;
+    out.roomWidth = roomWidth;
+    out.roomHeight = roomHeight;
+    out.roomDepth = roomDepth;
+    out.spawnX = spawnX;
+    out.spawnZ = spawnZ;
+    out.gridCellSize = gridCellSize;
+    out.textures = textures;
+    copyFloor(walls, floor, out.walls);
+    copyFloor(towers, floor, out.towers);
+    copyFloor(books, floor, out.books);
+    copyFloor(doors, floor, out.doors);
+    copyFloor(decorations, floor, out.decorations);
+    copyFloor(npcs, floor, out.npcs);
+    for (const auto& s : stairs) {
+        if (s.floor == floor || s.floor + 1 == floor) out.stairs.push_back(s);
+    }
+    return out;
+}
+
+bool loadLevelLayout(const char* path, LevelLayout& out) {
+    std::ifstream file(path);
+    if (!file) {
+        printf("LevelLayout: cannot open '%s'\n", path);
+        return false;
+    }
+
+    LevelLayout layout;
+    bool ok = true;
+    std::string line;
+    int lineNo = 0;
+    int floor = 0; // Set by 'floor' lines
+
+    while (std::getline(file, line)) {
+        ++lineNo;
+        stripComment(line);
+
+        std::istringstream in(line);
+        std::string kind;
+        if (!(in >> kind)) continue; // Blank line
+
+        bool lineOk = false;
+        if (kind == "room") {
+            lineOk = (bool)(in >> layout.roomWidth >> layout.roomHeight >> layout.roomDepth);
+        }
+        else if (kind == "spawn") {
+            lineOk = (bool)(in >> layout.spawnX >> layout.spawnZ);
+        }
+        else if (kind == "grid") {
+            lineOk = (bool)(in >> layout.gridCellSize) && layout.gridCellSize > 0.0f;
+        }
+        else if (kind == "floor") {
+            lineOk = (bool)(in >> floor) && floor >= 0 && floor < MAX_FLOORS;
+            if (!lineOk) floor = 0;
+        }
+        else if (kind == "texture") {
+            LayoutTexture t;
+            lineOk = (bool)(in >> t.slot >> t.path);
+            if (lineOk) layout.textures.push_back(t);
+        }
+        else if (kind == "wall") {
+            LayoutWall w;
+            lineOk = (bool)(in >> w.startX >> w.startZ >> w.endX >> w.endZ >> w.thickness);
+            w.floor = floor;
+            if (lineOk) layout.walls.push_back(w);
+        }
+        else if (kind == "tower") {
+            LayoutTower t;
+            lineOk = (bool)(in >> t.x >> t.z);
+            t.floor = floor;
+            if (lineOk) layout.towers.push_back(t);
+        }
+        else if (kind == "book") {
+            LayoutBook b;
+            lineOk = (in >> b.x >> b.z) && readQuoted(in, b.message);
+            if (lineOk && !(in >> b.clueFor)) b.clueFor = -1; // Clue link is optional
+            b.floor = floor;
+            if (lineOk) layout.books.push_back(b);
+        }
+        else if (kind == "door") {
+            LayoutDoor d;
+            lineOk = (bool)(in >> d.x >> d.z >> d.direction >> d.pin);
+            d.floor = floor;
+            if (lineOk) layout.doors.push_back(d);
+        }
+        else if (kind == "decor") {
+            LayoutDecor d;
+            lineOk = (bool)(in >> d.type >> d.x >> d.z);
+            if (lineOk && !(in >> d.rotation)) d.rotation = 0.0f; // Rotation is optional
+            d.floor = floor;
+            if (lineOk) layout.decorations.push_back(d);
+        }
+        else if (kind == "npc") {
+            LayoutNpc n;
+            std::string role;
+            lineOk = (bool)(in >> role >> n.x >> n.z) && (role == "guard" || role == "visitor");
+            n.role = role == "guard" ? 0 : 1;
+            if (lineOk && !(in >> n.patrolX >> n.patrolZ)) { n.patrolX = n.x; n.patrolZ = n.z; } // Patrol is optional
+            n.floor = floor;
+            if (lineOk) layout.npcs.push_back(n);
+        }
+        else if (kind == "stairs") {
+            LayoutStairs s;
+            lineOk = (bool)(in >> s.x0 >> s.z0 >> s.x1 >> s.z1 >> s.width) && s.width > 0.0f &&
+                ((s.x0 == s.x1) != (s.z0 == s.z1)) && floor + 1 < MAX_FLOORS; // Along X or Z, and not flat
+            s.floor = floor;
+            if (lineOk) layout.stairs.push_back(s);
+        }
+        else {
+            printf("LevelLayout: %s:%d: unknown object '%s'\n", path, lineNo, kind.c_str());
+            ok = false;
+            continue;
+        }
+
+        if (!lineOk) {
+            printf("LevelLayout: %s:%d: malformed '%s' line\n", path, lineNo, kind.c_str());
+            ok = false;
+        }
+    }
+
+    if (!ok) return false;
+
+    out = layout;
+    printf("LevelLayout: '%s' loaded (%d walls, %d towers, %d books, %d doors, %d decorations, %d npcs, %d floors)\n",
+        path, (int)out.walls.size(), (int)out.towers.size(), (int)out.books.size(),
+        (int)out.doors.size(), (int)out.decorations.size(), (int)out.npcs.size(), out.getFloorCount());
+    return true;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// ================================================================
+// LevelLayout
+//
+// Plain description of where everything in the level goes, read from a
+// text file so the layout can be edited (and hot reloaded) without
+// recompiling. One object per line, '#' starts a comment:
+//
+//   room    width height depth
+//   spawn   x z
+//   grid    cellSize              (collision cell size, default 1; the grid covers the room)
+//   texture slot path             (e.g. room.floor textures/floor.dds)
+//   wall   startX startZ endX endZ thickness
+//   tower  x z
+//   book   x z "message" [door]   (\n and \" escapes allowed; door = index of the
+//                                  door, in file order, this note is a clue for)
+//   door   x z direction pin      (direction: 1 = along X, 2 = along Z)
+//   decor  type x z rotation
+//   npc    role x z [x2 z2]       (role: guard or visitor; a guard patrols
+//                                  between (x, z) and (x2, z2))
+//   floor  n                      (the objects after it are on floor n, 0 = ground;
+//                                  every floor is a storey of 'height' above the last)
+//   stairs x0 z0 x1 z1 width      (from (x0, z0) on this floor up to (x1, z1) on the
+//                                  next one; they run along X or along Z)
+//
+// Each section is compared separately on reload, so only the module whose
+// objects actually changed has to be rebuilt.
+//
+// The game loads levels in the compiled binary form (see LevelFile.h);
+// this text form is the source it is compiled from.
+// ================================================================
+
+struct LayoutTexture {
+    std::string slot;
+    std::string path;
+    bool operator==(const LayoutTexture& o) const { return slot == o.slot && path == o.path; }
+};
+
+struct LayoutWall {
+    float startX, startZ, endX, endZ;
+    float thickness;
+    int floor;
+    bool operator==(const LayoutWall& o) const {
+        return startX == o.startX && startZ == o.startZ && endX == o.endX && endZ == o.endZ && thickness == o.thickness &&
+            floor == o.floor;
+    }
+};
+
+struct LayoutTower {
+    float x, z;
+    int floor;
+    bool operator==(const LayoutTower& o) const { return x == o.x && z == o.z && floor == o.floor; }
+};
+
+struct LayoutBook {
+    float x, z;
+    std::string message;
+    int clueFor; // Door this note helps to unlock, -1 if none
+    int floor;
+    bool operator==(const LayoutBook& o) const {
+        return x == o.x && z == o.z && message == o.message && clueFor == o.clueFor && floor == o.floor;
+    }
+};
+
+struct LayoutDoor {
+    float x, z;
+    int direction;
+    std::string pin;
+    int floor;
+    bool operator==(const LayoutDoor& o) const {
+        return x == o.x && z == o.z && direction == o.direction && pin == o.pin && floor == o.floor;
+    }
+};
+
+struct LayoutDecor {
+    int type;
+    float x, z;
+    float rotation;
+    int floor;
+    bool operator==(const LayoutDecor& o) const {
+        return type == o.type && x == o.x && z == o.z && rotation == o.rotation && floor == o.floor;
+    }
+};
+
+struct LayoutNpc {
+    int role;              // NpcRole (0 = guard, 1 = visitor)
+    float x, z;
+    float patrolX, patrolZ;
+    int floor;
+    bool operator==(const LayoutNpc& o) const {
+        return role == o.role && x == o.x && z == o.z && patrolX == o.patrolX && patrolZ == o.patrolZ && floor == o.floor;
+    }
+};
+
+struct LayoutStairs {
+    float x0, z0;          // Middle of the bottom step
+    float x1, z1;          // Middle of the top edge, on the floor above
+    float width;
+    int floor;             // Floor at the bottom
+    bool operator==(const LayoutStairs& o) const {
+        return x0 == o.x0 && z0 == o.z0 && x1 == o.x1 && z1 == o.z1 && width == o.width && floor == o.floor;
+    }
+};
+
+struct LevelLayout {
+    float roomWidth, roomHeight, roomDepth;
+    float spawnX, spawnZ;
+    float gridCellSize;
+    std::vector<LayoutTexture> textures;
+
+    std::vector<LayoutWall> walls;
+    std::vector<LayoutTower> towers;
+    std::vector<LayoutBook> books;
+    std::vector<LayoutDoor> doors;
+    std::vector<LayoutDecor> decorations;
+    std::vector<LayoutNpc> npcs;
+    std::vector<LayoutStairs> stairs;
+
+    LevelLayout()
+        : roomWidth(40.0f), roomHeight(5.0f), roomDepth(40.0f), spawnX(0.0f), spawnZ(0.0f), gridCellSize(1.0f) {}
+
+    /**
+     * @brief Collision grid covering the room floor (centered on the origin).
+     */
+    int getGridWidth() const;
+    int getGridHeight() const;
+    float getGridOriginX() const { return -roomWidth / 2.0f; }
+    float getGridOriginZ() const { return -roomDepth / 2.0f; }
+
+    /**
+     * @brief Path assigned to a texture slot, or nullptr if the level has none.
+     */
+    const char* getTexture(const char* slot) const;
+
+    /**
+     * @brief Number of floors: 1 + the highest floor any object or stairs reach.
+     */
+    int getFloorCount() const;
+
+    /**
+     * @brief Copy holding only the objects of one floor, and the stairs
+     * leading up from it or arriving on it. Room, spawn and textures are kept.
+     */
+    LevelLayout onFloor(int floor) const;
+};
+
+/**
+ * @brief Parses a layout text file.
+ * @param path File to read.
+ * @param out Receives the parsed layout (untouched if the file cannot be opened).
+ * @return False if the file is missing or has a malformed line. Errors are
+ * printed with their line number; a failed reload keeps the old layout.
+ */
+bool loadLevelLayout(const char* path, LevelLayout& out);
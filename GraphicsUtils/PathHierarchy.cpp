@@ -0,0 +1,696 @@
+// PathHierarchy.cpp : HPA* clusters, entrances and abstract search over the collision grid.
+//
+#include "pch.h" // Must be first
+#include "PathHierarchy.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+PathHierarchy g_pathHierarchy;
+
+static const float UNREACHED = 1e30f;
+static const float DIAGONAL_COST = 1.41421356f;
+
+// The abstract search overestimates the remaining distance by this much
+// (weighted A*): routes come out at most 20% longer than the best abstract
+// route (about 1% once pulled tight) for a third of the expansions
+static const float HEURISTIC_WEIGHT = 1.2f;
+
+// findRoute(): routes this many cells apart (on either axis) or more go
+// through the hierarchy, which beats a flat search from about here on
+static const int LONG_ROUTE_CELLS = 300;
+// findRoute(): shorter routes give up on the flat search after this many
+// jump points (well under a millisecond) and go through the hierarchy
+static const int FLAT_EXPANSION_LIMIT = 1000;
+
+static const int STEP_X[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+static const int STEP_Z[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+static inline float octile(int dx, int dz) {
+    dx = abs(dx);
+    dz = abs(dz);
+    return (dx > dz) ? (dx - dz) + dz * DIAGONAL_COST : (dz - dx) + dx * DIAGONAL_COST;
+}
+
+static int findRoot(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static bool localNodeGreater(const Pathfinder::OpenNode& a, const Pathfinder::OpenNode& b) {
+    return a.f > b.f;
+}
+
+static bool openEntryGreater(const PathHierarchy::OpenEntry& a, const PathHierarchy::OpenEntry& b) {
+    if (a.f != b.f) return a.f > b.f;
+    return a.g < b.g;
+}
+
+// ================================================================
+// Setup
+// ================================================================
+
+PathHierarchy::PathHierarchy()
+    : m_grid(nullptr), m_width(0), m_height(0),
+    m_clusterSize(0), m_clustersX(0), m_clustersZ(0), m_areasStale(true), m_rebuilt(0),
+    m_localCluster(-1), m_localStride(0), m_search(0)
+{
+}
+
+void PathHierarchy::clear() {
+    m_grid = nullptr;
+    m_width = m_height = 0;
+    m_clustersX = m_clustersZ = 0;
+    m_clusters.clear();
+    m_nodeCluster.clear();
+    m_nodeCell.clear();
+    m_nodeX.clear();
+    m_nodeZ.clear();
+    m_nodeAcross.clear();
+    m_nodeArea.clear();
+    m_areasStale = true;
+    m_localCluster = -1;
+    m_state.clear();
+    m_open.clear();
+    m_goalCosts.clear();
+}
+
+void PathHierarchy::build(const CollisionGrid& grid, int clusterSize) {
+    m_grid = &grid;
+    m_width = grid.getWidth();
+    m_height = grid.getHeight();
+    m_clusterSize = clusterSize > 4 ? clusterSize : 4;
+    m_clustersX = (m_width + m_clusterSize - 1) / m_clusterSize;
+    m_clustersZ = (m_height + m_clusterSize - 1) / m_clusterSize;
+
+    m_clusters.assign((size_t)m_clustersX * m_clustersZ, Cluster());
+    for (int cz = 0; cz < m_clustersZ; ++cz) {
+        for (int cx = 0; cx < m_clustersX; ++cx) {
+            Cluster& c = m_clusters[cz * m_clustersX + cx];
+            c.x0 = cx * m_clusterSize;
+            c.z0 = cz * m_clusterSize;
+            c.x1 = std::min(c.x0 + m_clusterSize, m_width) - 1;
+            c.z1 = std::min(c.z0 + m_clusterSize, m_height) - 1;
+            c.firstNode = 0;
+        }
+    }
+
+    for (int k = 0; k < (int)m_clusters.size(); ++k) makeEntrances(k);
+    for (int k = 0; k < (int)m_clusters.size(); ++k) resolveLinks(k);
+    for (int k = 0; k < (int)m_clusters.size(); ++k) computeCosts(k);
+    numberNodes();
+    labelAreas();
+    m_rebuilt = (int)m_clusters.size();
+}
+
+void PathHierarchy::update(const CollisionGrid& grid, int x0, int z0, int x1, int z1) {
+    if (m_grid != &grid || grid.getWidth() != m_width || grid.getHeight() != m_height) return;
+    if (x0 > x1) std::swap(x0, x1);
+    if (z0 > z1) std::swap(z0, z1);
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, m_width - 1);
+    z1 = std::min(z1, m_height - 1);
+    if (x0 > x1 || z0 > z1) return;
+
+    // The clusters the change touches, plus their neighbours (shared borders)
+    int tx0 = x0 / m_clusterSize, tz0 = z0 / m_clusterSize;
+    int tx1 = x1 / m_clusterSize, tz1 = z1 / m_clusterSize;
+    int cx0 = std::max(tx0 - 1, 0);
+    int cz0 = std::max(tz0 - 1, 0);
+    int cx1 = std::min(tx1 + 1, m_clustersX - 1);
+    int cz1 = std::min(tz1 + 1, m_clustersZ - 1);
+
+    // Costs only depend on a cluster's own cells and entrances: a neighbour
+    // keeps them unless its entrances along the shared border moved
+    m_rebuilt = 0;
+    std::vector<int> before;
+    for (int cz = cz0; cz <= cz1; ++cz) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            int k = cz * m_clustersX + cx;
+            before.swap(m_clusters[k].nodes);
+            makeEntrances(k);
+            bool touched = cx >= tx0 && cx <= tx1 && cz >= tz0 && cz <= tz1;
+            if (touched || m_clusters[k].nodes != before) {
+                computeCosts(k);
+                m_rebuilt++;
+            }
+        }
+    }
+
+    // Links into the rebuilt clusters, from them and from the ring around them
+    for (int cz = std::max(cz0 - 1, 0); cz <= std::min(cz1 + 1, m_clustersZ - 1); ++cz) {
+        for (int cx = std::max(cx0 - 1, 0); cx <= std::min(cx1 + 1, m_clustersX - 1); ++cx) {
+            resolveLinks(cz * m_clustersX + cx);
+        }
+    }
+    numberNodes();
+}
+
+int PathHierarchy::clusterOf(int cell) const {
+    int x = cell % m_width, z = cell / m_width;
+    return (z / m_clusterSize) * m_clustersX + x / m_clusterSize;
+}
+
+void PathHierarchy::resolveLinks(int cluster) {
+    // By cluster and index rather than node id, so renumbering keeps them
+    Cluster& c = m_clusters[cluster];
+    c.facing.clear();
+    for (size_t l = 0; l < c.links.size(); l += 2) {
+        int k = clusterOf(c.links[l + 1]);
+        const std::vector<int>& nodes = m_clusters[k].nodes;
+        int index = (int)(std::find(nodes.begin(), nodes.end(), c.links[l + 1]) - nodes.begin());
+        c.facing.push_back(k);
+        c.facing.push_back(index < (int)nodes.size() ? index : -1);
+    }
+}
+
+void PathHierarchy::numberNodes() {
+    int total = 0;
+    for (auto& c : m_clusters) {
+        c.firstNode = total;
+        total += (int)c.nodes.size();
+    }
+    m_nodeCluster.resize(total);
+    m_nodeCell.resize(total);
+    m_nodeX.resize(total);
+    m_nodeZ.resize(total);
+    m_nodeAcross.assign((size_t)total * 2, -1);
+    for (int k = 0; k < (int)m_clusters.size(); ++k) {
+        const Cluster& c = m_clusters[k];
+        for (size_t i = 0; i < c.nodes.size(); ++i) {
+            m_nodeCluster[c.firstNode + i] = k;
+            m_nodeCell[c.firstNode + i] = c.nodes[i];
+            m_nodeX[c.firstNode + i] = c.nodes[i] % m_width;
+            m_nodeZ[c.firstNode + i] = c.nodes[i] / m_width;
+        }
+    }
+
+    // Node ids across each border (a corner cell can face two borders, no cell more)
+    for (const auto& c : m_clusters) {
+        for (size_t l = 0; l < c.links.size(); l += 2) {
+            if (c.facing[l + 1] < 0) continue;
+            int* across = &m_nodeAcross[(size_t)(c.firstNode + c.links[l]) * 2];
+            across[across[0] < 0 ? 0 : 1] = m_clusters[c.facing[l]].firstNode + c.facing[l + 1];
+        }
+    }
+    m_areasStale = true;
+
+    // Stamps of older searches are all below the next one, whatever node they now belong to
+    SearchState unvisited = { 0, -1, 0.0f, 0 };
+    m_state.resize(total + 2, unvisited);
+}
+
+void PathHierarchy::labelAreas() {
+    // Connected areas, so a goal the start cannot reach is turned down
+    // without flooding the whole graph
+    int total = (int)m_nodeCluster.size();
+    m_nodeArea.resize(total);
+    for (int i = 0; i < total; ++i) m_nodeArea[i] = i;
+    for (const auto& c : m_clusters) {
+        // Inside a cluster, joining each entrance to the first one it reaches is enough
+        size_t n = c.nodes.size();
+        for (size_t j = 1; j < n; ++j) {
+            size_t i = 0;
+            while (i < j && c.costs[i * n + j] >= UNREACHED) i++;
+            if (i < j) m_nodeArea[findRoot(m_nodeArea, c.firstNode + (int)j)] = findRoot(m_nodeArea, c.firstNode + (int)i);
+        }
+    }
+    for (int i = 0; i < total * 2; ++i) {
+        if (m_nodeAcross[i] < 0) continue;
+        int a = findRoot(m_nodeArea, i / 2), b = findRoot(m_nodeArea, m_nodeAcross[i]);
+        if (a != b) m_nodeArea[a] = b;
+    }
+    for (int i = 0; i < total; ++i) m_nodeArea[i] = findRoot(m_nodeArea, i);
+    m_areasStale = false;
+}
+
+// ================================================================
+// Entrances and Costs
+// ================================================================
+
+void PathHierarchy::addBorder(Cluster& c, int x, int z, int dx, int dz, int stepX, int stepZ, int length) {
+    // Runs of border cells open on both sides
+    int runStart = -1;
+    for (int i = 0; i <= length; ++i) {
+        int bx = x + i * stepX, bz = z + i * stepZ;
+        bool open = i < length && walkable(bx, bz) && walkable(bx + dx, bz + dz);
+        if (open && runStart < 0) runStart = i;
+        if (open || runStart < 0) continue;
+
+        // One entrance in the middle of the run (a second one at the ends of
+        // wide runs doubled the abstract graph for a few percent of length,
+        // which the path pulling wins back anyway)
+        int p = (runStart + i - 1) / 2;
+        int px = x + p * stepX, pz = z + p * stepZ;
+        int cell = pz * m_width + px;
+        int index = (int)(std::find(c.nodes.begin(), c.nodes.end(), cell) - c.nodes.begin());
+        if (index == (int)c.nodes.size()) c.nodes.push_back(cell);
+        c.links.push_back(index);
+        c.links.push_back((pz + dz) * m_width + px + dx);
+        runStart = -1;
+    }
+}
+
+void PathHierarchy::makeEntrances(int cluster) {
+    // Both clusters of a border find the same runs, so each side only adds its own half
+    Cluster& c = m_clusters[cluster];
+    c.nodes.clear();
+    c.links.clear();
+    int w = c.x1 - c.x0 + 1, h = c.z1 - c.z0 + 1;
+    if (c.x0 > 0) addBorder(c, c.x0, c.z0, -1, 0, 0, 1, h);
+    if (c.x1 < m_width - 1) addBorder(c, c.x1, c.z0, 1, 0, 0, 1, h);
+    if (c.z0 > 0) addBorder(c, c.x0, c.z0, 0, -1, 1, 0, w);
+    if (c.z1 < m_height - 1) addBorder(c, c.x0, c.z1, 0, 1, 1, 0, w);
+}
+
+void PathHierarchy::computeCosts(int cluster) {
+    size_t n = m_clusters[cluster].nodes.size();
+    m_clusters[cluster].costs.assign(n * n, UNREACHED);
+    for (size_t i = 0; i < n; ++i) {
+        searchCluster(cluster, m_clusters[cluster].nodes[i], -1);
+        const Cluster& c = m_clusters[cluster];
+        for (size_t j = 0; j < n; ++j) m_clusters[cluster].costs[i * n + j] = localDistance(c.nodes[j]);
+    }
+}
+
+void PathHierarchy::searchCluster(int cluster, int fromCell, int stopCell) {
+    const Cluster& c = m_clusters[cluster];
+    int stride = c.x1 - c.x0 + 3;
+    size_t size = (size_t)stride * (c.z1 - c.z0 + 3);
+    m_localCluster = cluster;
+    m_localStride = stride;
+    m_localWalkable.assign(size, 0);
+    for (int z = c.z0; z <= c.z1; ++z) {
+        unsigned char* row = &m_localWalkable[(size_t)(z - c.z0 + 1) * stride + 1];
+        for (int x = c.x0; x <= c.x1; ++x) row[x - c.x0] = walkable(x, z);
+    }
+    m_localDist.assign(size, UNREACHED);
+    m_localParent.assign(size, -1);
+    m_localOpen.clear();
+
+    int from = localIndex(fromCell), stop = (stopCell >= 0) ? localIndex(stopCell) : -1;
+    if (from < 0 || !m_localWalkable[from]) return;
+    int sx = (stop >= 0) ? stop % stride : 0, sz = (stop >= 0) ? stop / stride : 0;
+    int offsets[8];
+    for (int i = 0; i < 8; ++i) offsets[i] = STEP_Z[i] * stride + STEP_X[i];
+
+    m_localDist[from] = 0.0f;
+    Pathfinder::OpenNode start = { 0.0f, 0.0f, from };
+    m_localOpen.push_back(start);
+
+    while (!m_localOpen.empty()) {
+        std::pop_heap(m_localOpen.begin(), m_localOpen.end(), localNodeGreater);
+        Pathfinder::OpenNode n = m_localOpen.back();
+        m_localOpen.pop_back();
+        if (n.g > m_localDist[n.cell]) continue; // Stale entry
+        if (n.cell == stop) return;
+        int x = n.cell % stride, z = n.cell / stride;
+
+        for (int i = 0; i < 8; ++i) {
+            int next = n.cell + offsets[i];
+            if (!m_localWalkable[next]) continue;
+            bool diagonal = STEP_X[i] != 0 && STEP_Z[i] != 0;
+            if (diagonal && (!m_localWalkable[n.cell + STEP_X[i]] || !m_localWalkable[n.cell + STEP_Z[i] * stride])) continue;
+
+            float g = n.g + (diagonal ? DIAGONAL_COST : 1.0f);
+            if (g < m_localDist[next]) {
+                m_localDist[next] = g;
+                m_localParent[next] = n.cell;
+                float f = (stop >= 0) ? g + octile(sx - x - STEP_X[i], sz - z - STEP_Z[i]) : g;
+                Pathfinder::OpenNode open = { f, g, next };
+                m_localOpen.push_back(open);
+                std::push_heap(m_localOpen.begin(), m_localOpen.end(), localNodeGreater);
+            }
+        }
+    }
+}
+
+int PathHierarchy::localIndex(int cell) const {
+    const Cluster& c = m_clusters[m_localCluster];
+    int x = cell % m_width, z = cell / m_width;
+    if (x < c.x0 || x > c.x1 || z < c.z0 || z > c.z1) return -1;
+    return (z - c.z0 + 1) * m_localStride + x - c.x0 + 1;
+}
+
+float PathHierarchy::localDistance(int cell) const {
+    int local = localIndex(cell);
+    return (local >= 0) ? m_localDist[local] : UNREACHED;
+}
+
+// ================================================================
+// Search
+// ================================================================
+
+bool PathHierarchy::findAbstractPath(int startX, int startZ, int goalX, int goalZ, std::vector<int>& outCells) {
+    outCells.clear();
+    if (!m_grid || !walkable(startX, startZ) || !walkable(goalX, goalZ)) return false;
+
+    int w = m_width;
+    int startCell = startZ * w + startX, goalCell = goalZ * w + goalX;
+    int startCluster = clusterOf(startCell), goalCluster = clusterOf(goalCell);
+    const int nodeCount = (int)m_nodeCluster.size();
+    const int START = nodeCount, GOAL = nodeCount + 1;
+
+    // Goal side first: the start side search is the one refined paths come from
+    searchCluster(goalCluster, goalCell, -1);
+    m_goalCosts.clear();
+    for (int cell : m_clusters[goalCluster].nodes) m_goalCosts.push_back(localDistance(cell));
+    float direct = (startCluster == goalCluster) ? localDistance(startCell) : UNREACHED;
+
+    if (++m_search == 0) {
+        for (auto& s : m_state) s.stamp = 0;
+        m_search = 1;
+    }
+    m_open.clear();
+
+    auto cellOf = [&](int node) {
+        if (node == START) return startCell;
+        if (node == GOAL) return goalCell;
+        return m_nodeCell[node];
+    };
+    auto relax = [&](int node, int parent, float g) {
+        SearchState& s = m_state[node];
+        if (s.stamp == m_search && (s.closed || g >= s.g)) return;
+        s.stamp = m_search;
+        s.closed = 0;
+        s.g = g;
+        s.parent = parent;
+        float h = (node < nodeCount) ? HEURISTIC_WEIGHT * octile(goalX - m_nodeX[node], goalZ - m_nodeZ[node]) : 0.0f;
+        OpenEntry e = { g + h, g, node };
+        m_open.push_back(e);
+        std::push_heap(m_open.begin(), m_open.end(), openEntryGreater);
+    };
+
+    SearchState start = { m_search, -1, 0.0f, 1 };
+    m_state[START] = start;
+    searchCluster(startCluster, startCell, -1);
+    const Cluster& sc = m_clusters[startCluster];
+    const Cluster& gc = m_clusters[goalCluster];
+
+    // Only searched if an entrance the start reaches shares an area with one the goal reaches
+    if (m_areasStale) labelAreas();
+    bool reachable = direct < UNREACHED;
+    for (size_t i = 0; !reachable && i < sc.nodes.size(); ++i) {
+        if (localDistance(sc.nodes[i]) >= UNREACHED) continue;
+        for (size_t j = 0; !reachable && j < gc.nodes.size(); ++j) {
+            reachable = m_goalCosts[j] < UNREACHED && m_nodeArea[sc.firstNode + i] == m_nodeArea[gc.firstNode + j];
+        }
+    }
+    if (!reachable) return false;
+
+    for (size_t i = 0; i < sc.nodes.size(); ++i) {
+        float d = localDistance(sc.nodes[i]);
+        if (d < UNREACHED) relax(sc.firstNode + (int)i, START, d);
+    }
+    if (direct < UNREACHED) relax(GOAL, START, direct);
+
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), openEntryGreater);
+        OpenEntry e = m_open.back();
+        m_open.pop_back();
+        SearchState& s = m_state[e.node];
+        if (s.closed || e.g > s.g) continue;
+        s.closed = 1;
+
+        if (e.node == GOAL) {
+            for (int node = GOAL; node >= 0; node = m_state[node].parent) {
+                int cell = cellOf(node);
+                if (outCells.empty() || outCells.back() != cell) outCells.push_back(cell);
+            }
+            std::reverse(outCells.begin(), outCells.end());
+            return true;
+        }
+
+        int k = m_nodeCluster[e.node];
+        const Cluster& c = m_clusters[k];
+        int i = e.node - c.firstNode;
+        size_t n = c.nodes.size();
+        for (size_t j = 0; j < n; ++j) {
+            float cost = c.costs[i * n + j];
+            if ((int)j != i && cost < UNREACHED) relax(c.firstNode + (int)j, e.node, e.g + cost);
+        }
+        for (int l = 0; l < 2; ++l) {
+            int across = m_nodeAcross[(size_t)e.node * 2 + l];
+            if (across >= 0) relax(across, e.node, e.g + 1.0f);
+        }
+        if (k == goalCluster && m_goalCosts[i] < UNREACHED) relax(GOAL, e.node, e.g + m_goalCosts[i]);
+    }
+    return false;
+}
+
+bool PathHierarchy::refineSegment(int fromCell, int toCell, std::vector<int>& outCells) {
+    outCells.clear();
+    if (!m_grid || fromCell == toCell) return m_grid != nullptr;
+
+    // Entrances facing each other across a border
+    int w = m_width;
+    int dx = toCell % w - fromCell % w, dz = toCell / w - fromCell / w;
+    if (abs(dx) + abs(dz) == 1) {
+        outCells.push_back(toCell);
+        return true;
+    }
+
+    int cluster = clusterOf(fromCell);
+    if (clusterOf(toCell) != cluster) return false;
+
+    // Search from the far end so the parents lead toward it
+    searchCluster(cluster, toCell, fromCell);
+    if (localDistance(fromCell) >= UNREACHED) return false;
+    const Cluster& c = m_clusters[cluster];
+    int stride = m_localStride;
+    for (int local = localIndex(fromCell), to = localIndex(toCell); local != to; ) {
+        local = m_localParent[local];
+        outCells.push_back((c.z0 + local / stride - 1) * w + c.x0 + local % stride - 1);
+    }
+    return true;
+}
+
+bool PathHierarchy::findCellPath(int startX, int startZ, int goalX, int goalZ, std::vector<int>& outCells) {
+    std::vector<int> route, leg;
+    outCells.clear();
+    if (!findAbstractPath(startX, startZ, goalX, goalZ, route)) return false;
+
+    outCells.push_back(route[0]);
+    for (size_t i = 1; i < route.size(); ++i) {
+        if (!refineSegment(route[i - 1], route[i], leg)) {
+            outCells.clear();
+            return false;
+        }
+        outCells.insert(outCells.end(), leg.begin(), leg.end());
+    }
+    return true;
+}
+
+bool PathHierarchy::findPath(float startX, float startZ, float goalX, float goalZ,
+    std::vector<PathPoint>& outPath, const Pathfinder* pull) {
+    outPath.clear();
+    if (!m_grid) return false;
+
+    int sx, sz, gx, gz;
+    m_grid->worldToCell(startX, startZ, sx, sz);
+    m_grid->worldToCell(goalX, goalZ, gx, gz);
+    std::vector<int> cells, pulled;
+    if (pull && pull->isReady()) {
+        // Only legs without a straight line of sight are refined to cells;
+        // the pulling then works on entrances and a few refined legs
+        std::vector<int> route, leg;
+        if (!findAbstractPath(sx, sz, gx, gz, route)) return false;
+        int w = m_width;
+        cells.push_back(route[0]);
+        for (size_t i = 1; i < route.size(); ++i) {
+            int a = route[i - 1], b = route[i];
+            if (pull->isLineWalkable(a % w, a / w, b % w, b / w)) {
+                cells.push_back(b);
+                continue;
+            }
+            if (!refineSegment(a, b, leg)) return false;
+            cells.insert(cells.end(), leg.begin(), leg.end());
+        }
+        pull->smooth(cells, pulled);
+    }
+    else if (!findCellPath(sx, sz, gx, gz, pulled)) {
+        return false;
+    }
+
+    PathPoint p = { startX, startZ };
+    outPath.push_back(p);
+    for (size_t i = 1; i + 1 < pulled.size(); ++i) {
+        m_grid->cellCenter(pulled[i] % m_width, pulled[i] / m_width, p.x, p.z);
+        outPath.push_back(p);
+    }
+    p.x = goalX;
+    p.z = goalZ;
+    outPath.push_back(p);
+    return true;
+}
+
+bool PathHierarchy::findRoute(float startX, float startZ, float goalX, float goalZ,
+    std::vector<PathPoint>& outPath, Pathfinder& flat) {
+    if (!m_grid) return flat.findPath(startX, startZ, goalX, goalZ, outPath);
+
+    float reach = std::max(fabsf(goalX - startX), fabsf(goalZ - startZ)) / m_grid->getCellSize();
+    if (reach >= LONG_ROUTE_CELLS) return findPath(startX, startZ, goalX, goalZ, outPath, &flat);
+    if (flat.findPath(startX, startZ, goalX, goalZ, outPath, FLAT_EXPANSION_LIMIT)) return true;
+    return flat.wasCutOff() && findPath(startX, startZ, goalX, goalZ, outPath, &flat);
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+static float cellPathLength(const std::vector<int>& cells, int width) {
+    float length = 0.0f;
+    for (size_t c = 1; c < cells.size(); ++c) {
+        length += octile(cells[c] % width - cells[c - 1] % width, cells[c] / width - cells[c - 1] / width);
+    }
+    return length;
+}
+
+static float worldPathLength(const std::vector<PathPoint>& path) {
+    float length = 0.0f;
+    for (size_t i = 1; i < path.size(); ++i) {
+        float dx = path[i].x - path[i - 1].x, dz = path[i].z - path[i - 1].z;
+        length += sqrtf(dx * dx + dz * dz);
+    }
+    return length;
+}
+
+// Average and 95th percentile of a set of timings, printed after a label
+static void printTimes(const char* label, std::vector<double> times) {
+    if (times.empty()) return;
+    double total = 0.0;
+    for (double t : times) total += t;
+    std::sort(times.begin(), times.end());
+    printf("%s%7.1f us average, 95%% under %7.1f us, worst %7.1f us\n",
+        label, total / times.size(), times[times.size() * 95 / 100], times.back());
+}
+
+void PathHierarchy::runBenchmark(int size) {
+    typedef std::chrono::steady_clock Clock;
+    if (size < 100) size = 100;
+
+    // The shared benchmark venue: 50 x 50 rooms joined by doorways, some furniture
+    CollisionGrid grid;
+    std::vector<int> doorways; // x0, z0, x1, z1
+    makeBenchmarkVenue(grid, size, true, &doorways);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> pos(0, size - 1);
+
+    PathHierarchy hierarchy;
+    Clock::time_point t0 = Clock::now();
+    hierarchy.build(grid);
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    Pathfinder finder;
+    finder.build(grid);
+
+    const int queries = 400;
+    std::vector<int> pairs;
+    while ((int)pairs.size() < queries * 4) {
+        int x = pos(rng), z = pos(rng);
+        if (!grid.get(x, z)) { pairs.push_back(x); pairs.push_back(z); }
+    }
+
+    // Every query, and the long routes (ends at least half the venue apart on one axis) on their own
+    std::vector<int> route, cells, reference;
+    std::vector<PathPoint> path, flatPath, routed;
+    std::vector<double> abstractTimes[2], refinedTimes[2], flatTimes[2], pathTimes[2], flatPathTimes[2];
+    std::vector<double> routeTimes[2], allRouteTimes, allFlatTimes;
+    double worstRatio = 1.0, ratioSum = 0.0, pulledRatioSum = 0.0;
+    int compared = 0, disagreements = 0;
+    for (int i = 0; i < queries; ++i) {
+        const int* q = &pairs[i * 4];
+        int set = std::max(abs(q[2] - q[0]), abs(q[3] - q[1])) >= size / 2;
+        t0 = Clock::now();
+        hierarchy.findAbstractPath(q[0], q[1], q[2], q[3], route);
+        abstractTimes[set].push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+
+        t0 = Clock::now();
+        bool found = hierarchy.findCellPath(q[0], q[1], q[2], q[3], cells);
+        refinedTimes[set].push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+
+        t0 = Clock::now();
+        bool flatFound = finder.findCellPath(q[0], q[1], q[2], q[3], reference);
+        flatTimes[set].push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+
+        // World paths pulled tight, as agents use them
+        float sx, sz, gx, gz;
+        grid.cellCenter(q[0], q[1], sx, sz);
+        grid.cellCenter(q[2], q[3], gx, gz);
+        t0 = Clock::now();
+        hierarchy.findPath(sx, sz, gx, gz, path, &finder);
+        pathTimes[set].push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+
+        t0 = Clock::now();
+        finder.findPath(sx, sz, gx, gz, flatPath);
+        flatPathTimes[set].push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        allFlatTimes.push_back(flatPathTimes[set].back());
+
+        // As the crowd plans: whichever of the two findRoute() picks
+        t0 = Clock::now();
+        hierarchy.findRoute(sx, sz, gx, gz, routed, finder);
+        routeTimes[set].push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        allRouteTimes.push_back(routeTimes[set].back());
+
+        if (found != flatFound) disagreements++;
+        float optimal = cellPathLength(reference, size);
+        float flatLength = worldPathLength(flatPath);
+        if (found && flatFound && optimal > 0.0f && flatLength > 0.0f) {
+            double ratio = cellPathLength(cells, size) / optimal;
+            ratioSum += ratio;
+            worstRatio = std::max(worstRatio, ratio);
+            pulledRatioSum += worldPathLength(path) / flatLength;
+            compared++;
+        }
+    }
+
+    // Close and reopen random doorways; the result must match a fresh build
+    const int toggles = 50;
+    std::uniform_int_distribution<int> pick(0, (int)doorways.size() / 4 - 1);
+    double updateUs = 0.0;
+    long long rebuilt = 0;
+    for (int i = 0; i < toggles; ++i) {
+        const int* d = &doorways[pick(rng) * 4];
+        grid.fillRect(d[0], d[1], d[2], d[3], !grid.get(d[0], d[1]));
+        t0 = Clock::now();
+        hierarchy.update(grid, d[0], d[1], d[2], d[3]);
+        updateUs += std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        rebuilt += hierarchy.getLastRebuilt();
+    }
+    PathHierarchy fresh;
+    fresh.build(grid);
+    int differ = 0;
+    for (size_t k = 0; k < fresh.m_clusters.size(); ++k) {
+        const Cluster& a = hierarchy.m_clusters[k];
+        const Cluster& b = fresh.m_clusters[k];
+        if (a.nodes != b.nodes || a.costs != b.costs || a.links != b.links || a.facing != b.facing) differ++;
+    }
+
+    printf("PathHierarchy benchmark (%dx%d, %d clusters of %d, %d entrances):\n",
+        size, size, hierarchy.getClusterCount(), hierarchy.m_clusterSize, hierarchy.getNodeCount());
+    printf("  build:            %.2f ms\n", buildMs);
+    for (int set = 0; set < 2; ++set) {
+        printf("  %s routes (%d, ends %s %d cells apart):\n", set ? "long" : "short",
+            (int)abstractTimes[set].size(), set ? "at least" : "under", size / 2);
+        printTimes("    abstract query:      ", abstractTimes[set]);
+        printTimes("    refined query:       ", refinedTimes[set]);
+        printTimes("    Pathfinder cells:    ", flatTimes[set]);
+        printTimes("    world path:          ", pathTimes[set]);
+        printTimes("    Pathfinder path:     ", flatPathTimes[set]);
+        printTimes("    routed path:         ", routeTimes[set]);
+    }
+    printf("  all routes (%d):\n", queries);
+    printTimes("    Pathfinder path:     ", allFlatTimes);
+    printTimes("    routed path:         ", allRouteTimes);
+    printf("  length vs best:   %.3f average, %.3f worst (%d paths, %d found by only one)\n",
+        compared ? ratioSum / compared : 1.0, worstRatio, compared, disagreements);
+    printf("  pulled vs flat:   %.3f average world path length\n", compared ? pulledRatioSum / compared : 1.0);
+    printf("  door update:      %.1f us average (%.1f clusters)\n", updateUs / toggles, (double)rebuilt / toggles);
+    printf("  update vs build:  %d clusters differ\n", differ);
+}
@@ -0,0 +1,173 @@
+#pragma once
+#include <vector>
+#include "CollisionGrid.h"
+#include "Pathfinder.h"
+
+// ================================================================
+// PathHierarchy
+//
+// Hierarchical pathfinding (HPA*, Botea, Mueller & Schaeffer) for venues
+// too big to search cell by cell on every query.
+//
+// The grid is cut into square clusters. Where two clusters touch, each
+// run of cells that is open on both sides gets an entrance in its middle;
+// doorways between rooms are exactly such runs. Every entrance is a node
+// of a small abstract graph:
+//  - entrances facing each other across a border are joined at cost 1
+//  - entrances of the same cluster are joined by the walking distance
+//    between them inside the cluster, worked out when the cluster is built
+// A query connects the start and goal to the entrances of their own
+// clusters, runs a weighted A* on the abstract graph and only then turns
+// each leg back into cells with an A* bounded to one cluster. findPath()
+// only refines the legs without a straight line of sight before pulling
+// the route tight. Agents that walk a long route can refine it a leg at a
+// time (refineSegment()). A goal in another connected area of the graph is
+// turned down without a search.
+//
+// Paths are near-optimal (they pass through entrance cells), not optimal.
+// On the benchmark venue, routes across half of it or more take about 60%
+// of the time of a flat Pathfinder search on average and a third of it at
+// the 95th percentile; routes under about 300 cells are faster flat.
+//
+// update() rebuilds only the clusters a change touches, and those of their
+// direct neighbours whose entrances along the shared border moved, so a
+// door opening or closing costs one or two clusters.
+// ================================================================
+
+class PathHierarchy {
+public:
+    PathHierarchy();
+
+    /**
+     * @brief Builds the hierarchy for a grid. The grid must stay alive while it is searched.
+     * @param clusterSize Side of a cluster in cells.
+     */
+    void build(const CollisionGrid& grid, int clusterSize = 24);
+
+    /**
+     * @brief Rebuilds the clusters around cells [x0..x1] x [z0..z1] after they changed.
+     * Does nothing if the grid is not the one that was built or changed size.
+     */
+    void update(const CollisionGrid& grid, int x0, int z0, int x1, int z1);
+
+    void clear();
+
+    bool isReady() const { return m_grid != nullptr; }
+
+    /**
+     * @brief Abstract route: the start cell, the entrance cells passed and the
+     * goal cell (indices z * width + x). Consecutive cells are in the same
+     * cluster or face each other across a border.
+     */
+    bool findAbstractPath(int startX, int startZ, int goalX, int goalZ, std::vector<int>& outCells);
+
+    /**
+     * @brief Cells from one abstract route cell to the next (the first not
+     * included, the last included).
+     */
+    bool refineSegment(int fromCell, int toCell, std::vector<int>& outCells);
+
+    /**
+     * @brief findAbstractPath() refined to every cell of the route.
+     */
+    bool findCellPath(int startX, int startZ, int goalX, int goalZ, std::vector<int>& outCells);
+
+    /**
+     * @brief World version, like Pathfinder::findPath.
+     * @param pull Pathfinder used to pull the path tight (optional).
+     */
+    bool findPath(float startX, float startZ, float goalX, float goalZ,
+        std::vector<PathPoint>& outPath, const Pathfinder* pull = nullptr);
+
+    /**
+     * @brief World path the cheaper way: short routes by a flat search bounded
+     * to a few hundred microseconds, long ones (or those the flat search gives
+     * up on) through the hierarchy. Falls back to an unbounded flat search if
+     * the hierarchy is not built.
+     * @param flat Pathfinder built on the same grid.
+     */
+    bool findRoute(float startX, float startZ, float goalX, float goalZ,
+        std::vector<PathPoint>& outPath, Pathfinder& flat);
+
+    int getClusterCount() const { return (int)m_clusters.size(); }
+    int getNodeCount() const { return (int)m_nodeCluster.size(); }
+
+    // Clusters rebuilt by the last build() or update() (for stats)
+    int getLastRebuilt() const { return m_rebuilt; }
+
+    /**
+     * @brief Times queries and door changes on a generated size x size grid,
+     * compares path lengths with the Pathfinder and checks updates against
+     * full builds, printed to the console.
+     */
+    static void runBenchmark(int size);
+
+    // Open list entry of the abstract search
+    struct OpenEntry {
+        float f;
+        float g;
+        int node;
+    };
+
+private:
+    struct Cluster {
+        int x0, z0, x1, z1;
+        int firstNode;              // Id of nodes[0] in the abstract graph
+        std::vector<int> nodes;     // Entrance cells
+        std::vector<float> costs;   // nodes x nodes walking distances inside the cluster
+        std::vector<int> links;     // Pairs: entrance index, cell of the entrance across the border
+        std::vector<int> facing;    // Pairs per link: cluster and entrance index across (-1 if gone)
+    };
+
+    bool walkable(int x, int z) const { return !m_grid->get(x, z); }
+    int clusterOf(int cell) const;
+
+    void makeEntrances(int cluster);
+    void resolveLinks(int cluster);
+    void addBorder(Cluster& c, int x, int z, int dx, int dz, int stepX, int stepZ, int length);
+    void computeCosts(int cluster);
+    void numberNodes();
+    void labelAreas();
+
+    // Dijkstra from a cell, bounded to one cluster's rectangle; with a
+    // stopCell it is an A* toward that cell and stops when it gets there
+    void searchCluster(int cluster, int fromCell, int stopCell);
+    int localIndex(int cell) const;  // Index in the last searched cluster, or -1 outside it
+    float localDistance(int cell) const;
+
+    const CollisionGrid* m_grid;
+    int m_width, m_height;
+    int m_clusterSize, m_clustersX, m_clustersZ;
+    std::vector<Cluster> m_clusters;
+    std::vector<int> m_nodeCluster;  // Cluster of each abstract node
+    std::vector<int> m_nodeCell;     // Cell of each abstract node
+    std::vector<int> m_nodeX, m_nodeZ; // Its coordinates (for the heuristic)
+    std::vector<int> m_nodeAcross;   // Two per node: entrances across a border (-1 if none)
+    std::vector<int> m_nodeArea;     // Connected area of each node (nodes that reach each other share it)
+    bool m_areasStale;               // Relabelled by the next search after a change
+    int m_rebuilt;
+
+    // Bounded search scratch (cluster-local indices, rows of m_localStride
+    // with a blocked ring around the cluster so neighbours need no bounds checks)
+    int m_localCluster;
+    int m_localStride;
+    std::vector<unsigned char> m_localWalkable;
+    std::vector<float> m_localDist;
+    std::vector<int> m_localParent;
+    std::vector<Pathfinder::OpenNode> m_localOpen;
+
+    // Abstract search scratch (start = node count, goal = node count + 1),
+    // one entry per node so a relaxation touches a single cache line
+    struct SearchState {
+        unsigned int stamp;
+        int parent;
+        float g;
+        int closed;
+    };
+    std::vector<SearchState> m_state;
+    std::vector<OpenEntry> m_open;
+    std::vector<float> m_goalCosts;  // Goal cluster entrances to the goal
+    unsigned int m_search;
+};
+
+extern PathHierarchy g_pathHierarchy;
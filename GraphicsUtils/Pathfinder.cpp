@@ -0,0 +1,666 @@
+// Pathfinder.cpp : Jump Point Search over the collision grid bitset.
+//
+#include "pch.h" // Must be first
+#include "Pathfinder.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+Pathfinder g_pathfinder;
+
+static const float DIAGONAL_COST = 1.41421356f;
+
+// ================================================================
+// Helpers
+// ================================================================
+
+static inline int lowestBit64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (int)index;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+static inline int highestBit64(uint64_t v) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+// Cost of a straight or diagonal run (and the A* heuristic)
+static inline float octile(int dx, int dz) {
+    dx = abs(dx);
+    dz = abs(dz);
+    return (dx > dz) ? (dx - dz) + dz * DIAGONAL_COST : (dz - dx) + dx * DIAGONAL_COST;
+}
+
+static inline int sign(int v) {
+    return (v > 0) - (v < 0);
+}
+
+// Cells of one line (a grid row, or a row of the transposed grid) where
+// moving along it by dir finds a neighbour cell that just came free
+// ("forced neighbours"): free at p, blocked one cell behind p.
+// Bits past the end of the line count as blocked.
+static inline uint64_t forcedBits(const uint64_t* side, int w, int words, uint64_t lastMask, int dir) {
+    if (!side) return 0; // Outside the grid: all blocked, nothing comes free
+    uint64_t bits = side[w];
+    if (w == words - 1) bits |= ~lastMask;
+
+    uint64_t behind;
+    if (dir > 0) {
+        uint64_t carry = (w > 0) ? (side[w - 1] >> 63) : 1;
+        behind = (bits << 1) | carry;
+    }
+    else {
+        uint64_t carry = (w + 1 < words) ? (side[w + 1] & 1) : 1;
+        behind = (bits >> 1) | (carry << 63);
+    }
+    return ~bits & behind;
+}
+
+// Straight jump along line 'line' of a bitset grid, from 'pos' in direction
+// dir (+1 / -1). Stops at the goal (goal < 0: not on this line) or at the
+// first cell with a forced neighbour on either side line.
+// Returns that cell, or -1 if a blocked cell (or the edge) comes first.
+static int scanLine(const CollisionGrid& g, int line, int pos, int dir, int goal) {
+    int length = g.getWidth();
+    if (line < 0 || line >= g.getHeight() || pos < 0 || pos >= length) return -1;
+
+    int words = g.getWordsPerRow();
+    const uint64_t* cur = g.row(line);
+    const uint64_t* side0 = (line > 0) ? g.row(line - 1) : nullptr;
+    const uint64_t* side1 = (line + 1 < g.getHeight()) ? g.row(line + 1) : nullptr;
+    uint64_t lastMask = (length & 63) ? ((1ULL << (length & 63)) - 1) : ~0ULL;
+    int first = pos >> 6;
+
+    for (int w = first; w >= 0 && w < words; w += dir) {
+        uint64_t stop = cur[w] | forcedBits(side0, w, words, lastMask, dir) | forcedBits(side1, w, words, lastMask, dir);
+        if (w == words - 1) stop |= ~lastMask;
+        if ((goal >> 6) == w && goal >= 0) stop |= 1ULL << (goal & 63);
+
+        // Only cells from pos onwards
+        if (w == first) {
+            int b = pos & 63;
+            if (dir > 0) stop &= ~0ULL << b;
+            else stop &= (b == 63) ? ~0ULL : ((1ULL << (b + 1)) - 1);
+        }
+        if (!stop) continue;
+
+        int p = (w << 6) + (dir > 0 ? lowestBit64(stop) : highestBit64(stop));
+        if (p >= length || ((cur[p >> 6] >> (p & 63)) & 1)) return -1;
+        return p;
+    }
+    return -1;
+}
+
+// ================================================================
+// Setup
+// ================================================================
+
+Pathfinder::Pathfinder()
+    : m_grid(nullptr), m_width(0), m_height(0), m_areasStale(true), m_nodeCount(0), m_search(0),
+    m_goalX(-1), m_goalZ(-1), m_expanded(0), m_cutOff(false)
+{
+}
+
+void Pathfinder::build(const CollisionGrid& grid) {
+    m_grid = &grid;
+    m_width = grid.getWidth();
+    m_height = grid.getHeight();
+
+    // Transpose: only the blocked cells need to be written
+    m_columns.configure(m_height, m_width, grid.getCellSize(), grid.getOriginZ(), grid.getOriginX());
+    for (int z = 0; z < m_height; ++z) {
+        const uint64_t* r = grid.row(z);
+        for (int w = 0; w < grid.getWordsPerRow(); ++w) {
+            for (uint64_t bits = r[w]; bits; bits &= bits - 1) {
+                m_columns.set(z, (w << 6) + lowestBit64(bits), true);
+            }
+        }
+    }
+
+    SearchNode empty = { 0, -1, 0.0f, -1, 0 };
+    m_nodes.assign(1024, empty);
+    m_nodeCount = 0;
+    m_search = 0;
+    m_areasStale = true;
+}
+
+void Pathfinder::update(const CollisionGrid& grid, int x0, int z0, int x1, int z1) {
+    if (m_grid != &grid || grid.getWidth() != m_width || grid.getHeight() != m_height) return;
+
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, m_width - 1);
+    z1 = std::min(z1, m_height - 1);
+    for (int x = x0; x <= x1; ++x) {
+        for (int z = z0; z <= z1; ++z) {
+            m_columns.set(z, x, grid.get(x, z));
+        }
+    }
+    m_areasStale = true;
+}
+
+void Pathfinder::updateArea(const CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ) {
+    int x0, z0, x1, z1;
+    grid.worldToCell(minX, minZ, x0, z0);
+    grid.worldToCell(maxX, maxZ, x1, z1);
+    update(grid, x0, z0, x1, z1);
+}
+
+void Pathfinder::clear() {
+    m_grid = nullptr;
+    m_width = m_height = 0;
+    m_columns.resize(0, 0);
+    m_rowRuns.clear();
+    m_runStart.clear();
+    m_runEnd.clear();
+    m_runArea.clear();
+    m_areasStale = true;
+    m_nodes.clear();
+    m_nodeCount = 0;
+    m_open.clear();
+}
+
+// ================================================================
+// Connected Areas
+// ================================================================
+
+static int findRoot(std::vector<int>& parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void Pathfinder::labelAreas() {
+    m_rowRuns.assign(m_height + 1, 0);
+    m_runStart.clear();
+    m_runEnd.clear();
+
+    // Runs of free cells, a word at a time
+    int words = m_grid->getWordsPerRow();
+    for (int z = 0; z < m_height; ++z) {
+        m_rowRuns[z] = (int)m_runStart.size();
+        const uint64_t* r = m_grid->row(z);
+        int x = 0;
+        while (x < m_width) {
+            // Next free cell, then the next blocked one after it
+            uint64_t freeBits = ~r[x >> 6] & (~0ULL << (x & 63));
+            int w = x >> 6;
+            while (!freeBits && ++w < words) freeBits = ~r[w];
+            if (!freeBits) break;
+            int start = (w << 6) + lowestBit64(freeBits);
+            if (start >= m_width) break;
+
+            uint64_t blockedBits = r[start >> 6] & (~0ULL << (start & 63));
+            w = start >> 6;
+            while (!blockedBits && ++w < words) blockedBits = r[w];
+            int end = blockedBits ? std::min((w << 6) + lowestBit64(blockedBits), m_width) : m_width;
+
+            m_runStart.push_back(start);
+            m_runEnd.push_back(end - 1);
+            x = end;
+        }
+    }
+    m_rowRuns[m_height] = (int)m_runStart.size();
+
+    // Join runs that overlap a run on the row before. Runs that only touch
+    // diagonally stay apart: one of the two corner cells is always blocked.
+    int runs = (int)m_runStart.size();
+    std::vector<int> parent(runs);
+    for (int i = 0; i < runs; ++i) parent[i] = i;
+    for (int z = 1; z < m_height; ++z) {
+        int a = m_rowRuns[z - 1], aEnd = m_rowRuns[z];
+        int b = m_rowRuns[z], bEnd = m_rowRuns[z + 1];
+        while (a < aEnd && b < bEnd) {
+            if (m_runStart[a] <= m_runEnd[b] && m_runStart[b] <= m_runEnd[a]) {
+                int ra = findRoot(parent, a), rb = findRoot(parent, b);
+                if (ra != rb) parent[ra] = rb;
+            }
+            if (m_runEnd[a] < m_runEnd[b]) a++;
+            else b++;
+        }
+    }
+
+    m_runArea.resize(runs);
+    for (int i = 0; i < runs; ++i) m_runArea[i] = findRoot(parent, i);
+    m_areasStale = false;
+}
+
+int Pathfinder::areaOf(int x, int z) const {
+    // Last run of the row starting at or before x
+    const int* first = m_runStart.data() + m_rowRuns[z];
+    const int* last = m_runStart.data() + m_rowRuns[z + 1];
+    const int* run = std::upper_bound(first, last, x);
+    if (run == first) return -1;
+    int i = (int)(run - m_runStart.data()) - 1;
+    return (x <= m_runEnd[i]) ? m_runArea[i] : -1;
+}
+
+// ================================================================
+// Jumping
+// ================================================================
+
+int Pathfinder::jumpX(int x, int z, int dx) const {
+    return scanLine(*m_grid, z, x, dx, (z == m_goalZ) ? m_goalX : -1);
+}
+
+int Pathfinder::jumpZ(int x, int z, int dz) const {
+    return scanLine(m_columns, x, z, dz, (x == m_goalX) ? m_goalZ : -1);
+}
+
+bool Pathfinder::jump(int x, int z, int dx, int dz, int& jx, int& jz) const {
+    if (dx != 0 && dz != 0) {
+        for (;;) {
+            if (!walkable(x, z)) return false;
+
+            // A diagonal cell is a jump point if either straight run from it finds one
+            if ((x == m_goalX && z == m_goalZ) || jumpX(x + dx, z, dx) >= 0 || jumpZ(x, z + dz, dz) >= 0) {
+                jx = x;
+                jz = z;
+                return true;
+            }
+
+            // No corner cutting: both sides must be free to keep going
+            if (!walkable(x + dx, z) || !walkable(x, z + dz)) return false;
+            x += dx;
+            z += dz;
+        }
+    }
+
+    if (dx != 0) {
+        int p = jumpX(x, z, dx);
+        if (p < 0) return false;
+        jx = p;
+        jz = z;
+        return true;
+    }
+
+    int p = jumpZ(x, z, dz);
+    if (p < 0) return false;
+    jx = x;
+    jz = p;
+    return true;
+}
+
+// ================================================================
+// Search
+// ================================================================
+
+static bool openNodeGreater(const Pathfinder::OpenNode& a, const Pathfinder::OpenNode& b);
+
+static inline unsigned int hashCell(int cell) {
+    return (unsigned int)cell * 2654435761u;
+}
+
+Pathfinder::SearchNode* Pathfinder::findNode(int cell) {
+    unsigned int mask = (unsigned int)m_nodes.size() - 1;
+    for (unsigned int i = hashCell(cell) & mask; ; i = (i + 1) & mask) {
+        SearchNode& n = m_nodes[i];
+        if (n.stamp != m_search) return nullptr;
+        if (n.cell == cell) return &n;
+    }
+}
+
+Pathfinder::SearchNode& Pathfinder::addNode(int cell) {
+    if ((m_nodeCount + 1) * 2 > (int)m_nodes.size()) growNodes();
+    unsigned int mask = (unsigned int)m_nodes.size() - 1;
+    unsigned int i = hashCell(cell) & mask;
+    while (m_nodes[i].stamp == m_search) i = (i + 1) & mask;
+
+    SearchNode& n = m_nodes[i];
+    n.stamp = m_search;
+    n.cell = cell;
+    n.g = 1e30f;
+    n.parent = -1;
+    n.closed = 0;
+    m_nodeCount++;
+    return n;
+}
+
+void Pathfinder::growNodes() {
+    // Re-insert this search's nodes into a table twice the size
+    std::vector<SearchNode> old;
+    old.swap(m_nodes);
+    SearchNode empty = { 0, -1, 0.0f, -1, 0 };
+    m_nodes.assign(old.size() * 2, empty);
+
+    unsigned int mask = (unsigned int)m_nodes.size() - 1;
+    for (const auto& n : old) {
+        if (n.stamp != m_search) continue;
+        unsigned int i = hashCell(n.cell) & mask;
+        while (m_nodes[i].stamp == m_search) i = (i + 1) & mask;
+        m_nodes[i] = n;
+    }
+}
+
+void Pathfinder::visit(int cell, int parent, float g, int x, int z) {
+    SearchNode* found = findNode(cell);
+    if (found && (found->closed || g >= found->g)) return;
+    SearchNode& node = found ? *found : addNode(cell);
+
+    node.g = g;
+    node.parent = parent;
+    OpenNode n = { g + octile(m_goalX - x, m_goalZ - z), g, cell };
+    m_open.push_back(n);
+    std::push_heap(m_open.begin(), m_open.end(), openNodeGreater);
+}
+
+bool Pathfinder::findCellPath(int startX, int startZ, int goalX, int goalZ, std::vector<int>& outCells,
+    int maxExpanded) {
+    outCells.clear();
+    m_expanded = 0;
+    m_cutOff = false;
+    if (!m_grid || !walkable(startX, startZ) || !walkable(goalX, goalZ)) return false;
+
+    if (m_areasStale) labelAreas();
+    if (areaOf(startX, startZ) != areaOf(goalX, goalZ)) return false;
+
+    m_goalX = goalX;
+    m_goalZ = goalZ;
+    if (++m_search == 0) {
+        // Stamp wrapped around: forget every old search
+        for (auto& n : m_nodes) n.stamp = 0;
+        m_search = 1;
+    }
+    m_nodeCount = 0;
+    m_open.clear();
+
+    int w = m_width;
+    visit(startZ * w + startX, -1, 0.0f, startX, startZ);
+
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), openNodeGreater);
+        int c = m_open.back().cell;
+        m_open.pop_back();
+        SearchNode* node = findNode(c);
+        if (node->closed) continue; // Older, longer entry of a node
+        if (maxExpanded > 0 && m_expanded >= maxExpanded) {
+            m_cutOff = true;
+            return false;
+        }
+        node->closed = 1;
+        float g = node->g;
+        int parent = node->parent; // (node moves if the table grows below)
+        m_expanded++;
+
+        int x = c % w, z = c / w;
+        if (x == goalX && z == goalZ) {
+            for (int p = c; p >= 0; p = findNode(p)->parent) outCells.push_back(p);
+            std::reverse(outCells.begin(), outCells.end());
+            return true;
+        }
+
+        // Directions worth jumping in (pruned by where we came from)
+        int dirs[8][2];
+        int count = 0;
+        if (parent < 0) {
+            for (int dz = -1; dz <= 1; ++dz) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dx == 0 && dz == 0) continue;
+                    if (dx != 0 && dz != 0 && (!walkable(x + dx, z) || !walkable(x, z + dz))) continue;
+                    dirs[count][0] = dx; dirs[count][1] = dz; count++;
+                }
+            }
+        }
+        else {
+            int dx = sign(x - parent % w), dz = sign(z - parent / w);
+            if (dx != 0 && dz != 0) {
+                bool nextX = walkable(x + dx, z), nextZ = walkable(x, z + dz);
+                if (nextZ) { dirs[count][0] = 0; dirs[count][1] = dz; count++; }
+                if (nextX) { dirs[count][0] = dx; dirs[count][1] = 0; count++; }
+                if (nextX && nextZ) { dirs[count][0] = dx; dirs[count][1] = dz; count++; }
+            }
+            else if (dx != 0) {
+                // Straight: forward, plus the sides that came free past a blocked cell
+                bool next = walkable(x + dx, z);
+                if (next) { dirs[count][0] = dx; dirs[count][1] = 0; count++; }
+                for (int s = -1; s <= 1; s += 2) {
+                    if (!walkable(x, z + s) || walkable(x - dx, z + s)) continue;
+                    dirs[count][0] = 0; dirs[count][1] = s; count++;
+                    if (next) { dirs[count][0] = dx; dirs[count][1] = s; count++; }
+                }
+            }
+            else {
+                bool next = walkable(x, z + dz);
+                if (next) { dirs[count][0] = 0; dirs[count][1] = dz; count++; }
+                for (int s = -1; s <= 1; s += 2) {
+                    if (!walkable(x + s, z) || walkable(x + s, z - dz)) continue;
+                    dirs[count][0] = s; dirs[count][1] = 0; count++;
+                    if (next) { dirs[count][0] = s; dirs[count][1] = dz; count++; }
+                }
+            }
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int jx, jz;
+            if (!jump(x + dirs[i][0], z + dirs[i][1], dirs[i][0], dirs[i][1], jx, jz)) continue;
+            visit(jz * w + jx, c, g + octile(jx - x, jz - z), jx, jz);
+        }
+    }
+    return false;
+}
+
+static bool openNodeGreater(const Pathfinder::OpenNode& a, const Pathfinder::OpenNode& b) {
+    // Equal estimates: the one further along first (fewer nodes on long straight paths)
+    return a.f > b.f || (a.f == b.f && a.g < b.g);
+}
+
+
+// ================================================================
+// Smoothing
+// ================================================================
+
+bool Pathfinder::isLineWalkable(int x0, int z0, int x1, int z1) const {
+    if (!m_grid || !walkable(x0, z0) || !walkable(x1, z1)) return false;
+
+    // Every cell the line between the two centers touches, in order
+    int nx = abs(x1 - x0), nz = abs(z1 - z0);
+    int stepX = sign(x1 - x0), stepZ = sign(z1 - z0);
+    int x = x0, z = z0;
+    for (int ix = 0, iz = 0; ix < nx || iz < nz; ) {
+        long long decision = (long long)(1 + 2 * ix) * nz - (long long)(1 + 2 * iz) * nx;
+        if (decision == 0) {
+            // Exactly through a corner: both cells beside it must be free
+            if (!walkable(x + stepX, z) || !walkable(x, z + stepZ)) return false;
+            x += stepX; z += stepZ; ix++; iz++;
+        }
+        else if (decision < 0) {
+            x += stepX; ix++;
+        }
+        else {
+            z += stepZ; iz++;
+        }
+        if (!walkable(x, z)) return false;
+    }
+    return true;
+}
+
+void Pathfinder::smooth(const std::vector<int>& cells, std::vector<int>& out) const {
+    out.clear();
+    if (cells.empty()) return;
+
+    int w = m_width;
+    size_t anchor = 0;
+    out.push_back(cells[0]);
+    while (anchor + 1 < cells.size()) {
+        // Furthest jump point still in a straight line of sight
+        size_t next = anchor + 1;
+        while (next + 1 < cells.size() &&
+            isLineWalkable(cells[anchor] % w, cells[anchor] / w, cells[next + 1] % w, cells[next + 1] / w)) {
+            next++;
+        }
+        out.push_back(cells[next]);
+        anchor = next;
+    }
+}
+
+bool Pathfinder::nearestWalkable(int& x, int& z, int maxRadius) const {
+    if (walkable(x, z)) return true;
+    for (int r = 1; r <= maxRadius; ++r) {
+        int bestX = 0, bestZ = 0, bestD = -1;
+        for (int dz = -r; dz <= r; ++dz) {
+            for (int dx = -r; dx <= r; ++dx) {
+                if (abs(dx) != r && abs(dz) != r) continue; // Ring only
+                if (!walkable(x + dx, z + dz)) continue;
+                int d = dx * dx + dz * dz;
+                if (bestD < 0 || d < bestD) { bestD = d; bestX = x + dx; bestZ = z + dz; }
+            }
+        }
+        if (bestD >= 0) {
+            x = bestX;
+            z = bestZ;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Pathfinder::findPath(float startX, float startZ, float goalX, float goalZ, std::vector<PathPoint>& outPath,
+    int maxExpanded) {
+    outPath.clear();
+    if (!m_grid) return false;
+
+    int sx, sz, gx, gz;
+    m_grid->worldToCell(startX, startZ, sx, sz);
+    m_grid->worldToCell(goalX, goalZ, gx, gz);
+    bool startMoved = !walkable(sx, sz), goalMoved = !walkable(gx, gz);
+    if (!nearestWalkable(sx, sz, 3) || !nearestWalkable(gx, gz, 3)) return false;
+
+    std::vector<int> cells, pulled;
+    if (!findCellPath(sx, sz, gx, gz, cells, maxExpanded)) return false;
+    smooth(cells, pulled);
+
+    PathPoint p;
+    if (startMoved) m_grid->cellCenter(sx, sz, p.x, p.z);
+    else { p.x = startX; p.z = startZ; }
+    outPath.push_back(p);
+
+    for (size_t i = 1; i + 1 < pulled.size(); ++i) {
+        m_grid->cellCenter(pulled[i] % m_width, pulled[i] / m_width, p.x, p.z);
+        outPath.push_back(p);
+    }
+
+    if (goalMoved) m_grid->cellCenter(gx, gz, p.x, p.z);
+    else { p.x = goalX; p.z = goalZ; }
+    outPath.push_back(p);
+    return true;
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+// Plain 8-connected A* (same moves and costs) as the reference for path lengths
+static float referenceAStar(const CollisionGrid& grid, int sx, int sz, int gx, int gz) {
+    int w = grid.getWidth(), h = grid.getHeight();
+    std::vector<float> g((size_t)w * h, 1e30f);
+    std::vector<unsigned char> closed((size_t)w * h, 0);
+    std::vector<Pathfinder::OpenNode> open;
+
+    g[sz * w + sx] = 0.0f;
+    Pathfinder::OpenNode start = { octile(gx - sx, gz - sz), 0.0f, sz * w + sx };
+    open.push_back(start);
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), openNodeGreater);
+        int c = open.back().cell;
+        open.pop_back();
+        if (closed[c]) continue;
+        closed[c] = 1;
+        int x = c % w, z = c / w;
+        if (x == gx && z == gz) return g[c];
+
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if ((dx == 0 && dz == 0) || grid.get(x + dx, z + dz)) continue;
+                if (dx != 0 && dz != 0 && (grid.get(x + dx, z) || grid.get(x, z + dz))) continue;
+                int n = (z + dz) * w + (x + dx);
+                float ng = g[c] + ((dx != 0 && dz != 0) ? DIAGONAL_COST : 1.0f);
+                if (ng < g[n]) {
+                    g[n] = ng;
+                    Pathfinder::OpenNode node = { ng + octile(gx - x - dx, gz - z - dz), ng, n };
+                    open.push_back(node);
+                    std::push_heap(open.begin(), open.end(), openNodeGreater);
+                }
+            }
+        }
+    }
+    return -1.0f;
+}
+
+void Pathfinder::runBenchmark(int size) {
+    typedef std::chrono::steady_clock Clock;
+
+    // A venue: 50 x 50 rooms joined by doorways, furniture on about 3% of the floor
+    CollisionGrid grid;
+    makeBenchmarkVenue(grid, size);
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> pos(0, size - 1);
+
+    Pathfinder finder;
+    Clock::time_point t0 = Clock::now();
+    finder.build(grid);
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    // Random pairs of walkable cells
+    const int queries = 200, checked = 20;
+    std::vector<int> pairs;
+    while ((int)pairs.size() < queries * 4) {
+        int x = pos(rng), z = pos(rng);
+        if (!grid.get(x, z)) { pairs.push_back(x); pairs.push_back(z); }
+    }
+
+    std::vector<int> cells;
+    std::vector<double> times;
+    int found = 0, mismatches = 0;
+    long long expanded = 0;
+    double totalUs = 0.0, worstUs = 0.0;
+    for (int i = 0; i < queries; ++i) {
+        const int* q = &pairs[i * 4];
+        t0 = Clock::now();
+        bool ok = finder.findCellPath(q[0], q[1], q[2], q[3], cells);
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        totalUs += us;
+        worstUs = std::max(worstUs, us);
+        times.push_back(us);
+        expanded += finder.getLastExpanded();
+
+        float length = -1.0f;
+        if (ok) {
+            found++;
+            length = 0.0f;
+            for (size_t c = 1; c < cells.size(); ++c) {
+                length += octile(cells[c] % size - cells[c - 1] % size, cells[c] / size - cells[c - 1] / size);
+            }
+        }
+        if (i < checked) {
+            float reference = referenceAStar(grid, q[0], q[1], q[2], q[3]);
+            if (fabsf(reference - length) > 0.01f + reference * 1e-5f) mismatches++; // Float sums over long paths
+        }
+    }
+
+    printf("Pathfinder benchmark (%dx%d, %d random queries):\n", size, size, queries);
+    printf("  build:            %.2f ms\n", buildMs);
+    std::sort(times.begin(), times.end());
+    printf("  query average:    %.1f us (worst %.1f us)\n", totalUs / queries, worstUs);
+    printf("  query median:     %.1f us (95%% under %.1f us)\n", times[queries / 2], times[queries * 95 / 100]);
+    printf("  nodes expanded:   %.0f per query\n", (double)expanded / queries);
+    printf("  paths found:      %d\n", found);
+    printf("  length vs A*:     %d of %d differ\n", mismatches, checked);
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <vector>
+#include "CollisionGrid.h"
+
+// ================================================================
+// Pathfinder
+//
+// Shortest paths over the collision grid: A* with Jump Point Search
+// (Harabor & Grastien), 8-connected, never cutting the corner of a
+// blocked cell.
+//
+// JPS only puts "jump points" (where the route may have to turn) on the
+// open list; the straight runs between them are scanned instead of
+// expanded. The scans work on the bitset a 64-cell word at a time: along
+// X on the grid's own rows, along Z on a transposed copy of the grid the
+// pathfinder keeps (build() / update() keep it in sync, like the
+// DistanceField).
+//
+// A goal the start cannot reach is turned down without a search (which
+// would otherwise flood everything the start can reach): the walkable
+// cells are grouped into connected areas, as runs of free cells per row
+// joined where they overlap a run on the next row. A change marks the
+// areas stale; they are relabelled by the next search.
+//
+// The resulting jump points are pulled tight with line of sight checks,
+// so a path is a short list of world-space waypoints.
+// ================================================================
+
+struct PathPoint {
+    float x, z;
+};
+
+class Pathfinder {
+public:
+    Pathfinder();
+
+    /**
+     * @brief Prepares for searches on a grid (copies it transposed).
+     * The grid must stay alive while it is searched.
+     */
+    void build(const CollisionGrid& grid);
+
+    /**
+     * @brief Refreshes the copy for cells [x0..x1] x [z0..z1] after they changed.
+     * Does nothing if the grid is not the one that was built or changed size.
+     */
+    void update(const CollisionGrid& grid, int x0, int z0, int x1, int z1);
+
+    /**
+     * @brief update() for the cells under a world-space rectangle.
+     */
+    void updateArea(const CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ);
+
+    void clear();
+
+    bool isReady() const { return m_grid != nullptr; }
+
+    /**
+     * @brief Finds a path between two world positions.
+     * A start or goal inside a blocked cell moves to the nearest walkable
+     * cell (a few cells at most).
+     * @param outPath Waypoints from the start to the goal, both included.
+     * @param maxExpanded Gives up after this many nodes (0 = no limit); see wasCutOff().
+     * @return False if there is no path.
+     */
+    bool findPath(float startX, float startZ, float goalX, float goalZ, std::vector<PathPoint>& outPath,
+        int maxExpanded = 0);
+
+    /**
+     * @brief Grid version: jump points (cell indices z * width + x) from start to goal,
+     * not smoothed.
+     */
+    bool findCellPath(int startX, int startZ, int goalX, int goalZ, std::vector<int>& outCells,
+        int maxExpanded = 0);
+
+    // True if the last search gave up at maxExpanded (the path may still exist)
+    bool wasCutOff() const { return m_cutOff; }
+
+    /**
+     * @brief True if a straight line between two cell centers only crosses
+     * walkable cells (and never squeezes between two diagonal blocked cells).
+     */
+    bool isLineWalkable(int x0, int z0, int x1, int z1) const;
+
+    /**
+     * @brief Pulls a cell path tight: keeps the first and last cell and only
+     * the cells needed to keep each leg in line of sight.
+     */
+    void smooth(const std::vector<int>& cells, std::vector<int>& out) const;
+
+    // Nodes taken off the open list by the last search (for stats)
+    int getLastExpanded() const { return m_expanded; }
+
+    /**
+     * @brief Times random queries on a generated size x size grid and checks
+     * path lengths against plain A*, printed to the console.
+     */
+    static void runBenchmark(int size);
+
+    // Open list entry: estimated total cost, cost so far and cell index
+    struct OpenNode {
+        float f;
+        float g;
+        int cell;
+    };
+
+private:
+    bool walkable(int x, int z) const { return !m_grid->get(x, z); }
+    bool nearestWalkable(int& x, int& z, int maxRadius) const;
+
+    // Jump from (x, z) in direction (dx, dz); true with the jump point in (jx, jz)
+    bool jump(int x, int z, int dx, int dz, int& jx, int& jz) const;
+    int jumpX(int x, int z, int dx) const;
+    int jumpZ(int x, int z, int dz) const;
+
+    void visit(int cell, int parent, float g, int x, int z);
+
+    void labelAreas();
+    int areaOf(int x, int z) const;
+
+    const CollisionGrid* m_grid;
+    CollisionGrid m_columns;   // Transposed grid: cell (z, x) is grid cell (x, z)
+    int m_width, m_height;
+
+    // Search state of the cells the current search reached, in a small
+    // open-addressing hash table (slots of older searches have an old stamp).
+    // JPS reaches few cells, so the table stays in cache where a per-cell
+    // array of a large grid would miss on every visit.
+    struct SearchNode {
+        unsigned int stamp;
+        int cell;
+        float g;
+        int parent;
+        int closed;
+    };
+    SearchNode* findNode(int cell);
+    SearchNode& addNode(int cell);
+    void growNodes();
+
+    // Connected areas: runs of free cells, row by row
+    std::vector<int> m_rowRuns;      // First run of each row (size = height + 1)
+    std::vector<int> m_runStart, m_runEnd;
+    std::vector<int> m_runArea;
+    bool m_areasStale;
+
+    std::vector<SearchNode> m_nodes;
+    int m_nodeCount;
+    std::vector<OpenNode> m_open;
+    unsigned int m_search;
+
+    int m_goalX, m_goalZ;
+    int m_expanded;
+    bool m_cutOff;
+};
+
+extern Pathfinder g_pathfinder;
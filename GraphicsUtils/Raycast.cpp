@@ -0,0 +1,196 @@
+// Raycast.cpp : Grid voxel traversal and ray/box tests.
+//
+#include "pch.h" // Must be first
+#include "Raycast.h"
+#include "CollisionGrid.h"
+#include <math.h>
+
+static const float NO_HIT = 1e30f;
+
+// ================================================================
+// Traversal
+// ================================================================
+
+namespace {
+
+// Walks the cells under a ray in order. Direction must be normalized
+// (2D or 3D); distances are measured along it.
+struct GridWalk {
+    int x, z;              // Current cell
+    int stepX, stepZ;
+    float nextX, nextZ;    // Distance to the next X / Z cell border
+    float deltaX, deltaZ;  // Distance between two X / Z borders
+    float enter;           // Distance at which the current cell was entered
+    int lastAxis;          // 0 = X, 1 = Z, -1 = start cell
+
+    GridWalk(const CollisionGrid& grid, float ox, float oz, float dx, float dz) {
+        grid.worldToCell(ox, oz, x, z);
+        const float cell = grid.getCellSize();
+        const float fx = (ox - grid.getOriginX()) / cell - x; // Position inside the cell (0..1)
+        const float fz = (oz - grid.getOriginZ()) / cell - z;
+
+        stepX = dx > 0.0f ? 1 : -1;
+        stepZ = dz > 0.0f ? 1 : -1;
+        deltaX = dx != 0.0f ? cell / fabsf(dx) : NO_HIT;
+        deltaZ = dz != 0.0f ? cell / fabsf(dz) : NO_HIT;
+        nextX = dx != 0.0f ? (dx > 0.0f ? 1.0f - fx : fx) * deltaX : NO_HIT;
+        nextZ = dz != 0.0f ? (dz > 0.0f ? 1.0f - fz : fz) * deltaZ : NO_HIT;
+        enter = 0.0f;
+        lastAxis = -1;
+    }
+
+    // Distance at which the ray leaves the current cell
+    float exit() const { return nextX < nextZ ? nextX : nextZ; }
+
+    void step() {
+        if (nextX < nextZ) {
+            enter = nextX; nextX += deltaX; x += stepX; lastAxis = 0;
+        }
+        else {
+            enter = nextZ; nextZ += deltaZ; z += stepZ; lastAxis = 1;
+        }
+    }
+};
+
+void fillHit(const GridWalk& walk, float ox, float oy, float oz, float dx, float dy, float dz, float t, GridRayHit& out) {
+    out.hit = true;
+    out.distance = t;
+    out.cellX = walk.x;
+    out.cellZ = walk.z;
+    out.x = ox + dx * t;
+    out.y = oy + dy * t;
+    out.z = oz + dz * t;
+    out.normalX = walk.lastAxis == 0 ? (float)-walk.stepX : 0.0f;
+    out.normalZ = walk.lastAxis == 1 ? (float)-walk.stepZ : 0.0f;
+}
+
+void clearHit(GridRayHit& out) {
+    out.hit = false;
+    out.distance = 0.0f;
+    out.cellX = out.cellZ = -1;
+    out.x = out.y = out.z = 0.0f;
+    out.normalX = out.normalZ = 0.0f;
+}
+
+} // namespace
+
+bool raycastGrid(float originX, float originZ, float dirX, float dirZ, float maxDistance, GridRayHit& out) {
+    clearHit(out);
+    float len = sqrtf(dirX * dirX + dirZ * dirZ);
+    if (len <= 0.0f) return false;
+    dirX /= len;
+    dirZ /= len;
+
+    const CollisionGrid& grid = g_collisionGrid;
+    GridWalk walk(grid, originX, originZ, dirX, dirZ);
+    while (walk.enter <= maxDistance) {
+        if (grid.get(walk.x, walk.z)) {
+            fillHit(walk, originX, 0.0f, originZ, dirX, 0.0f, dirZ, walk.enter, out);
+            return true;
+        }
+        walk.step();
+    }
+    return false;
+}
+
+bool raycastGrid3D(float originX, float originY, float originZ, float dirX, float dirY, float dirZ,
+    float maxDistance, float cellHeight, GridRayHit& out) {
+    clearHit(out);
+    float len = sqrtf(dirX * dirX + dirY * dirY + dirZ * dirZ);
+    if (len <= 0.0f) return false;
+    dirX /= len; dirY /= len; dirZ /= len;
+
+    // Part of the ray inside the height range [0, cellHeight]
+    float slabIn = 0.0f, slabOut = maxDistance;
+    if (dirY != 0.0f) {
+        float t0 = (0.0f - originY) / dirY;
+        float t1 = (cellHeight - originY) / dirY;
+        if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+        if (t0 > slabIn) slabIn = t0;
+        if (t1 < slabOut) slabOut = t1;
+    }
+    else if (originY < 0.0f || originY > cellHeight) {
+        return false;
+    }
+    if (slabIn > slabOut) return false;
+
+    const CollisionGrid& grid = g_collisionGrid;
+    GridWalk walk(grid, originX, originZ, dirX, dirZ);
+    while (walk.enter <= slabOut) {
+        float exit = walk.exit();
+        if (exit >= slabIn && grid.get(walk.x, walk.z)) {
+            float t = walk.enter > slabIn ? walk.enter : slabIn;
+            fillHit(walk, originX, originY, originZ, dirX, dirY, dirZ, t, out);
+            if (t > walk.enter) out.normalX = out.normalZ = 0.0f; // Came in from above or below
+            return true;
+        }
+        if (exit >= NO_HIT) break; // Vertical ray: only one cell
+        walk.step();
+    }
+    return false;
+}
+
+void raycastGridBatch(const float* originX, const float* originZ, const float* dirX, const float* dirZ,
+    int count, float maxDistance, float* outDistance) {
+    GridRayHit hit;
+    for (int i = 0; i < count; ++i) {
+        outDistance[i] = raycastGrid(originX[i], originZ[i], dirX[i], dirZ[i], maxDistance, hit) &&
+            hit.distance < maxDistance ? hit.distance : maxDistance;
+    }
+}
+
+bool hasLineOfSight(float fromX, float fromZ, float toX, float toZ) {
+    float dx = toX - fromX, dz = toZ - fromZ;
+    float dist = sqrtf(dx * dx + dz * dz);
+    if (dist <= 0.0f) return !g_collisionGrid.isWorldBlocked(fromX, fromZ);
+
+    GridRayHit hit;
+    return !raycastGrid(fromX, fromZ, dx, dz, dist, hit) || hit.distance > dist;
+}
+
+// ================================================================
+// Boxes
+// ================================================================
+
+bool rayIntersectsBox(float originX, float originY, float originZ, float dirX, float dirY, float dirZ,
+    float minX, float minY, float minZ, float maxX, float maxY, float maxZ,
+    float maxDistance, float& outDistance) {
+    float len = sqrtf(dirX * dirX + dirY * dirY + dirZ * dirZ);
+    if (len <= 0.0f) return false;
+
+    const float o[3] = { originX, originY, originZ };
+    const float d[3] = { dirX / len, dirY / len, dirZ / len };
+    const float lo[3] = { minX, minY, minZ };
+    const float hi[3] = { maxX, maxY, maxZ };
+
+    float tIn = 0.0f, tOut = maxDistance;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (d[axis] == 0.0f) {
+            if (o[axis] < lo[axis] || o[axis] > hi[axis]) return false;
+            continue;
+        }
+        float t0 = (lo[axis] - o[axis]) / d[axis];
+        float t1 = (hi[axis] - o[axis]) / d[axis];
+        if (t0 > t1) { float tmp = t0; t0 = t1; t1 = tmp; }
+        if (t0 > tIn) tIn = t0;
+        if (t1 < tOut) tOut = t1;
+        if (tIn > tOut) return false;
+    }
+    outDistance = tIn;
+    return true;
+}
+
+bool isRayUnobstructed(float originX, float originY, float originZ, float dirX, float dirY, float dirZ,
+    float distance, float cellHeight, float targetMinX, float targetMinZ, float targetMaxX, float targetMaxZ) {
+    GridRayHit hit;
+    if (!raycastGrid3D(originX, originY, originZ, dirX, dirY, dirZ, distance, cellHeight, hit)) return true;
+    if (hit.distance > distance) return true;
+
+    // The target's own cells (e.g. a closed door) do not hide it
+    const CollisionGrid& grid = g_collisionGrid;
+    const float cell = grid.getCellSize();
+    float cellMinX = grid.getOriginX() + hit.cellX * cell;
+    float cellMinZ = grid.getOriginZ() + hit.cellZ * cell;
+    return cellMinX < targetMaxX && cellMinX + cell > targetMinX &&
+           cellMinZ < targetMaxZ && cellMinZ + cell > targetMinZ;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// ================================================================
+// Raycast
+//
+// Ray queries against the collision grid (voxel traversal, Amanatides &
+// Woo): the ray visits exactly the cells it passes through, in order, so
+// a query costs O(cells crossed) and stops at the first blocked cell.
+//
+//  - 2D rays run on the floor plane.
+//  - 3D rays treat every blocked cell as a column from the floor up to a
+//    given height, so a ray can pass over low obstacles or hit the floor.
+//
+// Also ray vs. axis-aligned box, for picking objects the grid does not
+// know about (books) or knows only as cells (doors).
+// ================================================================
+
+struct GridRayHit {
+    bool hit;
+    float distance;          // Along the normalized ray direction
+    int cellX, cellZ;        // Blocked cell that was hit
+    float x, y, z;           // Hit point (y is 0 for 2D rays)
+    float normalX, normalZ;  // Side of the cell that was entered (0, 0 if the ray starts inside it)
+};
+
+/**
+ * @brief Casts a ray on the floor plane until it enters a blocked cell.
+ * @param dirX, dirZ Direction (any length but zero).
+ * @param maxDistance Cells further than this are not visited.
+ */
+bool raycastGrid(float originX, float originZ, float dirX, float dirZ, float maxDistance, GridRayHit& out);
+
+/**
+ * @brief 3D version: blocked cells are solid from y = 0 up to cellHeight.
+ * A ray that leaves that height range (e.g. hits the floor) stops without a hit.
+ */
+bool raycastGrid3D(float originX, float originY, float originZ, float dirX, float dirY, float dirZ,
+    float maxDistance, float cellHeight, GridRayHit& out);
+
+/**
+ * @brief Many 2D rays at once (lights, AI sight checks).
+ * @param outDistance Receives the hit distance of each ray, or maxDistance if nothing was hit.
+ */
+void raycastGridBatch(const float* originX, const float* originZ, const float* dirX, const float* dirZ,
+    int count, float maxDistance, float* outDistance);
+
+/**
+ * @brief True if no blocked cell lies between two points on the floor plane.
+ */
+bool hasLineOfSight(float fromX, float fromZ, float toX, float toZ);
+
+/**
+ * @brief Ray vs. axis-aligned box (slab test).
+ * @param outDistance Entry distance (0 if the ray starts inside).
+ * @return False if the box is missed or further than maxDistance.
+ */
+bool rayIntersectsBox(float originX, float originY, float originZ, float dirX, float dirY, float dirZ,
+    float minX, float minY, float minZ, float maxX, float maxY, float maxZ,
+    float maxDistance, float& outDistance);
+
+/**
+ * @brief True if a 3D ray reaches 'distance' without hitting a blocked cell,
+ * ignoring cells that overlap the target's floor rectangle (its own cells).
+ */
+bool isRayUnobstructed(float originX, float originY, float originZ, float dirX, float dirY, float dirZ,
+    float distance, float cellHeight, float targetMinX, float targetMinZ, float targetMaxX, float targetMaxZ);
@@ -0,0 +1,697 @@
+// RigidBodies.cpp : Pushable boxes on the floor plane (sequential impulse solver).
+//
+#include "pch.h" // Must be first
+#include "RigidBodies.h"
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+RigidBodyWorld g_rigidBodies;
+
+namespace {
+
+const int BODY_STATIC = -1;
+const int BODY_PUSHER = -2;
+
+const float SKIN = 0.02f;              // Contacts are made this far before touching
+const float SLOP = 0.005f;             // Overlap left alone (keeps contacts stable)
+const float BAUMGARTE = 0.2f;          // Share of the overlap removed per step
+const int SOLVER_ITERATIONS = 8;
+const float FRICTION = 0.4f;           // Between bodies and against walls
+const float PUSHER_FRICTION = 0.2f;
+const float FLOOR_DECEL = 3.0f;        // Units / s^2 lost sliding on the floor
+const float FLOOR_ANGULAR_DECEL = 6.0f;
+const float SLEEP_SPEED = 0.02f;
+const float SLEEP_TIME = 0.5f;
+
+inline float cross(float ax, float az, float bx, float bz) { return ax * bz - az * bx; }
+
+// Extent of a box along a unit axis
+inline float extentAlong(const RigidBodyWorld::Obb& b, float nx, float nz) {
+    return b.hx * fabsf(b.ux * nx + b.uz * nz) + b.hz * fabsf(-b.uz * nx + b.ux * nz);
+}
+
+/**
+ * Box against box. Returns up to two contact points (outXZ) with their
+ * separations and the normal from A to B, or 0 if the boxes are further
+ * apart than 'skin'.
+ */
+int collideObbs(const RigidBodyWorld::Obb& A, const RigidBodyWorld::Obb& B, float skin,
+    float outXZ[4], float outSeparation[2], float& outNX, float& outNZ) {
+    float dx = B.cx - A.cx, dz = B.cz - A.cz;
+    const RigidBodyWorld::Obb* boxes[2] = { &A, &B };
+
+    // Separating axis with the largest separation (the faces of A win ties)
+    int bestBox = -1, bestAxis = 0;
+    float bestSep = -1e30f;
+    for (int k = 0; k < 4; ++k) {
+        const RigidBodyWorld::Obb& o = *boxes[k / 2];
+        float nx = (k & 1) ? -o.uz : o.ux;
+        float nz = (k & 1) ? o.ux : o.uz;
+        float sep = fabsf(dx * nx + dz * nz) - extentAlong(A, nx, nz) - extentAlong(B, nx, nz);
+        if (sep > skin) return 0;
+        float tolerance = k >= 2 ? 0.001f : 0.0f;
+        if (sep > bestSep + tolerance) {
+            bestSep = sep;
+            bestBox = k / 2;
+            bestAxis = k & 1;
+        }
+    }
+
+    // Reference face on that box, normal pointing at the other box
+    const RigidBodyWorld::Obb& ref = *boxes[bestBox];
+    const RigidBodyWorld::Obb& inc = *boxes[1 - bestBox];
+    float nx = bestAxis ? -ref.uz : ref.ux;
+    float nz = bestAxis ? ref.ux : ref.uz;
+    float toIncX = inc.cx - ref.cx, toIncZ = inc.cz - ref.cz;
+    if (toIncX * nx + toIncZ * nz < 0.0f) { nx = -nx; nz = -nz; }
+    float refHalfN = bestAxis ? ref.hz : ref.hx;
+    float refHalfT = bestAxis ? ref.hx : ref.hz;
+    float faceX = ref.cx + nx * refHalfN, faceZ = ref.cz + nz * refHalfN;
+    float tx = -nz, tz = nx;
+
+    // Incident edge: the face of the other box most against the normal
+    float du = inc.ux * nx + inc.uz * nz;
+    float dv = -inc.uz * nx + inc.ux * nz;
+    float inX, inZ, edgeX, edgeZ, incHalfN, incHalfT;
+    if (fabsf(du) > fabsf(dv)) {
+        float s = du > 0.0f ? -1.0f : 1.0f;
+        inX = inc.ux * s; inZ = inc.uz * s;
+        edgeX = -inc.uz; edgeZ = inc.ux;
+        incHalfN = inc.hx; incHalfT = inc.hz;
+    }
+    else {
+        float s = dv > 0.0f ? -1.0f : 1.0f;
+        inX = -inc.uz * s; inZ = inc.ux * s;
+        edgeX = inc.ux; edgeZ = inc.uz;
+        incHalfN = inc.hz; incHalfT = inc.hx;
+    }
+    float ex = inc.cx + inX * incHalfN, ez = inc.cz + inZ * incHalfN;
+    float p[2][2] = {
+        { ex + edgeX * incHalfT, ez + edgeZ * incHalfT },
+        { ex - edgeX * incHalfT, ez - edgeZ * incHalfT },
+    };
+
+    // Clip the edge to the sides of the reference face
+    float center = faceX * tx + faceZ * tz;
+    float a0 = p[0][0] * tx + p[0][1] * tz - center;
+    float a1 = p[1][0] * tx + p[1][1] * tz - center;
+    float lo = std::max(std::min(a0, a1), -refHalfT);
+    float hi = std::min(std::max(a0, a1), refHalfT);
+    if (lo > hi) return 0;
+    float span = a1 - a0;
+    float clipped[2][2];
+    for (int i = 0; i < 2; ++i) {
+        float a = i == 0 ? lo : hi;
+        float t = fabsf(span) > 1e-6f ? (a - a0) / span : 0.0f;
+        clipped[i][0] = p[0][0] + (p[1][0] - p[0][0]) * t;
+        clipped[i][1] = p[0][1] + (p[1][1] - p[0][1]) * t;
+    }
+
+    int count = 0;
+    for (int i = 0; i < 2; ++i) {
+        if (i == 1 && hi - lo < 1e-5f) break; // Corner on face: one point
+        float sep = (clipped[i][0] - faceX) * nx + (clipped[i][1] - faceZ) * nz;
+        if (sep > skin) continue;
+        outXZ[count * 2] = clipped[i][0];
+        outXZ[count * 2 + 1] = clipped[i][1];
+        outSeparation[count] = sep;
+        count++;
+    }
+    if (bestBox == 1) { nx = -nx; nz = -nz; } // Normal from A to B
+    outNX = nx;
+    outNZ = nz;
+    return count;
+}
+
+// Closest point of a box to (x, z); returns false if (x, z) is inside
+bool closestOnObb(const RigidBodyWorld::Obb& b, float x, float z, float& outX, float& outZ) {
+    float rx = x - b.cx, rz = z - b.cz;
+    float lx = rx * b.ux + rz * b.uz;
+    float lz = -rx * b.uz + rz * b.ux;
+    bool inside = fabsf(lx) < b.hx && fabsf(lz) < b.hz;
+    if (inside) {
+        // Nearest face
+        if (b.hx - fabsf(lx) < b.hz - fabsf(lz)) lx = lx < 0.0f ? -b.hx : b.hx;
+        else lz = lz < 0.0f ? -b.hz : b.hz;
+    }
+    else {
+        lx = std::max(-b.hx, std::min(b.hx, lx));
+        lz = std::max(-b.hz, std::min(b.hz, lz));
+    }
+    outX = b.cx + lx * b.ux - lz * b.uz;
+    outZ = b.cz + lx * b.uz + lz * b.ux;
+    return !inside;
+}
+
+} // namespace
+
+// ================================================================
+// Bodies
+// ================================================================
+
+RigidBodyWorld::RigidBodyWorld()
+    : m_hasPusher(false), m_pusherX(0.0f), m_pusherZ(0.0f), m_pusherRadius(0.0f),
+    m_pusherVX(0.0f), m_pusherVZ(0.0f), m_awake(0), m_grid(nullptr)
+{
+}
+
+int RigidBodyWorld::addBox(float x, float z, float rotationDeg, float halfWidth, float halfDepth, float mass, const void* owner) {
+    Body b;
+    b.x = b.prevX = x;
+    b.z = b.prevZ = z;
+    b.angle = b.prevAngle = -rotationDeg * (float)M_PI / 180.0f;
+    b.vx = b.vz = b.w = 0.0f;
+    b.hx = halfWidth;
+    b.hz = halfDepth;
+    b.invMass = mass > 0.0f ? 1.0f / mass : 0.0f;
+    float inertia = mass * (halfWidth * halfWidth + halfDepth * halfDepth) / 3.0f;
+    b.invInertia = inertia > 0.0f ? 1.0f / inertia : 0.0f;
+    b.restTime = SLEEP_TIME;
+    b.awake = false;
+    b.active = true;
+    b.enabled = true;
+    b.owner = owner;
+    updateBounds(b);
+
+    int index = (int)m_bodies.size();
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+        m_bodies[index] = b;
+    }
+    else {
+        m_bodies.push_back(b);
+    }
+    m_order.push_back(index);
+    return index;
+}
+
+void RigidBodyWorld::removeBodies(const void* owner) {
+    // Free the slots so the other bodies keep their indices
+    for (int i = 0; i < (int)m_bodies.size(); ++i) {
+        Body& b = m_bodies[i];
+        if (!b.active || b.owner != owner) continue;
+        b.active = false;
+        b.awake = false;
+        b.owner = nullptr;
+        b.cells.clear();
+        m_free.push_back(i);
+    }
+    m_order.erase(std::remove_if(m_order.begin(), m_order.end(),
+        [this](int i) { return !m_bodies[i].active; }), m_order.end());
+    m_contacts.clear();
+}
+
+void RigidBodyWorld::setOwnerEnabled(const void* owner, bool enabled) {
+    for (int i = 0; i < (int)m_bodies.size(); ++i) {
+        Body& b = m_bodies[i];
+        if (!b.active || b.owner != owner || b.enabled == enabled) continue;
+        b.enabled = enabled;
+        b.awake = false;
+        b.vx = b.vz = b.w = 0.0f;
+        b.cells.clear();
+        if (enabled) m_order.push_back(i);
+    }
+    m_order.erase(std::remove_if(m_order.begin(), m_order.end(),
+        [this](int i) { return !m_bodies[i].enabled; }), m_order.end());
+    m_contacts.clear();
+}
+
+void RigidBodyWorld::clear() {
+    m_bodies.clear();
+    m_order.clear();
+    m_free.clear();
+    m_contacts.clear();
+}
+
+void RigidBodyWorld::getPose(int body, float alpha, float& x, float& z, float& rotationDeg) const {
+    const Body& b = m_bodies[body];
+    x = b.prevX + (b.x - b.prevX) * alpha;
+    z = b.prevZ + (b.z - b.prevZ) * alpha;
+    float angle = b.prevAngle + (b.angle - b.prevAngle) * alpha;
+    rotationDeg = -angle * 180.0f / (float)M_PI;
+}
+
+void RigidBodyWorld::setPusher(float x, float z, float radius, float vx, float vz) {
+    m_hasPusher = true;
+    m_pusherX = x;
+    m_pusherZ = z;
+    m_pusherRadius = radius;
+    m_pusherVX = vx;
+    m_pusherVZ = vz;
+}
+
+bool RigidBodyWorld::separateCircle(float& x, float& z, float radius) const {
+    bool moved = false;
+    for (const Body& b : m_bodies) {
+        if (!b.active || !b.enabled) continue;
+        if (x + radius < b.minX || x - radius > b.maxX || z + radius < b.minZ || z - radius > b.maxZ) continue;
+        Obb box = boxOf(b);
+        float qx, qz;
+        bool outside = closestOnObb(box, x, z, qx, qz);
+        float dx = x - qx, dz = z - qz;
+        float d = sqrtf(dx * dx + dz * dz);
+        if (outside && d >= radius) continue;
+        if (d < 1e-6f) continue;
+        float s = outside ? 1.0f : -1.0f; // Inside: the face point is ahead, not behind
+        x = qx + s * dx / d * radius;
+        z = qz + s * dz / d * radius;
+        moved = true;
+    }
+    return moved;
+}
+
+RigidBodyWorld::Obb RigidBodyWorld::boxOf(const Body& b) const {
+    Obb o = { b.x, b.z, cosf(b.angle), sinf(b.angle), b.hx, b.hz };
+    return o;
+}
+
+void RigidBodyWorld::updateBounds(Body& b) const {
+    float c = fabsf(cosf(b.angle)), s = fabsf(sinf(b.angle));
+    float ex = c * b.hx + s * b.hz;
+    float ez = s * b.hx + c * b.hz;
+    b.minX = b.x - ex; b.maxX = b.x + ex;
+    b.minZ = b.z - ez; b.maxZ = b.z + ez;
+}
+
+// ================================================================
+// Step
+// ================================================================
+
+void RigidBodyWorld::step(float dt, const CollisionWorld& statics, CollisionGrid* grid) {
+    if (dt <= 0.0f) return;
+    for (Body& b : m_bodies) {
+        b.prevX = b.x;
+        b.prevZ = b.z;
+        b.prevAngle = b.angle;
+    }
+
+    // Floor friction: sliding bodies slow down at a constant rate
+    for (Body& b : m_bodies) {
+        if (!b.awake) continue;
+        float speed = sqrtf(b.vx * b.vx + b.vz * b.vz);
+        float keep = speed > 0.0f ? std::max(0.0f, speed - FLOOR_DECEL * dt) / speed : 0.0f;
+        b.vx *= keep;
+        b.vz *= keep;
+        float spin = fabsf(b.w);
+        b.w = spin > FLOOR_ANGULAR_DECEL * dt ? b.w - (b.w > 0.0f ? 1.0f : -1.0f) * FLOOR_ANGULAR_DECEL * dt : 0.0f;
+    }
+
+    findContacts(statics);
+    solve(dt);
+    integrate(dt);
+    m_hasPusher = false;
+
+    // Re-stamp the bodies whose cells changed
+    if (grid && isStamped(*grid)) {
+        for (Body& b : m_bodies) {
+            bool moved = b.x != b.prevX || b.z != b.prevZ || b.angle != b.prevAngle;
+            if (b.active && moved) stamp(b, *grid);
+        }
+    }
+}
+
+void RigidBodyWorld::findContacts(const CollisionWorld& statics) {
+    m_contacts.clear();
+
+    // Sweep and prune on X: the order barely changes between steps
+    for (size_t i = 1; i < m_order.size(); ++i) {
+        int body = m_order[i];
+        float key = m_bodies[body].minX;
+        size_t j = i;
+        while (j > 0 && m_bodies[m_order[j - 1]].minX > key) {
+            m_order[j] = m_order[j - 1];
+            --j;
+        }
+        m_order[j] = body;
+    }
+    for (size_t i = 0; i < m_order.size(); ++i) {
+        int a = m_order[i];
+        for (size_t j = i + 1; j < m_order.size(); ++j) {
+            int b = m_order[j];
+            const Body& A = m_bodies[a];
+            const Body& B = m_bodies[b];
+            if (B.minX > A.maxX + SKIN) break;
+            if (!A.awake && !B.awake) continue;
+            if (B.minZ > A.maxZ + SKIN || B.maxZ < A.minZ - SKIN) continue;
+            addBoxContacts(a, b, boxOf(A), boxOf(B));
+        }
+    }
+
+    // Walls and furniture around moving bodies
+    for (int a = 0; a < (int)m_bodies.size(); ++a) {
+        const Body& A = m_bodies[a];
+        if (!A.awake) continue;
+        m_statics.clear();
+        statics.findBoxes(A.minX - SKIN, A.minZ - SKIN, A.maxX + SKIN, A.maxZ + SKIN, m_statics);
+        for (const ColliderShape& s : m_statics) {
+            Obb box = { s.cx, s.cz, s.ux, s.uz, s.hx, s.hz };
+            addBoxContacts(a, BODY_STATIC, boxOf(A), box);
+        }
+    }
+
+    // The player
+    if (m_hasPusher) {
+        float r = m_pusherRadius + SKIN;
+        for (int a = 0; a < (int)m_bodies.size(); ++a) {
+            Body& A = m_bodies[a];
+            if (!A.active || !A.enabled) continue;
+            if (m_pusherX + r < A.minX || m_pusherX - r > A.maxX || m_pusherZ + r < A.minZ || m_pusherZ - r > A.maxZ) continue;
+            Obb box = boxOf(A);
+            float qx, qz;
+            bool outside = closestOnObb(box, m_pusherX, m_pusherZ, qx, qz);
+            float dx = m_pusherX - qx, dz = m_pusherZ - qz;
+            float d = sqrtf(dx * dx + dz * dz);
+            if (d < 1e-6f) continue;
+            float sep = outside ? d - m_pusherRadius : -d - m_pusherRadius;
+            if (sep > SKIN) continue;
+            float s = outside ? 1.0f : -1.0f;
+
+            Contact c;
+            memset(&c, 0, sizeof(c));
+            c.a = a;
+            c.b = BODY_PUSHER;
+            c.px = qx;
+            c.pz = qz;
+            c.nx = s * dx / d;
+            c.nz = s * dz / d;
+            c.separation = sep;
+            m_contacts.push_back(c);
+            if (!A.awake) { A.awake = true; A.restTime = 0.0f; }
+        }
+    }
+}
+
+void RigidBodyWorld::addBoxContacts(int a, int b, const Obb& boxA, const Obb& boxB) {
+    float points[4], separation[2], nx, nz;
+    int count = collideObbs(boxA, boxB, SKIN, points, separation, nx, nz);
+    if (count == 0) return;
+
+    // Touching a moving body wakes a sleeping one
+    if (b >= 0) {
+        Body& A = m_bodies[a];
+        Body& B = m_bodies[b];
+        if (!A.awake) { A.awake = true; A.restTime = 0.0f; }
+        if (!B.awake) { B.awake = true; B.restTime = 0.0f; }
+    }
+    for (int i = 0; i < count; ++i) {
+        Contact c;
+        memset(&c, 0, sizeof(c));
+        c.a = a;
+        c.b = b;
+        c.px = points[i * 2];
+        c.pz = points[i * 2 + 1];
+        c.nx = nx;
+        c.nz = nz;
+        c.separation = separation[i];
+        m_contacts.push_back(c);
+    }
+}
+
+void RigidBodyWorld::solve(float dt) {
+    // Effective masses and velocity targets
+    for (Contact& c : m_contacts) {
+        const Body& A = m_bodies[c.a];
+        float raX = c.px - A.x, raZ = c.pz - A.z;
+        float invMassB = 0.0f, invInertiaB = 0.0f, rbX = 0.0f, rbZ = 0.0f;
+        if (c.b >= 0) {
+            const Body& B = m_bodies[c.b];
+            invMassB = B.invMass;
+            invInertiaB = B.invInertia;
+            rbX = c.px - B.x;
+            rbZ = c.pz - B.z;
+        }
+        float tx = -c.nz, tz = c.nx;
+        float rnA = cross(raX, raZ, c.nx, c.nz), rnB = cross(rbX, rbZ, c.nx, c.nz);
+        float rtA = cross(raX, raZ, tx, tz), rtB = cross(rbX, rbZ, tx, tz);
+        float kNormal = A.invMass + invMassB + A.invInertia * rnA * rnA + invInertiaB * rnB * rnB;
+        float kTangent = A.invMass + invMassB + A.invInertia * rtA * rtA + invInertiaB * rtB * rtB;
+        c.massNormal = kNormal > 0.0f ? 1.0f / kNormal : 0.0f;
+        c.massTangent = kTangent > 0.0f ? 1.0f / kTangent : 0.0f;
+
+        // Apart: may close the gap this step. Overlapping: pushed apart a little per step.
+        if (c.separation > 0.0f) c.bias = -c.separation / dt;
+        else c.bias = BAUMGARTE / dt * std::max(0.0f, -c.separation - SLOP);
+    }
+
+    for (int it = 0; it < SOLVER_ITERATIONS; ++it) {
+        for (Contact& c : m_contacts) {
+            Body& A = m_bodies[c.a];
+            Body* B = c.b >= 0 ? &m_bodies[c.b] : nullptr;
+            float raX = c.px - A.x, raZ = c.pz - A.z;
+            float rbX = B ? c.px - B->x : 0.0f, rbZ = B ? c.pz - B->z : 0.0f;
+
+            // Relative velocity of B against A at the contact point
+            float vaX = A.vx - A.w * raZ, vaZ = A.vz + A.w * raX;
+            float vbX = 0.0f, vbZ = 0.0f;
+            if (B) { vbX = B->vx - B->w * rbZ; vbZ = B->vz + B->w * rbX; }
+            else if (c.b == BODY_PUSHER) { vbX = m_pusherVX; vbZ = m_pusherVZ; }
+            float relX = vbX - vaX, relZ = vbZ - vaZ;
+
+            // Normal: accumulated impulse never pulls
+            float vn = relX * c.nx + relZ * c.nz;
+            float lambda = c.massNormal * (c.bias - vn);
+            float old = c.impulseNormal;
+            c.impulseNormal = std::max(old + lambda, 0.0f);
+            lambda = c.impulseNormal - old;
+
+            // Friction: bounded by the normal impulse
+            float tx = -c.nz, tz = c.nx;
+            float vt = relX * tx + relZ * tz;
+            float lambdaT = -c.massTangent * vt;
+            float limit = (c.b == BODY_PUSHER ? PUSHER_FRICTION : FRICTION) * c.impulseNormal;
+            float oldT = c.impulseTangent;
+            c.impulseTangent = std::max(-limit, std::min(limit, oldT + lambdaT));
+            lambdaT = c.impulseTangent - oldT;
+
+            float px = c.nx * lambda + tx * lambdaT, pz = c.nz * lambda + tz * lambdaT;
+            A.vx -= px * A.invMass;
+            A.vz -= pz * A.invMass;
+            A.w -= A.invInertia * cross(raX, raZ, px, pz);
+            if (B) {
+                B->vx += px * B->invMass;
+                B->vz += pz * B->invMass;
+                B->w += B->invInertia * cross(rbX, rbZ, px, pz);
+            }
+        }
+    }
+}
+
+void RigidBodyWorld::integrate(float dt) {
+    m_awake = 0;
+    for (Body& b : m_bodies) {
+        if (!b.awake) continue;
+        b.x += b.vx * dt;
+        b.z += b.vz * dt;
+        b.angle += b.w * dt;
+        updateBounds(b);
+
+        // Sleep after resting for a while
+        bool still = b.vx * b.vx + b.vz * b.vz < SLEEP_SPEED * SLEEP_SPEED && fabsf(b.w) < SLEEP_SPEED;
+        b.restTime = still ? b.restTime + dt : 0.0f;
+        if (b.restTime > SLEEP_TIME) {
+            b.awake = false;
+            b.vx = b.vz = b.w = 0.0f;
+        }
+        else {
+            m_awake++;
+        }
+    }
+}
+
+// ================================================================
+// Collision grid
+// ================================================================
+
+void RigidBodyWorld::coveredCells(const Body& b, const CollisionGrid& grid, std::vector<int>& out) const {
+    out.clear();
+    int x0, z0, x1, z1;
+    grid.worldToCell(b.minX, b.minZ, x0, z0);
+    grid.worldToCell(b.maxX, b.maxZ, x1, z1);
+    x0 = std::max(x0, 0); z0 = std::max(z0, 0);
+    x1 = std::min(x1, grid.getWidth() - 1); z1 = std::min(z1, grid.getHeight() - 1);
+
+    // Cells whose interior overlaps the box (separating axes: cell sides, box sides)
+    Obb box = boxOf(b);
+    float half = grid.getCellSize() * 0.5f;
+    float ex = (b.maxX - b.minX) * 0.5f, ez = (b.maxZ - b.minZ) * 0.5f;
+    float cellU = half * (fabsf(box.ux) + fabsf(box.uz));
+    const float EPS = 1e-3f;
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            float cx, cz;
+            grid.cellCenter(x, z, cx, cz);
+            float dx = cx - box.cx, dz = cz - box.cz;
+            if (fabsf(dx) >= half + ex - EPS || fabsf(dz) >= half + ez - EPS) continue;
+            if (fabsf(dx * box.ux + dz * box.uz) >= box.hx + cellU - EPS) continue;
+            if (fabsf(-dx * box.uz + dz * box.ux) >= box.hz + cellU - EPS) continue;
+            out.push_back(z * grid.getWidth() + x);
+        }
+    }
+}
+
+void RigidBodyWorld::stamp(Body& b, CollisionGrid& grid) {
+    coveredCells(b, grid, m_scratchCells);
+    if (m_scratchCells == b.cells) return;
+
+    int w = grid.getWidth();
+    int x0 = w, z0 = grid.getHeight(), x1 = -1, z1 = -1;
+    auto grow = [&](int c) {
+        int x = c % w, z = c / w;
+        x0 = std::min(x0, x); x1 = std::max(x1, x);
+        z0 = std::min(z0, z); z1 = std::max(z1, z);
+    };
+    for (int c : b.cells) {
+        grow(c);
+        if (--m_coverage[c] == 0) grid.set(c % w, c / w, m_wasBlocked[c] != 0);
+    }
+    for (int c : m_scratchCells) {
+        grow(c);
+        if (m_coverage[c]++ == 0) {
+            m_wasBlocked[c] = grid.get(c % w, c / w) ? 1 : 0;
+            grid.set(c % w, c / w, true);
+        }
+    }
+    b.cells.swap(m_scratchCells);
+    if (x1 >= 0) grid.notifyChanged(x0, z0, x1, z1);
+}
+
+bool RigidBodyWorld::isStamped(const CollisionGrid& grid) const {
+    return &grid == m_grid && m_coverage.size() == (size_t)grid.getWidth() * grid.getHeight();
+}
+
+template <typename Fn>
+void RigidBodyWorld::forEachCoveredCell(const CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ, Fn fn) {
+    if (!isStamped(grid) || !grid.isNotifyEnabled()) return;
+    int x0, z0, x1, z1;
+    grid.worldToCell(minX, minZ, x0, z0);
+    grid.worldToCell(maxX, maxZ, x1, z1);
+    x0 = std::max(x0, 0); z0 = std::max(z0, 0);
+    x1 = std::min(x1, grid.getWidth() - 1); z1 = std::min(z1, grid.getHeight() - 1);
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) {
+            int c = z * grid.getWidth() + x;
+            if (m_coverage[c] > 0) fn(x, z, c);
+        }
+    }
+}
+
+void RigidBodyWorld::liftArea(CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ) {
+    forEachCoveredCell(grid, minX, minZ, maxX, maxZ, [&](int x, int z, int c) {
+        grid.set(x, z, m_wasBlocked[c] != 0);
+    });
+}
+
+void RigidBodyWorld::restampArea(CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ) {
+    forEachCoveredCell(grid, minX, minZ, maxX, maxZ, [&](int x, int z, int c) {
+        m_wasBlocked[c] = grid.get(x, z) ? 1 : 0;
+        grid.set(x, z, true);
+    });
+}
+
+void RigidBodyWorld::applyCollision(CollisionGrid& grid) {
+    m_grid = &grid;
+    size_t cells = (size_t)grid.getWidth() * grid.getHeight();
+    m_coverage.assign(cells, 0);
+    m_wasBlocked.assign(cells, 0);
+    for (Body& b : m_bodies) {
+        b.cells.clear();
+        if (b.active && b.enabled) stamp(b, grid);
+    }
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+void RigidBodyWorld::runBenchmark(int bodies) {
+    typedef std::chrono::steady_clock Clock;
+    if (bodies < 1) bodies = 1;
+
+    // A square room just big enough to hold the crates a third full
+    int side = 10;
+    while (side * side < bodies * 3) side += 2;
+    float half = side / 2.0f;
+    CollisionWorld walls;
+    FootprintBox sideWall = { 0.5f, half + 1.0f, 0.0f, 0.0f };
+    FootprintBox endWall = { half + 1.0f, 0.5f, 0.0f, 0.0f };
+    walls.addBox(-half - 0.5f, 0.0f, 0.0f, sideWall, COLLIDER_BOUNDARY);
+    walls.addBox(half + 0.5f, 0.0f, 0.0f, sideWall, COLLIDER_BOUNDARY);
+    walls.addBox(0.0f, -half - 0.5f, 0.0f, endWall, COLLIDER_BOUNDARY);
+    walls.addBox(0.0f, half + 0.5f, 0.0f, endWall, COLLIDER_BOUNDARY);
+    walls.build();
+
+    CollisionGrid grid(side, side, 1.0f, -half, -half);
+
+    // Crates on a loose lattice in the middle, slightly turned
+    RigidBodyWorld world;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> turn(-20.0f, 20.0f);
+    int perRow = (int)ceilf(sqrtf((float)bodies));
+    for (int i = 0; i < bodies; ++i) {
+        float x = (i % perRow - perRow / 2.0f) * 1.3f;
+        float z = (i / perRow - perRow / 2.0f) * 1.3f;
+        world.addBox(x, z, turn(rng), 0.5f, 0.5f, 10.0f, nullptr);
+    }
+    world.applyCollision(grid);
+    long long notifiedCells = 0;
+    grid.addChangeListener([&](int x0, int z0, int x1, int z1) {
+        notifiedCells += (long long)(x1 - x0 + 1) * (z1 - z0 + 1);
+    });
+
+    // A pusher walks back and forth across the room, one lane further each pass,
+    // starting at the first row of crates
+    const float dt = 1.0f / 120.0f;
+    const int steps = 120 * 20;
+    const float speed = 5.0f;
+    float firstRow = -perRow / 2.0f * 1.3f - 1.0f;
+    float px = -half + 1.0f, pz = firstRow, dir = 1.0f;
+    double totalMs = 0.0, worstMs = 0.0;
+    long long awake = 0, contacts = 0;
+    for (int s = 0; s < steps; ++s) {
+        float vx = speed * dir, vz = 0.0f;
+        px += vx * dt;
+        if (px > half - 1.0f || px < -half + 1.0f) {
+            dir = -dir;
+            pz += 1.5f;
+            if (pz > half - 1.0f) pz = firstRow;
+        }
+        world.separateCircle(px, pz, 0.5f);
+        world.setPusher(px, pz, 0.5f, vx, vz);
+
+        Clock::time_point t0 = Clock::now();
+        world.step(dt, walls, &grid);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+        awake += world.getAwakeCount();
+        contacts += world.getContactCount();
+    }
+
+    // Leftover overlap between crates and crates outside the room
+    float deepest = 0.0f;
+    int escaped = 0;
+    for (int i = 0; i < bodies; ++i) {
+        const Body& a = world.m_bodies[i];
+        if (fabsf(a.x) > half || fabsf(a.z) > half) escaped++;
+        for (int j = i + 1; j < bodies; ++j) {
+            float points[4], sep[2], nx, nz;
+            int n = collideObbs(world.boxOf(a), world.boxOf(world.m_bodies[j]), 0.0f, points, sep, nx, nz);
+            for (int k = 0; k < n; ++k) deepest = std::max(deepest, -sep[k]);
+        }
+    }
+
+    printf("RigidBodies benchmark (%d crates, %dx%d room, %d steps at 120 Hz):\n", bodies, side, side, steps);
+    printf("  Step: %.3f ms average, %.3f ms worst\n", totalMs / steps, worstMs);
+    printf("  %.1f bodies awake, %.1f contacts per step on average\n", (double)awake / steps, (double)contacts / steps);
+    printf("  Grid: %lld cells re-stamped and reported\n", notifiedCells);
+    printf("  Deepest overlap left: %.3f, crates outside the room: %d\n", deepest, escaped);
+}
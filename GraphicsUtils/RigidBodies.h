@@ -0,0 +1,170 @@
+#pragma once
+#include <vector>
+#include "CollisionGrid.h"
+#include "CollisionWorld.h"
+
+// ================================================================
+// RigidBodies
+//
+// Boxes that slide on the floor (crates) and can be pushed around by the
+// player and by each other. Everything happens on the XZ plane: a body
+// has a position, a rotation about Y and linear and angular velocity.
+//
+// A step:
+//  - broadphase: sweep and prune on X (the order is kept from the last
+//    step and fixed with an insertion sort, so it is nearly linear), and
+//    the static colliders around each moving body from the CollisionWorld
+//  - narrowphase: box against box by separating axes, clipping the
+//    incident edge against the reference face for up to two contact
+//    points; the player is a moving circle of infinite mass
+//  - a sequential impulse solver with friction and a little positional
+//    bias, then floor friction and integration
+// Bodies that stay still for a moment go to sleep and cost nothing until
+// something touches them.
+//
+// Bodies keep the collision grid up to date: each one blocks the cells it
+// covers, and when that set changes the cells are re-stamped and
+// notifyChanged() is sent, so paths and fields follow crates as they move.
+// The grid saved with the level never contains them.
+// ================================================================
+
+class RigidBodyWorld {
+public:
+    RigidBodyWorld();
+
+    /**
+     * @brief Adds a box at rest.
+     * @param rotationDeg Rotation like glRotatef(rotationDeg, 0, 1, 0).
+     * @param owner Module the body belongs to (for removeBodies).
+     * @return Body index, valid until the body is removed (slots are reused).
+     */
+    int addBox(float x, float z, float rotationDeg, float halfWidth, float halfDepth, float mass, const void* owner);
+
+    /**
+     * @brief Removes every body added by a module. The grid keeps their
+     * cells until it is rebuilt (see applyCollision).
+     */
+    void removeBodies(const void* owner);
+    void clear();
+
+    /**
+     * @brief Freezes the bodies of a module and takes them out of the
+     * simulation (e.g. crates on another floor), or puts them back.
+     * Like removeBodies, the grid keeps their cells until it is rebuilt.
+     */
+    void setOwnerEnabled(const void* owner, bool enabled);
+
+    int getBodyCount() const { return (int)(m_bodies.size() - m_free.size()); }
+
+    /**
+     * @brief Pose between the last two steps (alpha 0 = previous, 1 = latest).
+     */
+    void getPose(int body, float alpha, float& x, float& z, float& rotationDeg) const;
+
+    /**
+     * @brief The player, a circle moving at (vx, vz), for the next step.
+     */
+    void setPusher(float x, float z, float radius, float vx, float vz);
+
+    /**
+     * @brief Moves a circle out of every body it overlaps.
+     * @return True if it was moved.
+     */
+    bool separateCircle(float& x, float& z, float radius) const;
+
+    /**
+     * @brief Advances every awake body.
+     * @param statics Fixed colliders the bodies bump into.
+     * @param grid Grid to keep stamped (nullptr = none).
+     */
+    void step(float dt, const CollisionWorld& statics, CollisionGrid* grid);
+
+    /**
+     * @brief Stamps every body into a grid that was just rebuilt without them.
+     */
+    void applyCollision(CollisionGrid& grid);
+
+    /**
+     * @brief Brackets a static edit of the stamped grid (a door opening or
+     * closing) over the world area minX..maxZ. liftArea() puts back what is
+     * under the bodies there; restampArea() takes the edited cells as the
+     * new state under the bodies and blocks them again. Without this a body
+     * leaving the area would later restore the cells as they were before
+     * the edit. Both do nothing while the grid's notifications are off: a
+     * bulk rebuild is followed by applyCollision().
+     */
+    void liftArea(CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ);
+    void restampArea(CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ);
+
+    // Stats of the last step
+    int getAwakeCount() const { return m_awake; }
+    int getContactCount() const { return (int)m_contacts.size(); }
+
+    /**
+     * @brief Times a room full of crates being bulldozed by a pusher, printed to the console.
+     */
+    static void runBenchmark(int bodies);
+
+    // Oriented box on the floor: center, local X axis, half extents
+    struct Obb {
+        float cx, cz;
+        float ux, uz;
+        float hx, hz;
+    };
+
+private:
+    struct Body {
+        float x, z, angle;          // Angle counter-clockwise in (x, z), = -rotation
+        float vx, vz, w;
+        float hx, hz;
+        float invMass, invInertia;
+        float prevX, prevZ, prevAngle;
+        float minX, minZ, maxX, maxZ;
+        float restTime;             // Seconds spent nearly still
+        bool awake;
+        bool active;                // False for a free slot
+        bool enabled;               // False while its owner is switched off
+        const void* owner;
+        std::vector<int> cells;     // Grid cells stamped (z * width + x)
+    };
+
+    struct Contact {
+        int a, b;                   // b: body index, BODY_STATIC or BODY_PUSHER
+        float px, pz;               // Contact point
+        float nx, nz;               // Normal from a to b
+        float separation;           // Negative when overlapping
+        float massNormal, massTangent;
+        float bias;
+        float impulseNormal, impulseTangent;
+    };
+
+    Obb boxOf(const Body& b) const;
+    void updateBounds(Body& b) const;
+    void findContacts(const CollisionWorld& statics);
+    void addBoxContacts(int a, int b, const Obb& boxA, const Obb& boxB);
+    void solve(float dt);
+    void integrate(float dt);
+    void stamp(Body& b, CollisionGrid& grid);
+    void coveredCells(const Body& b, const CollisionGrid& grid, std::vector<int>& out) const;
+    bool isStamped(const CollisionGrid& grid) const;
+    template <typename Fn> void forEachCoveredCell(const CollisionGrid& grid, float minX, float minZ, float maxX, float maxZ, Fn fn);
+
+    std::vector<Body> m_bodies;
+    std::vector<int> m_order;       // Active bodies sorted by minX
+    std::vector<int> m_free;        // Slots of removed bodies
+    std::vector<Contact> m_contacts;
+    std::vector<ColliderShape> m_statics;
+    std::vector<int> m_scratchCells;
+
+    bool m_hasPusher;
+    float m_pusherX, m_pusherZ, m_pusherRadius, m_pusherVX, m_pusherVZ;
+    int m_awake;
+
+    // Grid stamping: bodies covering each cell, and whether the cell was
+    // blocked by something else before the first body covered it
+    const CollisionGrid* m_grid;
+    std::vector<unsigned char> m_coverage;
+    std::vector<unsigned char> m_wasBlocked;
+};
+
+extern RigidBodyWorld g_rigidBodies;
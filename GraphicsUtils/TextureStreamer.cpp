@@ -0,0 +1,560 @@
+// TextureStreamer.cpp : Distance-driven mip residency for SOIL2 textures.
+//
+#include "pch.h" // Must be first
+#include "TextureStreamer.h"
+#include "GpuMemory.h"
+#include "JobSystem.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+extern "C" {
+#include <image_DXT.h> // convert_image_to_DXT1 / DXT5 (part of SOIL2)
+}
+
+// --- GL 1.2+ / S3TC constants missing from the Windows GL 1.1 headers ---
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// glut.h undefines APIENTRY again on Windows
+#ifndef APIENTRY
+#ifdef _WIN32
+#define APIENTRY __stdcall
+#else
+#define APIENTRY
+#endif
+#endif
+
+typedef void (APIENTRY* CompressedTexImage2DProc)(GLenum target, GLint level, GLenum internalFormat,
+    GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid* data);
+static CompressedTexImage2DProc s_glCompressedTexImage2D = nullptr;
+
+// Smallest mip edge (in pixels) that always stays resident
+static const int MIN_RESIDENT_SIZE = 32;
+
+// SOIL2 reports errors through an unsynchronised global string, so decode
+// jobs load files one at a time (the mips and DXT encoding run side by side)
+static std::mutex s_soilMutex;
+
+TextureStreamer g_textureStreamer;
+
+// ================================================================
+// Helpers
+// ================================================================
+
+static int mipCountFor(int w, int h) {
+    int largest = (w > h) ? w : h;
+    int count = 1;
+    while (largest > 1) { largest >>= 1; ++count; }
+    return count;
+}
+
+static int mipSize(int size, int level) {
+    int s = size >> level;
+    return (s < 1) ? 1 : s;
+}
+
+// Finest level we are ever allowed to drop to (keeps a MIN_RESIDENT_SIZE fallback)
+static int coarsestLevelFor(int w, int h) {
+    int level = 0;
+    int count = mipCountFor(w, h);
+    while (level < count - 1 && (mipSize(w, level) > MIN_RESIDENT_SIZE || mipSize(h, level) > MIN_RESIDENT_SIZE)) {
+        ++level;
+    }
+    return level;
+}
+
+static size_t levelBytes(int w, int h, bool compressed, bool hasAlpha) {
+    if (compressed) {
+        size_t blocks = (size_t)((w + 3) / 4) * (size_t)((h + 3) / 4);
+        return blocks * (hasAlpha ? 16 : 8);
+    }
+    return (size_t)w * (size_t)h * 4;
+}
+
+// 2x2 box filter on RGBA8 data
+static void downsample(const StreamedMip& src, StreamedMip& dst) {
+    dst.width = (src.width > 1) ? src.width / 2 : 1;
+    dst.height = (src.height > 1) ? src.height / 2 : 1;
+    dst.data.resize((size_t)dst.width * dst.height * 4);
+
+    for (int y = 0; y < dst.height; ++y) {
+        int y0 = std::min(y * 2, src.height - 1);
+        int y1 = std::min(y * 2 + 1, src.height - 1);
+        for (int x = 0; x < dst.width; ++x) {
+            int x0 = std::min(x * 2, src.width - 1);
+            int x1 = std::min(x * 2 + 1, src.width - 1);
+            const unsigned char* a = &src.data[((size_t)y0 * src.width + x0) * 4];
+            const unsigned char* b = &src.data[((size_t)y0 * src.width + x1) * 4];
+            const unsigned char* c = &src.data[((size_t)y1 * src.width + x0) * 4];
+            const unsigned char* d = &src.data[((size_t)y1 * src.width + x1) * 4];
+            unsigned char* out = &dst.data[((size_t)y * dst.width + x) * 4];
+            for (int ch = 0; ch < 4; ++ch) {
+                out[ch] = (unsigned char)((a[ch] + b[ch] + c[ch] + d[ch] + 2) / 4);
+            }
+        }
+    }
+}
+
+// ================================================================
+// Construction
+// ================================================================
+
+TextureStreamer::TextureStreamer()
+    : m_budgetBytes(64 * 1024 * 1024), m_uploadBudgetBytes(4 * 1024 * 1024),
+    m_fullDetailDistance(6.0f), m_useDistance(30.0f), m_frame(0),
+    m_compressedUpload(false), m_capsQueried(false),
+    m_inFlight(0)
+{
+}
+
+TextureStreamer::~TextureStreamer() {
+    // Decode jobs are dropped when the job system stops before exit; GL
+    // objects are released with the context
+}
+
+// ================================================================
+// Public API (GL thread)
+// ================================================================
+
+// Adds a module to a texture's "A+B" owner list
+static void addOwner(std::string& owners, const char* owner) {
+    if (!owner || !*owner) return;
+    std::string padded = "+" + owners + "+";
+    if (padded.find(std::string("+") + owner + "+") != std::string::npos) return;
+    if (!owners.empty()) owners += "+";
+    owners += owner;
+}
+
+GLuint TextureStreamer::load(const char* path, const char* owner) {
+    if (!path) return 0;
+
+    auto it = m_pathIndex.find(path);
+    if (it != m_pathIndex.end()) {
+        StreamedTexture& shared = m_textures[it->second];
+        addOwner(shared.owner, owner);
+        trackMemory(shared);
+        return shared.id;
+    }
+
+    if (!m_capsQueried) {
+        if (SOIL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc")) {
+            s_glCompressedTexImage2D = (CompressedTexImage2DProc)SOIL_GL_GetProcAddress("glCompressedTexImage2DARB");
+        }
+        m_compressedUpload = (s_glCompressedTexImage2D != nullptr);
+        m_capsQueried = true;
+        printf("TextureStreamer: %s upload path\n", m_compressedUpload ? "DXT compressed" : "RGBA8");
+    }
+
+    StreamedTexture tex;
+    tex.path = path;
+    tex.id = 0;
+    addOwner(tex.owner, owner);
+    tex.width = tex.height = 0;
+    tex.mipCount = 0;
+    tex.hasAlpha = false;
+    tex.residentTop = -1;
+    tex.residentLevels = 0;
+    tex.pendingTop = -1;
+    tex.requestSerial = 0;
+    tex.desiredTop = 0;
+    tex.residentBytes = 0;
+    tex.residentFormat = GL_RGBA;
+    tex.failed = false;
+    tex.distance = 0.0f;
+    tex.lastUsedFrame = m_frame;
+
+    // Placeholder: 1x1 grey so the ID is valid before the first upload
+    const unsigned char grey[4] = { 128, 128, 128, 255 };
+    glGenTextures(1, &tex.id);
+    glBindTexture(GL_TEXTURE_2D, tex.id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_pathIndex[tex.path] = (int)m_textures.size();
+    m_textures.push_back(tex);
+    trackMemory(m_textures.back());
+
+    printf("TextureStreamer: registered '%s' (ID: %u)\n", path, tex.id);
+    return tex.id;
+}
+
+void TextureStreamer::addAnchor(GLuint id, float x, float z, float radius, const void* owner) {
+    StreamedTexture* tex = find(id);
+    if (!tex) return;
+    TextureAnchor a = { x, z, radius, owner };
+    tex->anchors.push_back(a);
+}
+
+void TextureStreamer::removeAnchors(const void* owner) {
+    for (auto& tex : m_textures) {
+        tex.anchors.erase(std::remove_if(tex.anchors.begin(), tex.anchors.end(),
+            [owner](const TextureAnchor& a) { return a.owner == owner; }),
+            tex.anchors.end());
+    }
+}
+
+const StreamedTexture* TextureStreamer::getTexture(int index) const {
+    if (index < 0 || index >= (int)m_textures.size()) return nullptr;
+    return &m_textures[index];
+}
+
+const StreamedTexture* TextureStreamer::findTexture(GLuint id) const {
+    for (const auto& tex : m_textures) {
+        if (tex.id == id) return &tex;
+    }
+    return nullptr;
+}
+
+StreamedTexture* TextureStreamer::find(GLuint id) {
+    for (auto& tex : m_textures) {
+        if (tex.id == id) return &tex;
+    }
+    return nullptr;
+}
+
+int TextureStreamer::coarsestTop(const StreamedTexture& tex) const {
+    if (tex.mipCount == 0) return 0; // Unknown until the first decode
+    return coarsestLevelFor(tex.width, tex.height);
+}
+
+size_t TextureStreamer::bytesForTop(const StreamedTexture& tex, int top) const {
+    size_t total = 0;
+    for (int level = top; level < tex.mipCount; ++level) {
+        total += levelBytes(mipSize(tex.width, level), mipSize(tex.height, level), m_compressedUpload, tex.hasAlpha);
+    }
+    return total;
+}
+
+size_t TextureStreamer::getResidentBytes() const {
+    size_t total = 0;
+    for (const auto& tex : m_textures) total += tex.residentBytes;
+    return total;
+}
+
+void TextureStreamer::queueRequest(StreamedTexture& tex, int top, bool fromDisk) {
+    tex.pendingTop = top;
+    unsigned int serial = ++tex.requestSerial;
+
+    // Decoded before: upload a slice of the cached chain (no job, no disk).
+    // It still goes through the results so the upload budget applies
+    if (tex.chain && !fromDisk) {
+        Result res;
+        res.id = tex.id;
+        res.serial = serial;
+        slice(tex.chain, top, res);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.push_back(std::move(res));
+        return;
+    }
+
+    Request req;
+    req.id = tex.id;
+    req.path = tex.path;
+    req.top = top;
+    req.compress = m_compressedUpload;
+    req.serial = serial;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight++;
+    }
+    // Decodes run side by side, so results can come back out of order
+    g_jobSystem.run("texture decode", [this, req] {
+        Result res;
+        decode(req, res);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(std::move(res));
+            m_inFlight--;
+        }
+        m_done.notify_all();
+    });
+}
+
+void TextureStreamer::update(float camX, float camZ) {
+    ++m_frame;
+
+    // --- 1. Desired mip from distance to the closest anchor ---
+    for (auto& tex : m_textures) {
+        float dist = 0.0f;
+        if (!tex.anchors.empty()) {
+            dist = 1e30f;
+            for (const auto& a : tex.anchors) {
+                float dx = a.x - camX;
+                float dz = a.z - camZ;
+                float d = sqrtf(dx * dx + dz * dz) - a.radius;
+                if (d < dist) dist = d;
+            }
+            if (dist < 0.0f) dist = 0.0f;
+        }
+        tex.distance = dist;
+        if (dist <= m_useDistance) tex.lastUsedFrame = m_frame;
+
+        int top = 0;
+        if (dist > m_fullDetailDistance) {
+            top = (int)floorf(log2f(dist / m_fullDetailDistance));
+        }
+        // Hysteresis: don't drop detail until we are clearly past the threshold
+        if (tex.residentTop >= 0 && top > tex.residentTop) {
+            float relaxed = dist * 0.8f;
+            int relaxedTop = (relaxed > m_fullDetailDistance) ? (int)floorf(log2f(relaxed / m_fullDetailDistance)) : 0;
+            if (relaxedTop <= tex.residentTop) top = tex.residentTop;
+        }
+        int coarsest = coarsestTop(tex);
+        if (tex.mipCount > 0 && top > coarsest) top = coarsest;
+        tex.desiredTop = top;
+    }
+
+    // --- 2. Budget: drop least recently used textures to coarser mips ---
+    size_t total = 0;
+    for (const auto& tex : m_textures) total += bytesForTop(tex, tex.desiredTop);
+
+    if (total > m_budgetBytes) {
+        std::vector<int> order(m_textures.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+        std::sort(order.begin(), order.end(), [this](int a, int b) {
+            const StreamedTexture& ta = m_textures[a];
+            const StreamedTexture& tb = m_textures[b];
+            if (ta.lastUsedFrame != tb.lastUsedFrame) return ta.lastUsedFrame < tb.lastUsedFrame;
+            return ta.distance > tb.distance;
+        });
+
+        for (int idx : order) {
+            StreamedTexture& tex = m_textures[idx];
+            int coarsest = coarsestTop(tex);
+            while (total > m_budgetBytes && tex.desiredTop < coarsest) {
+                total -= bytesForTop(tex, tex.desiredTop);
+                tex.desiredTop++;
+                total += bytesForTop(tex, tex.desiredTop);
+            }
+            if (total <= m_budgetBytes) break;
+        }
+    }
+
+    // --- 3. Ask the loader for textures whose residency changed ---
+    for (auto& tex : m_textures) {
+        if (!tex.failed && tex.pendingTop == -1 && tex.desiredTop != tex.residentTop) {
+            queueRequest(tex, tex.desiredTop);
+        }
+    }
+
+    // --- 4. Upload finished loads, bounded per frame ---
+    size_t uploaded = 0;
+    while (true) {
+        Result res;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_results.empty()) break;
+            if (uploaded > 0 && uploaded + m_results.front().bytes > m_uploadBudgetBytes) break;
+            res = std::move(m_results.front());
+            m_results.pop_front();
+        }
+        upload(res);
+        uploaded += res.bytes;
+    }
+}
+
+void TextureStreamer::flush() {
+    while (true) {
+        std::deque<Result> ready;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this] { return !m_results.empty() || m_inFlight == 0; });
+            ready.swap(m_results);
+            if (ready.empty()) break;
+        }
+        for (const auto& res : ready) upload(res);
+    }
+}
+
+bool TextureStreamer::reload(const char* path) {
+    auto it = m_pathIndex.find(path);
+    if (it == m_pathIndex.end()) return false;
+    StreamedTexture& tex = m_textures[it->second];
+    int top = (tex.residentTop >= 0) ? tex.residentTop : tex.desiredTop;
+    queueRequest(tex, top, true);
+    printf("TextureStreamer: reloading '%s'\n", path);
+    return true;
+}
+
+void TextureStreamer::upload(const Result& res) {
+    StreamedTexture* tex = find(res.id);
+    if (!tex || res.serial != tex->requestSerial) return; // Superseded by a later request
+    tex->pendingTop = -1;
+
+    if (!res.ok) {
+        printf("TextureStreamer: failed to load '%s': %s\n", tex->path.c_str(), res.error.c_str());
+        tex->failed = true; // Don't retry every frame
+        return;
+    }
+
+    const StreamedMipChain& chain = *res.chain;
+    tex->failed = false;
+    tex->chain = res.chain;
+    tex->width = chain.width;
+    tex->height = chain.height;
+    tex->mipCount = (int)chain.levels.size();
+    tex->hasAlpha = chain.hasAlpha;
+
+    GLenum format = chain.hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    int levels = (int)chain.levels.size() - res.top;
+
+    glBindTexture(GL_TEXTURE_2D, res.id);
+    for (int i = 0; i < levels; ++i) {
+        const StreamedMip& mip = chain.levels[res.top + i];
+        if (chain.compressed && s_glCompressedTexImage2D) {
+            s_glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, format, mip.width, mip.height, 0,
+                (GLsizei)mip.data.size(), mip.data.data());
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA, mip.width, mip.height, 0,
+                GL_RGBA, GL_UNSIGNED_BYTE, mip.data.data());
+        }
+    }
+    // Free the tail left over from a finer residency
+    for (int i = levels; i < tex->residentLevels; ++i) {
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    tex->residentTop = res.top;
+    tex->residentLevels = levels;
+    tex->residentBytes = res.bytes;
+    tex->residentFormat = chain.compressed ? format : GL_RGBA;
+    trackMemory(*tex);
+}
+
+void TextureStreamer::trackMemory(const StreamedTexture& tex) const {
+    if (tex.residentTop < 0) {
+        g_gpuMemory.trackTexture(tex.id, tex.owner.c_str(), tex.path.c_str(), GL_RGBA, 1, 1, 1); // Placeholder
+        return;
+    }
+    g_gpuMemory.trackTexture(tex.id, tex.owner.c_str(), tex.path.c_str(), tex.residentFormat,
+        mipSize(tex.width, tex.residentTop), mipSize(tex.height, tex.residentTop), tex.residentLevels);
+}
+
+void TextureStreamer::printReport() const {
+    printf("\n--- Texture Streaming Report (frame %u) ---\n", m_frame);
+    printf("  ID   Resident    Full        Mip    Dist      Bytes  Path\n");
+    for (const auto& tex : m_textures) {
+        int rw = (tex.residentTop >= 0) ? mipSize(tex.width, tex.residentTop) : 1;
+        int rh = (tex.residentTop >= 0) ? mipSize(tex.height, tex.residentTop) : 1;
+        printf("%4u   %4dx%-4d   %4dx%-4d   %2d/%-2d  %5.1f  %7.1f KB  %s%s\n",
+            tex.id, rw, rh, tex.width, tex.height,
+            tex.residentTop, tex.mipCount, tex.distance,
+            tex.residentBytes / 1024.0, tex.path.c_str(),
+            (tex.pendingTop != -1) ? " (streaming)" : "");
+    }
+    size_t cached = 0;
+    for (const auto& tex : m_textures) {
+        if (!tex.chain) continue;
+        for (const auto& mip : tex.chain->levels) cached += mip.data.size();
+    }
+    printf("Total resident: %.1f KB of %.1f KB budget (mip chains cached in memory: %.1f KB)\n\n",
+        getResidentBytes() / 1024.0, m_budgetBytes / 1024.0, cached / 1024.0);
+}
+
+// ================================================================
+// Decode jobs (worker threads)
+// ================================================================
+
+// Decodes the file and builds its whole mip chain (each level encoded
+// once); the result uploads levels req.top and coarser
+bool TextureStreamer::decode(const Request& req, Result& out) {
+    out.id = req.id;
+    out.top = req.top;
+    out.serial = req.serial;
+    out.ok = false;
+    out.bytes = 0;
+
+    int w = 0, h = 0, channels = 0;
+    unsigned char* pixels;
+    {
+        std::lock_guard<std::mutex> lock(s_soilMutex);
+        pixels = SOIL_load_image(req.path.c_str(), &w, &h, &channels, SOIL_LOAD_RGBA);
+        if (!pixels) {
+            out.error = SOIL_last_result();
+            return false;
+        }
+    }
+
+    // Flip to match SOIL_FLAG_INVERT_Y
+    StreamedMip current;
+    current.width = w;
+    current.height = h;
+    current.data.resize((size_t)w * h * 4);
+    size_t rowBytes = (size_t)w * 4;
+    for (int y = 0; y < h; ++y) {
+        memcpy(&current.data[(size_t)y * rowBytes], pixels + (size_t)(h - 1 - y) * rowBytes, rowBytes);
+    }
+    SOIL_free_image_data(pixels);
+
+    std::shared_ptr<StreamedMipChain> chain = std::make_shared<StreamedMipChain>();
+    chain->width = w;
+    chain->height = h;
+    chain->hasAlpha = (channels == 2 || channels == 4);
+    chain->compressed = req.compress;
+
+    int mipCount = mipCountFor(w, h);
+    for (int level = 0; level < mipCount; ++level) {
+        StreamedMip mip;
+        mip.width = current.width;
+        mip.height = current.height;
+        if (req.compress) {
+            int size = 0;
+            unsigned char* dxt = chain->hasAlpha
+                ? convert_image_to_DXT5(current.data.data(), current.width, current.height, 4, &size)
+                : convert_image_to_DXT1(current.data.data(), current.width, current.height, 4, &size);
+            if (!dxt) {
+                out.error = "DXT compression failed";
+                return false;
+            }
+            mip.data.assign(dxt, dxt + size);
+            free(dxt);
+        }
+        else {
+            mip.data = current.data;
+        }
+        chain->levels.push_back(std::move(mip));
+
+        if (level + 1 < mipCount) {
+            StreamedMip next;
+            downsample(current, next);
+            current = std::move(next);
+        }
+    }
+
+    slice(chain, req.top, out);
+    return true;
+}
+
+// Result uploading levels 'top' and coarser of a decoded chain
+void TextureStreamer::slice(const std::shared_ptr<const StreamedMipChain>& chain, int top, Result& out) {
+    int coarsest = coarsestLevelFor(chain->width, chain->height);
+    if (top > coarsest) top = coarsest;
+    if (top < 0) top = 0;
+
+    out.top = top;
+    out.ok = true;
+    out.chain = chain;
+    out.bytes = 0;
+    for (size_t level = top; level < chain->levels.size(); ++level) out.bytes += chain->levels[level].data.size();
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include <glut.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+// ================================================================
+// TextureStreamer
+//
+// Texture streaming on top of the SOIL2 loader. Every texture keeps only
+// the mip levels it needs for the current view resident on the GPU:
+//  - The finest resident mip is chosen from the distance between the
+//    Camera and the texture's anchors (the places it is drawn at).
+//  - When the total resident size goes over the budget, the least
+//    recently used textures are dropped to coarser mips first.
+//  - Decoding, mip generation and DXT compression run as "texture decode"
+//    jobs on g_jobSystem, several at once, once per file: the whole mip
+//    chain is kept in memory (in the upload format), so a later change of
+//    residency only uploads a slice of it. The GL upload happens in
+//    update() under a per-frame budget.
+//
+// Texture IDs never change, so display lists that bind them stay valid
+// while their mips are swapped underneath.
+// ================================================================
+
+/**
+ * @brief One decoded mip level waiting for upload.
+ */
+struct StreamedMip {
+    int width;
+    int height;
+    std::vector<unsigned char> data;
+};
+
+/**
+ * @brief Every mip level of a texture in the upload format (DXT or RGBA8),
+ * made by the first decode and shared by the uploads that follow.
+ */
+struct StreamedMipChain {
+    int width, height;     // Level 0
+    bool hasAlpha;
+    bool compressed;
+    std::vector<StreamedMip> levels;
+};
+
+/**
+ * @brief World position a texture is drawn at. Distance is measured to the
+ * edge of the anchor circle, so a large radius keeps a texture at full detail.
+ */
+struct TextureAnchor {
+    float x, z;
+    float radius;
+    const void* owner;     // Module that added it (for removeAnchors)
+};
+
+/**
+ * @brief Book-keeping for a single streamed texture.
+ */
+struct StreamedTexture {
+    std::string path;
+    GLuint id;
+    std::string owner;     // Modules that loaded it, e.g. "SecretBook+SecretDoor"
+
+    int width, height;     // Full resolution (0 until the first decode)
+    int mipCount;          // Levels in the full chain
+    bool hasAlpha;
+
+    int residentTop;       // Finest mip on the GPU (-1 = placeholder only)
+    int residentLevels;    // Number of levels currently uploaded
+    int pendingTop;        // Level requested from the loader (-1 = none)
+    unsigned int requestSerial; // Of the latest request; older results are dropped
+    int desiredTop;
+    size_t residentBytes;
+    GLenum residentFormat; // Internal format of the uploaded levels
+
+    bool failed;           // Last decode failed; not retried until reload()
+    std::shared_ptr<const StreamedMipChain> chain; // Decoded levels (null until the first decode)
+
+    float distance;        // Distance to the camera at the last update
+    unsigned int lastUsedFrame;
+
+    std::vector<TextureAnchor> anchors;
+};
+
+class TextureStreamer {
+public:
+    TextureStreamer();
+    ~TextureStreamer();
+
+    /**
+     * @brief Registers a texture file and returns its GL texture ID.
+     * The same path always returns the same ID. Pixel data arrives on a later
+     * update(); until then a 1x1 grey placeholder is bound.
+     * @param owner Module name reported to the GPU memory tracker.
+     */
+    GLuint load(const char* path, const char* owner = nullptr);
+
+    /**
+     * @brief Adds a world position the texture is drawn at. Textures without
+     * anchors are treated as always in view (distance 0).
+     */
+    void addAnchor(GLuint id, float x, float z, float radius = 0.0f, const void* owner = nullptr);
+
+    /**
+     * @brief Removes every anchor added by a module, e.g. before it re-adds
+     * its objects on a layout reload.
+     */
+    void removeAnchors(const void* owner);
+
+    /**
+     * @brief Sets the GPU memory budget for all streamed textures, in bytes.
+     */
+    void setBudget(size_t bytes) { m_budgetBytes = bytes; }
+    size_t getBudget() const { return m_budgetBytes; }
+
+    /**
+     * @brief Sets how many bytes may be uploaded per update() call.
+     */
+    void setUploadBudget(size_t bytes) { m_uploadBudgetBytes = bytes; }
+
+    /**
+     * @brief Distance up to which textures stay at full resolution. Every
+     * doubling of the distance beyond it drops one mip level.
+     */
+    void setFullDetailDistance(float distance) { m_fullDetailDistance = distance; }
+
+    /**
+     * @brief Picks residency for all textures and uploads finished loads.
+     * Call once per frame from idle(), with the camera position.
+     */
+    void update(float camX, float camZ);
+
+    /**
+     * @brief Blocks until every queued load has been decoded and uploaded.
+     * Used at the end of init() so the first frame is not blurry.
+     */
+    void flush();
+
+    /**
+     * @brief Re-decodes a texture from disk (replacing its cached mip chain)
+     * at its current residency.
+     * @return False if the path was never loaded.
+     */
+    bool reload(const char* path);
+
+    /**
+     * @brief Prints resident bytes per texture to the console.
+     */
+    void printReport() const;
+
+    size_t getResidentBytes() const;
+    int getTextureCount() const { return (int)m_textures.size(); }
+    const StreamedTexture* getTexture(int index) const;
+    const StreamedTexture* findTexture(GLuint id) const;
+
+private:
+    struct Request {
+        GLuint id;
+        std::string path;
+        int top;
+        bool compress;
+        unsigned int serial;
+    };
+
+    struct Result {
+        GLuint id;
+        int top;               // Finest level uploaded from the chain
+        unsigned int serial;
+        bool ok;
+        std::shared_ptr<const StreamedMipChain> chain;
+        size_t bytes;          // Of levels top and coarser
+        std::string error;
+    };
+
+    // Decode jobs
+    static bool decode(const Request& req, Result& out);
+    static void slice(const std::shared_ptr<const StreamedMipChain>& chain, int top, Result& out);
+
+    // GL thread
+    void queueRequest(StreamedTexture& tex, int top, bool fromDisk = false);
+    void upload(const Result& res);
+    int coarsestTop(const StreamedTexture& tex) const;
+    void trackMemory(const StreamedTexture& tex) const;
+    size_t bytesForTop(const StreamedTexture& tex, int top) const;
+    StreamedTexture* find(GLuint id);
+
+    std::vector<StreamedTexture> m_textures;
+    std::map<std::string, int> m_pathIndex;
+
+    size_t m_budgetBytes;
+    size_t m_uploadBudgetBytes;
+    float m_fullDetailDistance;
+    float m_useDistance;       // Textures within this range count as "used"
+    unsigned int m_frame;
+
+    bool m_compressedUpload;   // S3TC available on this driver
+    bool m_capsQueried;
+
+    // Shared with the decode jobs
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+    std::deque<Result> m_results;
+    int m_inFlight;            // Decode jobs not finished yet
+};
+
+// Shared streamer used by every module that loads textures
+extern TextureStreamer g_textureStreamer;
@@ -0,0 +1,172 @@
+// TriggerVolumes.cpp : Enter / stay / exit events for areas around the player.
+//
+#include "pch.h" // Must be first
+#include "TriggerVolumes.h"
+#include <math.h>
+#include <algorithm>
+
+TriggerVolumes g_triggers;
+
+TriggerVolumes::TriggerVolumes(float cellSize)
+    : m_cellSize(cellSize > 0.0f ? cellSize : 4.0f), m_stayEvents(true), m_nextSubscriber(1)
+{
+}
+
+int TriggerVolumes::cellOf(float v) const {
+    return (int)floorf(v / m_cellSize);
+}
+
+// ================================================================
+// Volumes
+// ================================================================
+
+void TriggerVolumes::addCircle(float x, float z, float radius, int tag, int index, const void* owner) {
+    Volume v = { TRIGGER_CIRCLE, x, z, radius, 0.0f, 0.0f, tag, index, owner, true };
+    add(v);
+}
+
+void TriggerVolumes::addBox(float minX, float minZ, float maxX, float maxZ, int tag, int index, const void* owner) {
+    Volume v = { TRIGGER_BOX, minX, minZ, 0.0f, maxX, maxZ, tag, index, owner, true };
+    add(v);
+}
+
+void TriggerVolumes::add(const Volume& v) {
+    m_volumes.push_back(v);
+    m_wasInside.push_back(0);
+    insert((int)m_volumes.size() - 1);
+}
+
+void TriggerVolumes::insert(int volume) {
+    const Volume& v = m_volumes[volume];
+    float minX, minZ, maxX, maxZ;
+    if (v.shape == TRIGGER_CIRCLE) {
+        minX = v.x - v.radius; maxX = v.x + v.radius;
+        minZ = v.z - v.radius; maxZ = v.z + v.radius;
+    }
+    else {
+        minX = v.x; maxX = v.maxX;
+        minZ = v.z; maxZ = v.maxZ;
+    }
+
+    for (int cz = cellOf(minZ); cz <= cellOf(maxZ); ++cz) {
+        for (int cx = cellOf(minX); cx <= cellOf(maxX); ++cx) {
+            m_buckets[key(cx, cz)].push_back(volume);
+        }
+    }
+}
+
+void TriggerVolumes::removeOwner(const void* owner) {
+    std::vector<Volume> kept;
+    std::vector<unsigned char> keptInside;
+    kept.reserve(m_volumes.size());
+
+    for (size_t i = 0; i < m_volumes.size(); ++i) {
+        if (m_volumes[i].owner == owner) {
+            if (m_wasInside[i]) push(TRIGGER_EXIT, m_volumes[i]);
+            continue;
+        }
+        kept.push_back(m_volumes[i]);
+        keptInside.push_back(m_wasInside[i]);
+    }
+    if (kept.size() == m_volumes.size()) return;
+
+    // Volume numbers changed: rebuild the buckets and the inside list
+    m_volumes.swap(kept);
+    m_wasInside.swap(keptInside);
+    m_buckets.clear();
+    m_inside.clear();
+    for (int i = 0; i < (int)m_volumes.size(); ++i) {
+        insert(i);
+        if (m_wasInside[i]) m_inside.push_back(i);
+    }
+}
+
+void TriggerVolumes::setOwnerEnabled(const void* owner, bool enabled) {
+    for (size_t i = 0; i < m_volumes.size(); ++i) {
+        Volume& v = m_volumes[i];
+        if (v.owner != owner || v.enabled == enabled) continue;
+        v.enabled = enabled;
+        if (!enabled && m_wasInside[i]) {
+            push(TRIGGER_EXIT, v);
+            m_wasInside[i] = 0;
+            m_inside.erase(std::find(m_inside.begin(), m_inside.end(), (int)i));
+        }
+    }
+}
+
+bool TriggerVolumes::contains(const Volume& v, float x, float z) const {
+    if (v.shape == TRIGGER_CIRCLE) {
+        float dx = x - v.x, dz = z - v.z;
+        return dx * dx + dz * dz < v.radius * v.radius;
+    }
+    return x >= v.x && x < v.maxX && z >= v.z && z < v.maxZ;
+}
+
+// ================================================================
+// Events
+// ================================================================
+
+void TriggerVolumes::push(int type, const Volume& v) {
+    TriggerEvent e = { type, v.tag, v.index, v.owner };
+    m_queue.push_back(e);
+}
+
+void TriggerVolumes::update(float playerX, float playerZ) {
+    // Volumes inside this tick, found in the player's cell only
+    std::vector<int> now;
+    auto it = m_buckets.find(key(cellOf(playerX), cellOf(playerZ)));
+    if (it != m_buckets.end()) {
+        for (int v : it->second) {
+            if (m_volumes[v].enabled && contains(m_volumes[v], playerX, playerZ)) now.push_back(v);
+        }
+    }
+
+    // Left since last tick (still flagged, but not found now)
+    for (int v : now) m_wasInside[v] |= 2;
+    for (int v : m_inside) {
+        if (!(m_wasInside[v] & 2)) {
+            push(TRIGGER_EXIT, m_volumes[v]);
+        }
+    }
+
+    for (int v : now) {
+        if (m_wasInside[v] & 1) {
+            if (m_stayEvents) push(TRIGGER_STAY, m_volumes[v]);
+        }
+        else {
+            push(TRIGGER_ENTER, m_volumes[v]);
+        }
+    }
+
+    for (int v : m_inside) m_wasInside[v] = 0;
+    for (int v : now) m_wasInside[v] = 1;
+    m_inside.swap(now);
+}
+
+int TriggerVolumes::subscribe(TriggerCallback callback) {
+    int id = m_nextSubscriber++;
+    m_subscribers.push_back(std::make_pair(id, callback));
+    return id;
+}
+
+void TriggerVolumes::unsubscribe(int id) {
+    for (size_t i = 0; i < m_subscribers.size(); ++i) {
+        if (m_subscribers[i].first == id) {
+            m_subscribers.erase(m_subscribers.begin() + i);
+            return;
+        }
+    }
+}
+
+void TriggerVolumes::dispatch() {
+    if (m_queue.empty()) return;
+
+    // Subscribers may add or remove volumes (and queue more events) while handling these
+    std::vector<TriggerEvent> events;
+    events.swap(m_queue);
+    for (const auto& e : events) {
+        for (size_t i = 0; i < m_subscribers.size(); ++i) {
+            m_subscribers[i].second(e);
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+// ================================================================
+// TriggerVolumes
+//
+// Areas on the floor (circles or boxes) that report when the player
+// walks into them, stays inside, or leaves. Modules register volumes with
+// an owner pointer and a tag (what the volume belongs to), the same way
+// they add interactables and texture anchors.
+//
+// update() is called once per simulation tick with the player position.
+// Only the volumes in the player's broadphase cell are tested, and the
+// resulting enter / stay / exit events wait in a queue until dispatch()
+// hands them to every subscriber (prompts, puzzles, audio, stats).
+// ================================================================
+
+enum TriggerShape {
+    TRIGGER_CIRCLE = 0,
+    TRIGGER_BOX
+};
+
+enum TriggerEventType {
+    TRIGGER_ENTER = 0,
+    TRIGGER_STAY,
+    TRIGGER_EXIT
+};
+
+struct TriggerEvent {
+    int type;              // TriggerEventType
+    int tag;               // Tag the volume was added with (e.g. an InteractableKind)
+    int index;             // Object index inside its module
+    const void* owner;     // Module that added the volume
+};
+
+typedef std::function<void(const TriggerEvent& e)> TriggerCallback;
+
+class TriggerVolumes {
+public:
+    /**
+     * @param cellSize Broadphase cell size in world units.
+     */
+    explicit TriggerVolumes(float cellSize = 4.0f);
+
+    void addCircle(float x, float z, float radius, int tag, int index, const void* owner);
+    void addBox(float minX, float minZ, float maxX, float maxZ, int tag, int index, const void* owner);
+
+    /**
+     * @brief Removes every volume added by a module. Volumes the player is
+     * inside queue an exit event first, so subscribers stay balanced.
+     */
+    void removeOwner(const void* owner);
+
+    /**
+     * @brief Switches every volume of a module off or on (e.g. objects on
+     * another floor). Switching off queues exits like removeOwner.
+     */
+    void setOwnerEnabled(const void* owner, bool enabled);
+
+    /**
+     * @brief Tests the player position against nearby volumes and queues
+     * enter / stay / exit events. Call once per simulation tick.
+     */
+    void update(float playerX, float playerZ);
+
+    /**
+     * @brief Registers a callback for every event. Returns its ID.
+     */
+    int subscribe(TriggerCallback callback);
+    void unsubscribe(int id);
+
+    /**
+     * @brief Hands queued events to the subscribers, in the order they happened.
+     */
+    void dispatch();
+
+    int getCount() const { return (int)m_volumes.size(); }
+    int getInsideCount() const { return (int)m_inside.size(); }
+
+    /**
+     * @brief Turns stay events on or off (on by default).
+     */
+    void setStayEvents(bool enabled) { m_stayEvents = enabled; }
+
+private:
+    struct Volume {
+        int shape;         // TriggerShape
+        float x, z;        // Circle center, or box min corner
+        float radius;      // Circle only
+        float maxX, maxZ;  // Box only
+        int tag;
+        int index;
+        const void* owner;
+        bool enabled;
+    };
+
+    long long key(int cx, int cz) const { return ((long long)cx << 32) ^ (unsigned int)cz; }
+    int cellOf(float v) const;
+    void add(const Volume& v);
+    void insert(int volume);
+    bool contains(const Volume& v, float x, float z) const;
+    void push(int type, const Volume& v);
+
+    float m_cellSize;
+    std::vector<Volume> m_volumes;
+    std::unordered_map<long long, std::vector<int>> m_buckets;
+
+    std::vector<int> m_inside;        // Volumes the player was inside last tick
+    std::vector<unsigned char> m_wasInside; // Per volume flag for m_inside
+    bool m_stayEvents;
+
+    std::vector<TriggerEvent> m_queue;
+    std::vector<std::pair<int, TriggerCallback>> m_subscribers;
+    int m_nextSubscriber;
+};
+
+extern TriggerVolumes g_triggers;
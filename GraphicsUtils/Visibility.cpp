@@ -0,0 +1,206 @@
+// Visibility.cpp : Coarse block-to-block visibility for culling room objects.
+//
+#include "pch.h" // Must be first
+#include "Visibility.h"
+#include "GraphicsUtils.h"
+#include <stdio.h>
+#include <math.h>
+
+Visibility g_visibility;
+
+// Every sight line between two blocks leaves the first through its border
+// and enters the second through its border, so sampling the borders finds
+// it from any viewpoint inside: points every half cell around the edge
+// (plus the center). They are pulled in slightly from the block edge so a
+// ray along a wall face is not counted as blocked. A line towards a block
+// that lies entirely to one side never leaves through the opposite edge,
+// so points only on that edge are skipped for the pair.
+static const int EDGE_STEPS = Visibility::BLOCK_CELLS * 2;
+static const float EDGE_INSET = 0.01f;
+
+enum BlockSide {
+    SIDE_LEFT = 1, SIDE_RIGHT = 2, SIDE_BOTTOM = 4, SIDE_TOP = 8
+};
+
+// Edges of block (ax, az) that no line towards block (bx, bz) leaves through
+static int awaySides(int ax, int az, int bx, int bz) {
+    int sides = 0;
+    if (bx > ax) sides |= SIDE_LEFT;
+    if (bx < ax) sides |= SIDE_RIGHT;
+    if (bz > az) sides |= SIDE_BOTTOM;
+    if (bz < az) sides |= SIDE_TOP;
+    return sides;
+}
+
+static bool usable(const Visibility::BorderPoint& p, int away) {
+    return p.sides == 0 || (p.sides & ~away) != 0;
+}
+
+Visibility::Visibility()
+    : m_width(0), m_height(0), m_blocksX(0), m_blocksZ(0), m_viewBlock(-1)
+{
+}
+
+void Visibility::clear() {
+    m_bits.clear();
+    m_blocksX = m_blocksZ = 0;
+    m_viewBlock = -1;
+}
+
+bool Visibility::cellSolid(int x, int z) const {
+    if (x < 0 || z < 0 || x >= m_width || z >= m_height) return true;
+    return m_occluders[(size_t)z * m_width + x] != 0;
+}
+
+// Grid DDA from (x0, z0) to (x1, z1) in cell units
+bool Visibility::lineClear(float x0, float z0, float x1, float z1) const {
+    int cx = (int)floor(x0), cz = (int)floor(z0);
+    int ex = (int)floor(x1), ez = (int)floor(z1);
+    float dx = x1 - x0, dz = z1 - z0;
+
+    int stepX = dx > 0 ? 1 : -1;
+    int stepZ = dz > 0 ? 1 : -1;
+    float tDeltaX = dx != 0.0f ? fabsf(1.0f / dx) : 1e30f;
+    float tDeltaZ = dz != 0.0f ? fabsf(1.0f / dz) : 1e30f;
+    float tMaxX = dx != 0.0f ? (dx > 0 ? (cx + 1 - x0) : (x0 - cx)) * tDeltaX : 1e30f;
+    float tMaxZ = dz != 0.0f ? (dz > 0 ? (cz + 1 - z0) : (z0 - cz)) * tDeltaZ : 1e30f;
+
+    for (;;) {
+        if (cellSolid(cx, cz)) return false;
+        if (cx == ex && cz == ez) return true;
+        if (tMaxX < tMaxZ) {
+            if (tMaxX > 1.0f) return true;
+            tMaxX += tDeltaX;
+            cx += stepX;
+        }
+        else {
+            if (tMaxZ > 1.0f) return true;
+            tMaxZ += tDeltaZ;
+            cz += stepZ;
+        }
+    }
+}
+
+void Visibility::blockSamples(int bx, int bz, std::vector<BorderPoint>& out) const {
+    out.clear();
+    const float size = (float)BLOCK_CELLS;
+    const float step = (size - 2.0f * EDGE_INSET) / EDGE_STEPS;
+    float x0 = bx * size + EDGE_INSET, z0 = bz * size + EDGE_INSET;
+
+    auto add = [&](int u, int v) {
+        BorderPoint p = { x0 + u * step, z0 + v * step, 0 };
+        if (cellSolid((int)p.x, (int)p.z)) return;
+        if (u == 0) p.sides |= SIDE_LEFT;
+        if (u == EDGE_STEPS) p.sides |= SIDE_RIGHT;
+        if (v == 0) p.sides |= SIDE_BOTTOM;
+        if (v == EDGE_STEPS) p.sides |= SIDE_TOP;
+        out.push_back(p);
+    };
+    for (int k = 0; k <= EDGE_STEPS; ++k) { add(k, 0); add(k, EDGE_STEPS); }
+    for (int k = 1; k < EDGE_STEPS; ++k) { add(0, k); add(EDGE_STEPS, k); }
+    add(EDGE_STEPS / 2, EDGE_STEPS / 2);
+}
+
+bool Visibility::blockToBlockVisible(int a, int b, const std::vector<BorderPoint>& pa, const std::vector<BorderPoint>& pb) const {
+    int ax = a % m_blocksX, az = a / m_blocksX;
+    int bx = b % m_blocksX, bz = b / m_blocksX;
+    int awayA = awaySides(ax, az, bx, bz);
+    int awayB = awaySides(bx, bz, ax, az);
+    for (const BorderPoint& p : pa) {
+        if (!usable(p, awayA)) continue;
+        for (const BorderPoint& q : pb) {
+            if (usable(q, awayB) && lineClear(p.x, p.z, q.x, q.z)) return true;
+        }
+    }
+    return false;
+}
+
+void Visibility::compute(const unsigned char* occluderBits, int width, int height) {
+    clear();
+    if (!occluderBits || width <= 0 || height <= 0) return;
+
+    // Unpack to one byte per cell for the ray marcher
+    m_width = width;
+    m_height = height;
+    int rowBytes = (width + 7) / 8;
+    m_occluders.assign((size_t)width * height, 0);
+    for (int z = 0; z < height; ++z) {
+        for (int x = 0; x < width; ++x) {
+            if (occluderBits[z * rowBytes + x / 8] & (1 << (x % 8))) m_occluders[(size_t)z * width + x] = 1;
+        }
+    }
+
+    m_blocksX = (width + BLOCK_CELLS - 1) / BLOCK_CELLS;
+    m_blocksZ = (height + BLOCK_CELLS - 1) / BLOCK_CELLS;
+    int blocks = m_blocksX * m_blocksZ;
+    m_bits.assign(((size_t)blocks * blocks + 7) / 8, 0);
+
+    std::vector<std::vector<BorderPoint>> samples(blocks);
+    for (int b = 0; b < blocks; ++b) blockSamples(b % m_blocksX, b / m_blocksX, samples[b]);
+
+    // Symmetric, so only half of the pairs are traced
+    int visiblePairs = 0;
+    for (int a = 0; a < blocks; ++a) {
+        for (int b = a; b < blocks; ++b) {
+            if (!blockToBlockVisible(a, b, samples[a], samples[b])) continue;
+            size_t ab = (size_t)a * blocks + b, ba = (size_t)b * blocks + a;
+            m_bits[ab / 8] |= (unsigned char)(1 << (ab % 8));
+            m_bits[ba / 8] |= (unsigned char)(1 << (ba % 8));
+            visiblePairs++;
+        }
+    }
+
+    m_occluders.clear();
+    m_occluders.shrink_to_fit();
+    printf("Visibility: %dx%d blocks, %d of %d block pairs visible\n",
+        m_blocksX, m_blocksZ, visiblePairs, blocks * (blocks + 1) / 2);
+}
+
+bool Visibility::load(const std::vector<unsigned char>& bits, int blocksX, int blocksZ) {
+    clear();
+    int blocks = blocksX * blocksZ;
+    if (blocks <= 0 || bits.size() != ((size_t)blocks * blocks + 7) / 8) return false;
+    m_bits = bits;
+    m_blocksX = blocksX;
+    m_blocksZ = blocksZ;
+    return true;
+}
+
+bool Visibility::pairVisible(int a, int b) const {
+    size_t i = (size_t)a * (m_blocksX * m_blocksZ) + b;
+    return (m_bits[i / 8] & (1 << (i % 8))) != 0;
+}
+
+void Visibility::setViewpoint(float camX, float camZ, float camY, float wallHeight) {
+    m_viewBlock = -1;
+    if (!isReady() || camY > wallHeight) return;
+
+    int gx, gz;
+    if (!worldToGrid(camX, camZ, gx, gz)) return;
+    int block = (gz / BLOCK_CELLS) * m_blocksX + gx / BLOCK_CELLS;
+    if (block >= m_blocksX * m_blocksZ) return;
+
+    // A block that sees nothing (not even itself) is solid: don't trust it
+    if (pairVisible(block, block)) m_viewBlock = block;
+}
+
+bool Visibility::isVisible(float x, float z, float radius) const {
+    if (m_viewBlock < 0) return true;
+
+    int x0, z0, x1, z1;
+    worldToGrid(x - radius, z - radius, x0, z0);
+    worldToGrid(x + radius, z + radius, x1, z1);
+    int bx0 = x0 / BLOCK_CELLS, bz0 = z0 / BLOCK_CELLS;
+    int bx1 = x1 / BLOCK_CELLS, bz1 = z1 / BLOCK_CELLS;
+    if (bx0 < 0) bx0 = 0;
+    if (bz0 < 0) bz0 = 0;
+    if (bx1 >= m_blocksX) bx1 = m_blocksX - 1;
+    if (bz1 >= m_blocksZ) bz1 = m_blocksZ - 1;
+
+    for (int bz = bz0; bz <= bz1; ++bz) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+            if (pairVisible(m_viewBlock, bz * m_blocksX + bx)) return true;
+        }
+    }
+    return false;
+}
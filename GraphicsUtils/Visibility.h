@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+
+// ================================================================
+// Visibility
+//
+// Coarse potentially visible set (PVS) for the room. The collision grid
+// is split into square blocks of cells; for every pair of blocks we store
+// one bit saying whether any sight line between them passes the inside
+// walls and towers. Doors are not occluders because they open. Rays are
+// traced between points all around both block borders (every half cell),
+// which any sight line between the blocks must cross, so a pair is only
+// culled when no gap wider than the sample spacing joins them.
+//
+// The table is computed once per level (it is saved in the world cache)
+// and queried per object while drawing: an object is skipped when none of
+// the blocks it covers can be seen from the camera's block.
+// ================================================================
+
+class Visibility {
+public:
+    Visibility();
+
+    /**
+     * @brief Computes the PVS from a packed occluder grid (saveCollisionGrid format).
+     * @param occluderBits Cells blocked by walls and towers only.
+     * @param width Number of grid columns.
+     * @param height Number of grid rows.
+     */
+    void compute(const unsigned char* occluderBits, int width, int height);
+
+    /**
+     * @brief Replaces the PVS with a table saved earlier (see getBits).
+     * @return False (culling disabled) if the sizes do not match.
+     */
+    bool load(const std::vector<unsigned char>& bits, int blocksX, int blocksZ);
+
+    /**
+     * @brief Disables culling until the next compute() or load().
+     */
+    void clear();
+
+    /**
+     * @brief Sets the camera position used by isVisible for this frame.
+     * Culling is skipped above the walls (developer fly mode) or when the
+     * camera is inside a solid block.
+     */
+    void setViewpoint(float camX, float camZ, float camY, float wallHeight);
+
+    /**
+     * @brief True if an object centered at (x, z) with the given radius may
+     * be seen from the current viewpoint.
+     */
+    bool isVisible(float x, float z, float radius) const;
+
+    bool isReady() const { return !m_bits.empty(); }
+    int getBlocksX() const { return m_blocksX; }
+    int getBlocksZ() const { return m_blocksZ; }
+    const std::vector<unsigned char>& getBits() const { return m_bits; }
+
+    // Grid cells per block side
+    static const int BLOCK_CELLS = 4;
+
+    // Free sample point on a block's border, in cell units
+    struct BorderPoint {
+        float x, z;
+        int sides;  // Block edges it lies on (BlockSide bits; 0 = the center)
+    };
+
+private:
+    bool pairVisible(int a, int b) const;
+    void blockSamples(int bx, int bz, std::vector<BorderPoint>& out) const;
+    bool blockToBlockVisible(int a, int b, const std::vector<BorderPoint>& pa, const std::vector<BorderPoint>& pb) const;
+    bool lineClear(float x0, float z0, float x1, float z1) const;
+    bool cellSolid(int x, int z) const;
+
+    std::vector<unsigned char> m_bits;      // blocks x blocks bit matrix
+    std::vector<unsigned char> m_occluders; // One byte per cell (compute only)
+    int m_width, m_height;
+    int m_blocksX, m_blocksZ;
+    int m_viewBlock;                        // -1 = no culling this frame
+};
+
+extern Visibility g_visibility;
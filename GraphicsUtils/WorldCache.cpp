@@ -0,0 +1,146 @@
+// WorldCache.cpp : On-disk cache of derived world data (grid, meshes, visibility).
+//
+#include "pch.h" // Must be first
+#include "WorldCache.h"
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL; // FNV prime
+    }
+    return h;
+}
+
+namespace {
+
+uint32_t appendBytes(std::vector<unsigned char>& blob, const void* data, size_t size) {
+    uint32_t offset = (uint32_t)blob.size();
+    const unsigned char* p = (const unsigned char*)data;
+    if (size) blob.insert(blob.end(), p, p + size);
+    while (blob.size() % 4) blob.push_back(0);
+    return offset;
+}
+
+bool inside(uint64_t offset, uint64_t bytes, size_t size) {
+    return offset + bytes <= size;
+}
+
+} // namespace
+
+bool saveWorldCache(const char* path, uint64_t key, const WorldCacheData& data) {
+    WorldCacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, WORLD_CACHE_MAGIC, 4);
+    h.version = WORLD_CACHE_VERSION;
+    h.key = key;
+
+    std::vector<unsigned char> blob(sizeof(WorldCacheHeader), 0);
+
+    h.gridWidth = data.gridWidth;
+    h.gridHeight = data.gridHeight;
+    h.gridSize = (uint32_t)data.grid.size();
+    h.gridOffset = appendBytes(blob, data.grid.data(), data.grid.size());
+
+    for (int i = 0; i < CACHE_MESH_COUNT; ++i) {
+        const BakedMesh& m = data.meshes[i];
+        WorldCacheMeshInfo& info = h.meshes[i];
+        info.batchCount = (uint32_t)m.batches.size();
+        info.batchOffset = appendBytes(blob, m.batches.data(), m.batches.size() * sizeof(BakedBatch));
+        info.vertexCount = (uint32_t)m.vertices.size();
+        info.vertexOffset = appendBytes(blob, m.vertices.data(), m.vertices.size() * sizeof(BakedVertex));
+    }
+
+    h.visBlocksX = data.visBlocksX;
+    h.visBlocksZ = data.visBlocksZ;
+    h.visSize = (uint32_t)data.visibility.size();
+    h.visOffset = appendBytes(blob, data.visibility.data(), data.visibility.size());
+
+    h.fileSize = (uint32_t)blob.size();
+    memcpy(blob.data(), &h, sizeof(h));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        printf("WorldCache: cannot write '%s'\n", path);
+        return false;
+    }
+    file.write((const char*)blob.data(), (std::streamsize)blob.size());
+    if (!file) {
+        printf("WorldCache: write to '%s' failed\n", path);
+        return false;
+    }
+
+    printf("WorldCache: saved '%s' (%u bytes)\n", path, h.fileSize);
+    return true;
+}
+
+bool loadWorldCache(const char* path, uint64_t key, WorldCacheData& out) {
+    // One read of the whole file
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::streamoff fileSize = file.tellg();
+    if (fileSize < (std::streamoff)sizeof(WorldCacheHeader)) return false;
+
+    std::vector<unsigned char> blob((size_t)fileSize);
+    file.seekg(0);
+    if (!file.read((char*)blob.data(), fileSize)) return false;
+
+    WorldCacheHeader h;
+    memcpy(&h, blob.data(), sizeof(h));
+    size_t size = blob.size();
+
+    if (memcmp(h.magic, WORLD_CACHE_MAGIC, 4) != 0 || h.version != WORLD_CACHE_VERSION || h.fileSize != size) {
+        printf("WorldCache: '%s' is invalid or from another version, rebuilding.\n", path);
+        return false;
+    }
+    if (h.key != key) {
+        printf("WorldCache: '%s' belongs to another level or build, rebuilding.\n", path);
+        return false;
+    }
+
+    // Every section must lie inside the file
+    bool ok = inside(h.gridOffset, h.gridSize, size) && inside(h.visOffset, h.visSize, size);
+    for (int i = 0; i < CACHE_MESH_COUNT && ok; ++i) {
+        const WorldCacheMeshInfo& info = h.meshes[i];
+        ok = inside(info.batchOffset, (uint64_t)info.batchCount * sizeof(BakedBatch), size) &&
+            inside(info.vertexOffset, (uint64_t)info.vertexCount * sizeof(BakedVertex), size);
+    }
+    if (!ok) {
+        printf("WorldCache: '%s' is truncated, rebuilding.\n", path);
+        return false;
+    }
+
+    WorldCacheData data;
+    data.gridWidth = h.gridWidth;
+    data.gridHeight = h.gridHeight;
+    data.grid.assign(blob.begin() + h.gridOffset, blob.begin() + h.gridOffset + h.gridSize);
+
+    for (int i = 0; i < CACHE_MESH_COUNT; ++i) {
+        const WorldCacheMeshInfo& info = h.meshes[i];
+        BakedMesh& m = data.meshes[i];
+        m.batches.resize(info.batchCount);
+        if (info.batchCount) memcpy(m.batches.data(), blob.data() + info.batchOffset, info.batchCount * sizeof(BakedBatch));
+        m.vertices.resize(info.vertexCount);
+        if (info.vertexCount) memcpy(m.vertices.data(), blob.data() + info.vertexOffset, info.vertexCount * sizeof(BakedVertex));
+
+        // Batches must stay inside the vertex array
+        for (const auto& b : m.batches) {
+            if (b.first < 0 || b.count < 0 || (uint64_t)b.first + b.count > info.vertexCount) {
+                printf("WorldCache: '%s' has a bad mesh, rebuilding.\n", path);
+                return false;
+            }
+        }
+    }
+
+    data.visBlocksX = h.visBlocksX;
+    data.visBlocksZ = h.visBlocksZ;
+    data.visibility.assign(blob.begin() + h.visOffset, blob.begin() + h.visOffset + h.visSize);
+
+    out = std::move(data);
+    printf("WorldCache: loaded '%s' (%u bytes)\n", path, h.fileSize);
+    return true;
+}
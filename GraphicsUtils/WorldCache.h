@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "BakedMesh.h"
+
+// ================================================================
+// WorldCache
+//
+// Everything the game derives from a level at startup, saved next to the
+// level so the next launch can skip generating it:
+//  - the collision grid (all doors closed)
+//  - the baked geometry of the room shell, inside walls and towers
+//  - the visibility table (see Visibility.h)
+//
+// The cache is keyed by a hash of the compiled level file mixed with a
+// build number. Any change to the level or to the generating code (when
+// the build number is bumped) gives a new key, and a cache with the wrong
+// key, version or size is ignored and rebuilt. Layout:
+//
+//   WorldCacheHeader
+//   collision grid bits
+//   per mesh: BakedBatch[batchCount], BakedVertex[vertexCount]
+//   visibility bits
+// ================================================================
+
+static const char     WORLD_CACHE_MAGIC[4] = { 'E', 'R', 'W', 'C' };
+static const uint32_t WORLD_CACHE_VERSION = 1;
+
+enum WorldCacheMesh {
+    CACHE_MESH_ROOM = 0,
+    CACHE_MESH_WALLS = 1,
+    CACHE_MESH_TOWERS = 2,
+    CACHE_MESH_COUNT = 3
+};
+
+struct WorldCacheMeshInfo {
+    uint32_t batchCount, batchOffset;
+    uint32_t vertexCount, vertexOffset;
+};
+
+struct WorldCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t fileSize;
+    uint32_t reserved;
+    uint64_t key;
+
+    int32_t gridWidth, gridHeight;
+    uint32_t gridOffset, gridSize;
+
+    WorldCacheMeshInfo meshes[CACHE_MESH_COUNT];
+
+    int32_t visBlocksX, visBlocksZ;
+    uint32_t visOffset, visSize;
+};
+
+struct WorldCacheData {
+    std::vector<unsigned char> grid;
+    int gridWidth = 0, gridHeight = 0;
+
+    BakedMesh meshes[CACHE_MESH_COUNT];
+
+    std::vector<unsigned char> visibility;
+    int visBlocksX = 0, visBlocksZ = 0;
+};
+
+/**
+ * @brief 64-bit FNV-1a hash.
+ * @param seed Previous hash to continue from (default: FNV offset basis).
+ */
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ULL);
+
+/**
+ * @brief Writes the cache in one go.
+ * @return False if the file could not be written.
+ */
+bool saveWorldCache(const char* path, uint64_t key, const WorldCacheData& data);
+
+/**
+ * @brief Reads and validates the cache in one read.
+ * @return False if the file is missing, truncated, or has another key/version.
+ */
+bool loadWorldCache(const char* path, uint64_t key, WorldCacheData& out);
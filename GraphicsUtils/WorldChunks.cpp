@@ -0,0 +1,535 @@
+// WorldChunks.cpp : Static world cut into chunks streamed around the camera.
+//
+#include "pch.h" // Must be first
+#include "WorldChunks.h"
+#include "GpuMemory.h"
+#include "Visibility.h"
+#include "JobSystem.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+WorldChunks g_worldChunks;
+
+// Clip bound of the world's outer chunks (geometry beyond the grid stays with them)
+static const float OPEN_BOUND = 1e30f;
+
+// Quads thinner than this along an axis lie in a plane across it
+static const float FLAT_EPSILON = 1e-4f;
+
+static const size_t DEFAULT_UPLOAD_BUDGET = 256 * 1024;
+
+// ================================================================
+// Helpers
+// ================================================================
+
+// Whether an extent [lo, hi] belongs to the chunk span [min, max). A flat
+// extent (a wall face on a chunk edge) belongs to exactly one chunk.
+static bool overlapsSpan(float lo, float hi, float min, float max) {
+    if (hi - lo < FLAT_EPSILON) return lo >= min && lo < max;
+    return hi > min && lo < max;
+}
+
+static BakedVertex lerpVertex(const BakedVertex& a, const BakedVertex& b, float t) {
+    BakedVertex v;
+    v.u = a.u + (b.u - a.u) * t;
+    v.v = a.v + (b.v - a.v) * t;
+    v.nx = a.nx + (b.nx - a.nx) * t;
+    v.ny = a.ny + (b.ny - a.ny) * t;
+    v.nz = a.nz + (b.nz - a.nz) * t;
+    v.x = a.x + (b.x - a.x) * t;
+    v.y = a.y + (b.y - a.y) * t;
+    v.z = a.z + (b.z - a.z) * t;
+    return v;
+}
+
+// Keeps the part of a convex polygon on one side of the plane x = value
+// (or z = value). Quads are planar with affine texture coordinates, so
+// interpolating along the cut edges is exact.
+static void clipPolygon(std::vector<BakedVertex>& poly, bool alongX, float value, bool keepAbove,
+    std::vector<BakedVertex>& scratch) {
+    scratch.clear();
+    size_t n = poly.size();
+    for (size_t i = 0; i < n; ++i) {
+        const BakedVertex& a = poly[i];
+        const BakedVertex& b = poly[(i + 1) % n];
+        float da = (alongX ? a.x : a.z) - value;
+        float db = (alongX ? b.x : b.z) - value;
+        if (!keepAbove) { da = -da; db = -db; }
+        if (da >= 0.0f) scratch.push_back(a);
+        if ((da >= 0.0f) != (db >= 0.0f)) scratch.push_back(lerpVertex(a, b, da / (da - db)));
+    }
+    poly.swap(scratch);
+}
+
+static void appendVertex(BakedMesh& mesh, const BakedVertex& v) {
+    mesh.vertices.push_back(v);
+    mesh.batches.back().count++;
+}
+
+// ================================================================
+// Construction
+// ================================================================
+
+WorldChunks::WorldChunks()
+    : m_chunksX(0), m_chunksZ(0), m_chunkCells(8), m_chunkSize(8.0f),
+    m_originX(0.0f), m_originZ(0.0f), m_grid(nullptr),
+    m_loadRadius(48.0f), m_budgetBytes(16 * 1024 * 1024), m_uploadBudgetBytes(DEFAULT_UPLOAD_BUDGET),
+    m_residentBytes(0), m_pendingBytes(0), m_residentCount(0), m_requestedCount(0), m_generation(0),
+    m_inFlight(0)
+{
+}
+
+WorldChunks::~WorldChunks() {
+    // Cut jobs are dropped when the job system stops before exit; GL
+    // objects are released with the context
+}
+
+void WorldChunks::setChunkCells(int cells) {
+    m_chunkCells = std::max(1, std::min(MAX_CHUNK_CELLS, cells));
+}
+
+// ================================================================
+// Public API (GL thread)
+// ================================================================
+
+void WorldChunks::setSource(const std::shared_ptr<const ChunkSource>& source, const CollisionGrid* grid) {
+    unloadAll();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.clear();
+    }
+    ++m_generation; // Chunks still being cut are dropped when they come back
+    m_pendingBytes = 0;
+    m_requestedCount = 0;
+    m_chunks.clear();
+    m_chunksX = m_chunksZ = 0;
+    m_source = source;
+    m_grid = grid;
+    if (!source || !grid || grid->getWidth() == 0 || grid->getHeight() == 0) return;
+
+    m_chunkSize = m_chunkCells * grid->getCellSize();
+    m_originX = grid->getOriginX();
+    m_originZ = grid->getOriginZ();
+    m_chunksX = (grid->getWidth() + m_chunkCells - 1) / m_chunkCells;
+    m_chunksZ = (grid->getHeight() + m_chunkCells - 1) / m_chunkCells;
+    m_chunks.resize((size_t)m_chunksX * m_chunksZ);
+    for (int cz = 0; cz < m_chunksZ; ++cz) {
+        for (int cx = 0; cx < m_chunksX; ++cx) {
+            WorldChunk& c = m_chunks[(size_t)cz * m_chunksX + cx];
+            c.cx = cx;
+            c.cz = cz;
+            c.minX = m_originX + cx * m_chunkSize;
+            c.minZ = m_originZ + cz * m_chunkSize;
+            c.maxX = std::min(c.minX + m_chunkSize, m_originX + grid->getWorldWidth());
+            c.maxZ = std::min(c.minZ + m_chunkSize, m_originZ + grid->getWorldDepth());
+            c.resident = false;
+            c.requested = false;
+            c.vertexCount = 0;
+            memset(c.tile, 0, sizeof(c.tile));
+            c.bytes = c.expectedBytes = c.lastBytes = 0;
+            c.distance = 0.0f;
+        }
+    }
+    printf("WorldChunks: %dx%d chunks of %dx%d cells\n", m_chunksX, m_chunksZ, m_chunkCells, m_chunkCells);
+}
+
+void WorldChunks::queueRequest(int chunk) {
+    WorldChunk& c = m_chunks[chunk];
+    c.requested = true;
+    m_requestedCount++;
+
+    Request req;
+    req.generation = m_generation;
+    req.chunk = chunk;
+    req.minX = (c.cx == 0) ? -OPEN_BOUND : c.minX;
+    req.minZ = (c.cz == 0) ? -OPEN_BOUND : c.minZ;
+    req.maxX = (c.cx == m_chunksX - 1) ? OPEN_BOUND : c.maxX;
+    req.maxZ = (c.cz == m_chunksZ - 1) ? OPEN_BOUND : c.maxZ;
+    req.source = m_source;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlight++;
+    }
+    g_jobSystem.run("chunk cut", [this, req] {
+        Result res;
+        cut(req, res);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(std::move(res));
+            m_inFlight--;
+        }
+        m_done.notify_all();
+    });
+}
+
+void WorldChunks::update(float camX, float camZ) {
+    if (m_chunks.empty()) return;
+
+    // --- 1. Distance to every chunk; evict the ones left behind ---
+    for (auto& c : m_chunks) {
+        float dx = std::max(0.0f, std::max(c.minX - camX, camX - c.maxX));
+        float dz = std::max(0.0f, std::max(c.minZ - camZ, camZ - c.maxZ));
+        c.distance = sqrtf(dx * dx + dz * dz);
+        if (c.resident && c.distance > unloadRadius()) unload(c);
+    }
+
+    // --- 2. Budget: the farthest chunks go first (the closest one always stays) ---
+    while (m_residentBytes > m_budgetBytes && m_residentCount > 1 && evictFarthest(-1.0f)) {}
+
+    // --- 3. Request the missing chunks in range, closest first, while they fit ---
+    std::vector<int> wanted;
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        const WorldChunk& c = m_chunks[i];
+        if (!c.resident && !c.requested && c.distance <= m_loadRadius) wanted.push_back((int)i);
+    }
+    std::sort(wanted.begin(), wanted.end(), [this](int a, int b) {
+        return m_chunks[a].distance < m_chunks[b].distance;
+    });
+
+    for (int i : wanted) {
+        WorldChunk& c = m_chunks[i];
+        // A chunk evicted before keeps its size; a new one is guessed from the others
+        size_t expected = c.lastBytes ? c.lastBytes : (m_residentCount ? m_residentBytes / m_residentCount : 0);
+
+        // Make room by dropping chunks further away than this one
+        while (m_residentBytes + m_pendingBytes + expected > m_budgetBytes && evictFarthest(c.distance)) {}
+        bool first = (m_residentCount == 0 && m_requestedCount == 0);
+        if (!first && m_residentBytes + m_pendingBytes + expected > m_budgetBytes) break;
+
+        c.expectedBytes = expected;
+        m_pendingBytes += expected;
+        queueRequest(i);
+    }
+
+    // --- 4. Compile finished chunks, bounded per frame ---
+    size_t uploaded = 0;
+    while (true) {
+        Result res;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_results.empty()) break;
+            if (uploaded > 0 && uploaded + m_results.front().bytes > m_uploadBudgetBytes) break;
+            res = std::move(m_results.front());
+            m_results.pop_front();
+        }
+        uploaded += res.bytes;
+        upload(res);
+    }
+}
+
+void WorldChunks::flush(float camX, float camZ) {
+    update(camX, camZ);
+    while (true) {
+        std::deque<Result> ready;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this] { return !m_results.empty() || m_inFlight == 0; });
+            ready.swap(m_results);
+            if (ready.empty()) break;
+        }
+        for (auto& res : ready) upload(res);
+    }
+}
+
+void WorldChunks::upload(Result& res) {
+    if (res.generation != m_generation) return; // Cut from a replaced source
+    WorldChunk& c = m_chunks[res.chunk];
+    c.requested = false;
+    m_requestedCount--;
+    m_pendingBytes -= std::min(m_pendingBytes, c.expectedBytes);
+    if (c.distance > unloadRadius()) return; // The camera moved away meanwhile
+
+    // One list per source mesh, with the same state the modules' own lists set
+    c.lists.assign(res.meshes.size(), 0);
+    for (size_t m = 0; m < res.meshes.size(); ++m) {
+        const BakedMesh& mesh = res.meshes[m];
+        if (mesh.vertices.empty()) continue;
+        const ChunkSourceMesh& src = m_source->meshes[m];
+
+        GLuint id = glGenLists(1);
+        glNewList(id, GL_COMPILE);
+        glColor3f(1.0f, 1.0f, 1.0f);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        mesh.draw(src.textures.data(), (int)src.textures.size());
+        glEndList();
+        c.lists[m] = id;
+
+        char label[64];
+        sprintf_s(label, sizeof(label), "chunk %d,%d %s", c.cx, c.cz, src.label.c_str());
+        g_gpuMemory.trackDisplayList(id, "WorldChunks", label, (int)mesh.vertices.size());
+    }
+
+    c.objects.swap(res.objects);
+    c.vertexCount = res.vertexCount;
+    copyTile(c, 0, m_grid->getHeight() - 1);
+
+    c.bytes = res.bytes + sizeof(c.tile) + c.objects.size() * sizeof(ChunkObject);
+    c.lastBytes = c.bytes;
+    c.resident = true;
+    m_residentBytes += c.bytes;
+    m_residentCount++;
+}
+
+void WorldChunks::unload(WorldChunk& c) {
+    if (!c.resident) return;
+    for (GLuint id : c.lists) {
+        if (id == 0) continue;
+        g_gpuMemory.untrack(GPU_DISPLAY_LIST, id);
+        glDeleteLists(id, 1);
+    }
+    c.lists.clear();
+    c.objects.clear();
+    m_residentBytes -= c.bytes;
+    m_residentCount--;
+    c.bytes = 0;
+    c.resident = false;
+}
+
+void WorldChunks::unloadAll() {
+    for (auto& c : m_chunks) unload(c);
+}
+
+bool WorldChunks::evictFarthest(float beyond) {
+    WorldChunk* farthest = nullptr;
+    for (auto& c : m_chunks) {
+        if (c.resident && c.distance > beyond && (!farthest || c.distance > farthest->distance)) farthest = &c;
+    }
+    if (!farthest) return false;
+    unload(*farthest);
+    return true;
+}
+
+void WorldChunks::copyTile(WorldChunk& c, int z0, int z1) {
+    int x0 = c.cx * m_chunkCells;
+    int x1 = std::min(x0 + m_chunkCells, m_grid->getWidth()) - 1;
+    int rowStart = c.cz * m_chunkCells;
+    z0 = std::max(z0, rowStart);
+    z1 = std::min(z1, std::min(rowStart + m_chunkCells, m_grid->getHeight()) - 1);
+    for (int z = z0; z <= z1; ++z) {
+        uint64_t word = 0;
+        for (int x = x0; x <= x1; ++x) {
+            if (m_grid->get(x, z)) word |= (uint64_t)1 << (x - x0);
+        }
+        c.tile[z - rowStart] = word;
+    }
+}
+
+void WorldChunks::refreshTiles(int x0, int z0, int x1, int z1) {
+    if (m_chunks.empty()) return;
+    int cx0 = std::max(0, x0 / m_chunkCells), cx1 = std::min(m_chunksX - 1, x1 / m_chunkCells);
+    int cz0 = std::max(0, z0 / m_chunkCells), cz1 = std::min(m_chunksZ - 1, z1 / m_chunkCells);
+    for (int cz = cz0; cz <= cz1; ++cz) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            WorldChunk& c = m_chunks[(size_t)cz * m_chunksX + cx];
+            if (c.resident) copyTile(c, z0, z1);
+        }
+    }
+}
+
+bool WorldChunks::isChunkVisible(const WorldChunk& c) const {
+    float halfX = (c.maxX - c.minX) / 2.0f, halfZ = (c.maxZ - c.minZ) / 2.0f;
+    return g_visibility.isVisible(c.minX + halfX, c.minZ + halfZ, sqrtf(halfX * halfX + halfZ * halfZ));
+}
+
+bool WorldChunks::draw() const {
+    if (m_chunks.empty()) return false;
+
+    // A hole in the view is worse than drawing everything for a frame or two
+    for (const auto& c : m_chunks) {
+        if (!c.resident && c.distance <= m_loadRadius && isChunkVisible(c)) return false;
+    }
+    for (const auto& c : m_chunks) {
+        if (!c.resident || !isChunkVisible(c)) continue;
+        for (GLuint id : c.lists) {
+            if (id != 0) glCallList(id);
+        }
+    }
+    return true;
+}
+
+int WorldChunks::chunkIndexAt(float x, float z) const {
+    if (m_chunks.empty()) return -1;
+    int cx = (int)floorf((x - m_originX) / m_chunkSize);
+    int cz = (int)floorf((z - m_originZ) / m_chunkSize);
+    if (cx < 0 || cz < 0 || cx >= m_chunksX || cz >= m_chunksZ) return -1;
+    return cz * m_chunksX + cx;
+}
+
+const WorldChunk* WorldChunks::findResident(float x, float z) const {
+    int index = chunkIndexAt(x, z);
+    if (index < 0 || !m_chunks[index].resident) return nullptr;
+    return &m_chunks[index];
+}
+
+bool WorldChunks::isBlocked(float x, float z) const {
+    const WorldChunk* c = findResident(x, z);
+    if (!c) return true;
+    int cellX, cellZ;
+    if (!m_grid->worldToCell(x, z, cellX, cellZ)) return true;
+    int tx = cellX - c->cx * m_chunkCells;
+    int tz = cellZ - c->cz * m_chunkCells;
+    return (c->tile[tz] >> tx) & 1;
+}
+
+void WorldChunks::printReport() const {
+    printf("\n--- World Chunk Report ---\n");
+    printf("  Chunk   State      Dist   Vertices  Objects      Bytes\n");
+    for (const auto& c : m_chunks) {
+        if (!c.resident && !c.requested) continue;
+        printf("  %2d,%-2d   %-9s  %5.1f   %8d  %7d  %7.1f KB\n",
+            c.cx, c.cz, c.resident ? "resident" : "loading", c.distance,
+            c.vertexCount, (int)c.objects.size(), c.bytes / 1024.0);
+    }
+    printf("%d of %d chunks resident: %.1f KB of %.1f KB budget\n\n",
+        m_residentCount, (int)m_chunks.size(), m_residentBytes / 1024.0, m_budgetBytes / 1024.0);
+}
+
+// ================================================================
+// Cut jobs (worker threads)
+// ================================================================
+
+void WorldChunks::cut(const Request& req, Result& out) {
+    const ChunkSource& src = *req.source;
+    out.generation = req.generation;
+    out.chunk = req.chunk;
+    out.meshes.assign(src.meshes.size(), BakedMesh());
+    out.objects.clear();
+    out.vertexCount = 0;
+
+    std::vector<BakedVertex> poly, scratch;
+    for (size_t m = 0; m < src.meshes.size(); ++m) {
+        const BakedMesh& in = src.meshes[m].mesh;
+        BakedMesh& dst = out.meshes[m];
+
+        for (const BakedBatch& b : in.batches) {
+            bool started = false;
+            for (int q = b.first; q + 4 <= b.first + b.count; q += 4) {
+                const BakedVertex* v = &in.vertices[q];
+                float minX = std::min(std::min(v[0].x, v[1].x), std::min(v[2].x, v[3].x));
+                float maxX = std::max(std::max(v[0].x, v[1].x), std::max(v[2].x, v[3].x));
+                float minZ = std::min(std::min(v[0].z, v[1].z), std::min(v[2].z, v[3].z));
+                float maxZ = std::max(std::max(v[0].z, v[1].z), std::max(v[2].z, v[3].z));
+                if (!overlapsSpan(minX, maxX, req.minX, req.maxX) || !overlapsSpan(minZ, maxZ, req.minZ, req.maxZ)) continue;
+
+                if (!started) {
+                    dst.beginBatch(b.textureSlot);
+                    started = true;
+                }
+
+                // Most quads are small and lie inside one chunk
+                bool cutX = (maxX - minX >= FLAT_EPSILON) && (minX < req.minX || maxX > req.maxX);
+                bool cutZ = (maxZ - minZ >= FLAT_EPSILON) && (minZ < req.minZ || maxZ > req.maxZ);
+                if (!cutX && !cutZ) {
+                    for (int i = 0; i < 4; ++i) appendVertex(dst, v[i]);
+                    continue;
+                }
+
+                poly.assign(v, v + 4);
+                if (cutX && minX < req.minX) clipPolygon(poly, true, req.minX, true, scratch);
+                if (cutX && maxX > req.maxX) clipPolygon(poly, true, req.maxX, false, scratch);
+                if (cutZ && minZ < req.minZ) clipPolygon(poly, false, req.minZ, true, scratch);
+                if (cutZ && maxZ > req.maxZ) clipPolygon(poly, false, req.maxZ, false, scratch);
+
+                // Back to quads as a fan (a leftover triangle repeats its last vertex)
+                int n = (int)poly.size();
+                for (int i = 1; i + 1 < n; i += 2) {
+                    appendVertex(dst, poly[0]);
+                    appendVertex(dst, poly[i]);
+                    appendVertex(dst, poly[i + 1]);
+                    appendVertex(dst, poly[std::min(i + 2, n - 1)]);
+                }
+            }
+            if (started && dst.batches.back().count == 0) dst.batches.pop_back();
+        }
+        out.vertexCount += (int)dst.vertices.size();
+    }
+
+    for (const ChunkObject& o : src.objects) {
+        if (o.x >= req.minX && o.x < req.maxX && o.z >= req.minZ && o.z < req.maxZ) out.objects.push_back(o);
+    }
+    out.bytes = (size_t)out.vertexCount * GpuMemoryTracker::DISPLAY_LIST_BYTES_PER_VERTEX;
+}
+
+// ================================================================
+// Benchmark
+// ================================================================
+
+void WorldChunks::runBenchmark(int size) {
+    typedef std::chrono::steady_clock Clock;
+    if (size < 16) size = 16;
+
+    // A venue of size x size cells: one floor quad, walls every few cells, pillars
+    std::shared_ptr<ChunkSource> source = std::make_shared<ChunkSource>();
+    source->meshes.resize(2);
+    source->meshes[0].label = "floor";
+    source->meshes[1].label = "walls";
+    float half = size / 2.0f;
+    BakedMesh& floor = source->meshes[0].mesh;
+    floor.beginBatch(0);
+    floor.addVertex(-half, 0.0f, -half, 0, 1, 0, 0, 0);
+    floor.addVertex(half, 0.0f, -half, 0, 1, 0, size / 4.0f, 0);
+    floor.addVertex(half, 0.0f, half, 0, 1, 0, size / 4.0f, size / 4.0f);
+    floor.addVertex(-half, 0.0f, half, 0, 1, 0, 0, size / 4.0f);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> pos(-half, half);
+    std::uniform_real_distribution<float> length(2.0f, 20.0f);
+    BakedMesh& walls = source->meshes[1].mesh;
+    walls.beginBatch(0);
+    int wallCount = size * size / 40;
+    for (int i = 0; i < wallCount; ++i) {
+        float x = pos(rng), z = pos(rng), len = length(rng);
+        if (i % 3 == 0) walls.addBox(x, 2.5f, z, 0.5f, 5.0f, 0.5f, false);       // Pillar
+        else if (i % 3 == 1) walls.addBox(x, 2.5f, z, len, 5.0f, 0.5f, false);   // Along X
+        else walls.addBox(x, 2.5f, z, 0.5f, 5.0f, len, false);                   // Along Z
+    }
+    for (int i = 0; i < size * size / 20; ++i) {
+        ChunkObject o = { i % CHUNK_OBJECT_KIND_COUNT, i, pos(rng), pos(rng) };
+        source->objects.push_back(o);
+    }
+    int sourceVertices = (int)(floor.vertices.size() + walls.vertices.size());
+    printf("WorldChunks benchmark: %dx%d cells, %d source vertices, %d objects\n",
+        size, size, sourceVertices, (int)source->objects.size());
+
+    const size_t uploadBudget = DEFAULT_UPLOAD_BUDGET;
+    const int chunkSizes[] = { 8, 16, 32, 64 };
+    for (int cells : chunkSizes) {
+        if (cells > size) break;
+        int chunks = (size + cells - 1) / cells;
+        double totalMs = 0.0, worstMs = 0.0;
+        long long vertices = 0;
+        size_t largest = 0;
+        for (int cz = 0; cz < chunks; ++cz) {
+            for (int cx = 0; cx < chunks; ++cx) {
+                Request req;
+                req.generation = 0;
+                req.chunk = cz * chunks + cx;
+                req.minX = (cx == 0) ? -OPEN_BOUND : -half + cx * cells;
+                req.minZ = (cz == 0) ? -OPEN_BOUND : -half + cz * cells;
+                req.maxX = (cx == chunks - 1) ? OPEN_BOUND : -half + (cx + 1) * cells;
+                req.maxZ = (cz == chunks - 1) ? OPEN_BOUND : -half + (cz + 1) * cells;
+                req.source = source;
+
+                Result res;
+                Clock::time_point t0 = Clock::now();
+                cut(req, res);
+                double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+                totalMs += ms;
+                worstMs = std::max(worstMs, ms);
+                vertices += res.vertexCount;
+                largest = std::max(largest, res.bytes);
+            }
+        }
+        int count = chunks * chunks;
+        printf("  %2d cells: %5d chunks, cut %.3f ms avg / %.3f ms worst, %.1f KB avg / %.1f KB largest upload"
+            " (%d per frame at %d KB), %.1f%% extra vertices from clipping\n",
+            cells, count, totalMs / count, worstMs,
+            vertices * GpuMemoryTracker::DISPLAY_LIST_BYTES_PER_VERTEX / 1024.0 / count, largest / 1024.0,
+            largest > 0 ? std::max(1, (int)(uploadBudget / largest)) : count, (int)(uploadBudget / 1024),
+            100.0 * (vertices - sourceVertices) / sourceVertices);
+    }
+}
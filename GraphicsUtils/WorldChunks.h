@@ -0,0 +1,234 @@
+#pragma once
+#include <glut.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include "BakedMesh.h"
+#include "CollisionGrid.h"
+
+// ================================================================
+// WorldChunks
+//
+// The static world cut into square chunks of the collision grid. Each
+// chunk has its own geometry (one display list per source mesh), its
+// collision tile (its cells of the grid) and the list of objects standing
+// in it. Chunks are streamed around the Camera the way TextureStreamer
+// streams mips:
+//  - Chunks within the load radius are requested, closest first.
+//  - "chunk cut" jobs on g_jobSystem cut them out of the source meshes
+//    (quads crossing a chunk edge are clipped to it) and bin the objects.
+//  - The GL thread compiles finished chunks in update() under a
+//    per-frame upload budget, so a burst of loads never stalls a frame.
+//  - Chunks beyond the unload radius are evicted, and while resident
+//    memory is over the budget the farthest chunks go first.
+//
+// The source is a snapshot of the level's static meshes and object
+// positions; setSource() replaces it (layout reload, floor change) and
+// drops every chunk cut from the old one. Collision tiles are copied from
+// the live grid when a chunk is uploaded and kept in step through
+// refreshTiles(), so opened doors and pushed crates show up in them.
+// ================================================================
+
+// Chunk edge in grid cells; a tile row is one 64-bit word
+static const int MAX_CHUNK_CELLS = 64;
+
+enum ChunkObjectKind {
+    CHUNK_OBJECT_BOOK = 0,
+    CHUNK_OBJECT_DOOR,
+    CHUNK_OBJECT_DECORATION,
+    CHUNK_OBJECT_KIND_COUNT
+};
+
+/**
+ * @brief An object of a module, by its index in that module.
+ */
+struct ChunkObject {
+    int kind;
+    int index;
+    float x, z;
+};
+
+/**
+ * @brief One module's static geometry with the GL texture of each slot.
+ */
+struct ChunkSourceMesh {
+    std::string label;             // Shown in the GPU memory report, e.g. "walls"
+    BakedMesh mesh;
+    std::vector<GLuint> textures;
+};
+
+struct ChunkSource {
+    std::vector<ChunkSourceMesh> meshes;
+    std::vector<ChunkObject> objects;
+};
+
+/**
+ * @brief Book-keeping for a single chunk.
+ */
+struct WorldChunk {
+    int cx, cz;
+    float minX, minZ, maxX, maxZ;
+
+    bool resident;
+    bool requested;
+    std::vector<GLuint> lists;     // One per source mesh (0 = nothing of it here)
+    int vertexCount;
+    uint64_t tile[MAX_CHUNK_CELLS]; // Row z of the tile, bit x = cell blocked
+    std::vector<ChunkObject> objects;
+
+    size_t bytes;                  // Resident: lists (estimate) + tile + objects
+    size_t expectedBytes;          // Guess used while requested
+    size_t lastBytes;              // Size the last time it was resident (0 = never)
+    float distance;                // From the camera at the last update
+};
+
+class WorldChunks {
+public:
+    WorldChunks();
+    ~WorldChunks();
+
+    /**
+     * @brief Sets the chunk edge in grid cells (1..MAX_CHUNK_CELLS).
+     * Takes effect on the next setSource().
+     */
+    void setChunkCells(int cells);
+
+    /**
+     * @brief Chunks closer than this to the camera are loaded; they are
+     * evicted once a chunk edge further away. Should cover the view
+     * distance, or far chunks that are visible are simply not drawn.
+     */
+    void setLoadRadius(float radius) { m_loadRadius = radius; }
+
+    /**
+     * @brief Sets the memory budget for resident chunks, in bytes.
+     */
+    void setBudget(size_t bytes) { m_budgetBytes = bytes; }
+    size_t getBudget() const { return m_budgetBytes; }
+
+    /**
+     * @brief Sets how many bytes of geometry may be compiled per update() call.
+     */
+    void setUploadBudget(size_t bytes) { m_uploadBudgetBytes = bytes; }
+
+    /**
+     * @brief Replaces the world: chunks are laid over 'grid' (which must
+     * outlive this object) and cut from 'source'. Every resident chunk is
+     * dropped. A null source empties the world.
+     */
+    void setSource(const std::shared_ptr<const ChunkSource>& source, const CollisionGrid* grid);
+
+    /**
+     * @brief Requests, evicts and uploads chunks for the camera position.
+     * Call once per frame from idle().
+     */
+    void update(float camX, float camZ);
+
+    /**
+     * @brief Blocks until every chunk within the load radius is resident.
+     * Used when a world is set up so the first frame is complete.
+     */
+    void flush(float camX, float camZ);
+
+    /**
+     * @brief Re-copies the collision tiles of resident chunks over the cells
+     * [x0..x1] x [z0..z1]. Call from the grid's change listener.
+     */
+    void refreshTiles(int x0, int z0, int x1, int z1);
+
+    /**
+     * @brief Draws the resident chunks that pass g_visibility.
+     * @return False (and draws nothing) if a visible chunk within the load
+     * radius is not resident yet; the caller then draws the full geometry.
+     */
+    bool draw() const;
+
+    /**
+     * @brief Cell state from the resident tiles. Cells of chunks that are
+     * not resident (or outside the world) count as blocked.
+     */
+    bool isBlocked(float x, float z) const;
+
+    /**
+     * @brief Resident chunk at a world position, or nullptr.
+     */
+    const WorldChunk* findResident(float x, float z) const;
+
+    int getChunkCount() const { return (int)m_chunks.size(); }
+    int getResidentCount() const { return m_residentCount; }
+    size_t getResidentBytes() const { return m_residentBytes; }
+
+    /**
+     * @brief Prints every chunk's state and size to the console.
+     */
+    void printReport() const;
+
+    /**
+     * @brief Times the loader's work (cutting chunks out of a large
+     * generated world) and prints per-chunk cost and upload size.
+     * @param size World edge in grid cells.
+     */
+    static void runBenchmark(int size);
+
+private:
+    struct Request {
+        unsigned int generation;
+        int chunk;
+        float minX, minZ, maxX, maxZ;  // Clip bounds (open at the world's edges)
+        std::shared_ptr<const ChunkSource> source;
+    };
+
+    struct Result {
+        unsigned int generation;
+        int chunk;
+        std::vector<BakedMesh> meshes;  // One per source mesh
+        std::vector<ChunkObject> objects;
+        int vertexCount;
+        size_t bytes;                   // Geometry bytes to compile
+    };
+
+    // Cut jobs
+    static void cut(const Request& req, Result& out);
+
+    // GL thread
+    void queueRequest(int chunk);
+    void upload(Result& res);
+    void unload(WorldChunk& c);
+    void unloadAll();
+    bool evictFarthest(float beyond);  // Farthest resident chunk further than 'beyond'
+    void copyTile(WorldChunk& c, int z0, int z1);
+    bool isChunkVisible(const WorldChunk& c) const;
+    int chunkIndexAt(float x, float z) const;
+    float unloadRadius() const { return m_loadRadius + m_chunkSize; }
+
+    std::vector<WorldChunk> m_chunks;
+    int m_chunksX, m_chunksZ;
+    int m_chunkCells;
+    float m_chunkSize;             // World units
+    float m_originX, m_originZ;
+    const CollisionGrid* m_grid;
+    std::shared_ptr<const ChunkSource> m_source;
+
+    float m_loadRadius;
+    size_t m_budgetBytes;
+    size_t m_uploadBudgetBytes;
+    size_t m_residentBytes;
+    size_t m_pendingBytes;         // Expected size of the requested chunks
+    int m_residentCount;
+    int m_requestedCount;
+    unsigned int m_generation;     // Bumped by setSource(); older results are dropped
+
+    // Shared with the cut jobs
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+    std::deque<Result> m_results;
+    int m_inFlight;                // Cut jobs not finished yet
+};
+
+// Chunks of the floor the player is on
+extern WorldChunks g_worldChunks;
@@ -1,6 +1,9 @@
 #include "pch.h" // Must be first
 #include "InsideWall.h"
 #include "GraphicsUtils.h" 
+#include "GpuMemory.h"
+#include "Footprint.h"
+#include "CollisionWorld.h"
 #include <math.h>
 #include <stdio.h>
 
@@ -17,59 +20,41 @@ void InsideWall::addWall(float startX, float startZ, float endX, float endZ, flo
     w.thickness = thickness;
     w.height = m_height;
     m_walls.push_back(w);
+}
 
-    // ==========================================================
-    // FIXED COLLISION LOGIC: Create a Thicker Barrier
-    // ==========================================================
+void InsideWall::clear() {
+    m_walls.clear();
+}
 
-    // 1. Calculate the actual boundaries of the wall (Bounding Box)
-    // We expand the area by half the thickness in all directions.
-    float halfThick = thickness / 2.0f;
-
-    // Find min and max for the LINE part
-    float lineMinX = (startX < endX) ? startX : endX;
-    float lineMaxX = (startX < endX) ? endX : startX;
-    float lineMinZ = (startZ < endZ) ? startZ : endZ;
-    float lineMaxZ = (startZ < endZ) ? endZ : startZ;
-
-    // Expand by thickness (so the collision is wide enough)
-    // We add a tiny extra bit (+0.1f) to ensure we catch the border grid cells
-    float boxMinX = lineMinX - halfThick;
-    float boxMaxX = lineMaxX + halfThick;
-    float boxMinZ = lineMinZ - halfThick;
-    float boxMaxZ = lineMaxZ + halfThick;
-
-    // 2. Loop through this "Rectangle" on the floor
-    // We step by 0.5f to ensure every grid cell inside the wall is caught
-    for (float x = boxMinX; x <= boxMaxX; x += 0.5f) {
-        for (float z = boxMinZ; z <= boxMaxZ; z += 0.5f) {
-
-            int gridX, gridZ;
-            // If this point is on the grid, BLOCK IT
-            if (worldToGrid(x, z, gridX, gridZ)) {
-                addBlockGridBox(gridX, gridZ);
-            }
-        }
+void InsideWall::applyCollision(CollisionGrid& grid) {
+    for (const auto& w : m_walls) {
+        stampCollision(w, grid);
     }
-
-    printf("Added Wall Collision: X[%.1f to %.1f] Z[%.1f to %.1f]\n", boxMinX, boxMaxX, boxMinZ, boxMaxZ);
 }
 
-void InsideWall::build(GLuint textureID) {
-    m_textureID = textureID;
+void InsideWall::addColliders() {
+    for (const auto& w : m_walls) {
+        g_collisionWorld.addSegment(w.startX, w.startZ, w.endX, w.endZ, w.thickness, COLLIDER_WALL);
+    }
+}
 
-    if (m_displayListID != 0) glDeleteLists(m_displayListID, 1);
-    m_displayListID = glGenLists(1);
+void InsideWall::stampCollision(const WallSegment& w, CollisionGrid& grid) {
+    // ==========================================================
+    // COLLISION: The wall's exact footprint
+    // ==========================================================
+    // A box along the segment, as thick as the wall. The ends extend half
+    // the thickness past both end points so walls meeting at a corner
+    // leave no gap. Works for walls at any angle.
+    int cells = rasterizeFootprintSegment(w.startX, w.startZ, w.endX, w.endZ, w.thickness, true, grid);
 
-    glNewList(m_displayListID, GL_COMPILE);
+    printf("Added Wall Collision: (%.1f, %.1f) to (%.1f, %.1f), %d cells\n", w.startX, w.startZ, w.endX, w.endZ, cells);
+}
 
-    // Bind Texture
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, m_textureID);
-    glColor3f(1.0f, 1.0f, 1.0f);
+void InsideWall::bakeGeometry(BakedMesh& out) const {
+    out.clear();
+    out.beginBatch(0);
 
     for (const auto& wall : m_walls) {
-        // Visual Drawing Logic (Unchanged)
         float centerX = (wall.startX + wall.endX) / 2.0f;
         float centerZ = (wall.startZ + wall.endZ) / 2.0f;
 
@@ -80,30 +65,29 @@ void InsideWall::build(GLuint textureID) {
         if (width > depth) { depth = wall.thickness; }
         else { width = wall.thickness; }
 
-        glPushMatrix();
-        glTranslatef(centerX, wall.height / 2.0f, centerZ);
-        glScalef(width, wall.height, depth);
-
-        // Simple textured box 
-        float s = 0.5f;
-        glBegin(GL_QUADS);
-        // Front
-        glNormal3f(0, 0, 1); glTexCoord2f(0, 0); glVertex3f(-s, -s, s); glTexCoord2f(1, 0); glVertex3f(s, -s, s); glTexCoord2f(1, 1); glVertex3f(s, s, s); glTexCoord2f(0, 1); glVertex3f(-s, s, s);
-        // Back
-        glNormal3f(0, 0, -1); glTexCoord2f(0, 0); glVertex3f(s, -s, -s); glTexCoord2f(1, 0); glVertex3f(-s, -s, -s); glTexCoord2f(1, 1); glVertex3f(-s, s, -s); glTexCoord2f(0, 1); glVertex3f(s, s, -s);
-        // Left
-        glNormal3f(-1, 0, 0); glTexCoord2f(0, 0); glVertex3f(-s, -s, -s); glTexCoord2f(1, 0); glVertex3f(-s, -s, s); glTexCoord2f(1, 1); glVertex3f(-s, s, s); glTexCoord2f(0, 1); glVertex3f(-s, s, -s);
-        // Right
-        glNormal3f(1, 0, 0); glTexCoord2f(0, 0); glVertex3f(s, -s, s); glTexCoord2f(1, 0); glVertex3f(s, -s, -s); glTexCoord2f(1, 1); glVertex3f(s, s, -s); glTexCoord2f(0, 1); glVertex3f(s, s, s);
-        // Top
-        glNormal3f(0, 1, 0); glTexCoord2f(0, 0); glVertex3f(-s, s, s); glTexCoord2f(1, 0); glVertex3f(s, s, s); glTexCoord2f(1, 1); glVertex3f(s, s, -s); glTexCoord2f(0, 1); glVertex3f(-s, s, -s);
-        glEnd();
-
-        glPopMatrix();
+        // Simple textured box (the bottom sits on the floor and is never seen)
+        out.addBox(centerX, wall.height / 2.0f, centerZ, width, wall.height, depth, false);
     }
+}
+
+void InsideWall::build(GLuint textureID, const BakedMesh* baked) {
+    m_textureID = textureID;
+
+    // Reuse cached geometry when we have it, otherwise generate it
+    if (baked) m_mesh = *baked;
+    else bakeGeometry(m_mesh);
 
-    glDisable(GL_TEXTURE_2D);
+    if (m_displayListID != 0) {
+        glDeleteLists(m_displayListID, 1);
+        g_gpuMemory.untrack(GPU_DISPLAY_LIST, m_displayListID);
+    }
+    m_displayListID = glGenLists(1);
+
+    glNewList(m_displayListID, GL_COMPILE);
+    m_mesh.draw(&m_textureID, 1);
     glEndList();
+
+    g_gpuMemory.trackDisplayList(m_displayListID, "InsideWall", "walls", (int)m_mesh.vertices.size());
 }
 
 void InsideWall::draw() {
@@ -4,6 +4,9 @@
 #include "pch.h"
 #include <vector>
 #include <glut.h> 
+#include "BakedMesh.h"
+
+class CollisionGrid;
 
 // Structure to define a single wall segment
 struct WallSegment {
@@ -17,12 +20,32 @@ class InsideWall {
 public:
     InsideWall(float height);
 
+    // Height of the walls added from now on (the room height changed)
+    void setHeight(float height) { m_height = height; }
+
     // Add a wall from point A to point B
     // thickness: how thick the wall is (usually 0.5 or 1.0)
     void addWall(float startX, float startZ, float endX, float endZ, float thickness);
 
     // Call this AFTER adding all walls to generate the Display List
-    void build(GLuint textureID);
+    // baked: geometry from the world cache (skips generating it), or nullptr
+    void build(GLuint textureID, const BakedMesh* baked = nullptr);
+
+    // Generates the wall geometry on the CPU (no GL calls)
+    void bakeGeometry(BakedMesh& out) const;
+
+    // Geometry used by the last build() (saved into the world cache)
+    const BakedMesh& getMesh() const { return m_mesh; }
+
+    // Removes all walls (their grid cells stay blocked until the grid is rebuilt)
+    void clear();
+
+    // Blocks the cells of every wall in 'grid' (the live grid or a scratch one;
+    // not needed when a compiled level brings its own grid)
+    void applyCollision(CollisionGrid& grid);
+
+    // Adds every wall to g_collisionWorld (exact swept collision)
+    void addColliders();
 
     // Draw the walls
     void draw();
@@ -35,4 +58,8 @@ private:
     GLuint m_displayListID;
 
     std::vector<WallSegment> m_walls;
+    BakedMesh m_mesh;
+
+    // Blocks the grid cells covered by one wall
+    void stampCollision(const WallSegment& w, CollisionGrid& grid);
 };
\ No newline at end of file
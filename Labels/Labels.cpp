@@ -24,6 +24,18 @@ void Labels::onWindowResize(int w, int h) {
     m_windowHeight = (h == 0) ? 1 : h;
 }
 
+void Labels::setDeveloperStats(const char* text) {
+    m_devStats = text ? text : "";
+}
+
+void Labels::setCenterMessage(const char* message) {
+    m_centerMessage = message ? message : "";
+}
+
+void Labels::setActionHint(const char* message) {
+    m_actionHint = message ? message : "";
+}
+
 void Labels::toggleHelp() {
     m_showHelp = !m_showHelp;
 }
@@ -86,6 +98,10 @@ static void drawBackgroundBox(float x, float y, float w, float h) {
 }
 
 void Labels::draw(bool isDeveloperMode, float camX, float camY, float camZ) {
+    // Interaction prompts (under the panels)
+    if (!m_centerMessage.empty()) drawCenterMessage(m_centerMessage.c_str());
+    if (!m_actionHint.empty()) drawActionHint(m_actionHint.c_str());
+
     // Setup 2D Orthographic View
     glMatrixMode(GL_PROJECTION);
     glPushMatrix();
@@ -119,6 +135,21 @@ void Labels::draw(bool isDeveloperMode, float camX, float camY, float camZ) {
         drawBackgroundBox(boxX, boxY, boxWidth, boxHeight);
         glColor3f(1.0f, 1.0f, 1.0f);
         renderText(boxX + (padding / 2), boxY - 20, coordBuffer);
+
+        // --- Developer stats (below the coordinates) ---
+        if (!m_devStats.empty()) {
+            int statsLines = 1;
+            for (char ch : m_devStats) if (ch == '\n') statsLines++;
+
+            float statsWidth = getTextWidth(m_devStats.c_str()) + padding;
+            float statsHeight = (statsLines * m_lineHeight) + 13.0f;
+            float statsX = m_windowWidth - statsWidth - rightMargin;
+            float statsY = boxY - boxHeight - 10.0f;
+
+            drawBackgroundBox(statsX, statsY, statsWidth, statsHeight);
+            glColor3f(0.6f, 1.0f, 1.0f);
+            renderText(statsX + (padding / 2), statsY - 20, m_devStats.c_str());
+        }
     }
 
     // ============================================================
@@ -142,6 +173,11 @@ void Labels::draw(bool isDeveloperMode, float camX, float camY, float camZ) {
             lines.push_back({ "Shift      : Move Faster", 1.0f, 1.0f, 1.0f });
             lines.push_back({ "T          : Toggle Axes", 1.0f, 1.0f, 1.0f });
             lines.push_back({ "C          : Toggle Coords", 1.0f, 1.0f, 1.0f });
+            lines.push_back({ "R          : Texture Report", 1.0f, 1.0f, 1.0f });
+            lines.push_back({ "M          : GPU Memory Report", 1.0f, 1.0f, 1.0f });
+            lines.push_back({ "K          : Frame Pacing Report", 1.0f, 1.0f, 1.0f });
+            lines.push_back({ "J          : World Chunk Report", 1.0f, 1.0f, 1.0f });
+            lines.push_back({ "L          : Job Timing Report", 1.0f, 1.0f, 1.0f });
             lines.push_back({ "P          : Switch to Game Mode", 1.0f, 1.0f, 1.0f });
         }
         else {
@@ -153,6 +189,7 @@ void Labels::draw(bool isDeveloperMode, float camX, float camY, float camZ) {
             lines.push_back({ "Shift      : Sprint", 1.0f, 1.0f, 1.0f });
             lines.push_back({ "F          : Flashlight", 1.0f, 1.0f, 1.0f });
             lines.push_back({ "E          : Interact", 1.0f, 1.0f, 1.0f });
+            lines.push_back({ "G          : Guide Me", 1.0f, 1.0f, 1.0f });
             lines.push_back({ "", 1.0f, 1.0f, 1.0f });
             lines.push_back({ "P          : Switch to Developer", 1.0f, 1.0f, 1.0f });
         }
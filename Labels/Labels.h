@@ -2,6 +2,7 @@
 
 // We get <glut.h> from our precompiled header
 #include "pch.h"
+#include <string>
 
 class Labels {
 public:
@@ -33,6 +34,24 @@ public:
      */
     void drawActionHint(const char* message);
 
+    /**
+     * @brief Sets the center message drawn by draw() until it is changed.
+     * @param message The text, or an empty string for none.
+     */
+    void setCenterMessage(const char* message);
+
+    /**
+     * @brief Sets the action hint drawn by draw() until it is changed.
+     * @param message The hint text, or an empty string for none.
+     */
+    void setActionHint(const char* message);
+
+    /**
+     * @brief Sets extra developer stats (multi-line) shown under the coordinates panel.
+     * @param text The stats text, or an empty string to hide the panel.
+     */
+    void setDeveloperStats(const char* text);
+
     /**
      * @brief Call this from your keyboard() function when Tab is pressed.
      */
@@ -57,6 +76,9 @@ private:
 
     // --- State ---
     bool m_showHelp; // Tracks if the Tab menu is open
+    std::string m_devStats; // Extra lines for the developer HUD
+    std::string m_centerMessage; // Set by setCenterMessage()
+    std::string m_actionHint;    // Set by setActionHint()
 
     // --- Window Info ---
     int m_windowWidth;
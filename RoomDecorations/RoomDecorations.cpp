@@ -3,7 +3,10 @@
 #include "GraphicsUtils.h" 
 #include <math.h>
 #include <stdio.h>
-#include <SOIL2.h>
+#include "TextureStreamer.h"
+#include "Visibility.h"
+#include "CollisionWorld.h"
+#include "RigidBodies.h"
 
 
 // PI constant for round calculations
@@ -11,36 +14,134 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+// Bounding floor footprint of each DecorType, measured from its draw function
+// { halfWidth, halfDepth, offsetX, offsetZ } in the object's unrotated space
+static const FootprintBox DECOR_FOOTPRINTS[DECOR_TYPE_COUNT] = {
+    { 0.0f,  0.0f,   0.0f, 0.0f },    // 0: unused
+    { 0.30f, 0.30f,  0.0f, 0.0f },    // DECOR_CHAIR: 0.6 x 0.6 seat, back inside it
+    { 0.80f, 0.80f,  0.0f, 0.0f },    // DECOR_TABLE: round top, radius 0.8
+    { 0.80f, 0.40f,  0.0f, 0.0f },    // DECOR_CUPBOARD: 1.6 wide top, doors and handles in front
+    { 0.76f, 1.16f,  0.0f, 0.0f },    // DECOR_BED: 1.4 x 2.2 frame plus corner posts
+    { 0.75f, 0.28f,  0.0f, 0.0f },    // DECOR_RACK: shelves 1.5 x 0.55
+    { 0.40f, 0.40f,  0.0f, 0.0f },    // DECOR_FLOOR_LAMP: shade radius 0.4
+    { 2.00f, 0.48f,  0.0f, -0.02f },  // DECOR_SOFA: 2.4 sofa with a side table at each end
+    { 0.80f, 0.34f,  0.0f, 0.08f },   // DECOR_TV_UNIT: 1.6 x 0.5 plus the console in front
+    { 0.70f, 0.38f,  0.0f, 0.0f },    // DECOR_DESK: 1.4 x 0.7 top, drawers stick out
+    { 0.48f, 0.48f,  0.0f, 0.0f },    // DECOR_PLANT: saucer radius 0.32 scaled by 1.5 (leaves are overhead)
+    { 0.50f, 0.50f,  0.0f, 0.0f },    // DECOR_CRATE: 1 x 1
+};
+
+// Round on the floor (table pedestal and top, lamp base, plant pot): the
+// footprint is the same at every rotation, so it is stamped unrotated
+// instead of as a rotated square that reaches ~41% further diagonally
+static bool isRound(int type) {
+    return type == DECOR_TABLE || type == DECOR_FLOOR_LAMP || type == DECOR_PLANT;
+}
+
+static float footprintRotation(int type, float rotation) {
+    return isRound(type) ? 0.0f : rotation;
+}
+
+// Height of each DecorType's top surface (what the player can stand on),
+// measured from its draw function. Small things on top (teapot, monitor,
+// bed posts) are left out.
+static const float DECOR_HEIGHTS[DECOR_TYPE_COUNT] = {
+    0.0f,     // 0: unused
+    2.10f,    // DECOR_CHAIR: backrest
+    1.26f,    // DECOR_TABLE: top
+    3.45f,    // DECOR_CUPBOARD: crown
+    0.90f,    // DECOR_BED: mattress and blanket
+    3.00f,    // DECOR_RACK: posts
+    2.90f,    // DECOR_FLOOR_LAMP: shade
+    2.10f,    // DECOR_SOFA: backrest
+    2.18f,    // DECOR_TV_UNIT: TV on the console
+    1.20f,    // DECOR_DESK: top
+    2.20f,    // DECOR_PLANT: leaves
+    0.90f,    // DECOR_CRATE: lid
+};
+
+// Crates weigh this much (the player pushes with infinite mass, so this
+// only matters when crates push each other)
+static const float CRATE_MASS = 20.0f;
+
+const FootprintBox* RoomDecorations::getFootprint(int type) {
+    if (type <= 0 || type >= DECOR_TYPE_COUNT) return nullptr;
+    return &DECOR_FOOTPRINTS[type];
+}
+
 RoomDecorations::RoomDecorations()
-    : m_texWood(0), m_texMetal(0)
+    : m_renderAlpha(1.0f), m_texWood(0), m_texMetal(0)
 {
 }
 
+RoomDecorations::~RoomDecorations() {
+    g_rigidBodies.removeBodies(this);
+}
+
 void RoomDecorations::addDecoration(int type, float x, float z, float rotation) {
     DecorInstance d;
     d.type = type;
     d.x = x;
     d.z = z;
     d.rotation = rotation;
+    d.body = -1;
+    if (type == DECOR_CRATE) {
+        const FootprintBox& box = DECOR_FOOTPRINTS[DECOR_CRATE];
+        d.body = g_rigidBodies.addBox(x, z, rotation, box.halfWidth, box.halfDepth, CRATE_MASS, this);
+    }
     m_objects.push_back(d);
 
+    // Stream decoration textures at full detail only when the player is close
+    g_textureStreamer.addAnchor(m_texWood, x, z, 1.0f, this);
+    g_textureStreamer.addAnchor(m_texMetal, x, z, 1.0f, this);
+
     printf("Decoration (Type %d) added at (%.1f, %.1f).\n", type, x, z);
 }
 
+void RoomDecorations::clear() {
+    m_objects.clear();
+    g_textureStreamer.removeAnchors(this);
+    g_rigidBodies.removeBodies(this);
+}
+
+void RoomDecorations::applyCollision(CollisionGrid& grid) {
+    for (const auto& obj : m_objects) {
+        const FootprintBox* footprint = getFootprint(obj.type);
+        if (footprint && obj.body < 0) rasterizeFootprintBox(obj.x, obj.z, footprintRotation(obj.type, obj.rotation), *footprint, true, grid);
+    }
+}
+
+void RoomDecorations::addColliders() {
+    for (const auto& obj : m_objects) {
+        const FootprintBox* footprint = getFootprint(obj.type);
+        if (footprint && obj.body < 0) {
+            g_collisionWorld.addBox(obj.x, obj.z, footprintRotation(obj.type, obj.rotation), *footprint, COLLIDER_DECOR, DECOR_HEIGHTS[obj.type]);
+        }
+    }
+}
+
 void RoomDecorations::loadTextures(const char* woodTex, const char* metalTex) {
     m_texWood = loadTexture(woodTex);
     m_texMetal = loadTexture(metalTex);
 }
 
 GLuint RoomDecorations::loadTexture(const char* path) {
-    GLuint id = SOIL_load_OGL_texture(path, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID,
-        SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_TEXTURE_REPEATS);
-    return id;
+    // Mips are streamed in by the shared TextureStreamer
+    return g_textureStreamer.load(path, "RoomDecorations");
 }
 void RoomDecorations::draw() {
     glColor3f(1.0f, 1.0f, 1.0f);
 
     for (const auto& obj : m_objects) {
+        if (obj.body >= 0) {
+            // Crates are wherever the simulation moved them
+            float x, z, rot;
+            g_rigidBodies.getPose(obj.body, m_renderAlpha, x, z, rot);
+            if (g_visibility.isVisible(x, z, 1.0f)) drawCrate(x, z, rot);
+            continue;
+        }
+        if (!g_visibility.isVisible(obj.x, obj.z, 3.0f)) continue; // Hidden behind walls
+
         switch (obj.type) {
             // Original 5 Objects
         case 1: drawChair(obj.x, obj.z, obj.rotation); break;
@@ -995,6 +1096,51 @@ void RoomDecorations::drawCylinder(float radius, float height, int segments) {
     glEnd();
 }
 
+// 11. WOODEN CRATE (pushable)
+void RoomDecorations::drawCrate(float x, float z, float rot) {
+    glPushMatrix();
+    glTranslatef(x, 0.0f, z);
+    glRotatef(rot, 0.0f, 1.0f, 0.0f);
+
+    float size = 1.0f; float h = 0.9f; float slat = 0.08f;
+
+    // Body
+    if (m_texWood) { glEnable(GL_TEXTURE_2D); glBindTexture(GL_TEXTURE_2D, m_texWood); glColor3f(1, 1, 1); }
+    else { glDisable(GL_TEXTURE_2D); glColor3f(0.6f, 0.42f, 0.2f); }
+    glPushMatrix(); glTranslatef(0, h / 2, 0); drawBox(size - 0.02f, h, size - 0.02f); glPopMatrix();
+
+    // Darker edge slats (stand 1 cm proud of the sides)
+    if (m_texWood) glColor3f(0.6f, 0.5f, 0.4f);
+    else glColor3f(0.4f, 0.26f, 0.1f);
+    float e = size / 2 - slat / 2;
+    for (int i = 0; i < 4; ++i) {
+        float sx = (i & 1) ? e : -e;
+        float sz = (i & 2) ? e : -e;
+        glPushMatrix(); glTranslatef(sx, h / 2, sz); drawBox(slat, h, slat); glPopMatrix();
+    }
+    for (int i = 0; i < 2; ++i) {
+        float y = i == 0 ? slat / 2 : h - slat / 2;
+        glPushMatrix(); glTranslatef(0, y, e); drawBox(size, slat, slat); glPopMatrix();
+        glPushMatrix(); glTranslatef(0, y, -e); drawBox(size, slat, slat); glPopMatrix();
+        glPushMatrix(); glTranslatef(e, y, 0); drawBox(slat, slat, size); glPopMatrix();
+        glPushMatrix(); glTranslatef(-e, y, 0); drawBox(slat, slat, size); glPopMatrix();
+    }
+
+    // Diagonal brace on the front and back
+    float diag = sqrtf(size * size + h * h) - slat;
+    float angle = atan2f(h, size) * 180.0f / (float)M_PI;
+    for (int side = -1; side <= 1; side += 2) {
+        glPushMatrix();
+        glTranslatef(0, h / 2, side * (size / 2 - 0.005f));
+        glRotatef(angle, 0.0f, 0.0f, 1.0f);
+        drawBox(diag, slat, 0.02f);
+        glPopMatrix();
+    }
+
+    glColor3f(1, 1, 1);
+    glPopMatrix();
+}
+
 // Helper: Standard Box
 void RoomDecorations::drawBox(float w, float h, float d) {
     float hw = w / 2.0f; float hh = h / 2.0f; float hd = d / 2.0f;
@@ -3,13 +3,25 @@
 #include "pch.h"
 #include <glut.h>
 #include <vector>
+#include "Footprint.h"
+
+class CollisionGrid;
 
 // Enum for object types to make code readable
+// (values are the type numbers used by 'decor' lines in the level file)
 enum DecorType {
     DECOR_CHAIR = 1,
     DECOR_TABLE = 2,
-    DECOR_CRATE = 3,
-    // Add more types here later
+    DECOR_CUPBOARD = 3,
+    DECOR_BED = 4,
+    DECOR_RACK = 5,
+    DECOR_FLOOR_LAMP = 6,
+    DECOR_SOFA = 7,
+    DECOR_TV_UNIT = 8,
+    DECOR_DESK = 9,
+    DECOR_PLANT = 10,
+    DECOR_CRATE = 11, // Pushable: simulated by g_rigidBodies, not a fixed collider
+    DECOR_TYPE_COUNT
 };
 
 // Structure for a single decoration instance
@@ -17,11 +29,13 @@ struct DecorInstance {
     int type;
     float x, z;
     float rotation; // Degrees
+    int body;       // Rigid body of a crate (-1 for fixed decorations)
 };
 
 class RoomDecorations {
 public:
     RoomDecorations();
+    ~RoomDecorations();
 
     // Add a new decoration object
     // type: 1=Chair, 2=Table, etc.
@@ -29,14 +43,34 @@ public:
     // rotation: Rotation in degrees (optional, default 0)
     void addDecoration(int type, float x, float z, float rotation = 0.0f);
 
+    // Remove all decorations (used when the layout is reloaded)
+    void clear();
+
+    // Blocks the cells under every fixed decoration in 'grid' (rotated
+    // footprints; round ones are stamped unrotated)
+    // Crates stamp their own cells (RigidBodyWorld::applyCollision)
+    void applyCollision(CollisionGrid& grid);
+
+    // Adds the footprint of every fixed decoration to g_collisionWorld,
+    // with the height of its top (so the player can climb onto tables and beds)
+    void addColliders();
+
+    // Bounding floor footprint of a decoration type, before rotation
+    // Returns nullptr for unknown types (no collision)
+    static const FootprintBox* getFootprint(int type);
+
     // Load textures for decorations
     void loadTextures(const char* woodTex, const char* metalTex);
 
     // Draw all decorations
     void draw();
 
+    // Where crates are drawn between the last two physics steps (0..1)
+    void setRenderAlpha(float alpha) { m_renderAlpha = alpha; }
+
 private:
     std::vector<DecorInstance> m_objects;
+    float m_renderAlpha;
 
     // Textures
     GLuint m_texWood;
@@ -48,7 +82,7 @@ private:
     void drawCupboard(float x, float z, float rot);
     void drawBed(float x, float z, float rot);
     void drawRack(float x, float z, float rot);
-    void drawCrate(float x, float z, float rot); // Placeholder
+    void drawCrate(float x, float z, float rot);
 
     void drawFloorLamp(float x, float z, float rot);
     void drawSofa(float x, float z, float rot);
@@ -2,13 +2,25 @@
 #include "SecretBook.h"
 #include <math.h>
 #include <stdio.h>
-#include <SOIL2.h> 
+#include "TextureStreamer.h"
+#include "Visibility.h"
+#include "Raycast.h"
+#include "InteractableIndex.h"
+#include "TriggerVolumes.h"
+
+// Circle around the 1x1 look-at box of stool + book
+static const float BOOK_RADIUS = 0.71f;
 
 SecretBook::SecretBook()
     : m_interactionRange(2.0f), m_texWood(0), m_texCover(0), m_texPage(0)
 {
 }
 
+SecretBook::~SecretBook() {
+    // Deleted with its floor: nothing may keep pointing at it
+    clear();
+}
+
 void SecretBook::addBook(float x, float z, const char* message) {
     BookData b;
     b.x = x;
@@ -16,7 +28,24 @@ void SecretBook::addBook(float x, float z, const char* message) {
     b.message = message;
     b.isOpen = false;
     b.openAngle = 0.0f;
+    b.wasRead = false;
     m_books.push_back(b);
+
+    // Stream book textures at full detail only when the player is close
+    g_textureStreamer.addAnchor(m_texWood, x, z, 0.5f, this);
+    g_textureStreamer.addAnchor(m_texCover, x, z, 0.5f, this);
+    g_textureStreamer.addAnchor(m_texPage, x, z, 0.5f, this);
+
+    // Indexed for queries, and a trigger around everywhere it can be used from
+    g_interactables.add(x, z, BOOK_RADIUS, INTERACT_BOOK, (int)m_books.size() - 1, this);
+    g_triggers.addCircle(x, z, m_interactionRange + BOOK_RADIUS, INTERACT_BOOK, (int)m_books.size() - 1, this);
+}
+
+void SecretBook::clear() {
+    m_books.clear();
+    g_textureStreamer.removeAnchors(this);
+    g_interactables.removeOwner(this);
+    g_triggers.removeOwner(this);
 }
 
 void SecretBook::loadTextures(const char* woodTex, const char* bookCoverTex, const char* pageTex) {
@@ -26,10 +55,8 @@ void SecretBook::loadTextures(const char* woodTex, const char* bookCoverTex, con
 }
 
 GLuint SecretBook::loadTexture(const char* path) {
-    GLuint id = SOIL_load_OGL_texture(path, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID,
-        SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_TEXTURE_REPEATS);
-    // Suppress error spam if texture is missing, just return 0
-    return id;
+    // Mips are streamed in by the shared TextureStreamer
+    return g_textureStreamer.load(path, "SecretBook");
 }
 
 void SecretBook::update(float dt) {
@@ -49,25 +76,52 @@ void SecretBook::update(float dt) {
 }
 
 int SecretBook::getNearestBookIndex(float playerX, float playerZ) {
+    return g_interactables.findNearest(playerX, playerZ, m_interactionRange, this);
+}
+
+int SecretBook::getLookedAtBookIndex(float eyeX, float eyeY, float eyeZ, float dirX, float dirY, float dirZ, float occluderHeight) {
+    // Bounds of stool + book as drawn (a little generous so it is easy to aim at)
+    const float halfSize = 0.5f;
+    const float top = 1.6f;
+
     int nearestIndex = -1;
     float minDist = m_interactionRange;
 
-    for (size_t i = 0; i < m_books.size(); ++i) {
-        float dx = m_books[i].x - playerX;
-        float dz = m_books[i].z - playerZ;
-        float dist = sqrt(dx * dx + dz * dz);
-
-        if (dist < minDist) {
+    // Only books whose bounds are within reach of the eye
+    g_interactables.forEachNear(eyeX, eyeZ, m_interactionRange, [&](const Interactable& obj) {
+        if (obj.owner != this) return;
+        const BookData& b = m_books[obj.index];
+        float dist;
+        if (!rayIntersectsBox(eyeX, eyeY, eyeZ, dirX, dirY, dirZ,
+            b.x - halfSize, 0.0f, b.z - halfSize, b.x + halfSize, top, b.z + halfSize, minDist, dist)) return;
+        if (!isRayUnobstructed(eyeX, eyeY, eyeZ, dirX, dirY, dirZ, dist, occluderHeight,
+            b.x - halfSize, b.z - halfSize, b.x + halfSize, b.z + halfSize)) return;
+
+        // Ties keep the lower index, like the old scan in index order
+        if (nearestIndex == -1 || dist < minDist || (dist == minDist && obj.index < nearestIndex)) {
             minDist = dist;
-            nearestIndex = (int)i;
+            nearestIndex = obj.index;
         }
-    }
+    });
     return nearestIndex;
 }
 
 void SecretBook::toggleBook(int index) {
     if (index >= 0 && index < m_books.size()) {
         m_books[index].isOpen = !m_books[index].isOpen;
+        if (m_books[index].isOpen) m_books[index].wasRead = true;
+    }
+}
+
+bool SecretBook::isBookRead(int index) {
+    if (index >= 0 && index < m_books.size()) return m_books[index].wasRead;
+    return false;
+}
+
+void SecretBook::getBookPosition(int index, float& x, float& z) {
+    if (index >= 0 && index < m_books.size()) {
+        x = m_books[index].x;
+        z = m_books[index].z;
     }
 }
 
@@ -86,6 +140,8 @@ void SecretBook::draw() {
     glColor3f(1.0f, 1.0f, 1.0f);
 
     for (const auto& book : m_books) {
+        if (!g_visibility.isVisible(book.x, book.z, 1.0f)) continue; // Hidden behind walls
+
         glPushMatrix();
         glTranslatef(book.x, 0.0f, book.z);
 
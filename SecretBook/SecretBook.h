@@ -11,15 +11,20 @@ struct BookData {
     std::string message;
     bool isOpen;
     float openAngle; // 0.0 (closed) to 180.0 (open)
+    bool wasRead;    // Opened at least once
 };
 
 class SecretBook {
 public:
     SecretBook();
+    ~SecretBook();
 
     // Add a new book to the world
     void addBook(float x, float z, const char* message);
 
+    // Remove all books (used when the layout is reloaded)
+    void clear();
+
     // Setup textures (Call this in init)
     void loadTextures(const char* woodTex, const char* bookCoverTex, const char* pageTex);
 
@@ -32,11 +37,21 @@ public:
     // Check if player is near ANY book. 
     int getNearestBookIndex(float playerX, float playerZ);
 
+    // Book the player is looking at (eye position + view direction), within
+    // interaction range and not hidden behind blocked cells up to occluderHeight.
+    // Returns index of the nearest one, or -1
+    int getLookedAtBookIndex(float eyeX, float eyeY, float eyeZ, float dirX, float dirY, float dirZ, float occluderHeight);
+
     // Interact with a specific book
     void toggleBook(int index);
     bool isBookOpen(int index);
     const char* getBookMessage(int index);
 
+    // Books for hints and guidance
+    int getBookCount() const { return (int)m_books.size(); }
+    bool isBookRead(int index);
+    void getBookPosition(int index, float& x, float& z);
+
 private:
     std::vector<BookData> m_books;
     float m_interactionRange;
@@ -3,13 +3,40 @@
 #include "GraphicsUtils.h" // Needed for grid functions
 #include <math.h>
 #include <stdio.h>
-#include <SOIL2.h>
+#include "TextureStreamer.h"
+#include "Visibility.h"
+#include "Footprint.h"
+#include "CollisionWorld.h"
+#include "Raycast.h"
+#include "InteractableIndex.h"
+#include "TriggerVolumes.h"
+#include "RigidBodies.h"
+
+// Footprints match drawDoorModel (door space: width along X, 4 units):
+// Posts (x -2..-1 and 1..2): ALWAYS BLOCKED
+// Doorway between them (the two panels): Blocked if Closed
+static const FootprintBox LEFT_POST = { 0.5f, 0.4f, -1.5f, 0.0f };
+static const FootprintBox RIGHT_POST = { 0.5f, 0.4f, 1.5f, 0.0f };
+static const FootprintBox DOORWAY = { 1.0f, 0.2f, 0.0f, 0.0f };
+
+// Circle around the 4 x 0.8 frame, in either direction
+static const float DOOR_RADIUS = 2.05f;
+
+// Same rotation draw() uses for doors parallel to Z
+static float doorRotation(const DoorData& d) {
+    return (d.direction == 2) ? 90.0f : 0.0f;
+}
 
 SecretDoor::SecretDoor()
     : m_interactionRange(2.5f), m_texFrame(0), m_texDoor(0), m_texDetail(0)
 {
 }
 
+SecretDoor::~SecretDoor() {
+    // Deleted with its floor: nothing may keep pointing at it
+    clear();
+}
+
 void SecretDoor::addDoor(float x, float z, int direction, const char* pin) {
     DoorData d;
     d.x = x;
@@ -18,77 +45,86 @@ void SecretDoor::addDoor(float x, float z, int direction, const char* pin) {
     d.pinCode = pin;
     d.isOpen = false;
     d.openAngle = 0.0f;
+    d.doorwayCollider = -1;
 
     m_doors.push_back(d);
 
-    // Immediately block the grid for this new closed door
-    updateCollision((int)m_doors.size() - 1, true);
-}
+    // Stream door textures at full detail only when the player is close
+    g_textureStreamer.addAnchor(m_texFrame, x, z, 2.0f, this);
+    g_textureStreamer.addAnchor(m_texDoor, x, z, 2.0f, this);
+    g_textureStreamer.addAnchor(m_texDetail, x, z, 2.0f, this);
 
-void SecretDoor::updateCollision(int index, bool isClosed) {
-    if (index < 0 || index >= m_doors.size()) return;
+    // Indexed for queries, and a trigger around everywhere it can be used from
+    g_interactables.add(x, z, DOOR_RADIUS, INTERACT_DOOR, (int)m_doors.size() - 1, this);
+    g_triggers.addCircle(x, z, m_interactionRange + DOOR_RADIUS, INTERACT_DOOR, (int)m_doors.size() - 1, this);
+}
 
-    DoorData& d = m_doors[index];
+void SecretDoor::clear() {
+    m_doors.clear();
+    g_textureStreamer.removeAnchors(this);
+    g_interactables.removeOwner(this);
+    g_triggers.removeOwner(this);
+}
 
-    // Grid Logic (4 Units Wide):
-    // Left/Top Post: ALWAYS BLOCKED
-    // Left/Top Door: Blocked if Closed
-    // Right/Bot Door: Blocked if Closed
-    // Right/Bot Post: ALWAYS BLOCKED
+void SecretDoor::applyCollision(CollisionGrid& grid) {
+    for (size_t i = 0; i < m_doors.size(); ++i) {
+        stampCollision((int)i, grid, !m_doors[i].isOpen);
+    }
+}
 
-    int centerX, centerZ;
-    if (!worldToGrid(d.x - 0.1f, d.z - 0.1f, centerX, centerZ)) return;
+int SecretDoor::stampCollision(int index, CollisionGrid& grid, bool isClosed) const {
+    if (index < 0 || index >= (int)m_doors.size()) return 0;
 
-    std::vector<std::pair<int, int>> cellsToBlock;
-    std::vector<std::pair<int, int>> cellsToUnblock;
+    const DoorData& d = m_doors[index];
+    float rotation = doorRotation(d);
+    int cells = rasterizeFootprintBox(d.x, d.z, rotation, DOORWAY, isClosed, grid);
 
-    if (d.direction == 1) { // Parallel to X-axis
-        // Always block Posts (Outer edges)
-        cellsToBlock.push_back({ centerX - 1, centerZ }); // Far Left Post
-        cellsToBlock.push_back({ centerX + 2, centerZ }); // Far Right Post
+    // Re-stamp the posts in case the doorway shares a cell with them
+    cells += rasterizeFootprintBox(d.x, d.z, rotation, LEFT_POST, true, grid);
+    cells += rasterizeFootprintBox(d.x, d.z, rotation, RIGHT_POST, true, grid);
+    return cells;
+}
 
-        if (isClosed) {
-            // Closed: Block Middle Two
-            cellsToBlock.push_back({ centerX, centerZ });
-            cellsToBlock.push_back({ centerX + 1, centerZ });
-        }
-        else {
-            // Open: Unblock Middle Two
-            cellsToUnblock.push_back({ centerX, centerZ });
-            cellsToUnblock.push_back({ centerX + 1, centerZ });
-        }
-    }
-    else { // Parallel to Z-axis
-        // Always block Posts
-        cellsToBlock.push_back({ centerX, centerZ - 1 }); // Top Post
-        cellsToBlock.push_back({ centerX, centerZ + 2 }); // Bottom Post
-
-        if (isClosed) {
-            // Closed: Block Middle Two
-            cellsToBlock.push_back({ centerX, centerZ });
-            cellsToBlock.push_back({ centerX, centerZ + 1 });
-        }
-        else {
-            // Open: Unblock Middle Two
-            cellsToUnblock.push_back({ centerX, centerZ });
-            cellsToUnblock.push_back({ centerX, centerZ + 1 });
-        }
+void SecretDoor::addColliders() {
+    for (auto& d : m_doors) {
+        float rotation = doorRotation(d);
+        g_collisionWorld.addBox(d.x, d.z, rotation, LEFT_POST, COLLIDER_DOOR);
+        g_collisionWorld.addBox(d.x, d.z, rotation, RIGHT_POST, COLLIDER_DOOR);
+        d.doorwayCollider = g_collisionWorld.addBox(d.x, d.z, rotation, DOORWAY, COLLIDER_DOOR);
+        g_collisionWorld.setEnabled(d.doorwayCollider, !d.isOpen);
     }
+}
 
-    // Apply Blocks
-    for (auto& cell : cellsToBlock) {
-        addBlockGridBox(cell.first, cell.second);
-    }
+void SecretDoor::updateCollision(int index, bool isClosed) {
+    if (index < 0 || index >= m_doors.size()) return;
 
-    // Apply Unblocks
-    for (auto& cell : cellsToUnblock) {
-        removeBlockGridBox(cell.first, cell.second);
+    DoorData& d = m_doors[index];
+    float rotation = doorRotation(d);
+
+    // The door's area (the posts span the whole door)
+    float left[8], right[8];
+    footprintCorners(d.x, d.z, rotation, LEFT_POST, left);
+    footprintCorners(d.x, d.z, rotation, RIGHT_POST, right);
+    float minX = left[0], maxX = left[0], minZ = left[1], maxZ = left[1];
+    for (int i = 0; i < 4; ++i) {
+        minX = fminf(minX, fminf(left[i * 2], right[i * 2]));
+        maxX = fmaxf(maxX, fmaxf(left[i * 2], right[i * 2]));
+        minZ = fminf(minZ, fminf(left[i * 2 + 1], right[i * 2 + 1]));
+        maxZ = fmaxf(maxZ, fmaxf(left[i * 2 + 1], right[i * 2 + 1]));
     }
 
-    d.blockedCells = cellsToBlock;
+    // Edit the cells under any crate standing in the doorway, not the crate's stamp
+    g_rigidBodies.liftArea(g_collisionGrid, minX, minZ, maxX, maxZ);
+    int cells = stampCollision(index, g_collisionGrid, isClosed);
+    g_rigidBodies.restampArea(g_collisionGrid, minX, minZ, maxX, maxZ);
+
+    g_collisionWorld.setEnabled(d.doorwayCollider, isClosed);
 
-    if (isClosed) printf("Door %d Closed (4 Cells Blocked).\n", index);
-    else printf("Door %d Open (2 Middle Cells Unblocked).\n", index);
+    // Tell the grid listeners (distance field, paths, flow fields) which cells changed
+    g_collisionGrid.notifyChangedArea(minX, minZ, maxX, maxZ);
+
+    if (isClosed) printf("Door %d Closed (%d Cells Blocked).\n", index, cells);
+    else printf("Door %d Open (Doorway Unblocked).\n", index);
 }
 
 void SecretDoor::update(float dt) {
@@ -104,19 +140,35 @@ void SecretDoor::update(float dt) {
 }
 
 int SecretDoor::getNearestDoorIndex(float playerX, float playerZ) {
+    return g_interactables.findNearest(playerX, playerZ, m_interactionRange, this);
+}
+
+int SecretDoor::getLookedAtDoorIndex(float eyeX, float eyeY, float eyeZ, float dirX, float dirY, float dirZ, float occluderHeight) {
+    // Frame as drawn: 4 wide, 0.8 deep, 3.75 high (beam included)
+    const float halfWidth = 2.0f, halfDepth = 0.4f, height = 3.75f;
+
     int nearestIndex = -1;
     float minDist = m_interactionRange;
 
-    for (size_t i = 0; i < m_doors.size(); ++i) {
-        float dx = m_doors[i].x - playerX;
-        float dz = m_doors[i].z - playerZ;
-        float dist = sqrt(dx * dx + dz * dz);
-
-        if (dist < minDist) {
+    // Only doors whose frame is within reach of the eye
+    g_interactables.forEachNear(eyeX, eyeZ, m_interactionRange, [&](const Interactable& obj) {
+        if (obj.owner != this) return;
+        const DoorData& d = m_doors[obj.index];
+        float hx = (d.direction == 2) ? halfDepth : halfWidth;
+        float hz = (d.direction == 2) ? halfWidth : halfDepth;
+
+        float dist;
+        if (!rayIntersectsBox(eyeX, eyeY, eyeZ, dirX, dirY, dirZ,
+            d.x - hx, 0.0f, d.z - hz, d.x + hx, height, d.z + hz, minDist, dist)) return;
+        if (!isRayUnobstructed(eyeX, eyeY, eyeZ, dirX, dirY, dirZ, dist, occluderHeight,
+            d.x - hx, d.z - hz, d.x + hx, d.z + hz)) return;
+
+        // Ties keep the lower index, like the old scan in index order
+        if (nearestIndex == -1 || dist < minDist || (dist == minDist && obj.index < nearestIndex)) {
             minDist = dist;
-            nearestIndex = (int)i;
+            nearestIndex = obj.index;
         }
-    }
+    });
     return nearestIndex;
 }
 
@@ -131,6 +183,19 @@ bool SecretDoor::tryUnlock(int index, const char* enteredPin) {
     return false;
 }
 
+const char* SecretDoor::getDoorPin(int index) {
+    if (index >= 0 && index < m_doors.size()) return m_doors[index].pinCode.c_str();
+    return "";
+}
+
+void SecretDoor::getDoorPosition(int index, float& x, float& z, int& direction) {
+    if (index >= 0 && index < m_doors.size()) {
+        x = m_doors[index].x;
+        z = m_doors[index].z;
+        direction = m_doors[index].direction;
+    }
+}
+
 bool SecretDoor::isDoorOpen(int index) {
     if (index >= 0 && index < m_doors.size()) return m_doors[index].isOpen;
     return false;
@@ -143,15 +208,16 @@ void SecretDoor::loadTextures(const char* frameTex, const char* doorTex, const c
 }
 
 GLuint SecretDoor::loadTexture(const char* path) {
-    GLuint id = SOIL_load_OGL_texture(path, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID,
-        SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_TEXTURE_REPEATS);
-    return id;
+    // Mips are streamed in by the shared TextureStreamer
+    return g_textureStreamer.load(path, "SecretDoor");
 }
 
 void SecretDoor::draw() {
     glColor3f(1.0f, 1.0f, 1.0f);
 
     for (const auto& door : m_doors) {
+        if (!g_visibility.isVisible(door.x, door.z, 2.5f)) continue; // Hidden behind walls
+
         glPushMatrix();
         glTranslatef(door.x, 0.0f, door.z);
 
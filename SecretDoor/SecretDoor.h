@@ -5,6 +5,8 @@
 #include <vector>
 #include <string>
 
+class CollisionGrid;
+
 // Structure for a single door instance
 struct DoorData {
     float x, z;
@@ -12,20 +14,37 @@ struct DoorData {
     std::string pinCode;
     bool isOpen;
     float openAngle; // 0.0 (closed) to 90.0 (open)
-
-    // Store the grid coordinates blocked by this door so we can unblock them later
-    std::vector<std::pair<int, int>> blockedCells;
+    int doorwayCollider; // Doorway box in g_collisionWorld (-1 = none)
 };
 
 class SecretDoor {
 public:
     SecretDoor();
+    ~SecretDoor();
 
     // Add a new door
     // direction: 1 (X-axis) or 2 (Z-axis)
     // pin: 3-digit string (e.g., "123")
     void addDoor(float x, float z, int direction, const char* pin);
 
+    // Remove all doors (their grid cells stay blocked until the grid is rebuilt)
+    void clear();
+
+    // Blocks the cells of every door in 'grid' for its current state (the
+    // live grid or a scratch one; not needed when a compiled level brings
+    // its own grid)
+    void applyCollision(CollisionGrid& grid);
+
+    // Stamps one door into 'grid' as closed or open (the doorway's cells
+    // freed, the posts kept). Touches nothing else: crates, colliders and
+    // grid listeners are left to the caller (the level compiler finds each
+    // door's gate this way on its scratch grid)
+    int stampCollision(int index, CollisionGrid& grid, bool isClosed) const;
+
+    // Adds the posts and doorway of every door to g_collisionWorld
+    // (the doorway is switched off while the door is open)
+    void addColliders();
+
     // Load textures
     // frameTex: The static posts/beam
     // doorTex: The moving panels
@@ -42,6 +61,11 @@ public:
     // Returns index of nearest door, or -1
     int getNearestDoorIndex(float playerX, float playerZ);
 
+    // Door the player is looking at (eye position + view direction), within
+    // interaction range and not hidden behind other blocked cells up to occluderHeight.
+    // Returns index of the nearest one, or -1
+    int getLookedAtDoorIndex(float eyeX, float eyeY, float eyeZ, float dirX, float dirY, float dirZ, float occluderHeight);
+
     // Attempt to unlock a door
     // Returns true if PIN is correct
     bool tryUnlock(int index, const char* enteredPin);
@@ -49,6 +73,13 @@ public:
     // Check if a specific door is already open
     bool isDoorOpen(int index);
 
+    // The PIN that unlocks a door ("" for an invalid index)
+    const char* getDoorPin(int index);
+
+    // Doors for hints and guidance
+    int getDoorCount() const { return (int)m_doors.size(); }
+    void getDoorPosition(int index, float& x, float& z, int& direction);
+
 private:
     std::vector<DoorData> m_doors;
     float m_interactionRange;
@@ -64,6 +95,7 @@ private:
     void drawCylinder(float radius, float height); // New helper for cylinders
 
     // Collision helpers
+    // Opens or closes a door on the live grid (crates, doorway collider and listeners included)
     void updateCollision(int index, bool block);
     GLuint loadTexture(const char* path);
 };
\ No newline at end of file
@@ -1,9 +1,36 @@
 #include "pch.h"
 #include "TheRoom.h" 
-#include <SOIL2.h>
+#include "TextureStreamer.h"
+#include "GpuMemory.h"
 #include <stdio.h>
 #include <vector>
 #include <math.h>
+#include <algorithm>
+
+// Height of one stair step (the walking surface is a smooth ramp)
+const float STAIR_STEP_HEIGHT = 0.25f;
+
+// Floor or ceiling rectangle, split around the stairwell openings
+struct FloorRect {
+    float x0, z0, x1, z1;
+};
+
+// Replaces the rectangles overlapping a hole by the (up to four) pieces around it
+static void cutHole(std::vector<FloorRect>& rects, float hx0, float hz0, float hx1, float hz1) {
+    std::vector<FloorRect> out;
+    for (const FloorRect& r : rects) {
+        if (hx0 >= r.x1 || hx1 <= r.x0 || hz0 >= r.z1 || hz1 <= r.z0) {
+            out.push_back(r);
+            continue;
+        }
+        float z0 = std::max(r.z0, hz0), z1 = std::min(r.z1, hz1);
+        if (hz0 > r.z0) out.push_back({ r.x0, r.z0, r.x1, hz0 });
+        if (hz1 < r.z1) out.push_back({ r.x0, hz1, r.x1, r.z1 });
+        if (hx0 > r.x0) out.push_back({ r.x0, z0, hx0, z1 });
+        if (hx1 < r.x1) out.push_back({ hx1, z0, r.x1, z1 });
+    }
+    rects.swap(out);
+}
 
 // ================================================================
 // CORE CLASS IMPLEMENTATIONS
@@ -13,49 +40,59 @@
 TheRoom::TheRoom(float width, float height, float depth)
     : m_width(width), m_height(height), m_depth(depth),
     m_texFloor(0), m_texWall(0), m_texCeiling(0),
-    m_displayListID(0) // <--- Initialize to 0 (No list yet)
+    m_storeys(1) // <--- A single storey, no list yet
 {
     printf("TheRoom created: W=%.2f, H=%.2f, D=%.2f\n", width, height, depth);
 }
 
 // Destructor: Clean up the Display List from GPU memory
 TheRoom::~TheRoom() {
-    if (m_displayListID != 0) {
-        glDeleteLists(m_displayListID, 1);
-        printf("TheRoom: Display List %u deleted.\n", m_displayListID);
+    deleteLists();
+    g_textureStreamer.removeAnchors(this);
+}
+
+void TheRoom::deleteLists() {
+    for (Storey& s : m_storeys) {
+        if (s.displayListID == 0) continue;
+        glDeleteLists(s.displayListID, 1);
+        g_gpuMemory.untrack(GPU_DISPLAY_LIST, s.displayListID);
+        printf("TheRoom: Display List %u deleted.\n", s.displayListID);
+        s.displayListID = 0;
     }
 }
 
+void TheRoom::setFloors(const FloorStack& floors) {
+    deleteLists();
+    m_storeys.resize(floors.getFloorCount());
+    m_stairs.clear();
+    for (int i = 0; i < floors.getStairsCount(); ++i) m_stairs.push_back(floors.getStairs(i));
+}
+
+void TheRoom::setSize(float width, float height, float depth) {
+    m_width = width;
+    m_height = height;
+    m_depth = depth;
+}
+
 // Function to load a single texture using SOIL2
 GLuint TheRoom::loadSingleTexture(const char* path) {
     if (!path) return 0;
 
-    // Load texture with mipmaps and flipping Y for OpenGL
-    GLuint textureID = SOIL_load_OGL_texture(
-        path, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID,
-        SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_TEXTURE_REPEATS
-    );
-
-    if (!textureID) {
-        printf("SOIL2 loading error for '%s': %s\n", path, SOIL_last_result());
-        return 0;
-    }
+    // Mips (and filtering/repeat parameters) are handled by the TextureStreamer
+    GLuint textureID = g_textureStreamer.load(path, "TheRoom");
 
-    // Set Texture Parameters
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // The room shell surrounds the player, so anchor it over the whole room
+    float radius = sqrtf(m_width * m_width + m_depth * m_depth) / 2.0f;
+    g_textureStreamer.addAnchor(textureID, 0.0f, 0.0f, radius, this);
 
-    printf("SOIL2 loaded texture '%s' successfully (ID: %u)\n", path, textureID);
+    printf("TheRoom: streaming texture '%s' (ID: %u)\n", path, textureID);
     return textureID;
 }
 
 // Function to load all textures for the room
 bool TheRoom::loadTextures(const char* floorTexPath, const char* wallTexPath, const char* ceilingTexPath) {
     printf("Loading room textures...\n");
+    g_textureStreamer.removeAnchors(this); // Anchors of the previous textures (or size)
     m_texFloor = loadSingleTexture(floorTexPath);
     m_texWall = loadSingleTexture(wallTexPath);
     m_texCeiling = loadSingleTexture(ceilingTexPath);
@@ -65,148 +102,153 @@ bool TheRoom::loadTextures(const char* floorTexPath, const char* wallTexPath, co
 // ================================================================
 // NEW: Build the Display List (The Optimization)
 // ================================================================
-void TheRoom::build() {
-    // 1. Clean up old list if it exists
-    if (m_displayListID != 0) {
-        glDeleteLists(m_displayListID, 1);
-    }
+void TheRoom::build(const BakedMesh* baked) {
+    // 1. Clean up old lists if they exist
+    deleteLists();
 
-    // 2. Generate a new unique ID
-    m_displayListID = glGenLists(1);
+    for (int floor = 0; floor < (int)m_storeys.size(); ++floor) {
+        Storey& s = m_storeys[floor];
 
-    // 3. Start Recording
-    glNewList(m_displayListID, GL_COMPILE);
+        // 2. Reuse cached geometry when we have it, otherwise generate it
+        if (baked && floor == 0) s.mesh = *baked;
+        else bakeGeometry(s.mesh, floor);
 
-    // 4. Set global state for the room
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        // 3. Generate a new unique ID
+        s.displayListID = glGenLists(1);
 
-    // 5. Call the drawing functions (These commands are now stored on the GPU)
-    drawFloor();
-    drawWalls();
-    drawCeiling();
+        // 4. Record: global state for the room, then the baked quads
+        glNewList(s.displayListID, GL_COMPILE);
+        glColor3f(1.0f, 1.0f, 1.0f);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
-    // 6. Stop Recording
-    glEndList();
+        const GLuint textures[ROOM_TEXTURE_SLOTS] = { m_texFloor, m_texWall, m_texCeiling };
+        s.mesh.draw(textures, ROOM_TEXTURE_SLOTS);
+        glEndList();
 
-    printf("TheRoom: Optimized Display List created (ID: %u)\n", m_displayListID);
+        g_gpuMemory.trackDisplayList(s.displayListID, "TheRoom", "room shell", (int)s.mesh.vertices.size());
+        printf("TheRoom: Optimized Display List created (ID: %u, floor %d)\n", s.displayListID, floor);
+    }
 }
 
 // ================================================================
 // Master Draw Function (Now uses the list)
 // ================================================================
-void TheRoom::draw() {
-    if (m_displayListID != 0) {
-        // --- FAST PATH: Execute the recorded list ---
-        glCallList(m_displayListID);
-    }
-    else {
-        // --- SLOW PATH: Fallback if build() wasn't called ---
-        glColor3f(1.0f, 1.0f, 1.0f);
-        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-        drawFloor();
-        drawWalls();
-        drawCeiling();
-    }
+void TheRoom::draw(int floor) {
+    if (floor < 0 || floor >= (int)m_storeys.size()) return;
+    // Build on first use if build() wasn't called
+    if (m_storeys[floor].displayListID == 0) build();
+    glCallList(m_storeys[floor].displayListID);
 }
 
 // ================================================================
-// Internal Helper Functions
+// Geometry Baking Functions (same quads the room always drew)
 // ================================================================
 
-void TheRoom::bindAndCheckTexture(GLuint textureID) {
-    if (textureID != 0) {
-        glEnable(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glColor3f(1.0f, 1.0f, 1.0f);
-    }
-    else {
-        glDisable(GL_TEXTURE_2D);
-        glColor3f(1.0f, 0.0f, 1.0f); // Fallback: Pink
-    }
+void TheRoom::bakeGeometry(BakedMesh& out, int floor) const {
+    out.clear();
+    bakeFloor(out, floor);
+    bakeWalls(out);
+    bakeStairs(out, floor);
+    bakeCeiling(out, floor);
 }
 
-void TheRoom::unbindAndRestore() {
-    glDisable(GL_TEXTURE_2D);
-    glColor3f(1.0f, 1.0f, 1.0f);
-}
-
-
-// ================================================================
-// Geometry Drawing Functions (Unchanged logic, but called by List now)
-// ================================================================
-
-void TheRoom::drawFloor() {
+void TheRoom::bakeFloor(BakedMesh& out, int floor) const {
     float halfW = m_width / 2.0f;
     float halfD = m_depth / 2.0f;
     float floorRepeat = m_width / (m_width / 4.0f);
 
-    bindAndCheckTexture(m_texFloor);
-    glBegin(GL_QUADS);
-    glNormal3f(0.0f, 1.0f, 0.0f);
-    glTexCoord2f(0.0f, 0.0f);          glVertex3f(-halfW, 0.0f, -halfD);
-    glTexCoord2f(floorRepeat, 0.0f);   glVertex3f(halfW, 0.0f, -halfD);
-    glTexCoord2f(floorRepeat, floorRepeat); glVertex3f(halfW, 0.0f, halfD);
-    glTexCoord2f(0.0f, floorRepeat);   glVertex3f(-halfW, 0.0f, halfD);
-    glEnd();
-    unbindAndRestore();
+    // Open where stairs come up from the floor below
+    std::vector<FloorRect> rects(1, FloorRect{ -halfW, -halfD, halfW, halfD });
+    for (const FloorStairs& s : m_stairs) {
+        if (s.floor + 1 == floor) cutHole(rects, s.minX, s.minZ, s.maxX, s.maxZ);
+    }
+
+    out.beginBatch(ROOM_SLOT_FLOOR);
+    for (const FloorRect& r : rects) {
+        float u0 = (r.x0 + halfW) / m_width * floorRepeat, u1 = (r.x1 + halfW) / m_width * floorRepeat;
+        float v0 = (r.z0 + halfD) / m_depth * floorRepeat, v1 = (r.z1 + halfD) / m_depth * floorRepeat;
+        out.addVertex(r.x0, 0.0f, r.z0, 0.0f, 1.0f, 0.0f, u0, v0);
+        out.addVertex(r.x1, 0.0f, r.z0, 0.0f, 1.0f, 0.0f, u1, v0);
+        out.addVertex(r.x1, 0.0f, r.z1, 0.0f, 1.0f, 0.0f, u1, v1);
+        out.addVertex(r.x0, 0.0f, r.z1, 0.0f, 1.0f, 0.0f, u0, v1);
+    }
+}
+
+void TheRoom::bakeStairs(BakedMesh& out, int floor) const {
+    int steps = std::max(1, (int)(m_height / STAIR_STEP_HEIGHT + 0.5f));
+    bool started = false;
+    for (const FloorStairs& s : m_stairs) {
+        if (s.floor != floor) continue;
+        if (!started) out.beginBatch(ROOM_SLOT_WALL);
+        started = true;
+
+        // Solid blocks from the floor up, each one step higher than the last
+        for (int i = 0; i < steps; ++i) {
+            float a = (float)i / steps, b = (float)(i + 1) / steps;
+            float top = m_height * b;
+            float x0 = s.x0 + (s.x1 - s.x0) * a, x1 = s.x0 + (s.x1 - s.x0) * b;
+            float z0 = s.z0 + (s.z1 - s.z0) * a, z1 = s.z0 + (s.z1 - s.z0) * b;
+            bool alongX = (s.z0 == s.z1);
+            float w = alongX ? fabsf(x1 - x0) : s.halfWidth * 2.0f;
+            float d = alongX ? s.halfWidth * 2.0f : fabsf(z1 - z0);
+            out.addBox((x0 + x1) / 2.0f, top / 2.0f, (z0 + z1) / 2.0f, w, top, d, false);
+        }
+    }
 }
 
-void TheRoom::drawWalls() {
+void TheRoom::bakeWalls(BakedMesh& out) const {
     float halfW = m_width / 2.0f;
     float roomH = m_height;
     float halfD = m_depth / 2.0f;
     float wallRepeatU = m_width / 24.0f;
     float wallRepeatV = m_height / 24.0f;
 
-    bindAndCheckTexture(m_texWall);
-    glBegin(GL_QUADS);
+    out.beginBatch(ROOM_SLOT_WALL);
 
     // Left Wall
-    glNormal3f(1.0f, 0.0f, 0.0f);
-    glTexCoord2f(0.0f, 0.0f);              glVertex3f(-halfW, 0.0f, halfD);
-    glTexCoord2f(wallRepeatU, 0.0f);        glVertex3f(-halfW, 0.0f, -halfD);
-    glTexCoord2f(wallRepeatU, wallRepeatV); glVertex3f(-halfW, roomH, -halfD);
-    glTexCoord2f(0.0f, wallRepeatV);        glVertex3f(-halfW, roomH, halfD);
+    out.addVertex(-halfW, 0.0f, halfD, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    out.addVertex(-halfW, 0.0f, -halfD, 1.0f, 0.0f, 0.0f, wallRepeatU, 0.0f);
+    out.addVertex(-halfW, roomH, -halfD, 1.0f, 0.0f, 0.0f, wallRepeatU, wallRepeatV);
+    out.addVertex(-halfW, roomH, halfD, 1.0f, 0.0f, 0.0f, 0.0f, wallRepeatV);
 
     // Right Wall
-    glNormal3f(-1.0f, 0.0f, 0.0f);
-    glTexCoord2f(0.0f, 0.0f);              glVertex3f(halfW, 0.0f, -halfD);
-    glTexCoord2f(wallRepeatU, 0.0f);        glVertex3f(halfW, 0.0f, halfD);
-    glTexCoord2f(wallRepeatU, wallRepeatV); glVertex3f(halfW, roomH, halfD);
-    glTexCoord2f(0.0f, wallRepeatV);        glVertex3f(halfW, roomH, -halfD);
+    out.addVertex(halfW, 0.0f, -halfD, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    out.addVertex(halfW, 0.0f, halfD, -1.0f, 0.0f, 0.0f, wallRepeatU, 0.0f);
+    out.addVertex(halfW, roomH, halfD, -1.0f, 0.0f, 0.0f, wallRepeatU, wallRepeatV);
+    out.addVertex(halfW, roomH, -halfD, -1.0f, 0.0f, 0.0f, 0.0f, wallRepeatV);
 
     // Back Wall
-    glNormal3f(0.0f, 0.0f, -1.0f);
-    glTexCoord2f(0.0f, 0.0f);              glVertex3f(-halfW, 0.0f, halfD);
-    glTexCoord2f(wallRepeatU, 0.0f);        glVertex3f(halfW, 0.0f, halfD);
-    glTexCoord2f(wallRepeatU, wallRepeatV); glVertex3f(halfW, roomH, halfD);
-    glTexCoord2f(0.0f, wallRepeatV);        glVertex3f(-halfW, roomH, halfD);
+    out.addVertex(-halfW, 0.0f, halfD, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
+    out.addVertex(halfW, 0.0f, halfD, 0.0f, 0.0f, -1.0f, wallRepeatU, 0.0f);
+    out.addVertex(halfW, roomH, halfD, 0.0f, 0.0f, -1.0f, wallRepeatU, wallRepeatV);
+    out.addVertex(-halfW, roomH, halfD, 0.0f, 0.0f, -1.0f, 0.0f, wallRepeatV);
 
     // Front Wall
-    glNormal3f(0.0f, 0.0f, 1.0f);
-    glTexCoord2f(0.0f, 0.0f);              glVertex3f(halfW, 0.0f, -halfD);
-    glTexCoord2f(wallRepeatU, 0.0f);        glVertex3f(-halfW, 0.0f, -halfD);
-    glTexCoord2f(wallRepeatU, wallRepeatV); glVertex3f(-halfW, roomH, -halfD);
-    glTexCoord2f(0.0f, wallRepeatV);        glVertex3f(halfW, roomH, -halfD);
-
-    glEnd();
-    unbindAndRestore();
+    out.addVertex(halfW, 0.0f, -halfD, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+    out.addVertex(-halfW, 0.0f, -halfD, 0.0f, 0.0f, 1.0f, wallRepeatU, 0.0f);
+    out.addVertex(-halfW, roomH, -halfD, 0.0f, 0.0f, 1.0f, wallRepeatU, wallRepeatV);
+    out.addVertex(halfW, roomH, -halfD, 0.0f, 0.0f, 1.0f, 0.0f, wallRepeatV);
 }
 
-void TheRoom::drawCeiling() {
+void TheRoom::bakeCeiling(BakedMesh& out, int floor) const {
     float halfW = m_width / 2.0f;
     float roomH = m_height;
     float halfD = m_depth / 2.0f;
     float ceilRepeat = m_width / (m_width / 1.0f);
 
-    bindAndCheckTexture(m_texCeiling);
-    glBegin(GL_QUADS);
-    glNormal3f(0.0f, -1.0f, 0.0f);
-    glTexCoord2f(0.0f, ceilRepeat);         glVertex3f(-halfW, roomH, -halfD);
-    glTexCoord2f(ceilRepeat, ceilRepeat);   glVertex3f(halfW, roomH, -halfD);
-    glTexCoord2f(ceilRepeat, 0.0f);         glVertex3f(halfW, roomH, halfD);
-    glTexCoord2f(0.0f, 0.0f);               glVertex3f(-halfW, roomH, halfD);
-    glEnd();
-    unbindAndRestore();
-}
\ No newline at end of file
+    // Open where stairs go up to the floor above
+    std::vector<FloorRect> rects(1, FloorRect{ -halfW, -halfD, halfW, halfD });
+    for (const FloorStairs& s : m_stairs) {
+        if (s.floor == floor) cutHole(rects, s.minX, s.minZ, s.maxX, s.maxZ);
+    }
+
+    out.beginBatch(ROOM_SLOT_CEILING);
+    for (const FloorRect& r : rects) {
+        float u0 = (r.x0 + halfW) / m_width * ceilRepeat, u1 = (r.x1 + halfW) / m_width * ceilRepeat;
+        float v0 = (halfD - r.z0) / m_depth * ceilRepeat, v1 = (halfD - r.z1) / m_depth * ceilRepeat;
+        out.addVertex(r.x0, roomH, r.z0, 0.0f, -1.0f, 0.0f, u0, v0);
+        out.addVertex(r.x1, roomH, r.z0, 0.0f, -1.0f, 0.0f, u1, v0);
+        out.addVertex(r.x1, roomH, r.z1, 0.0f, -1.0f, 0.0f, u1, v1);
+        out.addVertex(r.x0, roomH, r.z1, 0.0f, -1.0f, 0.0f, u0, v1);
+    }
+}
@@ -1,5 +1,16 @@
 #pragma once
 #include "pch.h" // Includes <glut.h> and other standards
+#include "BakedMesh.h"
+#include "FloorStack.h"
+#include <vector>
+
+// Texture slots used by the room's baked mesh
+enum RoomTextureSlot {
+    ROOM_SLOT_FLOOR = 0,
+    ROOM_SLOT_WALL = 1,
+    ROOM_SLOT_CEILING = 2,
+    ROOM_TEXTURE_SLOTS = 3
+};
 
 class TheRoom {
 public:
@@ -9,19 +20,45 @@ public:
     // Destructor: Cleans up the Display List
     ~TheRoom();
 
-    // Loads the textures from files
+    // Changes the room dimensions (hot reload). Call before build() and
+    // loadTextures(), which anchors the textures over the whole room
+    void setSize(float width, float height, float depth);
+
+    // Loads the textures from files (again on a reload: replaces the previous ones)
     bool loadTextures(const char* floorTexPath, const char* wallTexPath, const char* ceilingTexPath);
 
     // --- NEW: Getter for the Wall Texture ID ---
     // This allows other modules (like InsideWall) to reuse the existing texture.
     GLuint getWallTextureID() const { return m_texWall; }
 
+    // Floors of the level: the room gets one storey per floor, with the
+    // stairs of each floor and openings where they come up. Call before build()
+    void setFloors(const FloorStack& floors);
+    int getFloorCount() const { return (int)m_storeys.size(); }
+
     // --- NEW: Compiles the drawing commands into a Display List ---
     // Call this AFTER loadTextures()
-    void build();
+    // baked: ground floor geometry from the world cache (skips generating it), or nullptr
+    void build(const BakedMesh* baked = nullptr);
+
+    // Generates the floor, walls, stairs and ceiling of one storey on the CPU
+    // (no GL calls), with y = 0 at the storey's floor
+    void bakeGeometry(BakedMesh& out, int floor = 0) const;
+
+    // Geometry of a storey used by the last build() (the ground floor's is
+    // saved into the world cache)
+    const BakedMesh& getMesh(int floor = 0) const { return m_storeys[floor].mesh; }
+
+    // GL texture of each RoomTextureSlot, for drawing the baked mesh elsewhere
+    void getTextures(GLuint out[ROOM_TEXTURE_SLOTS]) const {
+        out[ROOM_SLOT_FLOOR] = m_texFloor;
+        out[ROOM_SLOT_WALL] = m_texWall;
+        out[ROOM_SLOT_CEILING] = m_texCeiling;
+    }
 
     // Master draw function (Optimized to use the Display List)
-    void draw();
+    // Draws one storey at y = 0; the caller raises upper floors
+    void draw(int floor = 0);
 
 private:
     float m_width;
@@ -32,18 +69,21 @@ private:
     GLuint m_texWall;
     GLuint m_texCeiling;
 
-    // --- NEW: Variable to store the Display List ID ---
-    GLuint m_displayListID;
+    // --- NEW: Display List per storey ---
+    struct Storey {
+        BakedMesh mesh;
+        GLuint displayListID = 0;
+    };
+    std::vector<Storey> m_storeys;
+    std::vector<FloorStairs> m_stairs;
 
-    // Internal Drawing Functions
-    void drawFloor();
-    void drawWalls();
-    void drawCeiling();
+    // Internal Geometry Functions
+    void bakeFloor(BakedMesh& out, int floor) const;
+    void bakeWalls(BakedMesh& out) const;
+    void bakeStairs(BakedMesh& out, int floor) const;
+    void bakeCeiling(BakedMesh& out, int floor) const;
+    void deleteLists();
 
     // Internal Texture Management
     GLuint loadSingleTexture(const char* path);
-
-    // Helper functions for texture binding
-    void bindAndCheckTexture(GLuint textureID);
-    void unbindAndRestore();
 };
\ No newline at end of file